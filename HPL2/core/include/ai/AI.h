@@ -28,6 +28,7 @@
 namespace hpl {
 
 	class cAINodeGenerator;
+	class cAStarRequestQueue;
     
 	class cAI : public iUpdateable
 	{
@@ -41,9 +42,11 @@ namespace hpl {
 		void Init();
 		
 		cAINodeGenerator *GetNodeGenerator(){ return mpAINodeGenerator;}
+		cAStarRequestQueue *GetAStarRequestQueue(){ return mpAStarRequestQueue;}
 
 	private:
 		cAINodeGenerator *mpAINodeGenerator;
+		cAStarRequestQueue *mpAStarRequestQueue;
 	};
 
 };
@@ -29,6 +29,11 @@ namespace hpl {
 
 	class cWorld;
 
+	//--------------------------------
+
+	#define AI_NODE_CACHE_FORMAT_MAGIC_NUMBER	0x41494E43
+	#define AI_NODE_CACHE_FORMAT_VERSION		1
+
 	//--------------------------------
 	
 	typedef tFlag tAIFreePathFlag;
@@ -70,10 +75,15 @@ namespace hpl {
 		
 		const tString& GetName(){ return msName;}
 		int GetID(){ return mlID; }
+		/**
+		 * Index in the container, 0 to GetNodeNum()-1.
+		 */
+		int GetIndex() const { return mlIndex; }
 		
 	private:
 		tString msName;
 		int mlID;
+		int mlIndex;
 		cVector3f mvPosition;
 		void *mpUserData;
 
@@ -103,24 +113,39 @@ namespace hpl {
 
 	//--------------------------------
 
+	/**
+	 * Ray callback for free path checks, has no state of its own so it can be used with iPhysicsWorld::CastRays.
+	 * BeforeIntersect only reads the flags, so it can also be used as the filter for packet casts.
+	 */
 	class cAINodeRayCallback : public iPhysicsRayCallback
 	{
 	public:
-		void Reset();
-		void SetFlags(tAIFreePathFlag aFlags){ mFlags = aFlags;}
+		void Setup(tAIFreePathFlag aFlags, iAIFreePathCallback *apCallback){ mFlags = aFlags; mpCallback = apCallback;}
 		
 		bool BeforeIntersect(iPhysicsBody *pBody);
 		bool OnIntersect(iPhysicsBody *pBody,cPhysicsRayParams *apParams);
-		
-		bool Intersected();
-
-		iAIFreePathCallback *mpCallback;
 	
 	private:
-		bool mbIntersected;
+		iAIFreePathCallback *mpCallback;
 		tAIFreePathFlag mFlags;
 	};
 
+	//--------------------------------
+
+	class cAIFreePathQuery
+	{
+	public:
+		cAIFreePathQuery(){}
+		cAIFreePathQuery(const cVector3f &avStart, const cVector3f &avEnd) : mvStart(avStart), mvEnd(avEnd), mbFree(false){}
+
+		cVector3f mvStart;
+		cVector3f mvEnd;
+		bool mbFree;
+	};
+
+	typedef std::vector<cAIFreePathQuery> tAIFreePathQueryVec;
+	typedef tAIFreePathQueryVec::iterator tAIFreePathQueryVecIt;
+
 	//--------------------------------
 	
 	class cAIGridNode
@@ -232,6 +257,14 @@ namespace hpl {
 		bool FreePath(const cVector3f &avStart, const cVector3f &avEnd, int alRayNum=-1, 
 						tAIFreePathFlag aFlags=0, iAIFreePathCallback *apCallback=NULL);
 
+		/**
+		 * Same as FreePath but for many paths at once, the rays are cast in one batch. Without apCallback the
+		 * batch is cast as packets which can run in parallel.
+		 * \param apQueries The paths to check, mbFree is set for each.
+		 */
+		void FreePaths(cAIFreePathQuery *apQueries, int alNum, int alRayNum=-1, 
+						tAIFreePathFlag aFlags=0, iAIFreePathCallback *apCallback=NULL);
+
 
 		/**
 		 * Sets the max number of end node added to a node.
@@ -264,15 +297,20 @@ namespace hpl {
 
 
 		/**
-		 * Saves all the node connections to file.
+		 * Saves all the node connections to a binary cache file.
 		 */
-		void SaveToFile(const tWString &asFile);
+		bool SaveToFile(const tWString &asFile);
 		/**
-		* Loads all node connections from file. Only to be done after all nodes are loaded.
+		* Loads all node connections from a cache file. Only to be done after all nodes are loaded.
+		* \return false if the file could not be used (old version, other nodes or settings), then Compile is needed.
 		*/
-		void LoadFromFile(const tWString &asFile);
+		bool LoadFromFile(const tWString &asFile);
 
 	private:
+		unsigned int GetCacheHash();
+
+		int SetupFreePathRays(const cVector3f &avStart, const cVector3f &avEnd, int alRayNum, cPhysicsRay *apRays);
+
 		cVector2l GetGridPosFromLocal(const cVector2f &avLocalPos);
 		cAIGridNode* GetGrid(const cVector2l& avPos);
 
@@ -283,6 +321,8 @@ namespace hpl {
 		cVector3f mvSize;
 
 		cAINodeRayCallback *mpRayCallback;
+		tPhysicsRayVec mvTempRays;
+		tPhysicsRayHitVec mvTempHits;
 		tAINodeVec mvNodes;
 		tAINodeNameMap m_mapNodesByName;
 		tAINodeIDMap m_mapNodesByID;
@@ -32,6 +32,11 @@ namespace hpl {
 	
 	//-------------------------------
 
+	#define AI_NODE_GENERATOR_CACHE_FORMAT_MAGIC_NUMBER	0x41494E47
+	#define AI_NODE_GENERATOR_CACHE_FORMAT_VERSION		1
+
+	//-------------------------------
+
 	class cAINodeGeneratorParams
 	{
 	public:
@@ -59,15 +64,19 @@ namespace hpl {
 		void Generate(cWorld* apWorld,cAINodeGeneratorParams *apParams);
 
 	private:
+		bool BeforeIntersect(iPhysicsBody *pBody);
 		bool OnIntersect(iPhysicsBody *pBody,cPhysicsRayParams *apParams);
 
 		void SaveToFile();
-		void LoadFromFile();
+		bool LoadFromFile();
+		unsigned int GetParamsHash();
 
 		cAINodeGeneratorParams *mpParams;
 		cWorld* mpWorld;
 		tTempAiNodeList *mpNodeList;
 		int mlIDCount;
+
+		std::vector<tVector3fVec> mvRayGroundPoints;
 	};
 
 };
@@ -24,6 +24,8 @@
 #include "engine/EngineTypes.h"
 #include "math/MathTypes.h"
 
+#include "ai/AINodeContainer.h"
+
 namespace hpl {
 
 	class cAINodeContainer;
@@ -31,37 +33,44 @@ namespace hpl {
 
 	//--------------------------------------
 
-	typedef std::set<cAINode*> tAINodeSet;
-	typedef tAINodeSet::iterator tAINodeSetIt;
-
-	//--------------------------------------
-
 	typedef std::list<cAINode*> tAINodeList;
 	typedef tAINodeList::iterator tAINodeListIt;
 
+	typedef std::vector<cAINode*> tAINodeVec;
+	typedef tAINodeVec::iterator tAINodeVecIt;
+
 	//--------------------------------------
 
+	/**
+	 * Search data for a node, stored in a flat array indexed by cAINode::GetIndex. The data is only valid
+	 * if mlGeneration is the same as the current search, so nothing needs to be cleared between searches.
+	 */
 	class cAStarNode
 	{
 	public:
-		cAStarNode(cAINode *apAINode);
-
 		float mfCost;
 		float mfDistance;
 		
-		cAStarNode *mpParent;
-		cAINode *mpAINode;
+		int mlParent;
+		int mlHeapIdx;	//Position in open heap, -1 if not open.
+		
+		unsigned int mlGeneration;
+		unsigned int mlGoalGeneration;
+		bool mbClosed;
 	};
 
-	class cAStarNodeCompare
-	{
-	public:
-		bool operator()(cAStarNode* apNodeA,cAStarNode* apNodeB) const;
-	};
+	typedef std::vector<cAStarNode> tAStarNodeVec;
 
+	//--------------------------------------
 
-	typedef std::set<cAStarNode*,cAStarNodeCompare> tAStarNodeSet;
-	typedef tAStarNodeSet::iterator tAStarNodeSetIt;
+	enum eAStarSearchState
+	{
+		eAStarSearchState_None,
+		eAStarSearchState_Searching,
+		eAStarSearchState_Found,
+		eAStarSearchState_Failed,
+		eAStarSearchState_LastEnum
+	};
 
 	//--------------------------------------
 	class cAStarHandler;
@@ -82,32 +91,67 @@ namespace hpl {
 		cAStarHandler(cAINodeContainer *apContainer);
 		~cAStarHandler();
 		
+		/**
+		 * Finds a path from start to goal. The nodes are added goal first, so the back is the first node to move to.
+		 * If there is a free path to the goal, true is returned and no nodes are added.
+		 * Use the vector version and reuse the vector to avoid any allocations.
+		 */
+		bool GetPath(const cVector3f& avStart, const cVector3f& avGoal, tAINodeVec *apNodeVec);
 		bool GetPath(const cVector3f& avStart, const cVector3f& avGoal, tAINodeList *apNodeList);
 
 		/**
-		 * Set max number of times the algorithm is iterated.
+		 * Starts a search that is then run in steps with ContinueSearch. Any previous search is dropped.
+		 * \return The number of iterations used, where each free path check counts as one.
+		 */
+		int StartSearch(const cVector3f& avStart, const cVector3f& avGoal);
+		/**
+		 * Runs the current search.
+		 * \param alMaxIterations Max number of nodes to expand, -1 = until done.
+		 * \return The number of iterations used.
+		 */
+		int ContinueSearch(int alMaxIterations);
+		void CancelSearch();
+		eAStarSearchState GetSearchState(){ return mSearchState;}
+		/**
+		 * Adds the nodes of a found search, in the same order as GetPath.
+		 */
+		void GetSearchPath(tAINodeVec *apNodeVec);
+
+		/**
+		 * Set max number of times the algorithm is iterated for a search, counted over all ContinueSearch calls.
 		 * \param alX -1 = until OpenList is empty
 		 */
 		void SetMaxIterations(int alX){ mlMaxIterations = alX;}
 
 		void SetCallback(iAStarCallback *apCallback){ mpCallback = apCallback;}
 
+		cAINodeContainer* GetContainer(){ return mpContainer;}
+
 	private:
-		void IterateAlgorithm();
+		int AddReachableNodes(const cVector3f& avPos, bool abGoal);
 
-		void AddOpenNode(cAINode *apAINode, cAStarNode *apParent, float afDistance);
+		void BeginSearch();
+		int IterateAlgorithm(int alMaxIterations);
 
-		cAStarNode* GetBestNode();
+		void AddOpenNode(cAINode *apAINode, int alParent, float afDistance);
+
+		int GetBestNode();
 		
-		float Cost(float afDistance, cAINode *apAINode, cAStarNode *apParent);
+		float Cost(float afDistance, cAINode *apAINode, int alParent);
 		float Heuristic(const cVector3f& avStart, const cVector3f& avGoal);
 
-		bool IsGoalNode(cAINode *apAINode);
+		cAStarNode* GetSearchNode(int alIdx);
+
+		void HeapPush(int alNode);
+		int HeapPop();
+		void HeapSiftUp(int alPos);
+		void HeapSiftDown(int alPos);
 		
 		cVector3f mvGoal;
 
-        cAStarNode* mpGoalNode;
-		tAINodeSet m_setGoalNodes;
+		int mlGoalNode;
+		eAStarSearchState mSearchState;
+		int mlSearchIterations;
 
 		cAINodeContainer *mpContainer;
 
@@ -115,8 +159,12 @@ namespace hpl {
 
 		iAStarCallback *mpCallback;
 
-		tAStarNodeSet m_setOpenList;
-		tAStarNodeSet m_setClosedList;
+		unsigned int mlGeneration;
+		tAStarNodeVec mvSearchNodes;
+		std::vector<int> mvOpenHeap;
+
+		tAIFreePathQueryVec mvTempQueries;
+		tAINodeVec mvTempNodes;
 	};
 
 };
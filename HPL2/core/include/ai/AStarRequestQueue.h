@@ -0,0 +1,116 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef HPL_A_STAR_REQUEST_QUEUE_H
+#define HPL_A_STAR_REQUEST_QUEUE_H
+
+#include "system/SystemTypes.h"
+#include "math/MathTypes.h"
+
+namespace hpl {
+
+	class cAStarHandler;
+
+	//--------------------------------------
+
+	class iAStarRequestCallback
+	{
+	public:
+		virtual ~iAStarRequestCallback(){}
+
+		/**
+		 * Called when a request is done. The path (if found) is fetched with apHandler->GetSearchPath.
+		 */
+		virtual void OnAStarRequestDone(cAStarHandler *apHandler, bool abFoundPath)=0;
+	};
+
+	//--------------------------------------
+
+	class cAStarRequest
+	{
+	public:
+		cAStarHandler *mpHandler;
+		cVector3f mvStart;
+		cVector3f mvGoal;
+		iAStarRequestCallback *mpCallback;
+		bool mbStarted;
+		int mlQueuedUpdate;
+	};
+
+	typedef std::list<cAStarRequest> tAStarRequestList;
+	typedef tAStarRequestList::iterator tAStarRequestListIt;
+
+	//--------------------------------------
+
+	/**
+	 * Runs path searches over several updates, sharing a max number of iterations per update among all requests.
+	 * Requests are run oldest first and each gets an equal share of what is left of the budget, the ones not done
+	 * are continued next update. Requests that have waited more than the max wait updates are given the whole
+	 * budget one at a time, so a steady stream of new requests can not starve them.
+	 */
+	class cAStarRequestQueue
+	{
+	public:
+		cAStarRequestQueue();
+		~cAStarRequestQueue();
+
+		/**
+		 * Adds a path request, it is run by the next Update. An earlier request for the same handler is
+		 * replaced and the search restarted, but the request keeps its age and place in the queue.
+		 */
+		void AddRequest(cAStarHandler *apHandler, const cVector3f& avStart, const cVector3f& avGoal, iAStarRequestCallback *apCallback);
+		void CancelRequest(cAStarHandler *apHandler);
+		bool HasRequest(cAStarHandler *apHandler);
+		int GetRequestNum(){ return (int)mlstRequests.size();}
+
+		void Update();
+		void Reset();
+
+		/**
+		 * Max number of iterations (node expansions and free path checks) used each update, -1 = no limit.
+		 */
+		void SetMaxIterationsPerUpdate(int alX){ mlMaxIterationsPerUpdate = alX;}
+		int GetMaxIterationsPerUpdate(){ return mlMaxIterationsPerUpdate;}
+
+		int GetIterationsUsed(){ return mlIterationsUsed;}
+
+		/**
+		 * Number of updates a request can wait before it gets the whole budget.
+		 */
+		void SetMaxWaitUpdates(int alX){ mlMaxWaitUpdates = alX;}
+		int GetMaxWaitUpdates(){ return mlMaxWaitUpdates;}
+
+	private:
+		void RunRequests();
+		void RunAgedRequests();
+		bool RunRequest(cAStarRequest &aRequest, int alMaxIterations);
+		bool HasBudgetLeft();
+
+		tAStarRequestList mlstRequests;
+
+		int mlMaxIterationsPerUpdate;
+		int mlIterationsUsed;
+		int mlMaxWaitUpdates;
+		int mlUpdateCount;
+	};
+
+	//--------------------------------------
+
+};
+#endif // HPL_A_STAR_REQUEST_QUEUE_H
@@ -45,6 +45,7 @@ namespace hpl {
 	class cEngineInitVars;
 	class iTimer;
 	class iMutex;
+	class cJobScheduler;
 
 	//------------------------------------------------------
 	
@@ -127,6 +128,7 @@ namespace hpl {
 		cGui* GetGui(){ return mpGui;}
 		cHaptic* GetHaptic(){ return mpHaptic;}
 		cGenerate* GetGenerate(){ return mpGenerate;}
+		cJobScheduler* GetJobScheduler(){ return mpJobScheduler;}
 		
 		void ResetLogicTimer();
 		void SetUpdatesPerSec(int alUpdatesPerSec);
@@ -204,6 +206,8 @@ namespace hpl {
 
 		iMutex *mpMutex;
 
+		cJobScheduler *mpJobScheduler;
+
 		cFPSCounter* mpFPSCounter;
 		
 		iTimer *mpFrameTimer;
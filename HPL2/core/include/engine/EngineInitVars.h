@@ -37,10 +37,14 @@ namespace hpl {
 		{
 		public:
 			cEngineVars() :
-				mlUpdateRate(60)
+				mlUpdateRate(60),
+				mlJobWorkerThreads(-1),
+				mlPhysicsThreads(1)
 			  {}
 
 			  int mlUpdateRate;
+			  int mlJobWorkerThreads; //-1 = one per core except the main thread
+			  int mlPhysicsThreads; //Newton solver threads per physics world, 1 = single threaded
 		};
 		cEngineVars mGame;
 
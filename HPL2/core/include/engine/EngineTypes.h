@@ -41,7 +41,8 @@ namespace hpl {
 		eHplSetup_Sound =		eFlagBit_1,
 		eHplSetup_Input =		eFlagBit_2,
 		eHplSetup_Video =		eFlagBit_3, // To Do a "Half" init of the video
-		eHplSetup_All =		eFlagBit_All
+		eHplSetup_NullGraphics =	eFlagBit_4, // Use a low level graphics that renders nothing and only records commands. Not part of All.
+		eHplSetup_All =		eHplSetup_Screen | eHplSetup_Sound | eHplSetup_Input | eHplSetup_Video
 	};
 
 	//---------------------------------------
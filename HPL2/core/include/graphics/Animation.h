@@ -49,6 +49,13 @@ namespace hpl {
 
 		void SmoothAllTracks(float afAmount, float afPow, int alSamples,bool abTranslation, bool abRotation);
 
+		/**
+		 * Removes frames that can be interpolated within the error limits from all tracks, see cAnimationTrack::ReduceKeyFrames.
+		 */
+		void ReduceKeyFrames(float afMaxTransError, float afMaxRotError);
+		void SetKeyFramesReduced(bool abX){ mbKeyFramesReduced = abX;}
+		bool GetKeyFramesReduced(){ return mbKeyFramesReduced;}
+
 		const char* GetAnimationName(){ return msAnimName.c_str();}
 		void SetAnimationName(const tString &asName){ msAnimName =asName;}
 		
@@ -64,6 +71,7 @@ namespace hpl {
 		tString msFileName;
 
 		float mfLength;
+		bool mbKeyFramesReduced;
 		
 		tAnimationTrackVec mvTracks;
 	};
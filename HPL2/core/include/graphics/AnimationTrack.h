@@ -40,12 +40,20 @@ namespace hpl {
 		/**
 		 * Creates a new key frame. These should be added in sequential order.
 		 * \param afTime the time for the key frame.
+		 * \return the index of the new frame, indices after it are moved up if inserted before the last frame.
 		 */
-		cKeyFrame* CreateKeyFrame(float afTime);
+		int CreateKeyFrame(float afTime);
 		void ClearKeyFrames();
 		
-		inline cKeyFrame* GetKeyFrame(int alIndex){ return mvKeyFrames[alIndex];}
-		inline int GetKeyFrameNum(){ return (int) mvKeyFrames.size();}
+		cKeyFrame GetKeyFrame(int alIndex);
+		inline int GetKeyFrameNum(){ return (int) mvKeyTimes.size();}
+
+		inline float GetKeyFrameTime(int alIndex){ return mvKeyTimes[alIndex];}
+		inline const cVector3f& GetKeyFrameTrans(int alIndex){ return mvKeyTranslations[alIndex];}
+		inline const cQuaternion& GetKeyFrameRotation(int alIndex){ return mvKeyRotations[alIndex];}
+
+		inline void SetKeyFrameTrans(int alIndex, const cVector3f& avTrans){ mvKeyTranslations[alIndex] = avTrans;}
+		inline void SetKeyFrameRotation(int alIndex, const cQuaternion& aqRotation){ mvKeyRotations[alIndex] = aqRotation;}
 
 		inline tAnimTransformFlag GetTransformFlags(){ return mTransformFlags;}
 		
@@ -55,25 +63,41 @@ namespace hpl {
 		 * \param apNode The node with it's base pose
 		 * \param afTime The time at which to apply the animation
 		 * \param afWeight The weight of the animation, a value from 0 to 1.
+		 * \param apKeyCursor Key frame cursor kept by the caller, see GetKeyFramesAtTime. Can be NULL.
 		 */
-		void ApplyToNode(cNode3D* apNode, float afTime, float afWeight,bool bLoop=true);
+		void ApplyToNode(cNode3D* apNode, float afTime, float afWeight,bool bLoop=true, int *apKeyCursor=NULL);
 
 		/**
 		 * Get a KeyFrame that contains an interpolated value.
 		 * \param afTime The time from which to create the key frame.
 		 */
-		cKeyFrame GetInterpolatedKeyFrame(float afTime,bool bLoop=true);
+		cKeyFrame GetInterpolatedKeyFrame(float afTime,bool bLoop=true, int *apKeyCursor=NULL);
 
         /**
          * Gets key frames between for a specific time.
          * \param afTime The time
-         * \param &apKeyFrameA The frame that is equal to or before time
-         * \param &apKeyFrameB The frame that is after time. 
+         * \param apIdxA The frame that is equal to or before time
+         * \param apIdxB The frame that is after time. 
+		 * \param apKeyCursor Frame found by the last call. When time moves forward the frame is found without a search. Can be NULL.
          * \return Weight of the different frames. 0 = 100% A, 1 = 100% B 0.5 = 50% A and 50% B
          */
-        float GetKeyFramesAtTime(float afTime, cKeyFrame** apKeyFrameA,cKeyFrame** apKeyFrameB,bool bLoop=true);
+        float GetKeyFramesAtTime(float afTime, int *apIdxA, int *apIdxB, bool bLoop=true, int *apKeyCursor=NULL);
 
 		void Smooth(float afAmount, float afPow, int alSamples,bool abTranslation, bool abRotation);
+
+		/**
+		 * Gets the frames that must be kept for the track to stay within the error limits when interpolating between them.
+		 * The first and last frames are always kept, unless all frames are equal, then only the first is.
+		 * \param apKeptFrames Filled with the indices of the frames to keep, in order.
+		 * \param afMaxTransError Max distance between the interpolated and real translation.
+		 * \param afMaxRotError Max angle (radians) between the interpolated and real rotation.
+		 */
+		void GetReducedKeyFrames(tIntVec *apKeptFrames, float afMaxTransError, float afMaxRotError);
+		/**
+		 * Removes all frames not returned by GetReducedKeyFrames.
+		 * \return the number of frames removed.
+		 */
+		int ReduceKeyFrames(float afMaxTransError, float afMaxRotError);
 		
 		const tString& GetName(){ return msName;}
 		
@@ -85,12 +109,17 @@ namespace hpl {
 
 		int mlNodeIdx;
 
-		tKeyFramePtrVec mvKeyFrames;
+		tFloatVec mvKeyTimes;
+		tVector3fVec mvKeyTranslations;
+		std::vector<cQuaternion> mvKeyRotations;
 		tAnimTransformFlag mTransformFlags;
 
 		float mfMaxFrameTime;
 		
         cAnimation* mpParent;
+
+		int FindKeyFrameAfter(float afTime, int *apKeyCursor);
+		bool KeyFrameIsInterpolated(int alIdx, int alIdxA, int alIdxB, float afMaxTransError, float afMaxRotError);
 	};
 
 };
@@ -68,6 +68,7 @@ namespace hpl {
 		virtual bool SetVec4f(int alVarId, float afX,float afY,float afZ, float afW)=0;
 		virtual bool SetMatrixf(int alVarId, const cMatrixf& mMtx)=0;
 		virtual bool SetMatrixf(int alVarId, eGpuShaderMatrix mType, eGpuShaderMatrixOp mOp)=0;
+		virtual bool SetMatrixfArray(int alVarId, const cMatrixf* apMatrices, int alNum)=0;
 
         bool SetVec2f(int alVarId, const cVector2f avVec){return SetVec2f(alVarId,avVec.x, avVec.y);}
 		
@@ -81,6 +82,11 @@ namespace hpl {
 		void SetUserId(unsigned int alX){mlUserId = alX;}
 		unsigned int GetUserId(){ return mlUserId;}
 
+		/**
+		 * Small id used in render list sort keys, reused once the program is deleted.
+		 */
+		int GetSortId() const { return mlSortId;}
+
 	protected:
 		tString msName;
 		cResources *mpResources;
@@ -92,6 +98,9 @@ namespace hpl {
 		iGpuShader* mpShader[2];
 
 		bool mbAutoDestroyShaders;
+
+		int mlSortId;
+		static cSortIdPool mSortIdPool;
 	};
 
 	//---------------------------------------------------
@@ -35,6 +35,7 @@ namespace hpl {
 	#define kMaxNumOfLights (30)
 	#define kMaxClipPlanes (6)
 	#define kMaxDrawColorBuffers (4)
+	#define kMaxInstancesPerDraw (32)
 
 	//-----------------------------------------
 
@@ -289,6 +290,8 @@ namespace hpl {
 
 		eGraphicCaps_MaxColorRenderTargets,
 
+		eGraphicCaps_Instancing,
+
 		eGraphicCaps_LastEnum
 	};
 	
@@ -816,8 +819,9 @@ namespace hpl {
 	class cOcclusionQueryObject
 	{
 	public:
-		cOcclusionQueryObject() : mpQuery(NULL), mpVtxBuffer(NULL),mpMatrix(NULL), mbDepthTest(false), mlSampleResults(0) {}
+		cOcclusionQueryObject() : mpSource(NULL), mpQuery(NULL), mpVtxBuffer(NULL),mpMatrix(NULL), mbDepthTest(false), mlSampleResults(0) {}
 
+		void *mpSource;
 		int mlCustomID;
 		iOcclusionQuery *mpQuery;
 		iVertexBuffer *mpVtxBuffer;
@@ -892,6 +896,25 @@ namespace hpl {
 
 	//---------------------------------------
 
+	/**
+	 * Hands out small ids that are reused once released, so ids used in the render list sort keys stay
+	 * within the key bits as long as there are not too many objects alive at the same time.
+	 */
+	class cSortIdPool
+	{
+	public:
+		cSortIdPool();
+
+		int Get();
+		void Release(int alId);
+
+	private:
+		int mlNextId;
+		std::vector<int> mvFreeIds;
+	};
+
+	//---------------------------------------
+
 	extern tVertexElementFlag GetVertexElementFlagFromEnum(eVertexBufferElement aElement);
 	extern int GetVertexFormatByteSize(eVertexBufferElementFormat aFormat);
 	extern int GetVertexElementTextureUnit(eVertexBufferElement aElement);
@@ -0,0 +1,133 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef HPL_LIGHT_FROXEL_GRID_H
+#define HPL_LIGHT_FROXEL_GRID_H
+
+#include "math/MathTypes.h"
+
+namespace hpl {
+
+	//---------------------------------------------
+
+	class cJobScheduler;
+
+	//---------------------------------------------
+
+	class cLightFroxelRange
+	{
+	public:
+		int mlMinX, mlMaxX;
+		int mlMinY, mlMaxY;
+		int mlMinZ, mlMaxZ;
+	};
+
+	//---------------------------------------------
+
+	/**
+	 * Bins point lights into a grid of froxels (screen tiles split into depth slices). Screen tiles are evenly spaced with
+	 * x=0,y=0 in the lower left corner, slices are spaced exponentially between the near and far plane.
+	 * Lights are spheres in view space (camera looking down negative z). Each froxel gets a list of light indices, sorted
+	 * in the order the lights were added. Does not depend on any graphics, only on the projection data given in Setup.
+	 */
+	class cLightFroxelGrid
+	{
+	friend class cLightFroxelBinFunc;
+	public:
+		cLightFroxelGrid();
+		~cLightFroxelGrid();
+
+		/**
+		 * afFOV is the vertical field of view in radians. Must be called before binning and whenever projection changes.
+		 */
+		void Setup(float afFOV, float afAspect, float afNearPlane, float afFarPlane, const cVector3l& avGridSize);
+		
+		/**
+		 * Lights added to full froxels are skipped (and counted as overflow).
+		 */
+		void SetMaxLightsPerFroxel(int alX);
+		int GetMaxLightsPerFroxel(){ return mlMaxLightsPerFroxel;}
+
+		void ClearLights();
+		/**
+		 * Returns the index of the light.
+		 */
+		int AddLight(const cVector3f& avViewPos, float afRadius);
+		int GetLightNum(){ return (int)mvLightRadius.size();}
+
+		/**
+		 * Bins all added lights. Slices are binned in parallel if there is a scheduler with workers.
+		 */
+		void Bin(cJobScheduler *apJobScheduler);
+
+		const cVector3l& GetGridSize(){ return mvGridSize;}
+		int GetFroxelNum(){ return mvGridSize.x*mvGridSize.y*mvGridSize.z;}
+		
+		inline int GetFroxelIndex(int alX, int alY, int alZ){ return (alZ*mvGridSize.y + alY)*mvGridSize.x + alX;}
+		int GetFroxelLightNum(int alFroxel){ return mvFroxelLightCount[alFroxel];}
+		const unsigned short* GetFroxelLights(int alFroxel){ return &mvFroxelLights[alFroxel*mlMaxLightsPerFroxel];}
+		
+		/**
+		 * Depth is positive distance along the view direction.
+		 */
+		int GetSlice(float afDepth);
+		/**
+		 * Slice = log(depth) * scale + bias, as used when looking up froxels in shaders.
+		 */
+		float GetSliceScale(){ return mfSliceScale;}
+		float GetSliceBias(){ return mfSliceBias;}
+
+		int GetOverflowNum(){ return mlOverflowNum;}
+
+		bool GetLightRange(int alLight, cLightFroxelRange& aRange);
+
+	private:
+		void BinSlices(int alStart, int alEnd);
+		void AddLightToFroxel(int alLight, int alFroxel, int alSlice);
+
+		cVector3l mvGridSize;
+		int mlPaddedSizeX;
+		float mfNearPlane;
+		float mfFarPlane;
+		float mfTanHalfFovX;
+		float mfTanHalfFovY;
+		float mfSliceScale;
+		float mfSliceBias;
+		int mlMaxLightsPerFroxel;
+
+		//Froxel bounding boxes in view space. Rows are padded to multiple of 4 with empty boxes.
+		std::vector<float> mvFroxelMin[3];
+		std::vector<float> mvFroxelMax[3];
+
+		std::vector<float> mvLightPos[3];
+		std::vector<float> mvLightRadius;
+		std::vector<cLightFroxelRange> mvLightRanges;
+		std::vector<char> mvLightVisible;
+
+		std::vector<int> mvFroxelLightCount;
+		std::vector<unsigned short> mvFroxelLights;
+
+		std::vector<int> mvSliceOverflowNum;
+		int mlOverflowNum;
+	};
+
+	//---------------------------------------------
+
+};
+#endif // HPL_LIGHT_FROXEL_GRID_H
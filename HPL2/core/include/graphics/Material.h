@@ -114,8 +114,19 @@ namespace hpl {
 		
 		inline iTexture* GetTextureInUnit(eMaterialRenderMode aRenderMode, int alUnit) const { return mvTextureInUnit[aRenderMode][alUnit];}
 		inline iGpuProgram* GetProgram(char alSkeleton,eMaterialRenderMode aRenderMode) const { return mvPrograms[alSkeleton][aRenderMode];}
+		/**
+		 * Program used when drawing several objects with the material in one instanced call. NULL if not supported.
+		 */
+		inline iGpuProgram* GetInstancedProgram(eMaterialRenderMode aRenderMode) const { return mvInstancedPrograms[aRenderMode];}
 		inline eMaterialBlendMode GetBlendMode() const { return mBlendMode; }
 		inline eMaterialAlphaMode GetAlphaMode() const { return mAlphaMode; }
+
+		/**
+		 * Small ids used for render list sort keys, set on Compile. Taken from the program and the first texture used by the
+		 * render mode, so ids are reused once those are deleted. 0 means no program / no textures.
+		 */
+		inline int GetProgramSortId(eMaterialRenderMode aRenderMode) const { return mvProgramSortIds[aRenderMode];}
+		inline int GetTextureSetSortId(eMaterialRenderMode aRenderMode) const { return mvTextureSetSortIds[aRenderMode];}
 		inline bool GetDepthTest() const { return mbDepthTest; }
 
 		void SetPhysicsMaterial(const tString & asPhysicsMaterial){ msPhysicsMaterial = asPhysicsMaterial;}
@@ -189,8 +200,11 @@ namespace hpl {
 		bool mbUseAlphaDissolveFilter;
 
 		iGpuProgram *mvPrograms[2][eMaterialRenderMode_LastEnum]; //[2] == If it has skeleton or not.
+		iGpuProgram *mvInstancedPrograms[eMaterialRenderMode_LastEnum];
 		iTexture* mvTextures[eMaterialTexture_LastEnum];
 		iTexture* mvTextureInUnit[eMaterialRenderMode_LastEnum][kMaxTextureUnits];
+		int mvProgramSortIds[eMaterialRenderMode_LastEnum];
+		int mvTextureSetSortIds[eMaterialRenderMode_LastEnum];
 
 		std::vector<cMaterialUvAnimation> mvUvAnimations;
 		bool mbHasUvAnimation;
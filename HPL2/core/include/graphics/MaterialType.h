@@ -93,12 +93,22 @@ namespace hpl {
 
 		virtual iTexture* GetTextureForUnit(cMaterial *apMaterial,eMaterialRenderMode aRenderMode, int alUnit)=0;
 		virtual iGpuProgram* GetGpuProgram(cMaterial *apMaterial, eMaterialRenderMode aRenderMode, char alSkeleton)=0;
+		/**
+		 * Program that draws several instances in one call, NULL if the type does not support it for the mode.
+		 * Destroyed with DestroyProgram (alSkeleton=0).
+		 */
+		virtual iGpuProgram* GetInstancedGpuProgram(cMaterial *apMaterial, eMaterialRenderMode aRenderMode){ return NULL;}
 		
 		virtual void SetupTypeSpecificData(eMaterialRenderMode aRenderMode, iGpuProgram* apProgram, iRenderer *apRenderer)=0;
 		virtual void SetupMaterialSpecificData(	eMaterialRenderMode aRenderMode, iGpuProgram* apProgram, cMaterial *apMaterial, 
 												iRenderer *apRenderer)=0;
 		virtual void SetupObjectSpecificData(	eMaterialRenderMode aRenderMode, iGpuProgram* apProgram, iRenderable *apObject,
 												iRenderer *apRenderer)=0;
+		/**
+		 * Sets the model view matrices for an instanced draw, apProgram is from GetInstancedGpuProgram.
+		 */
+		virtual void SetupInstanceData(	eMaterialRenderMode aRenderMode, iGpuProgram* apProgram, const cMatrixf *apModelViewMatrices, int alNum,
+										iRenderer *apRenderer){}
 
 		int GetUsedTextureNum(){ return (int)mvUsedTextures.size(); }
 		cMaterialUsedTexture* GetUsedTexture(int alIdx){ return &mvUsedTextures[alIdx]; }
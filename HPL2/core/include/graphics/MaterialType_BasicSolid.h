@@ -50,6 +50,9 @@ namespace hpl {
 		void GetVariableValues(cMaterial *apMaterial, cResourceVarsObject* apVars);
 
 		void CompileMaterialSpecifics(cMaterial *apMaterial);
+
+		void SetupInstanceData(	eMaterialRenderMode aRenderMode, iGpuProgram* apProgram, const cMatrixf *apModelViewMatrices, int alNum,
+								iRenderer *apRenderer);
 		
 	protected:
 		virtual void CompileSolidSpecifics(cMaterial *apMaterial){}
@@ -100,6 +103,7 @@ namespace hpl {
 		iTexture* GetSpecialTexture(cMaterial *apMaterial, eMaterialRenderMode aRenderMode,iRenderer *apRenderer, int alUnit);
 		
 		iGpuProgram* GetGpuProgram(cMaterial *apMaterial, eMaterialRenderMode aRenderMode, char alSkeleton);
+		iGpuProgram* GetInstancedGpuProgram(cMaterial *apMaterial, eMaterialRenderMode aRenderMode);
 
 		void SetupTypeSpecificData(eMaterialRenderMode aRenderMode, iGpuProgram* apProgram, iRenderer *apRenderer);
 		void SetupMaterialSpecificData(	eMaterialRenderMode aRenderMode, iGpuProgram* apProgram, cMaterial *apMaterial,
@@ -112,6 +116,8 @@ namespace hpl {
 		void GetVariableValues(cMaterial *apMaterial, cResourceVarsObject *apVars);
 	
 	private:
+		iGpuProgram* GenerateProgram(cMaterial *apMaterial, eMaterialRenderMode aRenderMode, bool abInstanced);
+
 		void CompileSolidSpecifics(cMaterial *apMaterial);
 
 		void LoadSpecificData();
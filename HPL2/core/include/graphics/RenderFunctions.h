@@ -108,6 +108,7 @@ namespace hpl {
 
 
 		void DrawCurrent(eVertexBufferDrawType aDrawType = eVertexBufferDrawType_LastEnum);
+		void DrawCurrentInstanced(int alInstanceNum, eVertexBufferDrawType aDrawType = eVertexBufferDrawType_LastEnum);
 
 		void DrawWireFrame(iVertexBuffer *apVtxBuffer, const cColor &aColor);
 		
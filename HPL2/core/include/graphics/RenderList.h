@@ -32,20 +32,41 @@ namespace hpl {
 	class iLight;
 	class cFrustum;
 	class cFogArea;
+	class cJobScheduler;
 
 	//---------------------------------------------
 
 	typedef cSTLIterator<iRenderable*, tRenderableVec, tRenderableVecIt> cRenderableVecIterator;
 
+	//---------------------------------------------
+
+	typedef unsigned long long tRenderListSortKey;
+
+	class cRenderListSortEntry
+	{
+	public:
+		cRenderListSortEntry(){}
+		cRenderListSortEntry(tRenderListSortKey alKey, iRenderable *apObject) : mlKey(alKey), mpObject(apObject){}
+
+		tRenderListSortKey mlKey;
+		iRenderable *mpObject;
+	};
+
+	typedef std::vector<cRenderListSortEntry> tRenderListSortEntryVec;
+
 	//---------------------------------------------
 	
 	class cRenderList
 	{
+	friend class cRenderListGraphicsPrepareFunc;
 	public:
 		cRenderList();
 		~cRenderList();
 
-		void Setup(float afFrameTime, cFrustum *apFrustum);
+		/**
+		 * If there is a job scheduler, the graphics prepare of translucent objects is run in parallel when compiling.
+		 */
+		void Setup(float afFrameTime, cFrustum *apFrustum, cJobScheduler *apJobScheduler=NULL);
 
 		void AddObject(iRenderable *apObject);
 
@@ -53,6 +74,10 @@ namespace hpl {
 		
 		bool ArrayHasObjects(eRenderListType aType);
 		cRenderableVecIterator GetArrayIterator(eRenderListType aType);
+		/**
+		 * Direct access to a compiled array, used when runs of objects are drawn together.
+		 */
+		tRenderableVec* GetSortedArray(eRenderListType aType){ return &mvSortedArrays[aType];}
 
 		cRenderableVecIterator GetOcclusionQueryObjectIterator();
 
@@ -75,13 +100,17 @@ namespace hpl {
 
 	private:
 		void CompileArray(eRenderListType aType);
+		void PrepareGraphics();
+		void SortEntries(tRenderListSortEntryVec& avEntries);
 		
 		void FindNearestLargeSurfacePlane();
 
 		float mfFrameTime;
 		cFrustum *mpFrustum;
+		cJobScheduler *mpJobScheduler;
 
 		tRenderableVec mvOcclusionQueryObjects;
+		tRenderableVec mvGraphicsPrepareObjects;
 		tRenderableVec mvSolidObjects;
 		tRenderableVec mvTransObjects;
 		tRenderableVec mvDecalObjects;
@@ -90,6 +119,10 @@ namespace hpl {
 		std::vector<cFogArea*> mvFogAreas;
 
 		tRenderableVec mvSortedArrays[eRenderListType_LastEnum];
+
+		//Objects with a packed sort key for each list, keys are made when added (translucent on compile).
+		tRenderListSortEntryVec mvSortEntries[eRenderListType_LastEnum];
+		tRenderListSortEntryVec mvTempSortEntries;
 	};
 
 	//---------------------------------------------
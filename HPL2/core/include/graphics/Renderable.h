@@ -66,6 +66,26 @@ namespace hpl {
 		virtual void UpdateGraphicsForFrame(float afFrameTime){}
 		virtual bool UpdateGraphicsForViewport(cFrustum *apFrustum,float afFrameTime){ return true;}
 
+		/**
+		 * If true, the CPU work of UpdateGraphicsForViewport is done in PrepareGraphicsForViewport. The render list runs it
+		 * for its translucent objects in parallel jobs when compiling, so UpdateGraphicsForViewport only needs to upload.
+		 */
+		virtual bool UsesGraphicsPrepare(){ return false;}
+		/**
+		 * Called serially before the parallel prepare. Shall resolve lazy data shared with other objects (parent matrices and such).
+		 */
+		virtual void BeforeGraphicsPrepare(){}
+		/**
+		 * Builds vertex data on the CPU and must only write to the object's own data. Returns false if nothing is to be rendered.
+		 */
+		virtual bool PrepareGraphicsForViewport(cFrustum *apFrustum,float afFrameTime){ return true;}
+
+		void RunGraphicsPrepare(cFrustum *apFrustum,float afFrameTime);
+		/**
+		 * Runs the prepare unless it has already been done for the frustum this render frame. Returns the prepare result.
+		 */
+		bool EnsureGraphicsPrepared(cFrustum *apFrustum,float afFrameTime);
+
 		virtual bool UsesOcclusionQuery(){ return false; }
 		virtual void AssignOcclusionQuery(iRenderer *apRenderer){}
 		virtual bool RetrieveOcculsionQuery(iRenderer *apRenderer){ return true;}
@@ -127,6 +147,12 @@ namespace hpl {
 		void SetRenderableUserData(void* apData) { mpRenderableUserData = apData; }
 		void* GetRenderableUserData() { return mpRenderableUserData; }
 
+		/**
+		 * Set by containers that keep a list of moved objects, so an object is only added once.
+		 */
+		inline bool GetContainerUpdatePending() const { return mbContainerUpdatePending;}
+		inline void SetContainerUpdatePending(bool abX) { mbContainerUpdatePending = abX;}
+
 	protected:
 		cMatrixf m_mtxInvModel;
 		cMatrixf m_mtxPrevious;
@@ -162,6 +188,12 @@ namespace hpl {
 		iRenderableContainerNode *mpRenderContainerNode;
 
 		void* mpRenderableUserData;
+
+		bool mbContainerUpdatePending;
+
+		cFrustum *mpGraphicsPreparedFrustum;
+		int mlGraphicsPreparedFrameCount;
+		bool mbGraphicsPreparedResult;
 	};
 };
 #endif // HPL_RENDERABLE_H
@@ -25,6 +25,8 @@
 #include "scene/SceneTypes.h"
 
 #include "graphics/RenderFunctions.h"
+#include "graphics/ShadowMapAtlas.h"
+#include "graphics/SoftwareOcclusionBuffer.h"
 
 namespace hpl {
 
@@ -80,6 +82,28 @@ namespace hpl {
 
 	//---------------------------------------------
 
+	/**
+	 * Result of earlier frames for an occlusion object (source + custom index). Used when occlusion queries are latency
+	 * tolerant, mpPendingQuery is a query from an earlier frame whose result has not arrived yet.
+	 */
+	class cOcclusionQueryHistory
+	{
+	public:
+		cOcclusionQueryHistory() : mpPendingQuery(NULL), mlPendingFrame(0), mlSampleResults(0), mbHasResult(false), mlLastUsedFrame(0) {}
+
+		iOcclusionQuery *mpPendingQuery;
+		int mlPendingFrame;
+		int mlSampleResults;
+		bool mbHasResult;
+		int mlLastUsedFrame;
+	};
+
+	typedef std::pair<void*, int> tOcclusionQueryHistoryKey;
+	typedef std::map<tOcclusionQueryHistoryKey, cOcclusionQueryHistory> tOcclusionQueryHistoryMap;
+	typedef tOcclusionQueryHistoryMap::iterator tOcclusionQueryHistoryMapIt;
+
+	//---------------------------------------------
+
 	class cFogAreaRenderData
 	{
 	public:
@@ -128,6 +152,10 @@ namespace hpl {
 		int RetrieveOcclusionObjectSamples(iRenderer *apRenderer, void *apSource, int alCustomIndex);
 		void ClearOcclusionObjects(iRenderer *apRenderer);
 		void WaitAndRetrieveAllOcclusionQueries(iRenderer *apRenderer);
+		/**
+		 * Gets the samples of an object, waiting for the result unless queries are latency tolerant.
+		 */
+		int FetchOcclusionObjectSamples(iRenderer *apRenderer, cOcclusionQueryObject *apObject);
 
 		////////////////////////////
 		//Data
@@ -141,6 +169,7 @@ namespace hpl {
 		int mlCurrentOcclusionObject;
 		std::vector<cOcclusionQueryObject*> mvOcclusionObjectPool;
 		tOcclusionQueryObjectMap m_setOcclusionObjects;
+		tOcclusionQueryHistoryMap m_mapOcclusionQueryHistory;
 
 		std::vector<cFogAreaRenderData> mvFogRenderData;
 
@@ -239,11 +268,74 @@ namespace hpl {
 
 	//---------------------------------------------
 
+	/**
+	 * The tile a light uses in the shadow map atlas.
+	 */
+	class cShadowMapAtlasSlot
+	{
+	public:
+		cShadowMapAtlasSlot() : mlSize(0), mlLastUsedFrame(-1), mlLastUpdateFrame(-1), mbRendered(false) {}
+
+		cVector2l mvPos;
+		int mlSize;
+		int mlLastUsedFrame;
+		int mlLastUpdateFrame;
+		bool mbRendered;
+
+		cShadowMapLightCache mCache;
+	};
+
+	typedef std::map<iLight*, cShadowMapAtlasSlot> tShadowMapAtlasSlotMap;
+	typedef tShadowMapAtlasSlotMap::iterator tShadowMapAtlasSlotMapIt;
+
+	//---------------------------------------------
+
+	/**
+	 * The data needed to cull shadow casters for a light. Each light has its own so that several can be gathered at the same time.
+	 */
+	class cShadowCasterCullData
+	{
+	public:
+		void Setup(cFrustum *apLightFrustum, cFrustum *apViewFrustum, tRenderableVec *apCasterVec, bool abNodesPrepared);
+
+		cFrustum *mpLightFrustum;
+		cFrustum *mpViewFrustum;
+		tRenderableVec *mpCasterVec;
+
+		eFrustumPlane mvBeyondLightAndViewPlanes[6]; //Use to check if an caster is not going to affect view.
+		int mlBeyondLightAndViewPlaneNum;
+		bool mbLightBehindNearPlane;
+
+		bool mbNodesPrepared;	//If true, nodes and objects are already updated and must not be changed (gathered in a job).
+		cVector3f mvLightMin;	//AABB of light frustum, only set when nodes are prepared.
+		cVector3f mvLightMax;
+	};
+
+	//---------------------------------------------
+
+	/**
+	 * Shadow casters for a light, gathered in a job before the light is rendered.
+	 */
+	class cGatheredShadowCasters
+	{
+	public:
+		iLight *mpLight;
+		cShadowCasterCullData mCullData;
+		tRenderableVec mvCasters;
+		bool mbCastersUnchanged;
+		bool mbUsed;
+	};
+
+	typedef std::vector<cGatheredShadowCasters*> tGatheredShadowCastersVec;
+
+	//---------------------------------------------
+
 	
 	class iRenderer : public iRenderFunctions
 	{
 	friend class cRendererCallbackFunctions;
 	friend class cRenderSettings;
+	friend class cShadowCasterGatherFunc;
 	public:
 		iRenderer(const tString& asName, cGraphics *apGraphics,cResources* apResources, int alNumOfProgramComboModes);
 		virtual ~iRenderer();
@@ -302,6 +394,40 @@ namespace hpl {
 		static void SetRefractionEnabled(bool abX) { mbRefractionEnabled = abX;}
 		static bool GetRefractionEnabled(){ return mbRefractionEnabled;}
 
+		/**
+		 * If objects sharing vertex buffer and material are drawn with a single instanced call. Needs eGraphicCaps_Instancing
+		 * and shaders that support the UseInstancing feature (have the a_mtxInstanceModelView uniform). When enabled the Z and 
+		 * shadow caster lists are grouped by vertex buffer before depth.
+		 */
+		static void SetInstancingEnabled(bool abX) { mbInstancingEnabled = abX;}
+		static bool GetInstancingEnabled(){ return mbInstancingEnabled;}
+
+		/**
+		 * If shadow maps of lights without gobo are rendered to tiles in a single atlas, with updates limited by
+		 * the shadow map update scheduler. Must be set before the renderer data is loaded.
+		 */
+		static void SetShadowMapAtlasEnabled(bool abX) { mbShadowMapAtlasEnabled = abX;}
+		static bool GetShadowMapAtlasEnabled(){ return mbShadowMapAtlasEnabled;}
+
+		cShadowMapUpdateScheduler* GetShadowMapUpdateScheduler(){ return &mShadowMapUpdateScheduler;}
+
+		/**
+		 * Max number of frames old occlusion object results (halos and such) can be. 0 means the renderer waits for
+		 * the results in the same frame. Above 0 the renderer never waits, but uses the latest result that has arrived
+		 * and treats objects without any result as visible.
+		 */
+		static void SetOcclusionQueryLatency(int alX) { mlOcclusionQueryLatency = alX;}
+		static int GetOcclusionQueryLatency(){ return mlOcclusionQueryLatency;}
+
+		/**
+		 * If large static occluders are rasterized on the CPU into a low resolution depth buffer that objects and nodes
+		 * are tested against before being added to the render list.
+		 */
+		static void SetSoftwareOcclusionEnabled(bool abX) { mbSoftwareOcclusionEnabled = abX;}
+		static bool GetSoftwareOcclusionEnabled(){ return mbSoftwareOcclusionEnabled;}
+
+		cSoftwareOcclusionBuffer* GetSoftwareOcclusionBuffer(){ return &mSoftwareOcclusionBuffer;}
+
 		
 		//Debug
 		tRenderableVec *GetShadowCasterVec(){ return &mvShadowCasters;}
@@ -322,17 +448,42 @@ namespace hpl {
 		void CreateAndAddShadowMap(eShadowMapResolution aResolution, const cVector3l &avSize, ePixelFormat aFormat);
 		cShadowMapData* GetShadowMapData(eShadowMapResolution aResolution, iLight *apLight);
 		bool ShadowMapNeedsUpdate(iLight *apLight, cShadowMapData *apShadowData);
+		bool ShadowMapCacheIsValid(iLight *apLight, cShadowMapLightCache &aCache);
 		void DestroyShadowMaps();
 
+		/**
+		 * Tile sizes are taken from the shadow maps, so call after CreateAndAddShadowMap.
+		 */
+		void CreateShadowMapAtlas(int alSize, ePixelFormat aFormat);
+		bool ShadowMapAtlasIsUsable(iLight *apLight);
+		int GetShadowMapAtlasTileSize(eShadowMapResolution aResolution);
+		/**
+		 * Returns NULL if there is no room, slots used during the current frame are never evicted.
+		 */
+		cShadowMapAtlasSlot* GetShadowMapAtlasSlot(iLight *apLight, int alTileSize);
+		/**
+		 * Returns true if the light only has static casters and its tile is still valid. Casters need not be gathered then.
+		 */
+		bool ShadowMapAtlasHasCachedStaticLight(iLight *apLight, int alTileSize);
+		bool ShadowMapAtlasSlotNeedsUpdate(iLight *apLight, cShadowMapAtlasSlot *apSlot, float afDistance);
+		/**
+		 * Matrix that transforms shadow map coordinates (0-1) to coordinates of the inner part of the tile.
+		 */
+		cMatrixf GetShadowMapAtlasTileMatrix(cShadowMapAtlasSlot *apSlot);
+
 
         void RenderZObject(iRenderable *apObject, cFrustum *apCustomFrustum);
+		/**
+		 * Renders a run from GetInstanceRunLength (all objects sharing vertex buffer and material) to Z.
+		 */
+		void RenderZObjects(iRenderable **apObjects, int alNum, cFrustum *apCustomFrustum);
 
 		/**
 		 * Brute force adding of visible objects. Nothing is rendered.
 		 */
 		void CheckForVisibleAndAddToList(iRenderableContainer *apContainer, tRenderableFlag alNeededFlags); 
 
-		void CheckNodesAndAddToListIterative(iRenderableContainerNode *apNode, tRenderableFlag alNeededFlags);
+		void CheckNodesAndAddToListIterative(iRenderableContainerNode *apNode, tRenderableFlag alNeededFlags, eCollision aPrevCollision=eCollision_Intersect);
 
 
 		/**
@@ -353,16 +504,28 @@ namespace hpl {
 		void PushNodeChildrenToStack(tRendererSortedNodeSet& a_setNodeStack, iRenderableContainerNode *apNode, int alNeededFlags);
 		void AddAndRenderNodeOcclusionQuery(tNodeOcclusionPairList *apList, iRenderableContainerNode *apNode, bool abObjectsRendered);
 
-		bool CheckShadowCasterContributesToView(iRenderable *apObject);
-		void GetShadowCastersIterative(iRenderableContainerNode *apNode, eCollision aPrevCollision);
-		void GetShadowCasters(iRenderableContainer *apContainer, tRenderableVec& avObjectVec, cFrustum *apLightFrustum);
+		bool CheckShadowCasterContributesToView(iRenderable *apObject, cShadowCasterCullData *apCullData);
+		void GetShadowCastersIterative(iRenderableContainerNode *apNode, eCollision aPrevCollision, cShadowCasterCullData *apCullData);
+		void GetShadowCasters(iRenderableContainer *apContainer, cShadowCasterCullData *apCullData);
 		bool SetupShadowMapRendering(iLight *apLight);
 
+		/**
+		 * Gathers the shadow casters of all the lights in parallel jobs. SetupShadowMapRendering then uses the gathered
+		 * casters instead of walking the containers. Must be called with the same occlusion planes as used when rendering the lights.
+		 * Does nothing if there is no job scheduler with workers.
+		 */
+		void GatherShadowCasters(iLight **apLights, int alLightNum);
+		void PrepareShadowCasterNodesIterative(iRenderableContainerNode *apNode, const cVector3f& avMin, const cVector3f& avMax);
+		cGatheredShadowCasters* GetGatheredShadowCasters(iLight *apLight);
+
 		static bool RenderShadowCasterCHCStaticCallback(iRenderer *apRenderer, iRenderable *apObject);
 		bool RenderShadowCasterCHC(iRenderable *apObject);
 		void RenderShadowCaster(iRenderable *apObject, cFrustum *apLightFrustum);
 		void RenderShadowCastersNormal(cFrustum *apLightFrustum);
-		void RenderShadowMap(iLight *apLight, iFrameBuffer *apShadowBuffer);
+		/**
+		 * If alTileSize > 0 the map is rendered to a tile of the buffer (an atlas), else the entire buffer is used.
+		 */
+		void RenderShadowMap(iLight *apLight, iFrameBuffer *apShadowBuffer, const cVector2l &avTilePos=0, int alTileSize=0);
 
 		/**
 		 * Only depth is needed for framebuffer. All objects needs to be added to renderlist!
@@ -373,17 +536,36 @@ namespace hpl {
 		 * This retrieves all occlusion information for light pair queries and release occlusion queries. If specified, this is a waiting operation.
 		 */
 		void RetrieveAllLightOcclusionPair(bool abWaitForResult);
+
+		/**
+		 * Rasterizes the largest static occluders in view into the software occlusion buffer. CheckObjectIsVisible and
+		 * CheckNodeIsVisible test against the buffer until EndSoftwareOcclusion is called.
+		 */
+		void BeginSoftwareOcclusion();
+		void EndSoftwareOcclusion(){ mbSoftwareOcclusionActive = false;}
+		void CollectSoftwareOccluders(iRenderableContainerNode *apNode);
+		bool CheckBVIsSoftwareOccluded(const cVector3f& avMin, const cVector3f& avMax);
 		
 		
 		void RenderBasicSkyBox();
 
 		bool SetupLightScissorRect(iLight *apLight, cMatrixf *apViewSpaceMatrix);
 				
-		void SetMaterialProgram(eMaterialRenderMode aRenderMode, cMaterial *apMaterial);
+		void SetMaterialProgram(eMaterialRenderMode aRenderMode, cMaterial *apMaterial, bool abInstanced=false);
 		void SetMaterialTextures(eMaterialRenderMode aRenderMode, cMaterial *apMaterial);
 		
 		void DrawCurrentMaterial(eMaterialRenderMode aRenderMode, iRenderable *apObject);
 
+		/**
+		 * Returns the number of objects, starting at apObjects[0], that share vertex buffer and material and can be drawn
+		 * with a single instanced call. 1 means the first object must be drawn on its own. Never more than kMaxInstancesPerDraw.
+		 */
+		int GetInstanceRunLength(iRenderable **apObjects, int alNum, eMaterialRenderMode aRenderMode, cFrustum *apCustomFrustum);
+		/**
+		 * Draws a run from GetInstanceRunLength. Textures and render states must already be set up.
+		 */
+		void DrawInstancedRun(iRenderable **apObjects, int alNum, eMaterialRenderMode aRenderMode, cFrustum *apCustomFrustum);
+
 
 		/**
 		 * Checks if the renderable object is 1) submeshentity 2) is onesided plane 3)is away from camera. If all are true, FALSE is returned.
@@ -466,6 +648,14 @@ namespace hpl {
 		float mfScissorLastTanHalfFov;
 
 		tRenderableVec mvShadowCasters;
+		tRenderableVec mvTempContainerObjects;
+
+		cShadowCasterCullData mShadowCasterCullData;
+		tGatheredShadowCastersVec mvGatheredShadowCasters;
+		int mlGatheredShadowCasterNum;
+		int mlShadowCastersUnchanged;	//-1 = unknown, else result of ShadowCastersAreUnchanged done when gathering.
+
+		std::vector<cMatrixf> mvInstanceMatrices;	//Model view matrices of all instanced draws this frame.
 
 		static int mlRenderFrameCount;
 		float mfTimeCount;
@@ -481,6 +671,16 @@ namespace hpl {
 
 		std::vector<cShadowMapData*> mvShadowMapData[eShadowMapResolution_LastEnum];
 
+		cShadowMapAtlas *mpShadowMapAtlas;
+		iTexture *mpShadowMapAtlasTexture;
+		iFrameBuffer *mpShadowMapAtlasBuffer;
+		tShadowMapAtlasSlotMap m_mapShadowMapAtlasSlots;
+		cShadowMapUpdateScheduler mShadowMapUpdateScheduler;
+
+		cSoftwareOcclusionBuffer mSoftwareOcclusionBuffer;
+		bool mbSoftwareOcclusionActive;
+		std::vector<std::pair<float, iRenderable*> > mvSoftwareOccluders;
+
 		float mfTempAlpha;
 
         //Static variables
@@ -490,6 +690,10 @@ namespace hpl {
 		static bool mbParallaxEnabled;
 		static int mlReflectionSizeDiv;
 		static bool mbRefractionEnabled;
+		static bool mbInstancingEnabled;
+		static bool mbShadowMapAtlasEnabled;
+		static int mlOcclusionQueryLatency;
+		static bool mbSoftwareOcclusionEnabled;
 	};
 
 	//---------------------------------------------
@@ -21,6 +21,7 @@
 #define HPL_RENDERER_DEFERRED_H
 
 #include "graphics/Renderer.h"
+#include "graphics/LightFroxelGrid.h"
 
 namespace hpl {
 
@@ -55,6 +56,8 @@ namespace hpl {
 		eDeferredLightList_Box_StencilFront_RenderBack,
 		eDeferredLightList_Box_RenderBack,
 
+		eDeferredLightList_Clustered,					//Binned in froxels and all drawn with a single full screen quad.
+
 		eDeferredLightList_LastEnum
 	};
 
@@ -104,7 +107,7 @@ namespace hpl {
 	class cDeferredLight
 	{
 	public:
-		cDeferredLight() : mpShadowTexture(NULL), mbCastShadows(false){}
+		cDeferredLight() : mpShadowTexture(NULL), mbCastShadows(false), mfShadowDistance(0), mbShadowInAtlas(false), mbShadowCachedInAtlas(false){}
 
 		iLight *mpLight;
 		cRect2l mClipRect;
@@ -117,6 +120,11 @@ namespace hpl {
 		iTexture *mpShadowTexture;
 		bool mbCastShadows;
 		eShadowMapResolution mShadowResolution;
+		float mfShadowDistance;
+		
+		bool mbShadowInAtlas;
+		bool mbShadowCachedInAtlas;	//Static casters only and tile is valid, no need to get casters.
+		cMatrixf m_mtxShadowAtlasTile;
 	};
 
 	//---------------------------------------------
@@ -176,6 +184,13 @@ namespace hpl {
 		static void SetEdgeSmoothLoaded(bool abX){ mbEdgeSmoothLoaded = abX;}
 		static bool GetEdgeSmoothLoaded(){ return mbEdgeSmoothLoaded;}
 
+		/**
+		 * Simple point lights (no gobo, same falloff map) are binned into a froxel grid and shaded in a single pass
+		 * instead of a pass per light. Needs float textures and the deferred_light_clustered_frag.glsl shader.
+		 */
+		static void SetClusteredLightsLoaded(bool abX){ mbClusteredLightsLoaded = abX;}
+		static bool GetClusteredLightsLoaded(){ return mbClusteredLightsLoaded;}
+
 		static void SetOcclusionTestLargeLights(bool abX){ mbOcclusionTestLargeLights = abX;}
 		static bool GetOcclusionTestLargeLights(){ return mbOcclusionTestLargeLights;}
 
@@ -207,6 +222,9 @@ namespace hpl {
 		void RenderLights_Batches();
 		void RenderLights_Box_StencilFront_RenderBack();
 		void RenderLights_Box_RenderBack();
+		void RenderLights_Clustered();
+		bool CanRenderLightClustered(cDeferredLight* apLightData);
+		void UploadClusteredLightData();
         
 		void RenderIllumination();
 
@@ -310,7 +328,18 @@ namespace hpl {
 		iGpuProgram *mpEdgeSmooth_UnpackDepthProgram;
 		iGpuProgram *mpEdgeSmooth_RenderProgram;
 
+		cLightFroxelGrid mLightFroxelGrid;
+		iTexture *mpClusteredLightDataTexture;
+		iTexture *mpClusteredFroxelTexture;
+		iTexture *mpClusteredLightIndexTexture;
+		iTexture *mpClusteredFalloffMap;
+		iGpuProgram *mpClusteredLightProgram;
+		std::vector<float> mvClusteredLightData;
+		std::vector<float> mvClusteredFroxelData;
+		std::vector<float> mvClusteredLightIndexData;
+
 		std::vector<cDeferredLight*> mvTempDeferredLights;
+		std::vector<iLight*> mvTempShadowCastingLights;
 		std::vector<cDeferredLight*> mvSortedLights[eDeferredLightList_LastEnum];
 
 		iGpuProgram *mpSkyBoxProgram; 
@@ -337,6 +366,7 @@ namespace hpl {
 		static int mlSSAOBufferSizeDiv;
 
 		static bool mbEdgeSmoothLoaded;
+		static bool mbClusteredLightsLoaded;
 		static bool mbEnableParallax;
 
 		static bool mbDebugRenderFrameBuffers;
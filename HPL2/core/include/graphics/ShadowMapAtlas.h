@@ -0,0 +1,145 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef HPL_SHADOW_MAP_ATLAS_H
+#define HPL_SHADOW_MAP_ATLAS_H
+
+#include "math/MathTypes.h"
+
+namespace hpl {
+
+	//---------------------------------------------
+
+	enum eShadowMapUpdate
+	{
+		eShadowMapUpdate_Render,	//Shadow map must be (re)rendered this frame.
+		eShadowMapUpdate_Cached,	//Shadow map content is still valid.
+		eShadowMapUpdate_Delayed,	//Shadow map is outdated but update is postponed because of rate or budget.
+		eShadowMapUpdate_LastEnum,
+	};
+
+	//---------------------------------------------
+
+	/**
+	 * Allocates square power of two tiles in a shadow map atlas. The atlas is split like a quad tree, a tile is
+	 * split into four when a smaller one is needed and four free siblings are merged back when freed.
+	 * Positions are in texels with origin in the upper left corner (same as frame buffer positions).
+	 */
+	class cShadowMapAtlas
+	{
+	public:
+		cShadowMapAtlas(int alSize, int alMinTileSize);
+		~cShadowMapAtlas();
+
+		/**
+		 * Size is rounded up to the nearest power of two (and at least min tile size). Returns false if there is no room.
+		 */
+		bool Allocate(int alSize, cVector2l &avPos);
+		/**
+		 * Size must be the same as when allocated.
+		 */
+		void Free(const cVector2l &avPos, int alSize);
+		void Clear();
+
+		int GetSize(){ return mlSize;}
+		int GetMinTileSize(){ return mlMinTileSize;}
+		int GetFreeTexels(){ return mlFreeTexels;}
+
+		int GetTileSize(int alSize);
+
+	private:
+		int GetLevel(int alTileSize);
+		bool SplitLevel(int alLevel);
+		int FindFreeTile(int alLevel, const cVector2l &avPos);
+
+		int mlSize;
+		int mlMinTileSize;
+		int mlFreeTexels;
+
+		std::vector< std::vector<cVector2l> > mvFreeTiles;	//One list per level, level 0 is the entire atlas.
+	};
+
+	//---------------------------------------------
+
+	class cShadowMapUpdateRequest
+	{
+	public:
+		cShadowMapUpdateRequest() : mlTexels(0), mfDistance(0), mlFramesSinceUpdate(0), mbContentValid(false), mbCastersChanged(true) {}
+
+		int mlTexels;				//Number of texels the update renders.
+		float mfDistance;			//Distance from camera to light.
+		int mlFramesSinceUpdate;
+		bool mbContentValid;		//False if never rendered or if the light has moved or changed shape.
+		bool mbCastersChanged;		//True if any of the shadow casters have changed since last update.
+	};
+
+	//---------------------------------------------
+
+	/**
+	 * Decides which shadow maps are rendered each frame. Maps with invalid content are always rendered. Maps where only
+	 * casters have changed are updated at a lower rate the further away the light is, and only as long as the texel budget
+	 * for the frame allows it. Maps where nothing has changed (eg lights with static casters only) are never re-rendered.
+	 * Does not touch any graphics and only relies on the requests.
+	 */
+	class cShadowMapUpdateScheduler
+	{
+	public:
+		cShadowMapUpdateScheduler();
+
+		void BeginFrame();
+
+		eShadowMapUpdate Schedule(const cShadowMapUpdateRequest &aRequest);
+
+		/**
+		 * Number of frames between updates of a light with changed casters at the distance.
+		 */
+		int GetUpdateInterval(float afDistance);
+
+		void SetMaxTexelsPerFrame(int alX){ mlMaxTexelsPerFrame = alX;}
+		int GetMaxTexelsPerFrame(){ return mlMaxTexelsPerFrame;}
+
+		/**
+		 * Lights closer than afStart are updated every frame, after that the interval grows with one frame each afStep.
+		 */
+		void SetReducedRateDistance(float afStart, float afStep){ mfReducedRateStart = afStart; mfReducedRateStep = afStep;}
+		float GetReducedRateStart(){ return mfReducedRateStart;}
+		float GetReducedRateStep(){ return mfReducedRateStep;}
+
+		void SetMaxUpdateInterval(int alX){ mlMaxUpdateInterval = alX;}
+		int GetMaxUpdateInterval(){ return mlMaxUpdateInterval;}
+
+		int GetRenderedTexels(){ return mlRenderedTexels;}
+		int GetRenderedNum(){ return mlRenderedNum;}
+		int GetDelayedNum(){ return mlDelayedNum;}
+
+	private:
+		int mlMaxTexelsPerFrame;
+		float mfReducedRateStart;
+		float mfReducedRateStep;
+		int mlMaxUpdateInterval;
+
+		int mlRenderedTexels;
+		int mlRenderedNum;
+		int mlDelayedNum;
+	};
+
+	//---------------------------------------------
+
+};
+#endif // HPL_SHADOW_MAP_ATLAS_H
@@ -0,0 +1,108 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef HPL_SKINNING_H
+#define HPL_SKINNING_H
+
+#include "math/MathTypes.h"
+
+namespace hpl {
+
+	//-------------------------------------------
+
+	#define kMaxSkinningInfluences (4)
+
+	enum eSkinningKernel
+	{
+		eSkinningKernel_Scalar,
+		eSkinningKernel_SSE2,
+		eSkinningKernel_AVX2,
+		eSkinningKernel_LastEnum
+	};
+
+	//-------------------------------------------
+
+	/**
+	 * The bone weights and indices of a mesh transposed into one stream per influence slot.
+	 * Unused slots have weight 0 and bone 0, so kernels can run all slots up to mlMaxInfluences without branching.
+	 */
+	class cSkinningStreams
+	{
+	public:
+		cSkinningStreams();
+
+		void Setup(const float *apWeights, const unsigned char *apBones, int alVertexNum);
+		void Clear();
+
+		bool IsEmpty() const { return mlVertexNum==0; }
+
+		int mlVertexNum;
+		int mlMaxInfluences;
+		tFloatVec mvWeights[kMaxSkinningInfluences];
+		std::vector<unsigned char> mvBones[kMaxSkinningInfluences];
+	};
+
+	//-------------------------------------------
+
+	class cSkinningParams
+	{
+	public:
+		cSkinningParams();
+
+		const cSkinningStreams *mpStreams;
+		const cMatrixf *mpBoneMatrices;
+
+		const float *mpBindPos;
+		const float *mpBindNormal;
+		const float *mpBindTangent;
+
+		float *mpSkinPos;
+		float *mpSkinNormal;
+		float *mpSkinTangent;
+
+		int mlPosStride;
+		int mlStartVertex;
+		int mlEndVertex;
+	};
+
+	//-------------------------------------------
+
+	/**
+	 * CPU skinning of position, normal and tangent. The fastest kernel the CPU supports is picked at startup.
+	 * Only xyz of the skinned tangent is written, w is kept as is.
+	 */
+	class cSkinning
+	{
+	public:
+		static void SkinVertices(const cSkinningParams& aParams);
+		static void SkinVertices(const cSkinningParams& aParams, eSkinningKernel aKernel);
+
+		static eSkinningKernel GetKernel();
+		/**
+		 * Sets the kernel used, falls back to the best supported one if not available.
+		 */
+		static void SetKernel(eSkinningKernel aKernel);
+		static bool KernelIsSupported(eSkinningKernel aKernel);
+		static const char* GetKernelName(eSkinningKernel aKernel);
+	};
+
+	//-------------------------------------------
+
+};
+#endif // HPL_SKINNING_H
@@ -0,0 +1,86 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef HPL_SOFTWARE_OCCLUSION_BUFFER_H
+#define HPL_SOFTWARE_OCCLUSION_BUFFER_H
+
+#include "math/MathTypes.h"
+
+namespace hpl {
+
+	//---------------------------------------------
+
+	/**
+	 * Low resolution depth buffer that large occluders are rasterized into on the CPU, so that bounding boxes can be
+	 * tested for visibility without any GPU queries. Depth is stored as 1/w (inverse view depth, 0 is infinitely far)
+	 * since it is linear in screen space and has the same relative precision at all distances. x=0,y=0 is the lower left corner. Coverage is sampled at pixel centers and tests check a one pixel border around
+	 * the box, so thin gaps between occluders are not trusted.
+	 */
+	class cSoftwareOcclusionBuffer
+	{
+	public:
+		cSoftwareOcclusionBuffer();
+		~cSoftwareOcclusionBuffer();
+
+		void SetSize(int alWidth, int alHeight);
+		int GetWidth(){ return mlWidth;}
+		int GetHeight(){ return mlHeight;}
+
+		/**
+		 * Clears the buffer to infinitely far. The view projection matrix is used for all occluders and tests until next Clear.
+		 */
+		void Clear(const cMatrixf& a_mtxViewProj);
+
+		/**
+		 * Rasterizes an indexed triangle list. alPosStride is the number of floats per position (at least 3).
+		 */
+		void AddOccluder(	const cMatrixf& a_mtxWorld, const float *apPositions, int alPosStride, int alVertexNum,
+							const unsigned int *apIndices, int alIndexNum);
+
+		/**
+		 * Returns false only if the whole box is behind occluders. Boxes crossing the eye plane are always visible.
+		 */
+		bool TestAABB(const cVector3f& avMin, const cVector3f& avMax);
+
+		bool IsEmpty(){ return mlTriangleNum<=0;}
+		int GetTriangleNum(){ return mlTriangleNum;}
+		int GetOccludedNum(){ return mlOccludedNum;}
+
+		float GetInvDepth(int alX, int alY){ return mvInvDepth[alY*mlWidth + alX];}
+
+	private:
+		void RasterizeClipTriangle(const float *apV0, const float *apV1, const float *apV2);
+		void RasterizeTriangle(const cVector3f& avP0, const cVector3f& avP1, const cVector3f& avP2);
+		cVector3f ClipToScreen(const float *apClipPos);
+
+		int mlWidth;
+		int mlHeight;
+		cMatrixf m_mtxViewProj;
+		std::vector<float> mvInvDepth;
+
+		std::vector<float> mvTransformedPos;
+
+		int mlTriangleNum;
+		int mlOccludedNum;
+	};
+
+	//---------------------------------------------
+
+};
+#endif // HPL_SOFTWARE_OCCLUSION_BUFFER_H
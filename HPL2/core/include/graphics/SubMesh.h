@@ -25,6 +25,7 @@
 #include "system/SystemTypes.h"
 #include "math/MeshTypes.h"
 #include "physics/PhysicsTypes.h"
+#include "graphics/Skinning.h"
 
 namespace hpl {
 
@@ -110,6 +111,8 @@ namespace hpl {
 		const cVector3f& GetOneSidedNormal(){ return mvOneSidedNormal;}
 		const cVector3f& GetOneSidedPoint(){ return mvOneSidedPoint;}
 
+		const cSkinningStreams* GetSkinningStreams(){ return &mSkinningStreams;}
+
 		void SetMaterialName(const tString& asName){msMaterialName =asName;}
 		const tString& GetMaterialName(){ return msMaterialName;}
 		
@@ -132,6 +135,7 @@ namespace hpl {
 
 		float *mpVertexWeights;
 		unsigned char *mpVertexBones;
+		cSkinningStreams mSkinningStreams;
 
 		tTriEdgeVec mvEdges;
 		tTriangleDataVec mvTriangles;
@@ -44,10 +44,11 @@ namespace hpl {
 				mfFrameTime(1), mAnimMode(eTextureAnimMode_Loop), mlSizeDownScaleLevel(0), mvMinDownScaleSize(16,16,16),
 				mfAnisotropyDegree(1.0f),mFilter(eTextureFilter_Bilinear),
 				mCompareMode(eTextureCompareMode_None),
-				mCompareFunc(eTextureCompareFunc_LessOrEqual)
+				mCompareFunc(eTextureCompareFunc_LessOrEqual),
+				mlSortId(mSortIdPool.Get())
 		{}
 
-		virtual ~iTexture(){}
+		virtual ~iTexture(){ mSortIdPool.Release(mlSortId);}
 
 		bool Reload(){ return false;}
 		void Unload(){}
@@ -116,6 +117,11 @@ namespace hpl {
 		void SetMinLevelSize(const cVector2l& avSize){ mvMinDownScaleSize = avSize;}
 
 		eFrameBufferAttachment GetFrameBufferAttachmentType(){ return eFrameBufferAttachment_Texture;}
+
+		/**
+		 * Small id used in render list sort keys, reused once the texture is deleted.
+		 */
+		int GetSortId() const { return mlSortId;}
 		
 		virtual bool HasAnimation()=0;
 		virtual void NextFrame()=0;
@@ -152,6 +158,8 @@ namespace hpl {
 		unsigned int mlSizeDownScaleLevel;
 		cVector3l mvMinDownScaleSize;
 
+		int mlSortId;
+		static cSortIdPool mSortIdPool;
 	};
 };
 #endif // HPL_TEXTURE_H
@@ -74,6 +74,11 @@ namespace hpl {
 		virtual void Draw(eVertexBufferDrawType aDrawType = eVertexBufferDrawType_LastEnum)=0;
 		virtual void DrawIndices(	unsigned int *apIndices, int alCount,
 									eVertexBufferDrawType aDrawType = eVertexBufferDrawType_LastEnum)=0;
+		/**
+		 * Draws the buffer alInstanceNum times in one call. Requires eGraphicCaps_Instancing, the program
+		 * must get the per instance data (using the instance id) itself.
+		 */
+		virtual void DrawInstanced(int alInstanceNum, eVertexBufferDrawType aDrawType = eVertexBufferDrawType_LastEnum)=0;
 
 		virtual void Bind()=0;
 		virtual void UnBind()=0;
@@ -31,6 +31,8 @@
 #include "system/PreprocessParser.h"
 #include "system/Thread.h"
 #include "system/Mutex.h"
+#include "system/JobScheduler.h"
+#include "system/NameIndex.h"
 #include "system/Platform.h"
 #include "system/SHA1.h"
 
@@ -170,9 +172,11 @@
 #include "physics/PhysicsJointSlider.h"
 #include "physics/SurfaceData.h"
 #include "physics/PhysicsRope.h"
+#include "physics/PhysicsActivationManager.h"
 
 #include "ai/AI.h"
 #include "ai/AStar.h"
+#include "ai/AStarRequestQueue.h"
 #include "ai/AINodeContainer.h"
 #include "ai/AINodeGenerator.h"
 #include "ai/StateMachine.h"
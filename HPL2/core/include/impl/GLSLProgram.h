@@ -76,6 +76,7 @@ namespace hpl {
 
 		bool SetMatrixf(int alVarId, const cMatrixf& aMtx);
 		bool SetMatrixf(int alVarId, eGpuShaderMatrix aType, eGpuShaderMatrixOp aOp);
+		bool SetMatrixfArray(int alVarId, const cMatrixf* apMatrices, int alNum);
 		
 	private:
 		void LogProgramInfoLog();
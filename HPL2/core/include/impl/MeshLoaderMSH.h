@@ -31,12 +31,15 @@ namespace hpl {
 	class iVertexBuffer;
 	class cBone;
 	class cAnimation;
+	class cAnimationTrack;
 	class cNode3D;
 
 	//----------------------------------------------------------
 
 	#define MSH_FORMAT_MAGIC_NUMBER		0x76034569
 	#define MSH_FORMAT_VERSION			7
+	//Same as MSH_FORMAT_VERSION, but with animations in the compressed clip format.
+	#define MSH_FORMAT_COMPRESSED_ANIMATION_VERSION	8
 
 	//----------------------------------------------------------
 	
@@ -47,16 +50,32 @@ namespace hpl {
 		~cMeshLoaderMSH();
 
 		cMesh* LoadMesh(const tWString& asFile, tMeshLoadFlag aFlags);
+		/**
+		 * If abCurrentVersionOnly is set, a file not saved with the current animation compression setting is treated as
+		 * a stale cache and NULL is returned, so it can be re-created from the source.
+		 */
+		cMesh* LoadMesh(const tWString& asFile, tMeshLoadFlag aFlags, bool abCurrentVersionOnly);
 		bool SaveMesh(cMesh* apMesh,const tWString& asFile);
 
 		cWorld* LoadWorld(const tWString& asFile, cScene* apScene,tWorldLoadFlag aFlags);
 
 		cAnimation* LoadAnimation(const tWString& asFile);
+		cAnimation* LoadAnimation(const tWString& asFile, bool abCurrentVersionOnly);
 		bool SaveAnimation(cAnimation* apAnimation, const tWString& asFile);
 
+		/**
+		 * The version files are saved with, depends on cResources::GetCompressAnimations.
+		 */
+		static int GetCurrentVersion();
+
 	private:
-		void AddAnimation(cAnimation *apAnimation, cBinaryBuffer* apBuffer);
-		cAnimation* GetAnimation(cBinaryBuffer* apBuffer, const tWString &asFullPath);
+		bool CheckVersion(int alVersion, const tWString& asFile, bool abCurrentVersionOnly);
+
+		void AddAnimation(cAnimation *apAnimation, cBinaryBuffer* apBuffer, bool abCompressed);
+		cAnimation* GetAnimation(cBinaryBuffer* apBuffer, const tWString &asFullPath, bool abCompressed);
+
+		void AddCompressedKeyFrames(cAnimationTrack *apTrack, const tIntVec& avFrames, cBinaryBuffer* apBuffer);
+		void GetCompressedKeyFrames(cAnimationTrack *apTrack, int alFrameNum, cBinaryBuffer* apBuffer);
 
 		void AddNodeToBuffer(cNode3D *apNode, cBinaryBuffer* apBuffer, int alLevel);
 		void GetNodeFromBuffer(cNode3D *apParentNode, cMesh *apMesh, cBinaryBuffer* apBuffer, int alLevel);
@@ -30,6 +30,8 @@
 namespace hpl {
 
 	class iPhysicsBody;
+	class cPhysicsBodyNewton;
+	class cPhysicsContactData;
 	
 	//------------------------------------------
 
@@ -66,6 +68,13 @@ namespace hpl {
 		void UpdateMaterials();
 
 		int GetId(){ return mlMaterialId;}
+
+		/**
+		 * Creates the surface effects and sounds for a contact and calls the body callbacks.
+		 * Not thread safe, called from the contact callback or the deferred contact queue of the world.
+		 */
+		static void ProcessContact(	cPhysicsBodyNewton *apBody1, cPhysicsBodyNewton *apBody2,
+									cPhysicsContactData *apContactData, int alContactNum);
 	private:
 		float Combine(ePhysicsMaterialCombMode aMode, float afX, float afY);
 
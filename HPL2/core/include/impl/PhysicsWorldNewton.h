@@ -21,6 +21,7 @@
 #define HPL_PHYSICS_WORLD_NEWTON_H
 
 #include "physics/PhysicsWorld.h"
+#include "physics/PhysicsMaterial.h"
 
 #if defined(__linux__) || defined(__APPLE__)
 #include <unistd.h>
@@ -28,6 +29,37 @@
 #include <Newton.h>
 
 namespace hpl {
+
+	class cPhysicsBodyNewton;
+
+	//------------------------------------------
+
+	/**
+	 * A contact found by a solver thread, kept until the step is done so that sounds,
+	 * effects and body callbacks are run on the main thread.
+	 */
+	class cPhysicsContactEventNewton
+	{
+	public:
+		cPhysicsBodyNewton *mpBody1;
+		cPhysicsBodyNewton *mpBody2;
+		cPhysicsContactData mContactData;
+		int mlContactNum;
+	};
+
+	typedef std::vector<cPhysicsContactEventNewton> tPhysicsContactEventNewtonVec;
+
+	class cPhysicsJointLimitEventNewton
+	{
+	public:
+		iPhysicsJoint *mpJoint;
+		bool mbMaxLimit;
+	};
+
+	typedef std::vector<cPhysicsJointLimitEventNewton> tPhysicsJointLimitEventNewtonVec;
+
+	//------------------------------------------
+
 	class cPhysicsWorldNewton : public iPhysicsWorld
 	{
 	public:
@@ -95,6 +127,10 @@ namespace hpl {
 							bool abCalcDist, bool abCalcNormal, bool abCalcPoint,
 							bool abUsePrefilter = false);
 
+		void CastRays(iPhysicsRayCallback *apCallback, cPhysicsRay *apRays, int alRayNum, bool abUsePrefilter=false);
+		void CastRays(	const cPhysicsRay *apRays, int alRayNum, tPhysicsRayFlag aFlags, cPhysicsRayHit *apHits,
+						iPhysicsRayCallback *apFilter=NULL);
+
 		bool CheckShapeCollision(	iCollideShape* apShapeA, const cMatrixf& a_mtxA,
 						iCollideShape* apShapeB, const cMatrixf& a_mtxB,
 						cCollideData & aCollideData, int alMaxPoints,
@@ -105,13 +141,37 @@ namespace hpl {
 		void RenderDebugGeometry(iLowLevelGraphics *apLowLevel, const cColor& aColor);
 
 		NewtonWorld* GetNewtonWorld(){ return mpNewtonWorld;}
+
+		/**
+		 * True when Newton runs more than one solver thread. Contacts are then queued with
+		 * AddContactEvent (caller must hold the world critical section) and handled after each step.
+		 */
+		bool GetDeferSolverEvents(){ return mbDeferSolverEvents;}
+		void AddContactEvent(const cPhysicsContactEventNewton& aEvent){ mvContactEvents.push_back(aEvent);}
+
+		/**
+		 * Called by joint limit callbacks, runs the limit callbacks and sounds directly or queues them.
+		 */
+		void OnJointLimit(iPhysicsJoint *apJoint, bool abMaxLimit);
+
 	private:
+		void FlushSolverEvents();
+
 		NewtonWorld *mpNewtonWorld;
 
+		bool mbDeferSolverEvents;
+		tPhysicsContactEventNewtonVec mvContactEvents;
+		tPhysicsJointLimitEventNewtonVec mvJointLimitEvents;
+		int mlBodyCreationCount;
+		int mlJointCreationCount;
+
 		float* mpTempPoints;
 		float* mpTempNormals;
 		float* mpTempDepths;
 
+		std::vector<cVector3f> mvTempSubShapeMin;
+		std::vector<cVector3f> mvTempSubShapeMax;
+
 		cVector3f mvWorldSizeMin;
 		cVector3f mvWorldSizeMax;
 		cVector3f mvGravity;
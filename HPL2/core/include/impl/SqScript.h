@@ -23,10 +23,51 @@
 #include "system/Script.h"
 #include "impl/LowLevelSystemSDL.h"
 #include <angelscript.h>
-
+#include "impl/scriptstring.h"
+#include <map>
 
 namespace hpl {
 
+	//------------------------------------------
+
+	enum eSqScriptArgBind
+	{
+		eSqScriptArgBind_String,
+		eSqScriptArgBind_DWord,
+		eSqScriptArgBind_Float,
+		eSqScriptArgBind_Double,
+		eSqScriptArgBind_Byte,
+
+		eSqScriptArgBind_LastEnum
+	};
+
+	//------------------------------------------
+
+	class cSqScriptFunc
+	{
+	public:
+		tString msName;
+		unsigned int mlArgSignature;
+		int mlFuncId; //< 0 if the call cannot be made directly and must be compiled
+		eSqScriptArgBind mvArgBind[kMaxScriptCallArgs];
+	};
+
+	typedef std::map<unsigned long long, cSqScriptFunc> tSqScriptFuncMap;
+	typedef tSqScriptFuncMap::iterator tSqScriptFuncMapIt;
+
+	//------------------------------------------
+
+	class cSqScriptContext
+	{
+	public:
+		asIScriptContext *mpContext;
+		CScriptString *mvStrings[kMaxScriptCallArgs];
+	};
+
+	typedef std::vector<cSqScriptContext*> tSqScriptContextVec;
+
+	//------------------------------------------
+
 	class cSqScript : public iScript
 	{
 	public:
@@ -40,8 +81,15 @@ namespace hpl {
 
 		bool Run(const tString& asFuncLine);
 		bool Run(int alHandle);
+		bool Run(const cScriptCall& aCall);
 
 	private:
+		cSqScriptFunc* GetCachedFunc(const cScriptCall& aCall);
+		void ResolveFunc(const cScriptCall& aCall, cSqScriptFunc *apFunc);
+
+		cSqScriptContext* PopContext();
+		void PushContext(cSqScriptContext* apContext);
+
 		asIScriptEngine *mpScriptEngine;
 		cScriptOutput *mpScriptOutput;
         
@@ -51,6 +99,11 @@ namespace hpl {
 		int mlHandle;
 		tString msModuleName;
 
+		int mlStringTypeId;
+		tSqScriptFuncMap m_mapFuncs;
+		tSqScriptContextVec mvContexts;
+		tSqScriptContextVec mvFreeContexts;
+
 		char* LoadCharBuffer(const tWString& asFileName, int& alLength);
 	};
 };
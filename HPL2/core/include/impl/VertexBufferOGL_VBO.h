@@ -38,6 +38,7 @@ namespace hpl {
 		void Draw(eVertexBufferDrawType aDrawType = eVertexBufferDrawType_LastEnum);
 		void DrawIndices(unsigned int *apIndices, int alCount,
 						eVertexBufferDrawType aDrawType = eVertexBufferDrawType_LastEnum);
+		void DrawInstanced(int alInstanceNum, eVertexBufferDrawType aDrawType = eVertexBufferDrawType_LastEnum);
 		
 		void Bind();
 		void UnBind();
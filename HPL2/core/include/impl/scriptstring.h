@@ -32,6 +32,7 @@ public:
 
 	void AddRef() const;
 	void Release() const;
+	int GetRefCount() const { return refCount; }
 
 	CScriptString &operator=(const CScriptString &other);
 	CScriptString &operator+=(const CScriptString &other);
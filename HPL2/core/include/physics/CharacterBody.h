@@ -306,6 +306,13 @@ namespace hpl {
 		void SetMaxConnectionTorque(float afX){ mfMaxConnectionTorque = afX; }
 		float GetMaxConnectionForce(){ return mfMaxConnectionForce; }
 		float GetMaxConnectionTorque(){ return mfMaxConnectionTorque; }
+
+		/**
+		 * Bodies around the character are cached and only gathered from the broadphase again when the
+		 * character has moved further than this or the bodies in the world changed.
+		 */
+		void SetContactCacheMargin(float afX){ mfContactCacheMargin = afX; mpContactCacheShape = NULL;}
+		float GetContactCacheMargin(){ return mfContactCacheMargin;}
 		
 		///////////////////////////////////////
 		// User Properties
@@ -381,6 +388,8 @@ namespace hpl {
 
 		bool CheckCollision(cVector3f *apPushBackVector, const cVector3f& avPos, iPhysicsWorldCollisionCallback *apCallback,int alShapeIdx=-1);
 
+		std::vector<iPhysicsBody*>* GetContactCandidates(const cVector3f& avPos, iCollideShape *apShape);
+
 		tString msName;
 
 		float mfMass;
@@ -539,6 +548,13 @@ namespace hpl {
 		std::vector<iPhysicsBody*> mvBodies;
 
 		static std::vector<iPhysicsBody*> mvTempBodies;
+
+		std::vector<iPhysicsBody*> mvCachedContactBodies;
+		std::vector<iPhysicsBody*> mvContactCandidates;
+		cVector3f mvContactCacheCenter;
+		iCollideShape *mpContactCacheShape;
+		int mlContactCacheLayoutCount;
+		float mfContactCacheMargin;
 	};
 };
 #endif // HPL_CHARACTER_BODY_H
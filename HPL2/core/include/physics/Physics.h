@@ -35,6 +35,7 @@ namespace hpl {
 	class cResources;
 	class iHapticSurface;
 	class cHaptic;
+	class cJobScheduler;
 
 	//------------------------------------------------
 
@@ -92,6 +93,19 @@ namespace hpl {
 
 		cSurfaceDataIterator GetSurfaceDataIterator() { return cSurfaceDataIterator(&m_mapSurfaceData); }
 
+		/**
+		 * Scheduler given to all worlds created, used for batched ray casts.
+		 */
+		void SetJobScheduler(cJobScheduler *apJobScheduler){ mpJobScheduler = apJobScheduler;}
+		cJobScheduler* GetJobScheduler(){ return mpJobScheduler;}
+
+		/**
+		 * Number of Newton solver threads given to all worlds created. With more than one thread,
+		 * contact sounds and body collide callbacks are queued and run after each step.
+		 */
+		void SetNumberOfThreads(int alX){ mlNumberOfThreads = alX;}
+		int GetNumberOfThreads(){ return mlNumberOfThreads;}
+
 		void SetDebugLog(bool abX){ mbLog = abX;}
 		bool GetDebugLog(){ return mbLog;}
 	
@@ -104,6 +118,8 @@ namespace hpl {
 
 		iLowLevelPhysics *mpLowLevelPhysics;
 		cResources *mpResources;
+		cJobScheduler *mpJobScheduler;
+		int mlNumberOfThreads;
 
 		tPhysicsWorldList mlstWorlds;
 		tSurfaceDataMap m_mapSurfaceData;
@@ -0,0 +1,217 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef HPL_PHYSICS_ACTIVATION_MANAGER_H
+#define HPL_PHYSICS_ACTIVATION_MANAGER_H
+
+#include <map>
+#include "system/SystemTypes.h"
+#include "math/MathTypes.h"
+
+namespace hpl {
+
+	//-------------------------------------------
+
+	class iPhysicsWorld;
+	class iPhysicsBody;
+
+	//-------------------------------------------
+
+	class cPhysicsActivationStats
+	{
+	public:
+		cPhysicsActivationStats() : mlSourceNum(0), mlFrozenCellNum(0), mlFrozenIslandNum(0), mlFrozenBodyNum(0),
+									mlPendingIslandNum(0), mlFrozenBodiesLastUpdate(0), mlReactivatedBodiesLastUpdate(0) {}
+
+		int mlSourceNum;
+		int mlFrozenCellNum;
+		int mlFrozenIslandNum;
+		int mlFrozenBodyNum;
+		int mlPendingIslandNum;
+		int mlFrozenBodiesLastUpdate;
+		int mlReactivatedBodiesLastUpdate;
+	};
+
+	//-------------------------------------------
+
+	class cPhysicsFrozenBody
+	{
+	public:
+		iPhysicsBody *mpBody;
+		cVector3f mvLinearVelocity;
+		cVector3f mvAngularVelocity;
+	};
+
+	typedef std::vector<cPhysicsFrozenBody> tPhysicsFrozenBodyVec;
+
+	//-------------------------------------------
+
+	/**
+	 * Bodies connected by joints, frozen and restored together.
+	 */
+	class cPhysicsFrozenIsland
+	{
+	public:
+		tPhysicsFrozenBodyVec mvBodies;
+		cVector3l mvMinCell;
+		cVector3l mvMaxCell;
+		bool mbPending;
+	};
+
+	typedef std::list<cPhysicsFrozenIsland*> tPhysicsFrozenIslandList;
+	typedef tPhysicsFrozenIslandList::iterator tPhysicsFrozenIslandListIt;
+
+	typedef std::vector<cPhysicsFrozenIsland*> tPhysicsFrozenIslandVec;
+
+	typedef std::map<cVector3l, tPhysicsFrozenIslandVec> tPhysicsFrozenCellMap;
+	typedef tPhysicsFrozenCellMap::iterator tPhysicsFrozenCellMapIt;
+
+	typedef std::map<iPhysicsBody*, cPhysicsFrozenIsland*> tPhysicsFrozenBodyMap;
+	typedef tPhysicsFrozenBodyMap::iterator tPhysicsFrozenBodyMapIt;
+
+	typedef std::multimap<float, cPhysicsFrozenIsland*> tPhysicsFrozenIslandQueue;
+	typedef tPhysicsFrozenIslandQueue::iterator tPhysicsFrozenIslandQueueIt;
+
+	typedef std::map<iPhysicsBody*, float> tPhysicsBodyTimeMap;
+	typedef tPhysicsBodyTimeMap::iterator tPhysicsBodyTimeMapIt;
+
+	//-------------------------------------------
+
+	/**
+	 * Freezes awake bodies far away from all activation sources so they are no longer simulated.
+	 * The world is split into a grid of cells, an island (bodies connected by joints) is frozen when the cells it
+	 * covers have been outside the deactivate radius of all sources for the deactivate delay. Velocities are saved
+	 * and set back when a source gets within the activate radius of the cells again. Active character bodies
+	 * are always sources, others can be added each update with AddSource.
+	 * Bodies woken by anything else while frozen (impulses, contacts, EnableBodiesInBV) get their island restored.
+	 */
+	class cPhysicsActivationManager
+	{
+	public:
+		cPhysicsActivationManager(iPhysicsWorld *apWorld);
+		~cPhysicsActivationManager();
+
+		void Update(float afTimeStep);
+
+		/**
+		 * Deactivating restores all frozen islands.
+		 */
+		void SetActive(bool abX);
+		bool IsActive(){ return mbActive;}
+
+		/**
+		 * Changing the cell size restores all frozen islands.
+		 */
+		void SetCellSize(float afX);
+		float GetCellSize(){ return mfCellSize;}
+
+		void SetActivateRadius(float afX){ mfActivateRadius = afX;}
+		float GetActivateRadius(){ return mfActivateRadius;}
+		/**
+		 * Should be larger than the activate radius so islands at the border are not frozen and restored over and over.
+		 */
+		void SetDeactivateRadius(float afX){ mfDeactivateRadius = afX;}
+		float GetDeactivateRadius(){ return mfDeactivateRadius;}
+
+		void SetDeactivateDelay(float afX){ mfDeactivateDelay = afX;}
+		float GetDeactivateDelay(){ return mfDeactivateDelay;}
+
+		/**
+		 * How often bodies are checked for freezing, restoring is checked every update.
+		 */
+		void SetCheckInterval(float afX){ mfCheckInterval = afX;}
+		float GetCheckInterval(){ return mfCheckInterval;}
+
+		/**
+		 * Max number of bodies restored in one update, closest islands first. At least one island is always restored.
+		 */
+		void SetMaxReactivatedBodiesPerUpdate(int alX){ mlMaxReactivatedBodiesPerUpdate = alX;}
+		int GetMaxReactivatedBodiesPerUpdate(){ return mlMaxReactivatedBodiesPerUpdate;}
+
+		/**
+		 * Adds a source for the next update only.
+		 */
+		void AddSource(const cVector3f& avPosition);
+
+		bool IsBodyFrozen(iPhysicsBody *apBody);
+		/**
+		 * Restores the island the body is in, if frozen.
+		 */
+		void ReactivateBody(iPhysicsBody *apBody);
+		void ReactivateAll();
+
+		const cPhysicsActivationStats& GetStats(){ return mStats;}
+
+		void OnBodyDestroyed(iPhysicsBody *apBody);
+		/**
+		 * Forgets all frozen islands without touching the bodies, called when all bodies are destroyed.
+		 */
+		void Reset();
+
+	private:
+		void GatherSources();
+		void CheckReactivation();
+		void ReactivatePending();
+		void CheckDeactivation(float afTimeStep);
+
+		void FreezeIsland(const std::vector<int> &avBodyIdx, const cVector3l& avMinCell, const cVector3l& avMaxCell);
+		void ReactivateIsland(cPhysicsFrozenIsland *apIsland);
+		void RemoveIsland(cPhysicsFrozenIsland *apIsland);
+
+		int FindIslandRoot(int alIdx);
+		int GetTempBodyIdx(iPhysicsBody *apBody);
+		cVector3l GetCell(const cVector3f& avPos);
+		float GetCellsSqrDistToSources(const cVector3l& avMinCell, const cVector3l& avMaxCell);
+
+		iPhysicsWorld *mpWorld;
+
+		bool mbActive;
+		float mfCellSize;
+		float mfActivateRadius;
+		float mfDeactivateRadius;
+		float mfDeactivateDelay;
+		float mfCheckInterval;
+		int mlMaxReactivatedBodiesPerUpdate;
+
+		float mfCheckCount;
+
+		std::vector<cVector3f> mvSources;
+		std::vector<cVector3f> mvExtraSources;
+
+		tPhysicsFrozenIslandList mlstIslands;
+		tPhysicsFrozenCellMap m_mapCells;
+		tPhysicsFrozenBodyMap m_mapFrozenBodies;
+		tPhysicsFrozenIslandQueue m_mapPendingIslands;
+		tPhysicsBodyTimeMap m_mapOutOfRangeTime;
+		tPhysicsBodyTimeMap m_mapTempOutOfRangeTime;
+
+		std::vector<iPhysicsBody*> mvTempBodies;
+		std::vector<int> mvTempIslandParent;
+		std::vector<std::pair<int, int> > mvTempIslandSort;
+		std::vector<int> mvTempIslandBodies;
+		std::vector<char> mvTempBodyBlocked;
+		std::map<iPhysicsBody*, int> m_mapTempBodyIdx;
+
+		cPhysicsActivationStats mStats;
+	};
+
+	//-------------------------------------------
+
+};
+#endif // HPL_PHYSICS_ACTIVATION_MANAGER_H
@@ -44,7 +44,14 @@ namespace hpl {
 	class iPhysicsBodyCallback
 	{
 	public:
+		/**
+		 * Called during the step, when the world uses several threads this happens on a solver
+		 * thread (under the world lock) and so must only read state.
+		 */
 		virtual bool OnAABBCollide(iPhysicsBody *apBody, iPhysicsBody *apCollideBody)=0;
+		/**
+		 * Always called on the main thread, when the world uses several threads it is called after the step.
+		 */
 		virtual void OnBodyCollide(iPhysicsBody *apBody, iPhysicsBody *apCollideBody,cPhysicsContactData* apContactData)=0;
 	};
 
@@ -120,6 +127,10 @@ namespace hpl {
 		virtual void AddImpulseAtPosition(const cVector3f &avImpulse, const cVector3f &avPos)=0;
 
 		virtual void Enable()=0;
+		/**
+		 * Puts the body to sleep. Anything that would wake up a sleeping body still does so.
+		 */
+		virtual void Disable()=0;
 		virtual bool GetEnabled() const=0;
 		virtual void SetAutoDisable(bool abEnabled)=0;
 		virtual bool GetAutoDisable() const=0;
@@ -252,6 +263,12 @@ namespace hpl {
 
 		iPhysicsWorld *GetWorld(){ return mpWorld;}
 
+		/**
+		 * Order the body was created in by the world, used where results must not depend on memory addresses.
+		 */
+		void SetCreationIndex(int alX){ mlCreationIndex = alX;}
+		int GetCreationIndex(){ return mlCreationIndex;}
+
 		void DisableAfterSimulation(){ mbDisableAfterSimulation = true;}
 
 		//Entity implementation
@@ -262,6 +279,7 @@ namespace hpl {
         iPhysicsWorld *mpWorld;
 		iCollideShape *mpShape;
 		iPhysicsMaterial *mpMaterial;
+		int mlCreationIndex;
 		
 		iCharacterBody *mpCharacterBody;
 
@@ -35,6 +35,7 @@ namespace hpl {
 	class cSoundEntity;
 	class iPhysicsJoint;
 	class iPhysicsController;
+	class cPhysicsWorldNewton;
 
 	typedef std::map<tString, iPhysicsController*> tPhysicsControllerMap;
 	typedef tPhysicsControllerMap::iterator tPhysicsControllerMapIt;
@@ -95,6 +96,7 @@ namespace hpl {
 	#ifdef __GNUC__
 		typedef iSaveObject __super;
 	#endif
+	friend class cPhysicsWorldNewton;
 	public:
 		iPhysicsJoint(	const tString &asName, iPhysicsBody *apParentBody, iPhysicsBody *apChildBody,
 						iPhysicsWorld *apWorld,const cVector3f &avPivotPoint, const cVector3f &avPinDir);
@@ -105,6 +107,12 @@ namespace hpl {
 		void SetUniqueID(int alID){mlUniqueID = alID;}
 		int GetUniqueID(){return mlUniqueID;}
 
+		/**
+		 * Order the joint was created in by the world, used where results must not depend on memory addresses.
+		 */
+		void SetCreationIndex(int alX){ mlCreationIndex = alX;}
+		int GetCreationIndex(){ return mlCreationIndex;}
+
 		iPhysicsBody * GetParentBody(){ return mpParentBody;}
 		iPhysicsBody * GetChildBody(){ return mpChildBody;}
 
@@ -194,6 +202,7 @@ namespace hpl {
 	protected:
 		tString msName;
 		int mlUniqueID;
+		int mlCreationIndex;
 
 		iPhysicsBody *mpParentBody;
 		iPhysicsBody *mpChildBody;
@@ -81,6 +81,10 @@ namespace hpl {
 	typedef tVerletParticleContainerList::iterator tVerletParticleContainerListIt;
 
 
+	//----------------------------------------------------
+
+	class iPhysicsBody;
+
 	//----------------------------------------------------
 
 	class cPhysicsRayParams
@@ -90,12 +94,54 @@ namespace hpl {
 		float mfDist;
 		cVector3f mvNormal;
 		cVector3f mvPoint;
+		int mlRayIdx;	//Index of the ray when using iPhysicsWorld::CastRays, else -1.
 	};
 
 	//----------------------------------------------------
-	
-	class iPhysicsBody;
 
+	/**
+	 * Ray for iPhysicsWorld::CastRays. mbHit is set if the callback stopped the ray (OnIntersect returned false).
+	 */
+	class cPhysicsRay
+	{
+	public:
+		cPhysicsRay(){}
+		cPhysicsRay(const cVector3f& avStart, const cVector3f& avEnd) : mvStart(avStart), mvEnd(avEnd), mbHit(false){}
+
+		cVector3f mvStart;
+		cVector3f mvEnd;
+		bool mbHit;
+	};
+
+	typedef std::vector<cPhysicsRay> tPhysicsRayVec;
+	typedef tPhysicsRayVec::iterator tPhysicsRayVecIt;
+
+	//----------------------------------------------------
+
+	typedef tFlag tPhysicsRayFlag;
+
+	#define ePhysicsRayFlag_AnyHit		(0x00000001)	//Stop at the first hit found, which is not always the closest.
+	#define ePhysicsRayFlag_NoNormal	(0x00000002)	//Skip calculating the hit normal.
+
+	/**
+	 * Result of a ray for the buffered iPhysicsWorld::CastRays.
+	 */
+	class cPhysicsRayHit
+	{
+	public:
+		bool mbHit;
+		iPhysicsBody *mpBody;
+		float mfT;
+		float mfDist;
+		cVector3f mvNormal;
+		cVector3f mvPoint;
+	};
+
+	typedef std::vector<cPhysicsRayHit> tPhysicsRayHitVec;
+	typedef tPhysicsRayHitVec::iterator tPhysicsRayHitVecIt;
+
+	//----------------------------------------------------
+	
 	class iPhysicsRayCallback
 	{
 	public:
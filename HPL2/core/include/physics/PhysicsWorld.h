@@ -22,6 +22,7 @@
 
 #include <map>
 #include "system/SystemTypes.h"
+#include "system/NameIndex.h"
 #include "math/MathTypes.h"
 #include "graphics/GraphicsTypes.h"
 #include "physics/PhysicsTypes.h"
@@ -46,6 +47,8 @@ namespace hpl {
 	class iPhysicsController;
 	class iPhysicsRope;
 	class cBinaryBuffer;
+	class cJobScheduler;
+	class cPhysicsActivationManager;
 
 	class cWorld;
 	class cBoundingVolume;
@@ -86,6 +89,7 @@ namespace hpl {
 
 	class iPhysicsWorld
 	{
+	friend class cPhysicsActivationManager;
 	public:
 		iPhysicsWorld();
 		virtual ~iPhysicsWorld();
@@ -114,6 +118,11 @@ namespace hpl {
 		virtual void SetNumberOfThreads(int alThreads)=0;
 		virtual int GetNumberOfThreads()=0;
 
+		/**
+		 * Freezes bodies far away from characters, inactive until SetActive(true) is called on it.
+		 */
+		cPhysicsActivationManager* GetActivationManager(){ return mpActivationManager;}
+
 		//! @}
 
 		//########################################################################################
@@ -197,6 +206,16 @@ namespace hpl {
 
 		void AddBodyToUpdateList(iPhysicsBody *apBody);
 		void RemoveBodyFromUpdateList(iPhysicsBody *apBody, bool abDestroyingBody);
+		tPhysicsBodySet* GetUpdateBodySet(){ return &m_setUpdateBodies;}
+		tCharacterBodyList* GetCharacterBodyList(){ return &mlstCharBodies;}
+
+		/**
+		 * Changed when bodies are created, destroyed, moved from outside the simulation or stop being simulated.
+		 * Cached spatial queries (like the contact candidates of characters) use it to know when to refresh.
+		 * Bodies in the update list and character bodies can move at any time and must be checked separately.
+		 */
+		int GetBodyLayoutCount(){ return mlBodyLayoutCount;}
+		void IncBodyLayoutCount(){ ++mlBodyLayoutCount;}
 
 
 		//! @}
@@ -237,6 +256,26 @@ namespace hpl {
 							bool abCalcDist, bool abCalcNormal, bool abCalcPoint,
 							bool abUsePrefilter=false)=0;
 
+		/**
+		 * Casts a batch of rays on the calling thread, setting mbHit of each ray. All values in cPhysicsRayParams are
+		 * calculated and cPhysicsRayParams::mlRayIdx tells which ray the callback is called for.
+		 * Must not be called while the world is simulating.
+		 */
+		virtual void CastRays(iPhysicsRayCallback *apCallback, cPhysicsRay *apRays, int alRayNum, bool abUsePrefilter=false)=0;
+
+		/**
+		 * Casts a batch of rays and writes the closest hit (or any hit with ePhysicsRayFlag_AnyHit) of each ray to apHits.
+		 * Rays next to each other in the array that are close together are tested as a packet, gathering the bodies
+		 * once for all of them, so rays from the same origin should be kept together. If apFilter is set only its
+		 * BeforeIntersect is called (once per body and packet, from several threads) and must not change any state.
+		 * Must not be called while the world is simulating.
+		 */
+		virtual void CastRays(	const cPhysicsRay *apRays, int alRayNum, tPhysicsRayFlag aFlags, cPhysicsRayHit *apHits,
+								iPhysicsRayCallback *apFilter=NULL)=0;
+
+		void SetJobScheduler(cJobScheduler *apJobScheduler){ mpJobScheduler = apJobScheduler;}
+		cJobScheduler* GetJobScheduler(){ return mpJobScheduler;}
+
 		virtual void RenderShapeDebugGeometry(	iCollideShape *apShape, const cMatrixf& a_mtxTransform, 
 												iLowLevelGraphics *apLowLevel, const cColor& aColor)=0;
 		
@@ -255,7 +294,8 @@ namespace hpl {
 										bool abCollideCharacter=true,
 										int alMinPushStrength=0,
 										tFlag alCollideFlags = eFlagBit_All, 
-										bool abDebug=false);
+										bool abDebug=false,
+										std::vector<iPhysicsBody*> *apCandidateBodies=NULL);
 		
 		void DestroyAll();
 
@@ -272,7 +312,13 @@ namespace hpl {
 		tPhysicsJointList mlstJoints;
 		tPhysicsControllerList mlstControllers;
 		tPhysicsRopeList mlstRopes;
+		cNameIndex<iPhysicsBody> mBodyNameIndex;
+		cNameIndex<iPhysicsJoint> mJointNameIndex;
+		cNameIndex<iPhysicsRope> mRopeNameIndex;
 		cWorld *mpWorld;
+		cJobScheduler *mpJobScheduler;
+		cPhysicsActivationManager *mpActivationManager;
+		int mlBodyLayoutCount;
 
 		std::vector<iPhysicsBody*> mvTempBodies;
 
@@ -234,6 +234,16 @@ namespace hpl {
 
 		static void SetCreateAndLoadCompressedMaps(bool abX){ mbCreateAndLoadCompressedMaps = abX;}
 		static bool GetCreateAndLoadCompressedMaps(){ return mbCreateAndLoadCompressedMaps ;}
+
+		/**
+		 * If animations should be key frame reduced when loaded and saved to MSH/ANM caches using the compressed clip format.
+		 */
+		static void SetCompressAnimations(bool abX){ mbCompressAnimations = abX;}
+		static bool GetCompressAnimations(){ return mbCompressAnimations ;}
+
+		static void SetAnimationCompressionTolerance(float afTrans, float afRot){ mfAnimationCompressionTransTolerance = afTrans; mfAnimationCompressionRotTolerance = afRot;}
+		static float GetAnimationCompressionTransTolerance(){ return mfAnimationCompressionTransTolerance;}
+		static float GetAnimationCompressionRotTolerance(){ return mfAnimationCompressionRotTolerance;}
 		
 	private:
 		iLowLevelResources *mpLowLevelResources;
@@ -277,6 +287,9 @@ namespace hpl {
 
 		static bool mbForceCacheLoadingAndSkipSaving;
 		static bool mbCreateAndLoadCompressedMaps;
+		static bool mbCompressAnimations;
+		static float mfAnimationCompressionTransTolerance;
+		static float mfAnimationCompressionRotTolerance;
 	};
 
 };
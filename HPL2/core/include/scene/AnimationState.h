@@ -117,6 +117,12 @@ namespace hpl {
 
 		float GetFadeStep(){ return mfFadeStep;}
 		void SetFadeStep(float afX){ mfFadeStep = afX;}
+
+		/**
+		 * Key frame cursor for a track, passed to cAnimationTrack::ApplyToNode. Kept here and not in the track
+		 * since the animation is shared by all entities using it.
+		 */
+		int* GetTrackKeyCursor(int alTrack);
 	
 	private:
 		tString msName;
@@ -144,6 +150,8 @@ namespace hpl {
 
 		//properties for update
 		float mfFadeStep;
+
+		std::vector<int> mvTrackKeyCursors;
 	};
 
 };
@@ -83,6 +83,17 @@ namespace hpl {
 		void SetTransformUpdated(bool abUpdateCallbacks = true);
 		bool GetTransformUpdated();
 
+		/**
+		 * While a transform batch is open, SetTransformUpdatedBatched only marks the entity's own world transform as changed
+		 * and puts the entity in a dirty list. EndTransformBatch notifies children and callbacks once for every dirty
+		 * entity, parents before children. Without an open batch it is the same as SetTransformUpdated(true).
+		 * Batches can be nested, entities are notified when the outermost one ends.
+		 */
+		static void BeginTransformBatch();
+		static void EndTransformBatch();
+		static bool IsTransformBatchOpen(){ return mlTransformBatchDepth > 0;}
+		void SetTransformUpdatedBatched();
+
 		int GetTransformUpdateCount();
 
 		void AddCallback(iEntityCallback *apCallback);
@@ -152,6 +163,14 @@ namespace hpl {
 		int mlIteratorCount;
 	private:
 		void UpdateWorldTransform();
+		int GetHierarchyDepth();
+
+		bool mbInTransformBatch;
+		int mlTransformNotifyStamp;
+
+		static int mlTransformBatchDepth;
+		static int mlTransformNotifyStampCount;
+		static std::vector<iEntity3D*> mvTransformBatchEntities;
 	};
 
 };
@@ -194,7 +194,17 @@ namespace hpl {
 
 		void UpdateLogic(float afTimeStep);
 
+		/**
+		 * UpdateLogic split in three steps. UpdateSkeletonAnimation only touches the bone states of this entity
+		 * and can be run in parallel for many entities, the other two must be called from the main thread.
+		 */
+		void UpdateLogicBeforeAnimation(float afTimeStep);
+		void UpdateSkeletonAnimation(float afTimeStep);
+		void UpdateLogicAfterAnimation(float afTimeStep);
+		bool HasPendingSkeletonAnimation(){ return mbSkeletonAnimationPending;}
+
 		void UpdateGraphicsForFrame(float afFrameTime);
+		int GetBoneMatricesUpdateCount(){ return mlBoneMatricesUpdateCount;}
 
 		void SetBody(iPhysicsBody* apBody){ mpBody = apBody;}
 		iPhysicsBody* GetBody(){ return mpBody;}
@@ -231,6 +241,13 @@ namespace hpl {
 		
 		bool mbBoneMatricesNeedUpdate;
 		int mlBoneMatricesTransformCount;
+		int mlBoneMatricesUpdateCount;
+
+		bool mbLogicUpdateStarted;
+		bool mbAnimationUpdated;
+		bool mbSkeletonAnimationPending;
+		bool mbSkeletonAnimationActive;
+		bool mbSkeletonUpdateTransform;
 
 		cMatrixf m_mtxInvWorldMatrix;
 		int mlInvWorldMatrixTransformCount;
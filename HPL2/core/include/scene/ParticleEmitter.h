@@ -200,6 +200,10 @@ namespace hpl {
 		//Renderable implementation
 		bool UpdateGraphicsForViewport(cFrustum *apFrustum,float afFrameTime);
 
+		bool UsesGraphicsPrepare(){ return true;}
+		void BeforeGraphicsPrepare();
+		bool PrepareGraphicsForViewport(cFrustum *apFrustum,float afFrameTime);
+
 		cMaterial *GetMaterial();
 		iVertexBuffer* GetVertexBuffer();
 
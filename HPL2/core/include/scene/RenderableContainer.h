@@ -164,6 +164,13 @@ namespace hpl {
 
 		virtual void RenderDebug(cRendererCallbackFunctions *apFunctions)=0;
 
+		/**
+		 * Adds all objects that might be inside the frustum to the vector without iterating the node tree.
+		 * No visibility or flag checks are made.
+		 * \return false if not supported by the container, then the nodes must be iterated instead.
+		 */
+		virtual bool GetObjectsInFrustum(cFrustum *apFrustum, tRenderableVec *apObjectVec){ return false;}
+
 	private:
 		void CheckNeedPropertyUpdateIteration(iRenderableContainerNode* apNode);
 		void CheckNeedAABBUpdateIteration(iRenderableContainerNode* apNode);
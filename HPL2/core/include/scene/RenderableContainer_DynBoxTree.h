@@ -135,7 +135,7 @@ namespace hpl {
 
 		cRCNode_DynBoxTree *mpCheckForFitTempNode;
 
-		tRenderableSet m_setObjectsToUpdate;
+		tRenderableVec mvObjectsToUpdate;
 
 		cDynBoxTreeObjectCallback *mpObjectCalllback;
 
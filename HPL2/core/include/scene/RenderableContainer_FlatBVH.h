@@ -0,0 +1,98 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef HPL_RENDERABLE_CONTAINER_FLAT_BVH_H
+#define HPL_RENDERABLE_CONTAINER_FLAT_BVH_H
+
+#include "scene/RenderableContainer_BoxTree.h"
+
+namespace hpl {
+
+	//-------------------------------------------
+
+	/**
+	 * AABBs stored as center and half extent, one array per component. The arrays are padded so that
+	 * four boxes can always be loaded from any valid index.
+	 */
+	class cRCFlatBoxArray
+	{
+	public:
+		void Clear();
+		void Add(const cVector3f& avMin, const cVector3f& avMax);
+		void AddPadding();
+
+		int Size() const { return mlSize;}
+
+		int mlSize;
+		tFloatVec mvCenter[3];
+		tFloatVec mvExtent[3];
+	};
+
+	//-------------------------------------------
+
+	class cRCFlatNode
+	{
+	public:
+		int mlFirstChild;
+		int mlChildNum;
+		int mlFirstObject;
+		int mlObjectNum;
+		int mlSubTreeObjectEnd; //Objects of the node and all its children are [mlFirstObject, mlSubTreeObjectEnd)
+	};
+
+	typedef std::vector<cRCFlatNode> tRCFlatNodeVec;
+
+	//-------------------------------------------
+
+	/**
+	 * Box tree that is also flattened into contiguous arrays when compiled. The node tree is kept for code
+	 * that needs nodes (occlusion queries, shadow casters), while GetObjectsInFrustum culls four boxes at a
+	 * time and stops testing planes that a parent was already fully inside of.
+	 * Like the box tree, objects may not be moved after Compile.
+	 */
+	class cRenderableContainer_FlatBVH : public cRenderableContainer_BoxTree
+	{
+	public:
+		cRenderableContainer_FlatBVH();
+		~cRenderableContainer_FlatBVH();
+
+		void Compile();
+
+		bool GetObjectsInFrustum(cFrustum *apFrustum, tRenderableVec *apObjectVec);
+
+	private:
+		void FlattenNode(iRenderableContainerNode *apNode, int alNodeIdx);
+
+		int CollideBoxes(const cRCFlatBoxArray& aBoxes, int alStart, int alCount, int alPlaneMask, int *apPlaneMasks);
+
+		tRCFlatNodeVec mvNodes;
+		cRCFlatBoxArray mNodeBoxes;
+		cRCFlatBoxArray mObjectBoxes;
+		tRenderableVec mvObjects;
+
+		//Temp data, set up for each GetObjectsInFrustum call.
+		float mvPlaneData[6][4];
+		cVector3f mvFrustumMin;
+		cVector3f mvFrustumMax;
+		std::vector<cVector2l> mvNodeStack;
+	};
+
+	//-------------------------------------------
+};
+#endif // HPL_RENDERABLE_CONTAINER_FLAT_BVH_H
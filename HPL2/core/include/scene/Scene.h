@@ -38,6 +38,7 @@ namespace hpl {
 	class cSystem;
 	class cSound;
 	class cPhysics;
+	class cJobScheduler;
 	class cHaptic;
 	class cGui;
 
@@ -103,6 +104,9 @@ namespace hpl {
 		cWorld* CreateWorld(const tString& asName);
 		void DestroyWorld(cWorld* apWorld);
 		bool WorldExists(cWorld* apWorld);
+
+		void SetJobScheduler(cJobScheduler *apJobScheduler){ mpJobScheduler = apJobScheduler;}
+		cJobScheduler* GetJobScheduler(){ return mpJobScheduler;}
 		
 		
 	private:
@@ -117,6 +121,7 @@ namespace hpl {
 		cAI *mpAI;
 		cGui *mpGui;
 		cHaptic *mpHaptic;
+		cJobScheduler *mpJobScheduler;
 
 		cViewport *mpCurrentListener;
 
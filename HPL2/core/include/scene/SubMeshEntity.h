@@ -74,6 +74,13 @@ namespace hpl {
 
 		void UpdateGraphicsForFrame(float afFrameTime);
 
+		/**
+		 * Skins the dynamic vertex buffer on the CPU if the bone matrices have changed. Does not touch the GPU,
+		 * the upload is done in UpdateGraphicsForFrame. Can be run in parallel for different mesh entities.
+		 */
+		void UpdateSkinning();
+		bool HasDynamicVertexBuffer(){ return mpDynVtxBuffer!=NULL;}
+
 		iVertexBuffer* GetVertexBuffer();
 
 		cBoundingVolume* GetBoundingVolume();
@@ -126,6 +133,8 @@ namespace hpl {
 		bool mbUpdateBody;
 
 		bool mbGraphicsUpdated;
+		int mlSkinnedBoneMatricesCount;
+		bool mbDynVtxBufferNeedsUpload;
 
 		char mlStaticNullMatrixCount;
 		void *mpUserData;
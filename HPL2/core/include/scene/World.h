@@ -21,6 +21,7 @@
 #define HPL_WORLD_H
 
 #include "system/SystemTypes.h"
+#include "system/NameIndex.h"
 #include "graphics/GraphicsTypes.h"
 #include "math/MathTypes.h"
 #include "engine/EngineTypes.h"
@@ -59,6 +60,7 @@ namespace hpl {
 	class cBeam;
 	class cGuiSetEntity;
 	class iPhysicsWorld;
+	class cJobScheduler;
 	class iPhysicsBody;
 	class cSoundEntity;
 	class cAINodeContainer;
@@ -168,6 +170,16 @@ namespace hpl {
 
 		void PreUpdate(float afTotalTime, float afTimeStep);
 
+		/**
+		 * Computes bone matrices and CPU skinning for the animated meshes that were rendered last frame,
+		 * in parallel if there is a job scheduler. Called once per frame before rendering, the GPU upload is
+		 * still done when the sub mesh is added to the render list.
+		 */
+		void UpdateSkinnedMeshesForFrame(float afFrameTime);
+
+		void SetJobScheduler(cJobScheduler *apJobScheduler){ mpJobScheduler = apJobScheduler;}
+		cJobScheduler* GetJobScheduler(){ return mpJobScheduler;}
+
 		cVector3f GetWorldSize(){ return mvWorldSize;}
 
 		void SetIsSoundEmitter(bool abX){ mbIsSoundEmitter = abX;}
@@ -380,6 +392,10 @@ namespace hpl {
 		iPhysicsWorld *mpPhysicsWorld;
 		bool mbAutoDeletePhysicsWorld;
 
+		cJobScheduler *mpJobScheduler;
+		std::vector<cMeshEntity*> mvTempAnimatedMeshEntities;
+		int mlSkinnedMeshesFrameCount;
+
 		bool mbIsSoundEmitter;
 		
 		cVector3f mvWorldSize;
@@ -413,6 +429,18 @@ namespace hpl {
 		tFogAreaList mlstFogAreas;
 		tDummyRenderableList mlstDummyRenderables;
 
+		cNameIndex<iLight> mLightNameIndex;
+		cNameIndex<cMeshEntity> mDynamicMeshEntityNameIndex;
+		cNameIndex<cBillboard> mBillboardNameIndex;
+		cNameIndex<cBeam> mBeamNameIndex;
+		cNameIndex<cParticleSystem> mParticleSystemNameIndex;
+		cNameIndex<cGuiSetEntity> mGuiSetEntityNameIndex;
+		cNameIndex<cRopeEntity> mRopeEntityNameIndex;
+		cNameIndex<cSoundEntity> mSoundEntityNameIndex;
+		cNameIndex<cStartPosEntity> mStartPosEntityNameIndex;
+		cNameIndex<cFogArea> mFogAreaNameIndex;
+		cNameIndex<cDummyRenderable> mDummyRenderableNameIndex;
+
 		int mlSoundCreationIDCount;
 
 		//tSoundEntityList mlstSoundEntityPool;<-Debugging
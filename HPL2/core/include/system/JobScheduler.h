@@ -0,0 +1,171 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef HPL_JOB_SCHEDULER_H
+#define HPL_JOB_SCHEDULER_H
+
+#include "system/SystemTypes.h"
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+namespace hpl {
+
+	class iThread;
+	class cJobScheduler;
+
+	//-----------------------------------------
+
+	class iJob
+	{
+	public:
+		virtual ~iJob() {}
+		virtual void RunJob()=0;
+	};
+
+	//-----------------------------------------
+
+	class iJobRangeFunc
+	{
+	public:
+		virtual ~iJobRangeFunc() {}
+		/**
+		 * Called once per chunk with the half open range [alStart, alEnd). 
+		 * alThreadSlot is the slot of the thread running the chunk, see cJobScheduler::GetCurrentThreadSlot.
+		 */
+		virtual void RunJobRange(int alStart, int alEnd, int alThreadSlot)=0;
+	};
+
+	//-----------------------------------------
+
+	/**
+	 * Fork/join counter. Jobs added with a group are counted down when done, cJobScheduler::Wait returns
+	 * once all are finished.
+	 */
+	class cJobGroup
+	{
+	friend class cJobScheduler;
+	public:
+		cJobGroup() : mlPendingJobs(0) {}
+
+		bool IsDone() const { return mlPendingJobs.load()==0; }
+		int GetPendingJobs() const { return mlPendingJobs.load(); }
+
+	private:
+		cJobGroup(const cJobGroup&);
+		cJobGroup& operator=(const cJobGroup&);
+
+		std::atomic<int> mlPendingJobs;
+	};
+
+	//-----------------------------------------
+
+	/**
+	 * Work stealing job scheduler. Each worker thread has its own queue that it pops from the back (newest first),
+	 * idle workers steal from the front (oldest first) of the other queues. Threads that are not workers (normally
+	 * the main thread) add to a shared queue and help out running jobs while waiting for a group.
+	 */
+	class cJobScheduler
+	{
+	public:
+		/**
+		 * \param alNumWorkers Number of worker threads, 0 means all jobs are run by the thread that waits for them.
+		 */
+		cJobScheduler(int alNumWorkers);
+		~cJobScheduler();
+
+		int GetWorkerNum(){ return mlWorkerNum; }
+
+		/**
+		 * Number of thread slots, workers + 1 for all non-worker threads. Use to size per thread data.
+		 */
+		int GetThreadSlotNum(){ return mlWorkerNum+1; }
+		/**
+		 * The slot of the calling thread. Workers have 0 to GetWorkerNum()-1, any other thread gets GetWorkerNum().
+		 */
+		int GetCurrentThreadSlot();
+
+		/**
+		 * Adds a job to be run. The job must be kept alive until it has been run.
+		 * \param apGroup Group that is notified when the job is done, can be NULL.
+		 */
+		void AddJob(iJob* apJob, cJobGroup* apGroup);
+		void AddJobs(iJob** apJobs, int alNum, cJobGroup* apGroup);
+
+		/**
+		 * Runs jobs until all jobs in the group are done.
+		 */
+		void Wait(cJobGroup* apGroup);
+
+		/**
+		 * Splits [alStart, alEnd) into chunks and runs them in parallel, returns when all are done.
+		 * \param alGrainSize Number of items per chunk, <= 0 picks one from the number of threads.
+		 */
+		void ParallelFor(int alStart, int alEnd, int alGrainSize, iJobRangeFunc* apFunc);
+
+	private:
+		class cJobEntry
+		{
+		public:
+			cJobEntry(){}
+			cJobEntry(iJob* apJob, cJobGroup* apGroup) : mpJob(apJob), mpGroup(apGroup){}
+
+			iJob* mpJob;
+			cJobGroup* mpGroup;
+		};
+
+		class cJobQueue
+		{
+		public:
+			std::mutex mMutex;
+			std::deque<cJobEntry> mdqJobs;
+		};
+
+		class cJobWorker;
+
+		void PushJob(const cJobEntry& aJob);
+		void WakeWorkers(int alNum);
+
+		bool PopJob(int alSlot, cJobEntry& aJob);
+		bool StealJob(int alSlot, cJobEntry& aJob);
+		bool RunNextJob(int alSlot);
+		void RunJob(cJobEntry& aJob);
+
+		void WorkerLoop(int alWorker);
+
+		int mlWorkerNum;
+
+		std::vector<cJobQueue*> mvQueues;
+		std::vector<cJobWorker*> mvWorkers;
+		std::vector<iThread*> mvThreads;
+
+		std::atomic<int> mlQueuedJobs;
+		std::atomic<int> mlSleepingWorkers;
+		std::atomic<bool> mbShutdown;
+
+		std::mutex mSleepMutex;
+		std::condition_variable mWakeCondition;
+	};
+
+	//-----------------------------------------
+
+};
+#endif // HPL_JOB_SCHEDULER_H
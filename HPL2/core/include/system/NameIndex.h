@@ -0,0 +1,85 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef HPL_NAME_INDEX_H
+#define HPL_NAME_INDEX_H
+
+#include <map>
+
+#include "system/SystemTypes.h"
+#include "system/String.h"
+
+namespace hpl {
+
+	//-----------------------------------------
+
+	/**
+	 * Hashed lookup by name for objects that are owned by a list elsewhere. Used instead of STLFindByName
+	 * where there are many objects. Objects are added when pushed to the list and must be removed before
+	 * being deleted. Objects sharing a name are kept in the order added, so Find returns the same object
+	 * as STLFindByName over a list that is only pushed back. Objects must not be renamed while in the index.
+	 */
+	template <class T>
+	class cNameIndex
+	{
+	public:
+		void Add(T *apObject)
+		{
+			m_mapObjects.insert(typename tObjectMap::value_type(cString::GetHash(apObject->GetName()), apObject));
+		}
+
+		void Remove(T *apObject)
+		{
+			std::pair<typename tObjectMap::iterator, typename tObjectMap::iterator> range =
+										m_mapObjects.equal_range(cString::GetHash(apObject->GetName()));
+			for(typename tObjectMap::iterator it = range.first; it != range.second; ++it)
+			{
+				if(it->second == apObject){
+					m_mapObjects.erase(it);
+					return;
+				}
+			}
+		}
+
+		T* Find(const tString& asName)
+		{
+			std::pair<typename tObjectMap::iterator, typename tObjectMap::iterator> range =
+										m_mapObjects.equal_range(cString::GetHash(asName));
+			for(typename tObjectMap::iterator it = range.first; it != range.second; ++it)
+			{
+				//Different names can have the same hash
+				if(it->second->GetName() == asName) return it->second;
+			}
+			return NULL;
+		}
+
+		void Clear(){ m_mapObjects.clear(); }
+
+		size_t Size(){ return m_mapObjects.size(); }
+
+	private:
+		typedef std::multimap<unsigned int, T*> tObjectMap;
+
+		tObjectMap m_mapObjects;
+	};
+
+	//-----------------------------------------
+
+};
+#endif // HPL_NAME_INDEX_H
@@ -30,6 +30,7 @@ namespace hpl {
 	class iThread;
 	class iThreadClass;
 	class iMutex;
+	class cJobScheduler;
 
 	//-----------------------------------------
 
@@ -120,6 +121,11 @@ namespace hpl {
 
 		static unsigned long GetSystemAvailableDrives();
 
+		/**
+		* Number of logical cores, always at least 1.
+		*/
+		static int GetNumberOfCores();
+
 		static void GetAvailableVideoModes(tVideoModeVec& avDestVidModes, int alMinBpp=-1, int alMinRefreshRate=-1);
 		
 		static tWString GetDisplayName(int alDisplay);
@@ -143,6 +149,12 @@ namespace hpl {
 		static iThread* CreateThread(iThreadClass* apThreadClass);
 
 		static iMutex* CreateMutEx(); // If you name this method CreateMutex strange stuff will happen :S
+
+		/**
+		* Creates a work stealing job scheduler.
+		* \param alNumWorkers Number of worker threads, -1 means one per core except for the calling thread.
+		*/
+		static cJobScheduler* CreateJobScheduler(int alNumWorkers=-1);
 	
 	private:
         static void CreateMessageBoxBase(eMsgBoxType eType, const wchar_t* asCaption, const wchar_t* fmt, va_list ap);
@@ -32,6 +32,71 @@
 
 namespace hpl {
 
+	//------------------------------------------
+
+	#define kMaxScriptCallArgs 8
+
+	enum eScriptArgType
+	{
+		eScriptArgType_String,
+		eScriptArgType_Int,
+		eScriptArgType_Float,
+		eScriptArgType_Bool,
+
+		eScriptArgType_LastEnum
+	};
+
+	//------------------------------------------
+
+	class cScriptCallArg
+	{
+	public:
+		eScriptArgType mType;
+		const tString *mpString;
+		int mlInt;
+		float mfFloat;
+	};
+
+	//------------------------------------------
+
+	/**
+	 * A call to a script function with typed arguments. Function name and string args are kept as pointers
+	 * and must be alive until the call has been run.
+	 */
+	class cScriptCall
+	{
+	public:
+		cScriptCall(const tString& asFunc) : mpFunc(&asFunc), mlArgNum(0) {}
+
+		void AddString(const tString& asArg);
+		void AddInt(int alArg);
+		void AddFloat(float afArg);
+		void AddBool(bool abArg);
+
+		const tString& GetFunc() const { return *mpFunc; }
+		int GetArgNum() const { return mlArgNum; }
+		const cScriptCallArg& GetArg(int alIdx) const { return mvArgs[alIdx]; }
+
+		/**
+		 * Signature of the argument types, same for calls with the same number and types of args.
+		 */
+		unsigned int GetArgSignature() const;
+
+		/**
+		 * Returns the call as a line of code, for example: Func("Name", 1)
+		 */
+		tString ToFuncLine() const;
+
+	private:
+		cScriptCallArg* NewArg(eScriptArgType aType);
+
+		const tString *mpFunc;
+		int mlArgNum;
+		cScriptCallArg mvArgs[kMaxScriptCallArgs];
+	};
+
+	//------------------------------------------
+
 	class iScript : public iResourceBase
 	{
 	public:
@@ -56,6 +121,13 @@ namespace hpl {
 		virtual bool Run(const tString& asFuncLine)=0;
 		
 		virtual bool Run(int alHandle)=0;
+
+		/**
+		 * Runs a func in the script with typed arguments. The function is looked up once and cached, 
+		 * so no code is compiled as with Run(const tString&).
+		 * \return true if everything was ok, else false
+		 */
+		virtual bool Run(const cScriptCall& aCall)=0;
 	};
 };
 #endif // HPL_SCRIPT_H
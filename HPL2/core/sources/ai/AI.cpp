@@ -20,6 +20,7 @@
 #include "ai/AI.h"
 
 #include "ai/AINodeGenerator.h"
+#include "ai/AStarRequestQueue.h"
 #include "system/LowLevelSystem.h"
 #include "system/MemoryManager.h"
 
@@ -34,6 +35,7 @@ namespace hpl {
 	cAI::cAI() : iUpdateable("HPL_AI")
 	{
 		mpAINodeGenerator = hplNew( cAINodeGenerator, () );
+		mpAStarRequestQueue = hplNew( cAStarRequestQueue, () );
 	}
 
 	//-----------------------------------------------------------------------
@@ -41,6 +43,7 @@ namespace hpl {
 	cAI::~cAI()
 	{
 		hplDelete(mpAINodeGenerator);
+		hplDelete(mpAStarRequestQueue);
 	}
 
 	//-----------------------------------------------------------------------
@@ -53,14 +56,14 @@ namespace hpl {
 	
 	void cAI::Reset()
 	{
-
+		mpAStarRequestQueue->Reset();
 	}
 
 	//-----------------------------------------------------------------------
 
 	void cAI::Update(float afTimeStep)
 	{
-		
+		mpAStarRequestQueue->Update();
 	}
 	
 	//-----------------------------------------------------------------------
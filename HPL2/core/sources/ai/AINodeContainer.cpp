@@ -27,8 +27,7 @@
 
 #include "math/Math.h"
 
-
-#include "impl/tinyXML/tinyxml.h"
+#include "resources/BinaryBuffer.h"
 
 #include <algorithm>
 
@@ -42,6 +41,9 @@ namespace hpl {
 	
 	cAINode::cAINode()
 	{
+		mlID = -1;
+		mlIndex = -1;
+		mpUserData = NULL;
 	}
 
 	//-----------------------------------------------------------------------
@@ -65,27 +67,14 @@ namespace hpl {
 	
 	//-----------------------------------------------------------------------
 
+	#define kAINodeCacheCRCKey (0x3A17C5E9)
+
 	//////////////////////////////////////////////////////////////////////////
 	// RAY INTERSECT
 	//////////////////////////////////////////////////////////////////////////
 
 	//-----------------------------------------------------------------------
 
-	void cAINodeRayCallback::Reset()
-	{
-		mbIntersected = false;
-		mpCallback = NULL;
-	}
-	
-	//-----------------------------------------------------------------------
-
-	bool cAINodeRayCallback::Intersected()
-	{
-		return mbIntersected;
-	}
-
-	//-----------------------------------------------------------------------
-	
 	bool cAINodeRayCallback::BeforeIntersect(iPhysicsBody *pBody)
 	{
 		if(pBody->GetCollideCharacter()==false) return false;
@@ -104,23 +93,11 @@ namespace hpl {
 
 	bool cAINodeRayCallback::OnIntersect(iPhysicsBody *pBody,cPhysicsRayParams *apParams)
 	{
+		//Returning false stops the ray and marks it as hit.
 		if(mpCallback)
-		{
-			if(mpCallback->Intersects(pBody,apParams))
-			{
-				mbIntersected = true;
-				return false;
-			}
-			else
-			{
-				return true;
-			}
-		}
+			return mpCallback->Intersects(pBody,apParams)==false;
 		else
-		{
-			mbIntersected = true;
 			return false;
-		}
 	}
 
 	//-----------------------------------------------------------------------
@@ -248,6 +225,7 @@ namespace hpl {
 		msNodeName = asNodeName;
 
 		mpRayCallback = hplNew( cAINodeRayCallback, () );
+		mpRayCallback->Setup(0, NULL);
 
 		mlMaxNodeEnds = 5;
 		mlMinNodeEnds = 2;
@@ -290,6 +268,7 @@ namespace hpl {
 		pNode->mlID = alID;
 		pNode->mvPosition = avPosition;
 		pNode->mpUserData = apUserData;
+		pNode->mlIndex = (int)mvNodes.size();
 
 		mvNodes.push_back(pNode);
 		m_mapNodesByName.insert(tAINodeNameMap::value_type(asName,pNode));
@@ -342,13 +321,19 @@ namespace hpl {
 	{
 		BuildNodeGridMap();
 
+		////////////////////////////////////////
+		//Get all node pairs close enough to be connected, the free paths are then checked in one batch.
+		tAIFreePathQueryVec vQueries;
+		std::vector<cAINode*> vQueryStartNodes;
+		std::vector<cAINode*> vQueryEndNodes;
+
 		tAINodeVecIt CurrentNodeIt = mvNodes.begin();
 		for(; CurrentNodeIt != mvNodes.end(); ++CurrentNodeIt)
 		{
 			cAINode *pNode = *CurrentNodeIt;
 			
 			////////////////////////////////////////
-			//Add the ends that are connected to the node.
+			//Add the ends that could be connected to the node.
 			/*Log("Node %s checks: ",pNode->GetName().c_str());
 			tAINodeVecIt EndNodeIt = mvNodes.begin();
 			for(; EndNodeIt != mvNodes.end(); ++EndNodeIt)
@@ -384,18 +369,32 @@ namespace hpl {
                 				
 				float fHeight = fabs(pNode->mvPosition.y - pEndNode->mvPosition.y);
 				
-				tAIFreePathFlag flag = eAIFreePathFlag_SkipDynamic | eAIFreePathFlag_SkipVolatile;
-				if(	fHeight <= mfMaxHeight &&
-					FreePath(pNode->mvPosition, pEndNode->mvPosition,-1,flag))
+				if(fHeight <= mfMaxHeight)
 				{
-					pNode->AddEdge(pEndNode);	
-					//Log("Added!");
+					vQueries.push_back(cAIFreePathQuery(pNode->mvPosition, pEndNode->mvPosition));
+					vQueryStartNodes.push_back(pNode);
+					vQueryEndNodes.push_back(pEndNode);
 				}
 				//Log(", ");
 			}
 			//Log("\n");
+		}
+
+		////////////////////////////////////////
+		//Check paths and add the free ones
+		tAIFreePathFlag flag = eAIFreePathFlag_SkipDynamic | eAIFreePathFlag_SkipVolatile;
+		if(vQueries.empty()==false)
+			FreePaths(&vQueries[0], (int)vQueries.size(), -1, flag);
+
+		for(size_t i=0; i<vQueries.size(); ++i)
+		{
+			if(vQueries[i].mbFree) vQueryStartNodes[i]->AddEdge(vQueryEndNodes[i]);
+		}
+
+		for(CurrentNodeIt = mvNodes.begin(); CurrentNodeIt != mvNodes.end(); ++CurrentNodeIt)
+		{
+			cAINode *pNode = *CurrentNodeIt;
 
-			
 			///////////////////////////////////////
 			//Sort nodes and remove unwanted ones.
 			std::sort(pNode->mvEdges.begin(), pNode->mvEdges.end(), cSortEndNodes());
@@ -514,7 +513,89 @@ namespace hpl {
 		iPhysicsWorld *pPhysicsWorld = mpWorld->GetPhysicsWorld();
 		if(pPhysicsWorld==NULL) return true;
 
-		
+		cPhysicsRay vRays[5];
+		int lRayNum = SetupFreePathRays(avStart, avEnd, alRayNum, vRays);
+
+		mpRayCallback->Setup(aFlags, apCallback);
+
+		//Cast one ray at a time so the rest are skipped as soon as one is blocked.
+		for(int i=0; i< lRayNum; ++i)
+		{
+			pPhysicsWorld->CastRays(mpRayCallback, &vRays[i], 1, true);
+			if(vRays[i].mbHit) return false;
+		}
+
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	//Number of queries checked in each batch, to keep the temp rays small.
+	static const int kFreePathBatchSize = 1024;
+
+	void cAINodeContainer::FreePaths(cAIFreePathQuery *apQueries, int alNum, int alRayNum, 
+									tAIFreePathFlag aFlags, iAIFreePathCallback *apCallback)
+	{
+		iPhysicsWorld *pPhysicsWorld = mpWorld->GetPhysicsWorld();
+		if(pPhysicsWorld==NULL)
+		{
+			for(int i=0; i<alNum; ++i) apQueries[i].mbFree = true;
+			return;
+		}
+
+		mpRayCallback->Setup(aFlags, apCallback);
+
+		for(int lBatchStart=0; lBatchStart < alNum; lBatchStart += kFreePathBatchSize)
+		{
+			int lBatchEnd = cMath::Min(lBatchStart + kFreePathBatchSize, alNum);
+
+			/////////////////////////////
+			//Setup rays for all queries, each query uses the same number of rays.
+			mvTempRays.resize((lBatchEnd - lBatchStart) * 5);
+			int lRayCount = 0;
+			for(int i=lBatchStart; i<lBatchEnd; ++i)
+			{
+				lRayCount += SetupFreePathRays(apQueries[i].mvStart, apQueries[i].mvEnd, alRayNum, &mvTempRays[lRayCount]);
+			}
+
+			//Without a game callback only the flags decide what blocks a path, so the read-only packet cast can be used,
+			//which runs in parallel. A game callback can have any side effect and needs the serial cast.
+			if(apCallback==NULL)
+			{
+				mvTempHits.resize(lRayCount);
+				pPhysicsWorld->CastRays(&mvTempRays[0], lRayCount, ePhysicsRayFlag_AnyHit | ePhysicsRayFlag_NoNormal,
+										&mvTempHits[0], mpRayCallback);
+				for(int i=0; i<lRayCount; ++i) mvTempRays[i].mbHit = mvTempHits[i].mbHit;
+			}
+			else
+			{
+				pPhysicsWorld->CastRays(mpRayCallback, &mvTempRays[0], lRayCount, true);
+			}
+
+			/////////////////////////////
+			//Get the result
+			int lRayIdx = 0;
+			int lQueryRayNum = (alRayNum<0 || alRayNum>5) ? 5 : alRayNum;
+			for(int i=lBatchStart; i<lBatchEnd; ++i)
+			{
+				apQueries[i].mbFree = true;
+				for(int j=0; j<lQueryRayNum; ++j)
+				{
+					if(mvTempRays[lRayIdx+j].mbHit)
+					{
+						apQueries[i].mbFree = false;
+						break;
+					}
+				}
+				lRayIdx += lQueryRayNum;
+			}
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	int cAINodeContainer::SetupFreePathRays(const cVector3f &avStart, const cVector3f &avEnd, int alRayNum, cPhysicsRay *apRays)
+	{
 		if(alRayNum<0 || alRayNum>5) alRayNum =5;
 		
 		/////////////////////////////
@@ -531,111 +612,163 @@ namespace hpl {
 		const float fHalfWidth = mvSize.x * 0.4f;
 		const float fHalfHeight = mvSize.y * 0.4f;
 		
-		//Setup ray callback
-		mpRayCallback->SetFlags(aFlags);
-
-		//Iterate through all the rays.
+		//Setup all the rays.
 		for(int i=0; i< alRayNum; ++i)
 		{
 			cVector3f vAdd = vRight * (gvPosAdds[i].x*fHalfWidth) + vUp * (gvPosAdds[i].y*fHalfHeight);
-			cVector3f vStart = vStartCenter + vAdd;
-			cVector3f vEnd = vEndCenter + vAdd;
-
-			mpRayCallback->Reset(); 
-			mpRayCallback->mpCallback = apCallback;
-
-			pPhysicsWorld->CastRay(mpRayCallback,vStart,vEnd,false,false,false,true);
-			
-			if(mpRayCallback->Intersected()) return false;
+			apRays[i] = cPhysicsRay(vStartCenter + vAdd, vEndCenter + vAdd);
 		}
 
-		return true;
+		return alRayNum;
 	}
 
 	//-----------------------------------------------------------------------
 	
-	void cAINodeContainer::SaveToFile(const tWString &asFile)
+	bool cAINodeContainer::SaveToFile(const tWString &asFile)
 	{
-		TiXmlDocument* pXmlDoc = hplNew( TiXmlDocument,() );
-		
-		TiXmlElement *pRootElem = static_cast<TiXmlElement*>(pXmlDoc->InsertEndChild(TiXmlElement("AINodes")));
-
-		for(size_t i=0; i< mvNodes.size(); ++i)
+		cBinaryBuffer binBuff(asFile);
+
+		////////////////////////////////////////
+		// Header
+		binBuff.AddInt32(AI_NODE_CACHE_FORMAT_MAGIC_NUMBER);
+		binBuff.AddInt32(AI_NODE_CACHE_FORMAT_VERSION);
+		binBuff.AddInt32((int)GetCacheHash());
+
+		////////////////////////////////////////
+		// Edges as flat arrays, targets are node indices.
+		int lNodeNum = (int)mvNodes.size();
+		std::vector<int> vEdgeCounts(lNodeNum);
+		std::vector<int> vEdgeTargets;
+		std::vector<float> vEdgeDistances;
+
+		for(int i=0; i< lNodeNum; ++i)
 		{
 			cAINode * pNode = mvNodes[i];
-			TiXmlElement *pNodeElem = static_cast<TiXmlElement*>(pRootElem->InsertEndChild(TiXmlElement("Node")));
-
-			pNodeElem->SetAttribute("Name", pNode->GetName().c_str());
-			pNodeElem->SetAttribute("ID", cString::ToString(pNode->GetID()).c_str());
+			vEdgeCounts[i] = pNode->GetEdgeNum();
 
 			for(int edge =0; edge < pNode->GetEdgeNum(); ++edge)
 			{
 				cAINodeEdge *pEdge = pNode->GetEdge(edge);
-				TiXmlElement *pEdgeElem = static_cast<TiXmlElement*>(pNodeElem->InsertEndChild(TiXmlElement("Edge")));
-
-				pEdgeElem->SetAttribute("Node", pEdge->mpNode->GetName().c_str());
-				tString sDistance = cString::ToString(pEdge->mfDistance);
-				pEdgeElem->SetAttribute("Distance", sDistance.c_str());
+				vEdgeTargets.push_back(pEdge->mpNode->GetIndex());
+				vEdgeDistances.push_back(pEdge->mfDistance);
 			}
 		}
 
-		FILE *pFile = cPlatform::OpenFile(asFile, _W("w+"));
-		if(pFile==NULL || pXmlDoc->SaveFile(pFile)==false)
+		int lEdgeNum = (int)vEdgeTargets.size();
+		binBuff.AddInt32(lNodeNum);
+		binBuff.AddInt32(lEdgeNum);
+		if(lNodeNum > 0) binBuff.AddInt32Array(&vEdgeCounts[0], lNodeNum);
+		if(lEdgeNum > 0)
 		{
-			Error("Couldn't save XML file %s\n",asFile.c_str());
-			hplDelete(pXmlDoc);
-			return;
+			binBuff.AddInt32Array(&vEdgeTargets[0], lEdgeNum);
+			binBuff.AddFloat32Array(&vEdgeDistances[0], lEdgeNum);
 		}
-		fclose(pFile);
-		hplDelete(pXmlDoc);
+
+		////////////////////////////////////////
+		// Save
+		bool bRet = binBuff.Save();
+		if(bRet==false) Error("Couldn't save ai node cache to '%s'\n", cString::To8Char(asFile).c_str());
+
+		return bRet;
 	}
 	
 	//-----------------------------------------------------------------------
 	
-	void cAINodeContainer::LoadFromFile(const tWString &asFile)
+	bool cAINodeContainer::LoadFromFile(const tWString &asFile)
 	{
 		BuildNodeGridMap();
 
-		FILE *pFile = cPlatform::OpenFile(asFile, _W("rb"));
-		if(pFile==NULL) return;
+		cBinaryBuffer binBuff(asFile);
+		if(binBuff.Load()==false) return false;
 		
-		TiXmlDocument* pXmlDoc = hplNew( TiXmlDocument, () );
-		if(pXmlDoc->LoadFile(pFile)==false)
+		/////////////////////////////////////////////////
+		// Header
+		int lMagicNum = binBuff.GetInt32();
+		int lVersion = binBuff.GetInt32();
+		unsigned int lHash = (unsigned int)binBuff.GetInt32();
+
+		if(lMagicNum != AI_NODE_CACHE_FORMAT_MAGIC_NUMBER)
 		{
-			Warning("Couldn't open XML file %s\n",cString::To8Char(asFile).c_str());
-			fclose(pFile);
-			hplDelete(pXmlDoc);
-			return;
+			Error("File '%s' does not have right AI node cache magic number (%X instead of %X)! Invalid header!\n", cString::To8Char(asFile).c_str(),lMagicNum,AI_NODE_CACHE_FORMAT_MAGIC_NUMBER);
+			return false;
+		}
+		if(lVersion != AI_NODE_CACHE_FORMAT_VERSION)
+		{
+			Log("AI node cache '%s' has old version %d, newest is %d\n", cString::To8Char(asFile).c_str(),lVersion,AI_NODE_CACHE_FORMAT_VERSION);
+			return false;
+		}
+		if(lHash != GetCacheHash())
+		{
+			Log("AI node cache '%s' was made from other nodes or settings\n", cString::To8Char(asFile).c_str());
+			return false;
 		}
-		fclose(pFile);
 
-		TiXmlElement *pRootElem = pXmlDoc->RootElement();
+		/////////////////////////////////////////////////
+		// Edges
+		int lNodeNum = binBuff.GetInt32();
+		int lEdgeNum = binBuff.GetInt32();
+		if(lNodeNum != (int)mvNodes.size() || lEdgeNum < 0) return false;
+
+		std::vector<int> vEdgeCounts(lNodeNum);
+		std::vector<int> vEdgeTargets(lEdgeNum);
+		std::vector<float> vEdgeDistances(lEdgeNum);
+		if(lNodeNum > 0) binBuff.GetInt32Array(&vEdgeCounts[0], lNodeNum);
+		if(lEdgeNum > 0)
+		{
+			binBuff.GetInt32Array(&vEdgeTargets[0], lEdgeNum);
+			binBuff.GetFloat32Array(&vEdgeDistances[0], lEdgeNum);
+		}
 
-		TiXmlElement *pNodeElem = pRootElem->FirstChildElement("Node");
-		for(; pNodeElem != NULL; pNodeElem = pNodeElem->NextSiblingElement("Node"))
+		//Check so data is valid before adding anything
+		int lEdgeCount = 0;
+		for(int i=0; i<lNodeNum; ++i) lEdgeCount += vEdgeCounts[i];
+		if(lEdgeCount != lEdgeNum) return false;
+		for(int i=0; i<lEdgeNum; ++i)
+		{
+			if(vEdgeTargets[i] < 0 || vEdgeTargets[i] >= lNodeNum) return false;
+		}
+		
+		int lEdgeIdx = 0;
+		for(int i=0; i<lNodeNum; ++i)
 		{
-			tString sName = cString::ToString(pNodeElem->Attribute("Name"),"");
-			int alID = cString::ToInt(pNodeElem->Attribute("ID"),-1);
+			cAINode *pNode = mvNodes[i];
+			pNode->mvEdges.resize(vEdgeCounts[i]);
 
-			cAINode *pNode = GetNodeFromID(alID);
-            
-			TiXmlElement *pEdgeElem = pNodeElem->FirstChildElement("Edge");
-			for(; pEdgeElem != NULL; pEdgeElem = pEdgeElem->NextSiblingElement("Edge"))
+			for(int edge=0; edge < vEdgeCounts[i]; ++edge, ++lEdgeIdx)
 			{
-				tString sNodeName = cString::ToString(pEdgeElem->Attribute("Node"),"");			
-				cAINode *pEdgeNode = GetNodeFromName(sNodeName);
-
-				cAINodeEdge Edge;
-				Edge.mpNode = pEdgeNode;
-				Edge.mfDistance = cString::ToFloat(pEdgeElem->Attribute("Distance"),0);
+				cAINodeEdge &Edge = pNode->mvEdges[edge];
+				Edge.mpNode = mvNodes[vEdgeTargets[lEdgeIdx]];
+				Edge.mfDistance = vEdgeDistances[lEdgeIdx];
 				Edge.mfSqrDistance = Edge.mfDistance*Edge.mfDistance;
-
-				pNode->mvEdges.push_back(Edge);
 			}
 		}
 
-		hplDelete(pXmlDoc);
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	unsigned int cAINodeContainer::GetCacheHash()
+	{
+		cBinaryBuffer hashBuff;
+
+		hashBuff.AddVector3f(mvSize);
+		hashBuff.AddInt32(mlMaxNodeEnds);
+		hashBuff.AddInt32(mlMinNodeEnds);
+		hashBuff.AddFloat32(mfMaxEndDistance);
+		hashBuff.AddFloat32(mfMaxHeight);
+		hashBuff.AddBool(mbNodeIsAtCenter);
+
+		hashBuff.AddInt32((int)mvNodes.size());
+		for(size_t i=0; i< mvNodes.size(); ++i)
+		{
+			hashBuff.AddInt32(mvNodes[i]->GetID());
+			hashBuff.AddVector3f(mvNodes[i]->GetPosition());
+		}
+
+		return hashBuff.GetCRC(kAINodeCacheCRCKey, 0);
 	}
+
 	//-----------------------------------------------------------------------
 	
 	//////////////////////////////////////////////////////////////////////////
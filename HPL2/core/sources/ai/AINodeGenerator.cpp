@@ -32,7 +32,7 @@
 #include "physics/PhysicsWorld.h"
 #include "physics/PhysicsBody.h"
 
-#include "impl/tinyXML/tinyxml.h"
+#include "resources/BinaryBuffer.h"
 
 
 namespace hpl {
@@ -60,23 +60,21 @@ namespace hpl {
 	
 	//-----------------------------------------------------------------------
 
-	class cCollideRayCallback : public iPhysicsRayCallback
+	/**
+	 * Only lets static bodies through. Has no state, so it can be used as the filter for packet casts.
+	 */
+	class cStaticBodyRayFilter : public iPhysicsRayCallback
 	{
 	public:
-		bool OnIntersect(iPhysicsBody *pBody,cPhysicsRayParams *apParams)
+		bool BeforeIntersect(iPhysicsBody *pBody)
 		{
-			if(pBody->GetMass()!=0) return true;
-
-			mbIntersected = true;
-			mvPos = apParams->mvPoint;
-			mfDist = apParams->mfDist;
+			return pBody->GetMass()==0;
+		}
 
+		bool OnIntersect(iPhysicsBody *pBody,cPhysicsRayParams *apParams)
+		{
 			return false;
 		}
-
-		bool mbIntersected;
-		cVector3f mvPos;
-		float mfDist;
 	};
 
 	//-----------------------------------------------------------------------
@@ -105,7 +103,9 @@ namespace hpl {
 
 	//-----------------------------------------------------------------------
 	
-	static cCollideRayCallback gCollideRayCallback;
+	static cStaticBodyRayFilter gStaticBodyRayFilter;
+
+	#define kAINodeGeneratorCRCKey (0x5C2E9A41)
 
 	//-----------------------------------------------------------------------
 
@@ -129,7 +129,7 @@ namespace hpl {
 		if(mpWorld->GetFilePath() != _W(""))
 		{
 			tWString sPath = mpWorld->GetFilePath();
-			tWString sSaveFile = cString::SetFileExtW(sPath,_W("ainodes"));
+			tWString sSaveFile = cString::SetFileExtW(sPath,_W("ainodes_cache"));
 
 			if(sPath != _W("") && cPlatform::FileExists(sSaveFile))
 			{
@@ -137,9 +137,8 @@ namespace hpl {
 				cDate saveDate = cPlatform::FileModifiedDate(sSaveFile);
 
 				//If the save file is newer than the map load from it.
-				if(saveDate > mapDate)
+				if(saveDate > mapDate && LoadFromFile())
 				{
-					LoadFromFile();
 					return;
 				}
 			}
@@ -191,7 +190,8 @@ namespace hpl {
 				
 
 		/////////////////////////////////////////
-		//Place the nodes in the world
+		//Place the nodes in the world, all the grid rays are cast as one batch
+		tPhysicsRayVec vRays;
 		cVector3f vPos(vWorldMin.x,0,vWorldMin.z);
 
 		while(vPos.z <= vWorldMax.z)
@@ -199,7 +199,7 @@ namespace hpl {
 			cVector3f vStart(vPos.x, vWorldMax.y, vPos.z);
 			cVector3f vEnd(vPos.x, vWorldMin.y, vPos.z);
 			
-			pPhysicsWorld->CastRay(this,vStart,vEnd,false,false,true);
+			vRays.push_back(cPhysicsRay(vStart,vEnd));
 
 			//Log("Pos: %s Min: %s Max: %s\n",vPos.ToString().c_str(),
 			//								vWorldMin.ToString().c_str(),
@@ -213,6 +213,24 @@ namespace hpl {
 			}
 		}
 
+		//Every static body below each grid point is wanted, packets only give one hit per ray, so the serial cast is used
+		//with the static test as prefilter.
+		mvRayGroundPoints.clear();
+		mvRayGroundPoints.resize(vRays.size());
+		if(vRays.empty()==false)
+			pPhysicsWorld->CastRays(this,&vRays[0],(int)vRays.size(), true);
+
+		for(size_t i=0; i<mvRayGroundPoints.size(); ++i)
+		{
+			tVector3fVec &vPoints = mvRayGroundPoints[i];
+			for(size_t j=0; j<vPoints.size(); ++j)
+			{
+				mpNodeList->push_back(cTempAiNode(vPoints[j],"",mlIDCount));
+				mlIDCount++;
+			}
+		}
+		mvRayGroundPoints.clear();
+
 		/////////////////////////////////////////
 		//Check so that the nodes are not too close to walls
 		cVector3f vEnds[4] = {	cVector3f(mpParams->mfMinWallDist,0,0),
@@ -227,26 +245,37 @@ namespace hpl {
 										cVector3f(0,0,1)
 								};
 
-		tTempAiNodeListIt nodeIt = mpNodeList->begin();
-		for(; nodeIt != mpNodeList->end(); ++nodeIt)
+		//Check if there are any walls close by. One batch per direction, since each push moves the start of the next ray.
+		//Only the closest static body matters, so the rays are cast as packets.
+		tPhysicsRayHitVec vHits;
+		vRays.resize(mpNodeList->size());
+		vHits.resize(mpNodeList->size());
+		for(int i=0; i<4 && vRays.empty()==false; ++i)
 		{
-			cTempAiNode &Node = *nodeIt;
-		
-			//Check if there are any walls close by.
-			for(int i=0; i<4; ++i)
+			size_t lRay = 0;
+			tTempAiNodeListIt nodeIt = mpNodeList->begin();
+			for(; nodeIt != mpNodeList->end(); ++nodeIt, ++lRay)
 			{
-				gCollideRayCallback.mbIntersected = false;
-				pPhysicsWorld->CastRay(&gCollideRayCallback,Node.mvPos,Node.mvPos + vEnds[i],true,false,true);
+				vRays[lRay] = cPhysicsRay(nodeIt->mvPos, nodeIt->mvPos + vEnds[i]);
+			}
+
+			pPhysicsWorld->CastRays(&vRays[0],(int)vRays.size(), ePhysicsRayFlag_NoNormal, &vHits[0], &gStaticBodyRayFilter);
+
+			lRay = 0;
+			for(nodeIt = mpNodeList->begin(); nodeIt != mpNodeList->end(); ++nodeIt, ++lRay)
+			{
+				cTempAiNode &Node = *nodeIt;
 				
-				if(gCollideRayCallback.mbIntersected)
+				if(vHits[lRay].mbHit)
 				{
-					//Log("Walldistance %f : Add: (%s) Push (%s) Min: %f\n",gCollideRayCallback.mfDist, 
+					float fDist = vHits[lRay].mfDist;
+					//Log("Walldistance %f : Add: (%s) Push (%s) Min: %f\n",fDist, 
 					//											vEnds[i].ToString().c_str(),
 					//											vPushBackDirs[i].ToString().c_str(),
 					//											mpParams->mfMinWallDist);
-					if(gCollideRayCallback.mfDist < mpParams->mfMinWallDist)
+					if(fDist < mpParams->mfMinWallDist)
 					{
-						Node.mvPos += vPushBackDirs[i] * (mpParams->mfMinWallDist - gCollideRayCallback.mfDist);
+						Node.mvPos += vPushBackDirs[i] * (mpParams->mfMinWallDist - fDist);
 					}
 				}
 			}
@@ -264,16 +293,18 @@ namespace hpl {
 
 	//-----------------------------------------------------------------------
 	
-	bool cAINodeGenerator::OnIntersect(iPhysicsBody *pBody,cPhysicsRayParams *apParams)
+	bool cAINodeGenerator::BeforeIntersect(iPhysicsBody *pBody)
 	{
-		if(pBody->GetMass() != 0) return true;
+		return gStaticBodyRayFilter.BeforeIntersect(pBody);
+	}
 
-		iPhysicsWorld *pPhysicsWorld = mpWorld->GetPhysicsWorld();
+	//-----------------------------------------------------------------------
 
+	bool cAINodeGenerator::OnIntersect(iPhysicsBody *pBody,cPhysicsRayParams *apParams)
+	{
 		cVector3f vPosition = apParams->mvPoint + cVector3f(0,mpParams->mfHeightFromGround,0);
 		
-		mpNodeList->push_back(cTempAiNode(vPosition,"",mlIDCount));
-		mlIDCount++;
+		mvRayGroundPoints[apParams->mlRayIdx].push_back(vPosition);
 
 		return true;
 	}
@@ -284,83 +315,91 @@ namespace hpl {
 	{
 		if(mpWorld->GetFilePath() == _W("")) return;
 
-		cSystem *pSystem = mpWorld->GetSystem();
-		cResources *pResources = mpWorld->GetResources();
-		cFileSearcher *pFileSearcher = pResources->GetFileSearcher();
-
 		tWString sMapPath = mpWorld->GetFilePath();
-		tWString sSaveFile = cString::SetFileExtW(sMapPath,_W("ainodes"));
+		tWString sSaveFile = cString::SetFileExtW(sMapPath,_W("ainodes_cache"));
 		
-		TiXmlDocument* pXmlDoc = hplNew( TiXmlDocument, () );
+		cBinaryBuffer binBuff(sSaveFile);
 
-		TiXmlElement *pRootElem = static_cast<TiXmlElement*>(pXmlDoc->InsertEndChild(TiXmlElement("AiNodes")));
-		
+		binBuff.AddInt32(AI_NODE_GENERATOR_CACHE_FORMAT_MAGIC_NUMBER);
+		binBuff.AddInt32(AI_NODE_GENERATOR_CACHE_FORMAT_VERSION);
+		binBuff.AddInt32((int)GetParamsHash());
+
+		binBuff.AddInt32((int)mpNodeList->size());
 		tTempAiNodeListIt nodeIt = mpNodeList->begin();
 		for(; nodeIt != mpNodeList->end(); ++nodeIt)
 		{
 			cTempAiNode &Node = *nodeIt;
-			TiXmlElement *pNodeElem = static_cast<TiXmlElement*>(pRootElem->InsertEndChild(TiXmlElement("Node")));
-			
-			tString sPos =	cString::ToString(Node.mvPos.x)+" " + 
-							cString::ToString(Node.mvPos.y)+" " +
-							cString::ToString(Node.mvPos.z);
-			pNodeElem->SetAttribute("Pos",sPos.c_str());
-			pNodeElem->SetAttribute("Name", Node.msName.c_str());
-			pNodeElem->SetAttribute("Name", cString::ToString(Node.mlID).c_str());
+			binBuff.AddVector3f(Node.mvPos);
+			binBuff.AddString(Node.msName);
+			binBuff.AddInt32(Node.mlID);
 		}
 		
-		FILE *pFile = cPlatform::OpenFile(sSaveFile,_W("w+"));
-		if(pFile==NULL || pXmlDoc->SaveFile(pFile)==false)
+		if(binBuff.Save()==false)
 		{
-			Error("Couldn't save XML file %s\n",sSaveFile.c_str());
-			hplDelete(pXmlDoc);
-			return;
+			Error("Couldn't save ai node cache to '%s'\n",cString::To8Char(sSaveFile).c_str());
 		}
-		fclose(pFile);
-		hplDelete(pXmlDoc);
 	}
 
 	//-----------------------------------------------------------------------
 
-	void cAINodeGenerator::LoadFromFile()
+	bool cAINodeGenerator::LoadFromFile()
 	{
-		if(mpWorld->GetFilePath() == _W("")) return;
-
-		cSystem *pSystem = mpWorld->GetSystem();
-		cResources *pResources = mpWorld->GetResources();
-		cFileSearcher *pFileSearcher = pResources->GetFileSearcher();
+		if(mpWorld->GetFilePath() == _W("")) return false;
 
 		tWString sMapPath = mpWorld->GetFilePath();
-		tWString sSaveFile = cString::SetFileExtW(sMapPath,_W("ainodes"));
+		tWString sSaveFile = cString::SetFileExtW(sMapPath,_W("ainodes_cache"));
 
-		FILE *pFile = cPlatform::OpenFile(sSaveFile, _W("rb"));
-		if (!pFile) {
-			Warning("Couldn't open XML file %s\n",cString::To8Char(sSaveFile).c_str());
-			return;
-		}
-		TiXmlDocument* pXmlDoc = hplNew( TiXmlDocument, () );
-		if(pXmlDoc->LoadFile(pFile)==false)
+		cBinaryBuffer binBuff(sSaveFile);
+		if(binBuff.Load()==false)
 		{
-			Warning("Couldn't open XML file %s\n",cString::To8Char(sSaveFile).c_str());
-			fclose(pFile);
-			hplDelete(pXmlDoc);
-			return;
+			Warning("Couldn't open ai node cache '%s'\n",cString::To8Char(sSaveFile).c_str());
+			return false;
 		}
-		fclose(pFile);
 
-		TiXmlElement *pRootElem = pXmlDoc->RootElement();
+		int lMagicNum = binBuff.GetInt32();
+		int lVersion = binBuff.GetInt32();
+		unsigned int lHash = (unsigned int)binBuff.GetInt32();
 
-		TiXmlElement *pNodeElem = pRootElem->FirstChildElement("Node");
-		for(; pNodeElem != NULL; pNodeElem = pNodeElem->NextSiblingElement("Node"))
+		if(lMagicNum != AI_NODE_GENERATOR_CACHE_FORMAT_MAGIC_NUMBER)
+		{
+			Error("File '%s' does not have right ai node cache magic number (%X instead of %X)! Invalid header!\n", cString::To8Char(sSaveFile).c_str(),lMagicNum,AI_NODE_GENERATOR_CACHE_FORMAT_MAGIC_NUMBER);
+			return false;
+		}
+		if(lVersion != AI_NODE_GENERATOR_CACHE_FORMAT_VERSION || lHash != GetParamsHash())
 		{
-			cVector3f vPos = cString::ToVector3f(pNodeElem->Attribute("Pos"),0);
-			tString sName = cString::ToString(pNodeElem->Attribute("Name"),"");
-			int alID = cString::ToInt(pNodeElem->Attribute("ID"),-1);
+			Log("Ai node cache '%s' is out of date\n", cString::To8Char(sSaveFile).c_str());
+			return false;
+		}
+
+		int lNodeNum = binBuff.GetInt32();
+		for(int i=0; i<lNodeNum; ++i)
+		{
+			cVector3f vPos;
+			tString sName;
+			binBuff.GetVector3f(&vPos);
+			binBuff.GetString(&sName);
+			int lID = binBuff.GetInt32();
 
-			mpNodeList->push_back(cTempAiNode(vPos,sName,alID));
+			mpNodeList->push_back(cTempAiNode(vPos,sName,lID));
 		}
 
-		hplDelete(pXmlDoc);
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	unsigned int cAINodeGenerator::GetParamsHash()
+	{
+		cBinaryBuffer hashBuff;
+
+		hashBuff.AddString(mpParams->msNodeType);
+		hashBuff.AddFloat32(mpParams->mfHeightFromGround);
+		hashBuff.AddFloat32(mpParams->mfMinWallDist);
+		hashBuff.AddVector3f(mpParams->mvMinPos);
+		hashBuff.AddVector3f(mpParams->mvMaxPos);
+		hashBuff.AddFloat32(mpParams->mfGridSize);
+
+		return hashBuff.GetCRC(kAINodeGeneratorCRCKey, 0);
 	}
 	
 	//-----------------------------------------------------------------------
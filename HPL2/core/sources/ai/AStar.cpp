@@ -29,130 +29,104 @@
 namespace hpl {
 
 	//////////////////////////////////////////////////////////////////////////
-	// NODE
+	// CONSTRUCTORS
 	//////////////////////////////////////////////////////////////////////////
 
 	//-----------------------------------------------------------------------
 
-	cAStarNode::cAStarNode(cAINode *apAINode)
+	cAStarHandler::cAStarHandler(cAINodeContainer *apContainer)
 	{
-		mpParent = NULL;
-		mpAINode = apAINode;
+		mlMaxIterations = -1;
+
+		mpContainer = apContainer;
+
+		mpCallback = NULL;
+
+		mlGeneration = 0;
+		mlGoalNode = -1;
+		mSearchState = eAStarSearchState_None;
+		mlSearchIterations = 0;
 	}
 
 	//-----------------------------------------------------------------------
 
-	bool cAStarNodeCompare::operator()(cAStarNode* apNodeA,cAStarNode* apNodeB) const
+	cAStarHandler::~cAStarHandler()
 	{
-		return apNodeA->mpAINode < apNodeB->mpAINode;
 	}
 
-
 	//-----------------------------------------------------------------------
 
 	//////////////////////////////////////////////////////////////////////////
-	// CONSTRUCTORS
+	// PUBLIC METHODS
 	//////////////////////////////////////////////////////////////////////////
 
 	//-----------------------------------------------------------------------
 
-	cAStarHandler::cAStarHandler(cAINodeContainer *apContainer)
+	bool cAStarHandler::GetPath(const cVector3f& avStart, const cVector3f& avGoal, tAINodeVec *apNodeVec)
 	{
-		mlMaxIterations = -1;
+		StartSearch(avStart, avGoal);
+		ContinueSearch(-1);
+		if(mSearchState != eAStarSearchState_Found) return false;
 
-		mpContainer = apContainer;
+		if(apNodeVec) GetSearchPath(apNodeVec);
 
-		mpCallback = NULL;
+		return true;
 	}
 
 	//-----------------------------------------------------------------------
 
-	cAStarHandler::~cAStarHandler()
+	bool cAStarHandler::GetPath(const cVector3f& avStart, const cVector3f& avGoal, tAINodeList *apNodeList)
 	{
-		STLDeleteAll(m_setClosedList);
-		STLDeleteAll(m_setOpenList);
-	}
+		StartSearch(avStart, avGoal);
+		ContinueSearch(-1);
+		if(mSearchState != eAStarSearchState_Found) return false;
 
-	//-----------------------------------------------------------------------
+		if(apNodeList)
+		{
+			for(int lNode = mlGoalNode; lNode >= 0; lNode = mvSearchNodes[lNode].mlParent)
+			{
+				apNodeList->push_back(mpContainer->GetNode(lNode));
+			}
+		}
 
-	//////////////////////////////////////////////////////////////////////////
-	// PUBLIC METHODS
-	//////////////////////////////////////////////////////////////////////////
+		return true;
+	}
 
 	//-----------------------------------------------------------------------
 
-	bool cAStarHandler::GetPath(const cVector3f& avStart, const cVector3f& avGoal,tAINodeList *apNodeList)
+	int cAStarHandler::StartSearch(const cVector3f& avStart, const cVector3f& avGoal)
 	{
 		float fMaxHeight = mpContainer->GetMaxHeight()*1.5f;
+		int lIterationCount = 0;
+
+		mlGoalNode = -1;
+		mlSearchIterations = 0;
 
 		/////////////////////////////////////////////////
 		// check if there is free path from start to goal
 		float fHeight = fabs(avStart.y - avGoal.y);
-		if(fHeight <= fMaxHeight && mpContainer->FreePath(avStart,avGoal,-1,eAIFreePathFlag_SkipDynamic))
+		if(fHeight <= fMaxHeight)
 		{
-			mpGoalNode = NULL;
-			return true;
+			++lIterationCount;
+			if(mpContainer->FreePath(avStart,avGoal,-1,eAIFreePathFlag_SkipDynamic))
+			{
+				mSearchState = eAStarSearchState_Found;
+				return lIterationCount;
+			}
 		}
 
 		////////////////////////////////////////////////
 		//Reset all variables
-		//These should just be cleared and pools used instead.
-		STLDeleteAll(m_setClosedList);
-		STLDeleteAll(m_setOpenList);
-		m_setGoalNodes.clear();
-		mpGoalNode=NULL;
+		BeginSearch();
 
 		//Set goal position
 		mvGoal = avGoal;
 		
 		
 		////////////////////////////////////////////////
-		//Find nodes reachable from the start and goal position (use double 2*2 distance)
-		float fMaxDist = mpContainer->GetMaxEdgeDistance()*2; //float fMaxDist = mpContainer->GetMaxEdgeDistance()*mpContainer->GetMaxEdgeDistance()*4;
-		
-		/////////////////////
-		//Check with Start
-		//Log(" Get Start\n");
-		cAINodeIterator startNodeIt =  mpContainer->GetNodeIterator(avStart,fMaxDist);
-		while(startNodeIt.HasNext())
-		{
-			cAINode *pAINode = startNodeIt.Next();
-			//Log("Check node: %s\n",pAINode->GetName().c_str());
-
-			float fHeight = fabs(avStart.y - pAINode->GetPosition().y);
-			float fDist = cMath::Vector3Dist(avStart,pAINode->GetPosition()); //float fDist = cMath::Vector3DistSqr(avStart,pAINode->GetPosition());
-			if(fDist < fMaxDist && fHeight <= fMaxHeight)
-			{
-				//Check if path is clear
-				if(mpContainer->FreePath(avStart,pAINode->GetPosition(),-1,	eAIFreePathFlag_SkipDynamic))
-				{
-					AddOpenNode(pAINode,NULL,fDist);
-				}
-			}
-		}
-		//Log(" Found start\n");
-
-		////////////////////////////////
-		//Check with Goal
-		//Log(" Get Goal\n");
-		cAINodeIterator goalNodeIt =  mpContainer->GetNodeIterator(avGoal,fMaxDist);
-		while(goalNodeIt.HasNext())
-		{
-			cAINode *pAINode = goalNodeIt.Next();
-			//Log("Check node: %s\n",pAINode->GetName().c_str());
-			
-			float fHeight = fabs(avGoal.y - pAINode->GetPosition().y);
-			float fDist = cMath::Vector3Dist(avGoal,pAINode->GetPosition()); //fDist = cMath::Vector3DistSqr(avGoal,pAINode->GetPosition());
-			if(fDist < fMaxDist && fHeight <= fMaxHeight)
-			{
-				//Check if path is clear
-				if(mpContainer->FreePath(avGoal,pAINode->GetPosition(),-1, eAIFreePathFlag_SkipDynamic))
-				{
-					m_setGoalNodes.insert(pAINode);
-				}
-			}
-		}
-		//Log(" Found goal\n");
+		//Find nodes reachable from the start and goal position
+		lIterationCount += AddReachableNodes(avStart, false);
+		lIterationCount += AddReachableNodes(avGoal, true);
 		
 		/*for(int i=0; i<mpContainer->GetNodeNum(); ++i)
 		{
@@ -187,29 +161,56 @@ namespace hpl {
 			}
 		}*/
 
-		////////////////////////////////////////////////
-		//Iterate the algorithm
-		IterateAlgorithm();
+		mSearchState = mvOpenHeap.empty() ? eAStarSearchState_Failed : eAStarSearchState_Searching;
+
+		return lIterationCount;
+	}
+
+	//-----------------------------------------------------------------------
+
+	int cAStarHandler::ContinueSearch(int alMaxIterations)
+	{
+		if(mSearchState != eAStarSearchState_Searching) return 0;
 
 		////////////////////////////////////////////////
-		//Check if goal was found, if so build path.
-		if(mpGoalNode)
+		//Limit to what is left of the max iterations for the search
+		if(mlMaxIterations >= 0)
 		{
-			if(apNodeList)
-			{
-				cAStarNode *pParentNode = mpGoalNode;
-				while(pParentNode != NULL)
-				{
-					apNodeList->push_back(pParentNode->mpAINode);
-					pParentNode = pParentNode->mpParent;
-				}
-			}
-
-			return true;
+			int lIterationsLeft = mlMaxIterations - mlSearchIterations;
+			if(alMaxIterations < 0 || alMaxIterations > lIterationsLeft) alMaxIterations = lIterationsLeft;
 		}
-		else
+
+		////////////////////////////////////////////////
+		//Iterate the algorithm
+		int lIterationCount = IterateAlgorithm(alMaxIterations);
+		mlSearchIterations += lIterationCount;
+
+		if(mlGoalNode >= 0)
+			mSearchState = eAStarSearchState_Found;
+		else if(mvOpenHeap.empty() || (mlMaxIterations >= 0 && mlSearchIterations >= mlMaxIterations))
+			mSearchState = eAStarSearchState_Failed;
+
+		return lIterationCount;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cAStarHandler::CancelSearch()
+	{
+		mSearchState = eAStarSearchState_None;
+		mlGoalNode = -1;
+		mvOpenHeap.clear();
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cAStarHandler::GetSearchPath(tAINodeVec *apNodeVec)
+	{
+		if(mSearchState != eAStarSearchState_Found) return;
+
+		for(int lNode = mlGoalNode; lNode >= 0; lNode = mvSearchNodes[lNode].mlParent)
 		{
-			 return false;
+			apNodeVec->push_back(mpContainer->GetNode(lNode));
 		}
 	}
 
@@ -221,19 +222,100 @@ namespace hpl {
 
 	//-----------------------------------------------------------------------
 
-	void cAStarHandler::IterateAlgorithm()
+	//-----------------------------------------------------------------------
+
+	int cAStarHandler::AddReachableNodes(const cVector3f& avPos, bool abGoal)
+	{
+		float fMaxHeight = mpContainer->GetMaxHeight()*1.5f;
+		//Use double 2*2 distance
+		float fMaxDist = mpContainer->GetMaxEdgeDistance()*2; //float fMaxDist = mpContainer->GetMaxEdgeDistance()*mpContainer->GetMaxEdgeDistance()*4;
+
+		/////////////////////
+		//Get nodes close enough
+		mvTempQueries.clear();
+		mvTempNodes.clear();
+
+		cAINodeIterator nodeIt =  mpContainer->GetNodeIterator(avPos,fMaxDist);
+		while(nodeIt.HasNext())
+		{
+			cAINode *pAINode = nodeIt.Next();
+			//Log("Check node: %s\n",pAINode->GetName().c_str());
+
+			float fHeight = fabs(avPos.y - pAINode->GetPosition().y);
+			float fDist = cMath::Vector3Dist(avPos,pAINode->GetPosition()); //float fDist = cMath::Vector3DistSqr(avPos,pAINode->GetPosition());
+			if(fDist < fMaxDist && fHeight <= fMaxHeight)
+			{
+				mvTempQueries.push_back(cAIFreePathQuery(avPos, pAINode->GetPosition()));
+				mvTempNodes.push_back(pAINode);
+			}
+		}
+		if(mvTempQueries.empty()) return 0;
+
+		/////////////////////
+		//Check if paths are clear
+		mpContainer->FreePaths(&mvTempQueries[0], (int)mvTempQueries.size(), -1, eAIFreePathFlag_SkipDynamic);
+
+		for(size_t i=0; i<mvTempNodes.size(); ++i)
+		{
+			if(mvTempQueries[i].mbFree==false) continue;
+
+			cAINode *pAINode = mvTempNodes[i];
+			if(abGoal)
+				GetSearchNode(pAINode->GetIndex())->mlGoalGeneration = mlGeneration;
+			else
+				AddOpenNode(pAINode,-1,cMath::Vector3Dist(avPos,pAINode->GetPosition()));
+		}
+
+		return (int)mvTempQueries.size();
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cAStarHandler::BeginSearch()
+	{
+		mvOpenHeap.clear();
+		mlGoalNode = -1;
+
+		//Nodes with an old generation are treated as unvisited, so only clear when the counter wraps around.
+		++mlGeneration;
+		if(mlGeneration==0)
+		{
+			for(size_t i=0; i<mvSearchNodes.size(); ++i)
+			{
+				mvSearchNodes[i].mlGeneration = 0;
+				mvSearchNodes[i].mlGoalGeneration = 0;
+			}
+			mlGeneration = 1;
+		}
+
+		if((int)mvSearchNodes.size() < mpContainer->GetNodeNum())
+		{
+			size_t lOldSize = mvSearchNodes.size();
+			mvSearchNodes.resize(mpContainer->GetNodeNum());
+			for(size_t i=lOldSize; i<mvSearchNodes.size(); ++i)
+			{
+				mvSearchNodes[i].mlGeneration = 0;
+				mvSearchNodes[i].mlGoalGeneration = 0;
+			}
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	int cAStarHandler::IterateAlgorithm(int alMaxIterations)
 	{
 		int lIterationCount=0;
-		while(m_setOpenList.empty()==false && (mlMaxIterations <0 || lIterationCount < mlMaxIterations))
+		while(mvOpenHeap.empty()==false && (alMaxIterations <0 || lIterationCount < alMaxIterations))
 		{
-			cAStarNode *pNode = GetBestNode();
-			cAINode *pAINode = pNode->mpAINode;
+			int lNode = GetBestNode();
+			cAStarNode *pNode = &mvSearchNodes[lNode];
+			cAINode *pAINode = mpContainer->GetNode(lNode);
 
 			//////////////////////
 			// Check if current node can reach goal
-			if(IsGoalNode(pAINode))
+			if(pNode->mlGoalGeneration == mlGeneration)
 			{
-				mpGoalNode = pNode;
+				mlGoalNode = lNode;
 				break;
 			}
 
@@ -246,79 +328,60 @@ namespace hpl {
 
 				if(mpCallback == NULL || mpCallback->CanAddNode(pAINode, pEdge->mpNode))
 				{
-					AddOpenNode(pEdge->mpNode, pNode, pNode->mfDistance + pEdge->mfDistance);
-					//AddOpenNode(pEdge->mpNode, pNode, pNode->mfDistance + pEdge->mfSqrDistance);
+					AddOpenNode(pEdge->mpNode, lNode, pNode->mfDistance + pEdge->mfDistance);
 				}
 			}
 
 			++lIterationCount;
 		}
-	}
 
+		return lIterationCount;
+	}
 
 	//-----------------------------------------------------------------------
 
-	void cAStarHandler::AddOpenNode(cAINode *apAINode, cAStarNode *apParent, float afDistance)
+	void cAStarHandler::AddOpenNode(cAINode *apAINode, int alParent, float afDistance)
 	{
-		//TODO: free path check with dynamic objects here.
+		cAStarNode *pNode = GetSearchNode(apAINode->GetIndex());
+		if(pNode->mbClosed) return;
 
-		//TODO: Some pooling here would be good.
-		cAStarNode *pNode = hplNew( cAStarNode, (apAINode) );
+		float fCost = Cost(afDistance,apAINode,alParent) + Heuristic(apAINode->GetPosition(), mvGoal);
 
-		//Check if it is in closed list.
-		tAStarNodeSetIt it = m_setClosedList.find(pNode);
-		if(it != m_setClosedList.end()){
-			hplDelete(pNode);
-			return;
-		}
+		//Already open, only update if this way there is cheaper
+		if(pNode->mlHeapIdx >= 0)
+		{
+			if(fCost >= pNode->mfCost) return;
 
-		//Try to add it to the open list
-		std::pair<tAStarNodeSetIt, bool> testPair = m_setOpenList.insert(pNode);
-		if(testPair.second == false){
-			hplDelete(pNode);
+			pNode->mfDistance = afDistance;
+			pNode->mfCost = fCost;
+			pNode->mlParent = alParent;
+			HeapSiftUp(pNode->mlHeapIdx);
 			return;
 		}
 
 		pNode->mfDistance = afDistance;
-		pNode->mfCost = Cost(afDistance,apAINode,apParent) + Heuristic(pNode->mpAINode->GetPosition(), mvGoal);
-		pNode->mpParent = apParent;
+		pNode->mfCost = fCost;
+		pNode->mlParent = alParent;
+		HeapPush(apAINode->GetIndex());
 	}
 
 	//-----------------------------------------------------------------------
 
-	cAStarNode* cAStarHandler::GetBestNode()
+	int cAStarHandler::GetBestNode()
 	{
-		tAStarNodeSetIt it = m_setOpenList.begin();
-		tAStarNodeSetIt bestIt = it;
-		cAStarNode* pBestNode = *it; ++it;
-
-		//Iterate open list and find the best node.
-		for(; it != m_setOpenList.end(); ++it)
-		{
-			cAStarNode *pNode = *it;
-			if(pBestNode->mfCost > pNode->mfCost)
-			{
-				pBestNode = pNode;
-				bestIt = it;
-			}
-		}
-
-		//Remove node from open
-		m_setOpenList.erase(bestIt);
-
-		//Add to closed list
-		m_setClosedList.insert(pBestNode);
+		int lNode = HeapPop();
+		mvSearchNodes[lNode].mbClosed = true;
 
-		return pBestNode;
+		return lNode;
 	}
 
 	//-----------------------------------------------------------------------
 	
-	float cAStarHandler::Cost(float afDistance, cAINode *apAINode, cAStarNode *apParent)
+	float cAStarHandler::Cost(float afDistance, cAINode *apAINode, int alParent)
 	{
-		if(apParent)
+		if(alParent >= 0)
 		{
-			float fHeight = (1+fabs(apAINode->GetPosition().y - apParent->mpAINode->GetPosition().y));
+			float fHeight = (1+fabs(apAINode->GetPosition().y - mpContainer->GetNode(alParent)->GetPosition().y));
 			return afDistance * fHeight;
 		}
 		else
@@ -335,12 +398,102 @@ namespace hpl {
 
 	//-----------------------------------------------------------------------
 
-	bool cAStarHandler::IsGoalNode(cAINode *apAINode)
+	cAStarNode* cAStarHandler::GetSearchNode(int alIdx)
 	{
-		tAINodeSetIt it = m_setGoalNodes.find(apAINode);
-		if(it == m_setGoalNodes.end()) return false;
+		cAStarNode *pNode = &mvSearchNodes[alIdx];
+		if(pNode->mlGeneration != mlGeneration)
+		{
+			pNode->mlGeneration = mlGeneration;
+			pNode->mlHeapIdx = -1;
+			pNode->mlParent = -1;
+			pNode->mbClosed = false;
+		}
+		return pNode;
+	}
 
-		return true;
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// OPEN HEAP
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	void cAStarHandler::HeapPush(int alNode)
+	{
+		mvOpenHeap.push_back(alNode);
+		mvSearchNodes[alNode].mlHeapIdx = (int)mvOpenHeap.size()-1;
+		HeapSiftUp((int)mvOpenHeap.size()-1);
+	}
+
+	//-----------------------------------------------------------------------
+
+	int cAStarHandler::HeapPop()
+	{
+		int lTop = mvOpenHeap[0];
+		mvSearchNodes[lTop].mlHeapIdx = -1;
+
+		int lLast = mvOpenHeap.back();
+		mvOpenHeap.pop_back();
+		if(mvOpenHeap.empty()==false)
+		{
+			mvOpenHeap[0] = lLast;
+			mvSearchNodes[lLast].mlHeapIdx = 0;
+			HeapSiftDown(0);
+		}
+
+		return lTop;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cAStarHandler::HeapSiftUp(int alPos)
+	{
+		int lNode = mvOpenHeap[alPos];
+		float fCost = mvSearchNodes[lNode].mfCost;
+
+		while(alPos > 0)
+		{
+			int lParentPos = (alPos-1)/2;
+			int lParent = mvOpenHeap[lParentPos];
+			if(mvSearchNodes[lParent].mfCost <= fCost) break;
+
+			mvOpenHeap[alPos] = lParent;
+			mvSearchNodes[lParent].mlHeapIdx = alPos;
+			alPos = lParentPos;
+		}
+
+		mvOpenHeap[alPos] = lNode;
+		mvSearchNodes[lNode].mlHeapIdx = alPos;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cAStarHandler::HeapSiftDown(int alPos)
+	{
+		int lSize = (int)mvOpenHeap.size();
+		int lNode = mvOpenHeap[alPos];
+		float fCost = mvSearchNodes[lNode].mfCost;
+
+		while(true)
+		{
+			int lChildPos = alPos*2+1;
+			if(lChildPos >= lSize) break;
+
+			//Pick the cheapest child
+			if(lChildPos+1 < lSize && mvSearchNodes[mvOpenHeap[lChildPos+1]].mfCost < mvSearchNodes[mvOpenHeap[lChildPos]].mfCost)
+				++lChildPos;
+
+			int lChild = mvOpenHeap[lChildPos];
+			if(fCost <= mvSearchNodes[lChild].mfCost) break;
+
+			mvOpenHeap[alPos] = lChild;
+			mvSearchNodes[lChild].mlHeapIdx = alPos;
+			alPos = lChildPos;
+		}
+
+		mvOpenHeap[alPos] = lNode;
+		mvSearchNodes[lNode].mlHeapIdx = alPos;
 	}
 
 	//-----------------------------------------------------------------------
@@ -0,0 +1,237 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ai/AStarRequestQueue.h"
+
+#include "ai/AStar.h"
+
+namespace hpl {
+
+	//Smallest number of iterations a search is given when the budget is shared.
+	static const int kMinSliceIterations = 32;
+
+	//-----------------------------------------------------------------------
+
+	class cSortAStarRequestsByAge
+	{
+	public:
+		bool operator()(const cAStarRequest& aA, const cAStarRequest& aB) const
+		{
+			return aA.mlQueuedUpdate < aB.mlQueuedUpdate;
+		}
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+	// CONSTRUCTORS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	cAStarRequestQueue::cAStarRequestQueue()
+	{
+		mlMaxIterationsPerUpdate = 3000;
+		mlIterationsUsed = 0;
+		mlMaxWaitUpdates = 10;
+		mlUpdateCount = 0;
+	}
+
+	//-----------------------------------------------------------------------
+
+	cAStarRequestQueue::~cAStarRequestQueue()
+	{
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// PUBLIC METHODS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	void cAStarRequestQueue::AddRequest(cAStarHandler *apHandler, const cVector3f& avStart, const cVector3f& avGoal, iAStarRequestCallback *apCallback)
+	{
+		//Replace an earlier request, keeping its age so re-pathing often does not push it back.
+		for(tAStarRequestListIt it = mlstRequests.begin(); it != mlstRequests.end(); ++it)
+		{
+			if(it->mpHandler != apHandler) continue;
+
+			apHandler->CancelSearch();
+			it->mvStart = avStart;
+			it->mvGoal = avGoal;
+			it->mpCallback = apCallback;
+			it->mbStarted = false;
+			return;
+		}
+
+		cAStarRequest request;
+		request.mpHandler = apHandler;
+		request.mvStart = avStart;
+		request.mvGoal = avGoal;
+		request.mpCallback = apCallback;
+		request.mbStarted = false;
+		request.mlQueuedUpdate = mlUpdateCount;
+		mlstRequests.push_back(request);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cAStarRequestQueue::CancelRequest(cAStarHandler *apHandler)
+	{
+		for(tAStarRequestListIt it = mlstRequests.begin(); it != mlstRequests.end(); ++it)
+		{
+			if(it->mpHandler != apHandler) continue;
+
+			apHandler->CancelSearch();
+			mlstRequests.erase(it);
+			return;
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cAStarRequestQueue::HasRequest(cAStarHandler *apHandler)
+	{
+		for(tAStarRequestListIt it = mlstRequests.begin(); it != mlstRequests.end(); ++it)
+		{
+			if(it->mpHandler == apHandler) return true;
+		}
+		return false;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cAStarRequestQueue::Update()
+	{
+		mlIterationsUsed = 0;
+		++mlUpdateCount;
+
+		//The list sort is stable, so requests of the same age keep their order.
+		mlstRequests.sort(cSortAStarRequestsByAge());
+
+		RunAgedRequests();
+		RunRequests();
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cAStarRequestQueue::Reset()
+	{
+		for(tAStarRequestListIt it = mlstRequests.begin(); it != mlstRequests.end(); ++it)
+		{
+			it->mpHandler->CancelSearch();
+		}
+		mlstRequests.clear();
+		mlIterationsUsed = 0;
+		mlUpdateCount = 0;
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// PRIVATE METHODS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	void cAStarRequestQueue::RunRequests()
+	{
+		while(mlstRequests.empty()==false && HasBudgetLeft())
+		{
+			//////////////////////////////
+			// Give every request waiting at the start of the pass an equal share of the budget
+			int lRequestNum = (int)mlstRequests.size();
+			int lSlice = -1;
+			if(mlMaxIterationsPerUpdate >= 0)
+			{
+				lSlice = (mlMaxIterationsPerUpdate - mlIterationsUsed) / lRequestNum;
+				if(lSlice < kMinSliceIterations) lSlice = kMinSliceIterations;
+			}
+
+			for(int i=0; i<lRequestNum && mlstRequests.empty()==false && HasBudgetLeft(); ++i)
+			{
+				//Remove before running so callbacks can add and cancel requests freely.
+				cAStarRequest request = mlstRequests.front();
+				mlstRequests.pop_front();
+
+				if(RunRequest(request, lSlice)==false) mlstRequests.push_back(request);
+			}
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cAStarRequestQueue::RunAgedRequests()
+	{
+		if(mlMaxWaitUpdates < 0) return;
+
+		//Requests are sorted by age, so the aged ones are first.
+		while(mlstRequests.empty()==false && HasBudgetLeft())
+		{
+			if(mlUpdateCount - mlstRequests.front().mlQueuedUpdate <= mlMaxWaitUpdates) break;
+
+			cAStarRequest request = mlstRequests.front();
+			mlstRequests.pop_front();
+
+			int lSlice = -1;
+			if(mlMaxIterationsPerUpdate >= 0)
+			{
+				lSlice = mlMaxIterationsPerUpdate - mlIterationsUsed;
+				if(lSlice < kMinSliceIterations) lSlice = kMinSliceIterations;
+			}
+
+			//Not done means the budget is used up, continue with it first next update.
+			if(RunRequest(request, lSlice)==false)
+			{
+				mlstRequests.push_front(request);
+				break;
+			}
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cAStarRequestQueue::RunRequest(cAStarRequest &aRequest, int alMaxIterations)
+	{
+		cAStarHandler *pHandler = aRequest.mpHandler;
+		if(aRequest.mbStarted==false)
+		{
+			mlIterationsUsed += pHandler->StartSearch(aRequest.mvStart, aRequest.mvGoal);
+			aRequest.mbStarted = true;
+		}
+		mlIterationsUsed += pHandler->ContinueSearch(alMaxIterations);
+
+		eAStarSearchState state = pHandler->GetSearchState();
+		if(state == eAStarSearchState_Searching) return false;
+
+		if(aRequest.mpCallback)
+			aRequest.mpCallback->OnAStarRequestDone(pHandler, state == eAStarSearchState_Found);
+
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cAStarRequestQueue::HasBudgetLeft()
+	{
+		return mlMaxIterationsPerUpdate < 0 || mlIterationsUsed < mlMaxIterationsPerUpdate;
+	}
+
+	//-----------------------------------------------------------------------
+}
@@ -35,6 +35,7 @@
 #include "system/Platform.h"
 #include "system/Timer.h"
 #include "system/Mutex.h"
+#include "system/JobScheduler.h"
 
 #include "input/Input.h"
 #include "input/Mouse.h"
@@ -232,6 +233,9 @@ namespace hpl {
 		Log(" Creating system module\n");
 		mpSystem = mpGameSetup->CreateSystem();
 
+		Log(" Creating job scheduler\n");
+		mpJobScheduler = cPlatform::CreateJobScheduler(apVars->mGame.mlJobWorkerThreads);
+
 		Log(" Creating resource module\n");
 		mpResources = mpGameSetup->CreateResources(mpGraphics);
 
@@ -243,6 +247,8 @@ namespace hpl {
 
 		Log(" Creating physics module\n");
 		mpPhysics = mpGameSetup->CreatePhysics();
+		mpPhysics->SetJobScheduler(mpJobScheduler);
+		mpPhysics->SetNumberOfThreads(apVars->mGame.mlPhysicsThreads);
 
 		Log(" Creating ai module\n");
 		mpAI = mpGameSetup->CreateAI();
@@ -263,6 +269,7 @@ namespace hpl {
 
 		Log(" Creating scene module\n");
 		mpScene = mpGameSetup->CreateScene(mpGraphics, mpResources, mpSound,mpPhysics,mpSystem,mpAI,mpGui,mpHaptic);
+		mpScene->SetJobScheduler(mpJobScheduler);
 
 		Log("--------------------------------------------------------\n\n");
 
@@ -384,6 +391,8 @@ namespace hpl {
 		hplDelete(mpPhysics);
 		hplDelete(mpAI);
 		hplDelete(mpSystem);
+
+		hplDelete(mpJobScheduler);
 		
 		Log(" Deleting game setup provided by user\n");
 		hplDelete(mpGameSetup);
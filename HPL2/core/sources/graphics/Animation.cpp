@@ -34,6 +34,7 @@ namespace hpl {
 	{
 		msAnimName = "";
 		msFileName = asFile;
+		mbKeyFramesReduced = false;
 	}
 
 	//-----------------------------------------------------------------------
@@ -122,6 +123,17 @@ namespace hpl {
 
 	//-----------------------------------------------------------------------
 
+	void cAnimation::ReduceKeyFrames(float afMaxTransError, float afMaxRotError)
+	{
+		for(size_t i=0; i< mvTracks.size(); ++i)
+		{
+			mvTracks[i]->ReduceKeyFrames(afMaxTransError, afMaxRotError);
+		}
+		mbKeyFramesReduced = true;
+	}
+
+	//-----------------------------------------------------------------------
+
 
 	//////////////////////////////////////////////////////////////////////////
 	// PRIVATE METHODS
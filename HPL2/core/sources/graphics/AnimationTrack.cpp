@@ -24,8 +24,29 @@
 #include "system/LowLevelSystem.h"
 #include "scene/Node3D.h"
 
+#include <algorithm>
+
 namespace hpl {
 
+	//////////////////////////////////////////////////////////////////////////
+	// STATIC HELPERS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	static cQuaternion InterpolateRotation(float afT, cQuaternion aqA, cQuaternion aqB)
+	{
+		aqA.Normalize();
+		aqB.Normalize();
+
+		if(aqA.w < 0) aqA = aqA * -1.0f;
+		if(aqB.w < 0) aqB = aqB * -1.0f;
+
+		return cMath::QuaternionSlerp(afT, aqA, aqB, true);
+	}
+
+	//-----------------------------------------------------------------------
+
 	//////////////////////////////////////////////////////////////////////////
 	// CONSTRUCTORS
 	//////////////////////////////////////////////////////////////////////////
@@ -48,7 +69,6 @@ namespace hpl {
 
 	cAnimationTrack::~cAnimationTrack()
 	{
-		STLDeleteAll(mvKeyFrames);
 	}
 
 	//-----------------------------------------------------------------------
@@ -61,53 +81,62 @@ namespace hpl {
 	
 	void cAnimationTrack::ResizeKeyFrames(int alSize)
 	{
-		mvKeyFrames.reserve(alSize);
+		mvKeyTimes.reserve(alSize);
+		mvKeyTranslations.reserve(alSize);
+		mvKeyRotations.reserve(alSize);
 	}
 	
 	//-----------------------------------------------------------------------
 
-	cKeyFrame* cAnimationTrack::CreateKeyFrame(float afTime)
+	int cAnimationTrack::CreateKeyFrame(float afTime)
 	{
-		cKeyFrame* pFrame = hplNew( cKeyFrame,());
-		pFrame->time = afTime;
+		int lIdx = (int)mvKeyTimes.size();
 
 		//Check so that this is the first
-        if(afTime > mfMaxFrameTime || mvKeyFrames.empty())
+        if(afTime > mfMaxFrameTime || mvKeyTimes.empty())
 		{
-			mvKeyFrames.push_back(pFrame);
 			mfMaxFrameTime = afTime;
 		}
 		else
 		{
-			tKeyFramePtrVecIt it = mvKeyFrames.begin();
-			for(; it != mvKeyFrames.end(); it++)
-			{
-				if(afTime < (*it)->time)
-				{
-					break;
-				}
-			}
-			mvKeyFrames.insert(it,pFrame);
+			lIdx = (int)(std::upper_bound(mvKeyTimes.begin(), mvKeyTimes.end(), afTime) - mvKeyTimes.begin());
 		}
+
+		mvKeyTimes.insert(mvKeyTimes.begin()+lIdx, afTime);
+		mvKeyTranslations.insert(mvKeyTranslations.begin()+lIdx, cVector3f(0));
+		mvKeyRotations.insert(mvKeyRotations.begin()+lIdx, cQuaternion::Identity);
 		
-        return pFrame;
+        return lIdx;
 	}
 
 	//-----------------------------------------------------------------------
 
 	void cAnimationTrack::ClearKeyFrames()
 	{
-		STLDeleteAll(mvKeyFrames);
-		mvKeyFrames.clear();
+		mvKeyTimes.clear();
+		mvKeyTranslations.clear();
+		mvKeyRotations.clear();
+		mfMaxFrameTime = 0;
+	}
+
+	//-----------------------------------------------------------------------
+
+	cKeyFrame cAnimationTrack::GetKeyFrame(int alIndex)
+	{
+		cKeyFrame frame;
+		frame.time = mvKeyTimes[alIndex];
+		frame.trans = mvKeyTranslations[alIndex];
+		frame.rotation = mvKeyRotations[alIndex];
+		return frame;
 	}
 
 	//-----------------------------------------------------------------------
 
-	void cAnimationTrack::ApplyToNode(cNode3D* apNode, float afTime, float afWeight, bool bLoop)
+	void cAnimationTrack::ApplyToNode(cNode3D* apNode, float afTime, float afWeight, bool bLoop, int *apKeyCursor)
 	{
-		if(mvKeyFrames.empty()) return;
+		if(mvKeyTimes.empty()) return;
 
-		cKeyFrame Frame = GetInterpolatedKeyFrame(afTime);
+		cKeyFrame Frame = GetInterpolatedKeyFrame(afTime, true, apKeyCursor);
         		
 		//Scale
 		//Skip this for now...
@@ -126,28 +155,28 @@ namespace hpl {
 
 	//-----------------------------------------------------------------------
 
-	cKeyFrame cAnimationTrack::GetInterpolatedKeyFrame(float afTime, bool bLoop)
+	cKeyFrame cAnimationTrack::GetInterpolatedKeyFrame(float afTime, bool bLoop, int *apKeyCursor)
 	{
 		cKeyFrame ResultKeyFrame;
 		ResultKeyFrame.time = afTime;
 
-		if(mvKeyFrames.empty())
+		if(mvKeyTimes.empty())
 		{
 			ResultKeyFrame.rotation = cQuaternion(1,0,0,0);
 			ResultKeyFrame.trans = 0;
 			return ResultKeyFrame;
 		}
 
-		cKeyFrame *pKeyFrameA = NULL;
-		cKeyFrame *pKeyFrameB = NULL;
+		int lIdxA = 0;
+		int lIdxB = 0;
 		
-		float fT = GetKeyFramesAtTime(afTime, &pKeyFrameA, &pKeyFrameB, bLoop);
+		float fT = GetKeyFramesAtTime(afTime, &lIdxA, &lIdxB, bLoop, apKeyCursor);
 
 		
         if(fT == 0.0f)
 		{
-			ResultKeyFrame.rotation = pKeyFrameA->rotation;
-			ResultKeyFrame.trans = pKeyFrameA->trans;
+			ResultKeyFrame.rotation = mvKeyRotations[lIdxA];
+			ResultKeyFrame.trans = mvKeyTranslations[lIdxA];
 		}
 		else
 		{	
@@ -155,8 +184,8 @@ namespace hpl {
 			//This should include spline stuff later on.
 
             
-			cQuaternion rotA = pKeyFrameA->rotation;
-			cQuaternion rotB = pKeyFrameB->rotation;
+			cQuaternion rotA = mvKeyRotations[lIdxA];
+			cQuaternion rotB = mvKeyRotations[lIdxB];
             /*
             if ( rotA.v.x == -1 * rotB.v.x
                 && rotA.v.y == -1 * rotB.v.y 
@@ -171,29 +200,14 @@ namespace hpl {
 													rotB, true);
             }*/
 
-            rotA.Normalize();
-            rotB.Normalize();
-
-			if ( rotA.w < 0 )
-            {
-                rotA = rotA * -1.0f;
-            }
-			
-            if ( rotB.w < 0 )
-            {
-                rotB = rotB * -1.0f;
-            }
-
-
-            ResultKeyFrame.rotation = cMath::QuaternionSlerp(fT, rotA, 
-													rotB, true);
+            ResultKeyFrame.rotation = InterpolateRotation(fT, rotA, rotB);
 
             /*
 
             ResultKeyFrame.rotation = cMath::QuaternionSlerp(fT, pKeyFrameA->rotation, 
 													pKeyFrameB->rotation, true);
                                                     */
-			ResultKeyFrame.trans = pKeyFrameA->trans * (1 - fT) + pKeyFrameB->trans * fT;
+			ResultKeyFrame.trans = mvKeyTranslations[lIdxA] * (1 - fT) + mvKeyTranslations[lIdxB] * fT;
 		}
 
 		return ResultKeyFrame;
@@ -201,7 +215,7 @@ namespace hpl {
 
 	//-----------------------------------------------------------------------
 	
-	float cAnimationTrack::GetKeyFramesAtTime(float afTime, cKeyFrame** apKeyFrameA,cKeyFrame** apKeyFrameB, bool bLoop)
+	float cAnimationTrack::GetKeyFramesAtTime(float afTime, int *apIdxA, int *apIdxB, bool bLoop, int *apKeyCursor)
 	{
 		float fTotalAnimLength = mpParent->GetLength();
 
@@ -214,54 +228,37 @@ namespace hpl {
 		//If longer than max time return last frame and first
 		if(afTime >= mfMaxFrameTime)
 		{
-			*apKeyFrameA = mvKeyFrames[mvKeyFrames.size()-1];
-			*apKeyFrameB = mvKeyFrames[0];
-			
-			//Get T between end to start again. (the last frame doesn't mean the anim is over. 
-			// In that case wrap to the first frame).
-			float fDeltaT = fTotalAnimLength - (*apKeyFrameA)->time;
+			*apIdxA = (int)mvKeyTimes.size()-1;
+			*apIdxB = 0;
 			
 			//If animation time is >= max time might as well just return the last frame.
 			//Not sure if this is good for some looping anims, in that case check the code.
-			return 0.0f;//(afTime - (*apKeyFrameA)->time) / fDeltaT;
+			return 0.0f;
 		}
 
-		//Get the number of frames
-		const int lSize = (int)mvKeyFrames.size();
-
 		//Find the second frame.
-		int lIdxB=-1;
-		for(int i=0; i< lSize; i++)
-		{
-			if(afTime <= mvKeyFrames[i]->time)
-			{
-				lIdxB = i;
-				break;
-			}
-		}
+		int lIdxB = FindKeyFrameAfter(afTime, apKeyCursor);
 		
 		//If first frame was found, the lowest time is not 0. 
 		//If so return the first frame only.
 		if(lIdxB == 0)
 		{
-			*apKeyFrameA = mvKeyFrames[0];
-			*apKeyFrameB = mvKeyFrames[0];
+			*apIdxA = 0;
+			*apIdxB = 0;
 			return 0.0f;
 		}
 		
 		//Get the frames
-		*apKeyFrameA = mvKeyFrames[lIdxB-1];
-		*apKeyFrameB = mvKeyFrames[lIdxB];
+		*apIdxA = lIdxB-1;
+		*apIdxB = lIdxB;
         
-		float fDeltaT = (*apKeyFrameB)->time - (*apKeyFrameA)->time;
+		float fDeltaT = mvKeyTimes[lIdxB] - mvKeyTimes[lIdxB-1];
         
-		return (afTime - (*apKeyFrameA)->time) / fDeltaT;
+		return (afTime - mvKeyTimes[lIdxB-1]) / fDeltaT;
 	}
 
 	//-----------------------------------------------------------------------
 
-
-
 	void cAnimationTrack::Smooth(float afAmount,float afPow,  int alSamples, bool abTranslation, bool abRotation)
 	{
 		/*/////////////////////////////////
@@ -345,6 +342,75 @@ namespace hpl {
 
 	//-----------------------------------------------------------------------
 
+	void cAnimationTrack::GetReducedKeyFrames(tIntVec *apKeptFrames, float afMaxTransError, float afMaxRotError)
+	{
+		apKeptFrames->clear();
+
+		const int lSize = (int)mvKeyTimes.size();
+		if(lSize==0) return;
+
+		////////////////////////////////
+		// Grow each span for as long as all frames inside it can be interpolated from its end frames.
+		int lAnchor = 0;
+		apKeptFrames->push_back(0);
+		for(int lEnd = 2; lEnd < lSize; ++lEnd)
+		{
+			bool bSpanOk = true;
+			for(int i=lAnchor+1; i<lEnd; ++i)
+			{
+				if(KeyFrameIsInterpolated(i, lAnchor, lEnd, afMaxTransError, afMaxRotError)==false)
+				{
+					bSpanOk = false;
+					break;
+				}
+			}
+			if(bSpanOk) continue;
+
+			lAnchor = lEnd-1;
+			apKeptFrames->push_back(lAnchor);
+		}
+		if(lSize > 1) apKeptFrames->push_back(lSize-1);
+
+		////////////////////////////////
+		// Constant track, a single frame is enough.
+		if(apKeptFrames->size()==2)
+		{
+			float fRotDot = cMath::Abs(cMath::QuaternionDot(mvKeyRotations[0], mvKeyRotations[lSize-1]));
+			float fRotAngle = 2.0f * acosf(cMath::Min(fRotDot, 1.0f));
+			float fTransDist = cMath::Vector3Dist(mvKeyTranslations[0], mvKeyTranslations[lSize-1]);
+
+			if(fTransDist <= afMaxTransError && fRotAngle <= afMaxRotError)
+				apKeptFrames->pop_back();
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	int cAnimationTrack::ReduceKeyFrames(float afMaxTransError, float afMaxRotError)
+	{
+		tIntVec vKeptFrames;
+		GetReducedKeyFrames(&vKeptFrames, afMaxTransError, afMaxRotError);
+
+		int lRemoved = (int)(mvKeyTimes.size() - vKeptFrames.size());
+		if(lRemoved==0) return 0;
+
+		for(size_t i=0; i<vKeptFrames.size(); ++i)
+		{
+			int lSrc = vKeptFrames[i];
+			mvKeyTimes[i] = mvKeyTimes[lSrc];
+			mvKeyTranslations[i] = mvKeyTranslations[lSrc];
+			mvKeyRotations[i] = mvKeyRotations[lSrc];
+		}
+		mvKeyTimes.resize(vKeptFrames.size());
+		mvKeyTranslations.resize(vKeptFrames.size());
+		mvKeyRotations.resize(vKeptFrames.size());
+
+		mfMaxFrameTime = mvKeyTimes.empty() ? 0 : mvKeyTimes.back();
+
+		return lRemoved;
+	}
+
+	//-----------------------------------------------------------------------
 
 	//////////////////////////////////////////////////////////////////////////
 	// PRIVATE METHODS
@@ -352,5 +418,51 @@ namespace hpl {
 
 	//-----------------------------------------------------------------------
 
+	/**
+	 * Returns the first frame with time >= afTime. The cursor is checked first, and then the frame after it,
+	 * so normal playback never needs the binary search.
+	 */
+	int cAnimationTrack::FindKeyFrameAfter(float afTime, int *apKeyCursor)
+	{
+		const int lSize = (int)mvKeyTimes.size();
+
+		if(apKeyCursor)
+		{
+			int lCursor = *apKeyCursor;
+			if(lCursor >= 0 && lCursor < lSize && afTime <= mvKeyTimes[lCursor])
+			{
+				if(lCursor==0 || afTime > mvKeyTimes[lCursor-1]) return lCursor;
+			}
+			else if(lCursor >= 0 && lCursor+1 < lSize && afTime > mvKeyTimes[lCursor] && afTime <= mvKeyTimes[lCursor+1])
+			{
+				*apKeyCursor = lCursor+1;
+				return lCursor+1;
+			}
+		}
+
+		int lIdx = (int)(std::lower_bound(mvKeyTimes.begin(), mvKeyTimes.end(), afTime) - mvKeyTimes.begin());
+		if(apKeyCursor) *apKeyCursor = lIdx;
+
+		return lIdx;
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cAnimationTrack::KeyFrameIsInterpolated(int alIdx, int alIdxA, int alIdxB, float afMaxTransError, float afMaxRotError)
+	{
+		float fDeltaT = mvKeyTimes[alIdxB] - mvKeyTimes[alIdxA];
+		float fT = fDeltaT > 0 ? (mvKeyTimes[alIdx] - mvKeyTimes[alIdxA]) / fDeltaT : 0.0f;
+
+		cVector3f vTrans = mvKeyTranslations[alIdxA] * (1 - fT) + mvKeyTranslations[alIdxB] * fT;
+		if(cMath::Vector3Dist(vTrans, mvKeyTranslations[alIdx]) > afMaxTransError) return false;
+
+		cQuaternion qRot = InterpolateRotation(fT, mvKeyRotations[alIdxA], mvKeyRotations[alIdxB]);
+		cQuaternion qReal = mvKeyRotations[alIdx];
+		qReal.Normalize();
+
+		float fRotDot = cMath::Abs(cMath::QuaternionDot(qRot, qReal));
+		return 2.0f * acosf(cMath::Min(fRotDot, 1.0f)) <= afMaxRotError;
+	}
+
 	//-----------------------------------------------------------------------
 }
\ No newline at end of file
@@ -24,6 +24,8 @@
 
 namespace hpl{
 
+	cSortIdPool iGpuProgram::mSortIdPool;
+
 	//////////////////////////////////////////////////////////////////////////
 	// CONSTRUCTORS
 	//////////////////////////////////////////////////////////////////////////
@@ -43,10 +45,14 @@ namespace hpl{
 		for(int i=0; i<2; ++i) mpShader[i] = NULL;
 
 		mlUserId = 0;
+
+		mlSortId = mSortIdPool.Get();
 	}
 
 	iGpuProgram::~iGpuProgram()
 	{
+		mSortIdPool.Release(mlSortId);
+
 		if(mbAutoDestroyShaders && mpResources)
 		{
 			for(int i=0; i<2; ++i) 
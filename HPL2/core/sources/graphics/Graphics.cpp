@@ -36,6 +36,7 @@
 #include "graphics/MaterialType.h"
 #include "graphics/Texture.h"
 #include "graphics/GPUProgram.h"
+#include "graphics/Skinning.h"
 
 #include "resources/LowLevelResources.h"
 #include "resources/Resources.h"
@@ -134,6 +135,8 @@ namespace hpl {
 		
 		mpResources = apResources;
 
+		Log(" CPU skinning kernel: %s\n", cSkinning::GetKernelName(cSkinning::GetKernel()));
+
 		////////////////////////////////////////////////
 		//Setup the graphic directories:
 		apResources->AddResourceDir(_W("core/shaders"),false);
@@ -270,4 +270,39 @@ namespace hpl {
 	
 	//-----------------------------------------------------------------------
 
+	//////////////////////////////////////////////////////////////////////////
+	// SORT ID POOL
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	cSortIdPool::cSortIdPool()
+	{
+		mlNextId = 1;
+	}
+
+	//-----------------------------------------------------------------------
+
+	int cSortIdPool::Get()
+	{
+		if(mvFreeIds.empty()) return mlNextId++;
+
+		int lId = mvFreeIds.back();
+		mvFreeIds.pop_back();
+		return lId;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cSortIdPool::Release(int alId)
+	{
+		mvFreeIds.push_back(alId);
+	}
+
+	//-----------------------------------------------------------------------
+
+	cSortIdPool iTexture::mSortIdPool;
+
+	//-----------------------------------------------------------------------
+
 }
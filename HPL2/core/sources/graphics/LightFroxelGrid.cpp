@@ -0,0 +1,351 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "graphics/LightFroxelGrid.h"
+
+#include "math/Math.h"
+
+#include "system/JobScheduler.h"
+
+#include <cmath>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+	#define HPL_LIGHT_FROXEL_SSE
+	#include <xmmintrin.h>
+#endif
+
+namespace hpl {
+
+	//////////////////////////////////////////////////////////////////////////
+	// JOBS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	class cLightFroxelBinFunc : public iJobRangeFunc
+	{
+	public:
+		void RunJobRange(int alStart, int alEnd, int alThreadSlot)
+		{
+			//Each slice only writes to its own froxels.
+			mpGrid->BinSlices(alStart, alEnd);
+		}
+
+		cLightFroxelGrid *mpGrid;
+	};
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// CONSTRUCTORS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	cLightFroxelGrid::cLightFroxelGrid()
+	{
+		mvGridSize = cVector3l(0,0,0);
+		mlPaddedSizeX =0;
+		mfNearPlane = 0.1f;
+		mfFarPlane = 100.0f;
+		mfTanHalfFovX =1;
+		mfTanHalfFovY =1;
+		mfSliceScale =0;
+		mfSliceBias =0;
+		mlMaxLightsPerFroxel = 32;
+		mlOverflowNum =0;
+	}
+
+	//-----------------------------------------------------------------------
+
+	cLightFroxelGrid::~cLightFroxelGrid()
+	{
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// PUBLIC METHODS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	void cLightFroxelGrid::Setup(float afFOV, float afAspect, float afNearPlane, float afFarPlane, const cVector3l& avGridSize)
+	{
+		mvGridSize = avGridSize;
+		mlPaddedSizeX = (mvGridSize.x + 3) & ~3;
+
+		mfNearPlane = afNearPlane;
+		mfFarPlane = afFarPlane;
+		mfTanHalfFovY = tan(afFOV*0.5f);
+		mfTanHalfFovX = mfTanHalfFovY * afAspect;
+
+		float fLogFarDivNear = log(mfFarPlane / mfNearPlane);
+		mfSliceScale = (float)mvGridSize.z / fLogFarDivNear;
+		mfSliceBias = -(float)mvGridSize.z * log(mfNearPlane) / fLogFarDivNear;
+
+		////////////////////////////
+		// Set up froxel boxes
+		int lPaddedNum = mlPaddedSizeX * mvGridSize.y * mvGridSize.z;
+		for(int i=0; i<3; ++i)
+		{
+			mvFroxelMin[i].assign(lPaddedNum, 1e30f);
+			mvFroxelMax[i].assign(lPaddedNum, -1e30f);
+		}
+
+		for(int z=0; z<mvGridSize.z; ++z)
+		{
+			float fDepth0 = mfNearPlane * pow(mfFarPlane / mfNearPlane, (float)z / (float)mvGridSize.z);
+			float fDepth1 = mfNearPlane * pow(mfFarPlane / mfNearPlane, (float)(z+1) / (float)mvGridSize.z);
+			
+			for(int y=0; y<mvGridSize.y; ++y)
+			{
+				float fNdcY0 = -1.0f + 2.0f*(float)y / (float)mvGridSize.y;
+				float fNdcY1 = -1.0f + 2.0f*(float)(y+1) / (float)mvGridSize.y;
+
+				for(int x=0; x<mvGridSize.x; ++x)
+				{
+					float fNdcX0 = -1.0f + 2.0f*(float)x / (float)mvGridSize.x;
+					float fNdcX1 = -1.0f + 2.0f*(float)(x+1) / (float)mvGridSize.x;
+
+					int lIdx = (z*mvGridSize.y + y)*mlPaddedSizeX + x;
+
+					mvFroxelMin[0][lIdx] = cMath::Min(fNdcX0*fDepth0, fNdcX0*fDepth1) * mfTanHalfFovX;
+					mvFroxelMax[0][lIdx] = cMath::Max(fNdcX1*fDepth0, fNdcX1*fDepth1) * mfTanHalfFovX;
+					mvFroxelMin[1][lIdx] = cMath::Min(fNdcY0*fDepth0, fNdcY0*fDepth1) * mfTanHalfFovY;
+					mvFroxelMax[1][lIdx] = cMath::Max(fNdcY1*fDepth0, fNdcY1*fDepth1) * mfTanHalfFovY;
+					mvFroxelMin[2][lIdx] = -fDepth1;
+					mvFroxelMax[2][lIdx] = -fDepth0;
+				}
+			}
+		}
+
+		////////////////////////////
+		// Light lists
+		mvFroxelLightCount.assign(GetFroxelNum(), 0);
+		mvFroxelLights.resize(GetFroxelNum() * mlMaxLightsPerFroxel);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cLightFroxelGrid::SetMaxLightsPerFroxel(int alX)
+	{
+		mlMaxLightsPerFroxel = cMath::Max(alX, 1);
+		mvFroxelLights.resize(GetFroxelNum() * mlMaxLightsPerFroxel);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cLightFroxelGrid::ClearLights()
+	{
+		for(int i=0; i<3; ++i) mvLightPos[i].resize(0);
+		mvLightRadius.resize(0);
+	}
+
+	//-----------------------------------------------------------------------
+
+	int cLightFroxelGrid::AddLight(const cVector3f& avViewPos, float afRadius)
+	{
+		//Indices are stored as unsigned short
+		if(GetLightNum() >= 0xFFFF) return -1;
+
+		for(int i=0; i<3; ++i) mvLightPos[i].push_back(avViewPos.v[i]);
+		mvLightRadius.push_back(afRadius);
+
+		return GetLightNum()-1;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cLightFroxelGrid::Bin(cJobScheduler *apJobScheduler)
+	{
+		int lLightNum = GetLightNum();
+
+		////////////////////////////
+		// Get the froxel range of each light
+		mvLightRanges.resize(lLightNum);
+		mvLightVisible.resize(lLightNum);
+		for(int i=0; i<lLightNum; ++i)
+		{
+			mvLightVisible[i] = GetLightRange(i, mvLightRanges[i]) ? 1 : 0;
+		}
+
+		////////////////////////////
+		// Bin per slice
+		mvFroxelLightCount.assign(GetFroxelNum(), 0);
+		mvSliceOverflowNum.assign(mvGridSize.z, 0);
+
+		if(lLightNum > 0)
+		{
+			cLightFroxelBinFunc binFunc;
+			binFunc.mpGrid = this;
+
+			if(apJobScheduler && apJobScheduler->GetWorkerNum()>0 && mvGridSize.z > 1)
+				apJobScheduler->ParallelFor(0, mvGridSize.z, 1, &binFunc);
+			else
+				binFunc.RunJobRange(0, mvGridSize.z, -1);
+		}
+
+		mlOverflowNum =0;
+		for(size_t i=0; i<mvSliceOverflowNum.size(); ++i) mlOverflowNum += mvSliceOverflowNum[i];
+	}
+
+	//-----------------------------------------------------------------------
+
+	int cLightFroxelGrid::GetSlice(float afDepth)
+	{
+		if(afDepth <= mfNearPlane) return 0;
+
+		int lSlice = (int)floor(log(afDepth)*mfSliceScale + mfSliceBias);
+		return cMath::Min(cMath::Max(lSlice, 0), mvGridSize.z-1);
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cLightFroxelGrid::GetLightRange(int alLight, cLightFroxelRange& aRange)
+	{
+		float fX = mvLightPos[0][alLight];
+		float fY = mvLightPos[1][alLight];
+		float fDepth = -mvLightPos[2][alLight];
+		float fRadius = mvLightRadius[alLight];
+
+		////////////////////////////
+		// Depth
+		float fMinDepth = fDepth - fRadius;
+		float fMaxDepth = fDepth + fRadius;
+		if(fMaxDepth < mfNearPlane || fMinDepth > mfFarPlane) return false;
+
+		fMinDepth = cMath::Max(fMinDepth, mfNearPlane);
+		fMaxDepth = cMath::Min(fMaxDepth, mfFarPlane);
+
+		aRange.mlMinZ = GetSlice(fMinDepth);
+		aRange.mlMaxZ = GetSlice(fMaxDepth);
+
+		////////////////////////////
+		// Screen, the extremes of the bounding box projection are at the min and max depth.
+		float fInvMinX = 1.0f / (fMinDepth * mfTanHalfFovX);
+		float fInvMaxX = 1.0f / (fMaxDepth * mfTanHalfFovX);
+		float fInvMinY = 1.0f / (fMinDepth * mfTanHalfFovY);
+		float fInvMaxY = 1.0f / (fMaxDepth * mfTanHalfFovY);
+
+		float fMinNdcX = cMath::Min((fX - fRadius)*fInvMinX, (fX - fRadius)*fInvMaxX);
+		float fMaxNdcX = cMath::Max((fX + fRadius)*fInvMinX, (fX + fRadius)*fInvMaxX);
+		float fMinNdcY = cMath::Min((fY - fRadius)*fInvMinY, (fY - fRadius)*fInvMaxY);
+		float fMaxNdcY = cMath::Max((fY + fRadius)*fInvMinY, (fY + fRadius)*fInvMaxY);
+
+		if(fMaxNdcX < -1 || fMinNdcX > 1 || fMaxNdcY < -1 || fMinNdcY > 1) return false;
+
+		aRange.mlMinX = cMath::Min(cMath::Max((int)floor((fMinNdcX+1)*0.5f*(float)mvGridSize.x), 0), mvGridSize.x-1);
+		aRange.mlMaxX = cMath::Min(cMath::Max((int)floor((fMaxNdcX+1)*0.5f*(float)mvGridSize.x), 0), mvGridSize.x-1);
+		aRange.mlMinY = cMath::Min(cMath::Max((int)floor((fMinNdcY+1)*0.5f*(float)mvGridSize.y), 0), mvGridSize.y-1);
+		aRange.mlMaxY = cMath::Min(cMath::Max((int)floor((fMaxNdcY+1)*0.5f*(float)mvGridSize.y), 0), mvGridSize.y-1);
+
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// PRIVATE METHODS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	void cLightFroxelGrid::BinSlices(int alStart, int alEnd)
+	{
+		int lLightNum = GetLightNum();
+
+		for(int z=alStart; z<alEnd; ++z)
+		{
+			for(int lLight=0; lLight<lLightNum; ++lLight)
+			{
+				if(mvLightVisible[lLight]==0) continue;
+
+				const cLightFroxelRange& range = mvLightRanges[lLight];
+				if(z < range.mlMinZ || z > range.mlMaxZ) continue;
+
+				float fX = mvLightPos[0][lLight];
+				float fY = mvLightPos[1][lLight];
+				float fZ = mvLightPos[2][lLight];
+				float fRadiusSqr = mvLightRadius[lLight]*mvLightRadius[lLight];
+
+			#ifdef HPL_LIGHT_FROXEL_SSE
+				__m128 vX = _mm_set1_ps(fX);
+				__m128 vY = _mm_set1_ps(fY);
+				__m128 vZ = _mm_set1_ps(fZ);
+				__m128 vRadiusSqr = _mm_set1_ps(fRadiusSqr);
+			#endif
+				
+				for(int y=range.mlMinY; y<=range.mlMaxY; ++y)
+				{
+					int lRowStart = (z*mvGridSize.y + y)*mlPaddedSizeX;
+
+					//Test four froxels at a time, rows are padded with boxes that never intersect.
+					for(int x=range.mlMinX & ~3; x<=range.mlMaxX; x+=4)
+					{
+						int lIdx = lRowStart + x;
+						int lMask =0;
+
+					#ifdef HPL_LIGHT_FROXEL_SSE
+						//Distance from sphere center to closest point in box
+						__m128 vDX = _mm_sub_ps(vX, _mm_max_ps(_mm_loadu_ps(&mvFroxelMin[0][lIdx]), _mm_min_ps(vX, _mm_loadu_ps(&mvFroxelMax[0][lIdx]))));
+						__m128 vDY = _mm_sub_ps(vY, _mm_max_ps(_mm_loadu_ps(&mvFroxelMin[1][lIdx]), _mm_min_ps(vY, _mm_loadu_ps(&mvFroxelMax[1][lIdx]))));
+						__m128 vDZ = _mm_sub_ps(vZ, _mm_max_ps(_mm_loadu_ps(&mvFroxelMin[2][lIdx]), _mm_min_ps(vZ, _mm_loadu_ps(&mvFroxelMax[2][lIdx]))));
+						
+						__m128 vDistSqr = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vDX,vDX), _mm_mul_ps(vDY,vDY)), _mm_mul_ps(vDZ,vDZ));
+						lMask = _mm_movemask_ps(_mm_cmple_ps(vDistSqr, vRadiusSqr));
+					#else
+						for(int i=0; i<4; ++i)
+						{
+							float fDX = fX - cMath::Max(mvFroxelMin[0][lIdx+i], cMath::Min(fX, mvFroxelMax[0][lIdx+i]));
+							float fDY = fY - cMath::Max(mvFroxelMin[1][lIdx+i], cMath::Min(fY, mvFroxelMax[1][lIdx+i]));
+							float fDZ = fZ - cMath::Max(mvFroxelMin[2][lIdx+i], cMath::Min(fZ, mvFroxelMax[2][lIdx+i]));
+							if(fDX*fDX + fDY*fDY + fDZ*fDZ <= fRadiusSqr) lMask |= 1<<i;
+						}
+					#endif
+
+						if(lMask==0) continue;
+						for(int i=0; i<4; ++i)
+						{
+							if((lMask & (1<<i)) && x+i < mvGridSize.x)
+								AddLightToFroxel(lLight, GetFroxelIndex(x+i, y, z), z);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cLightFroxelGrid::AddLightToFroxel(int alLight, int alFroxel, int alSlice)
+	{
+		int &lCount = mvFroxelLightCount[alFroxel];
+		if(lCount >= mlMaxLightsPerFroxel)
+		{
+			++mvSliceOverflowNum[alSlice];
+			return;
+		}
+
+		mvFroxelLights[alFroxel*mlMaxLightsPerFroxel + lCount] = (unsigned short)alLight;
+		++lCount;
+	}
+
+	//-----------------------------------------------------------------------
+}
@@ -101,6 +101,12 @@ namespace hpl {
 		{
 			mvTextureInUnit[i][j] = NULL;
 		}
+		for(int i=0; i<eMaterialRenderMode_LastEnum;++i)
+		{
+			mvInstancedPrograms[i] = NULL;
+			mvProgramSortIds[i] = 0;
+			mvTextureSetSortIds[i] = 0;
+		}
 		
 
 		///////////////////////
@@ -135,6 +141,10 @@ namespace hpl {
 					mpType->DestroyProgram(this, (eMaterialRenderMode)i,mvPrograms[j][i], j);
 				}
 			}
+			for(int i=0;i<eMaterialRenderMode_LastEnum; ++i) 
+			{
+				if(mvInstancedPrograms[i]) mpType->DestroyProgram(this, (eMaterialRenderMode)i,mvInstancedPrograms[i], 0);
+			}
 		}
 
 		////////////////////////
@@ -189,6 +199,13 @@ namespace hpl {
 			//Destroy any previous program (this is so recompilations work with program count!)
 			if(pPrevProg) mpType->DestroyProgram(this, (eMaterialRenderMode)i,pPrevProg, j);
 		}
+		for(int i=0;i<eMaterialRenderMode_LastEnum; ++i) 
+		{
+			iGpuProgram *pPrevProg = mvInstancedPrograms[i];
+			mvInstancedPrograms[i] = mpType->GetInstancedGpuProgram(this, (eMaterialRenderMode)i);
+
+			if(pPrevProg) mpType->DestroyProgram(this, (eMaterialRenderMode)i,pPrevProg, 0);
+		}
 
 		///////////////////
 		// Compile texture lookup
@@ -197,6 +214,23 @@ namespace hpl {
 			{
 				mvTextureInUnit[i][j] = mpType->GetTextureForUnit(this, (eMaterialRenderMode)i, j);
 			}
+
+		///////////////////
+		// Sort ids
+		for(int i=0;i<eMaterialRenderMode_LastEnum; ++i) 
+		{
+			iGpuProgram *pProgram = mvPrograms[0][i];
+			mvProgramSortIds[i] = pProgram ? pProgram->GetSortId() : 0;
+
+			mvTextureSetSortIds[i] = 0;
+			for(int j=0; j<kMaxTextureUnits; ++j)
+			{
+				if(mvTextureInUnit[i][j]==NULL) continue;
+				
+				mvTextureSetSortIds[i] = mvTextureInUnit[i][j]->GetSortId();
+				break;
+			}
+		}
 		
 		///////////////////
 		// Type specifics
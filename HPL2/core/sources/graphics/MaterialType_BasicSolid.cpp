@@ -55,6 +55,7 @@ namespace hpl {
 	#define kVar_afDissolveAmount				4
 	#define kVar_avFrenselBiasPow				5
 	#define kVar_a_mtxInvViewRotation			6
+	#define kVar_a_mtxInstanceModelView			7
 
 
 	//------------------------------
@@ -67,8 +68,9 @@ namespace hpl {
 	#define eFeature_Diffuse_Skeleton		eFlagBit_4
 	#define eFeature_Diffuse_EnvMap			eFlagBit_5
 	#define eFeature_Diffuse_CubeMapAlpha	eFlagBit_6
+	#define eFeature_Diffuse_Instancing		eFlagBit_7
 		
-	#define kDiffuseFeatureNum 7
+	#define kDiffuseFeatureNum 8
 
 	static cProgramComboFeature vDiffuseFeatureVec[] =
 	{
@@ -79,6 +81,7 @@ namespace hpl {
 		cProgramComboFeature("UseSkeleton",	kPC_VertexBit),	
 		cProgramComboFeature("UseEnvMap", kPC_VertexBit | kPC_FragmentBit),
 		cProgramComboFeature("UseCubeMapAlpha", kPC_FragmentBit),
+		cProgramComboFeature("UseInstancing", kPC_VertexBit),
 	};
 
 	//------------------------------
@@ -103,8 +106,9 @@ namespace hpl {
 	#define eFeature_Z_Dissolve					eFlagBit_2
 	#define eFeature_Z_DissolveAlpha			eFlagBit_3
 	#define eFeature_Z_UseAlphaDissolveFilter	eFlagBit_4
+	#define eFeature_Z_Instancing				eFlagBit_5
 	
-	#define kZFeatureNum 5
+	#define kZFeatureNum 6
 
 	cProgramComboFeature vZFeatureVec[] =
 	{
@@ -112,7 +116,8 @@ namespace hpl {
 			cProgramComboFeature("UseUvAnimation",				kPC_VertexBit),
 			cProgramComboFeature("UseDissolve",					kPC_FragmentBit),
 			cProgramComboFeature("UseDissolveAlphaMap",			kPC_FragmentBit),
-			cProgramComboFeature("UseAlphaUseDissolveFilter",	kPC_FragmentBit)
+			cProgramComboFeature("UseAlphaUseDissolveFilter",	kPC_FragmentBit),
+			cProgramComboFeature("UseInstancing",				kPC_VertexBit)
 	};
 
 	//------------------------------
@@ -180,12 +185,14 @@ namespace hpl {
 		//This makes this material's program manager responsible for managing the global programs!
 		cParserVarContainer defaultVars;
 		defaultVars.Add("UseUv");
+		defaultVars.Add("MaxInstances", kMaxInstancesPerDraw);
 		
 		mpProgramManager->SetupGenerateProgramData(	eMaterialRenderMode_Z,"Z","deferred_base_vtx.glsl", "deferred_base_frag.glsl", 
 													vZFeatureVec,kZFeatureNum, defaultVars);
 		
 		mpProgramManager->AddGenerateProgramVariableId("a_mtxUV",kVar_a_mtxUV,eMaterialRenderMode_Z);
 		mpProgramManager->AddGenerateProgramVariableId("afDissolveAmount",kVar_afDissolveAmount,eMaterialRenderMode_Z);
+		mpProgramManager->AddGenerateProgramVariableId("a_mtxInstanceModelView",kVar_a_mtxInstanceModelView,eMaterialRenderMode_Z);
 
 		mpGlobalProgramManager = mpProgramManager;
 	}
@@ -252,6 +259,15 @@ namespace hpl {
 
 	//--------------------------------------------------------------------------
 
+	void iMaterialType_SolidBase::SetupInstanceData(eMaterialRenderMode aRenderMode, iGpuProgram* apProgram, const cMatrixf *apModelViewMatrices, int alNum,
+													iRenderer *apRenderer)
+	{
+		bool bRet = apProgram->SetMatrixfArray(kVar_a_mtxInstanceModelView, apModelViewMatrices, alNum);
+		if(bRet==false) Error("Could not set instance matrices!\n");
+	}
+
+	//--------------------------------------------------------------------------
+
 
 	//////////////////////////////////////////////////////////////////////////
 	// SOLID DIFFUSE
@@ -298,6 +314,7 @@ namespace hpl {
 		defaultVars.Add("UseNormals");
 		defaultVars.Add("UseDepth");
 		defaultVars.Add("VirtualPositionAddScale",mfVirtualPositionAddScale);
+		defaultVars.Add("MaxInstances", kMaxInstancesPerDraw);
 		
 		//Get the G-buffer type
 		if(cRendererDeferred::GetGBufferType() == eDeferredGBuffer_32Bit)	defaultVars.Add("Deferred_32bit");
@@ -338,6 +355,7 @@ namespace hpl {
 		mpProgramManager->AddGenerateProgramVariableId("a_mtxUV",kVar_a_mtxUV,eMaterialRenderMode_Diffuse);
 		mpProgramManager->AddGenerateProgramVariableId("avFrenselBiasPow", kVar_avFrenselBiasPow,eMaterialRenderMode_Diffuse);
 		mpProgramManager->AddGenerateProgramVariableId("a_mtxInvViewRotation", kVar_a_mtxInvViewRotation,eMaterialRenderMode_Diffuse);
+		mpProgramManager->AddGenerateProgramVariableId("a_mtxInstanceModelView", kVar_a_mtxInstanceModelView,eMaterialRenderMode_Diffuse);
 
 		mpProgramManager->AddGenerateProgramVariableId("a_mtxUV",kVar_a_mtxUV,eMaterialRenderMode_Illumination);
 		mpProgramManager->AddGenerateProgramVariableId("afColorMul",kVar_afColorMul,eMaterialRenderMode_Illumination);
@@ -452,6 +470,35 @@ namespace hpl {
 	//--------------------------------------------------------------------------
 	
 	iGpuProgram* cMaterialType_SolidDiffuse::GetGpuProgram(cMaterial *apMaterial, eMaterialRenderMode aRenderMode, char alSkeleton)
+	{
+		return GenerateProgram(apMaterial, aRenderMode, false);
+	}
+
+	//--------------------------------------------------------------------------
+
+	iGpuProgram* cMaterialType_SolidDiffuse::GetInstancedGpuProgram(cMaterial *apMaterial, eMaterialRenderMode aRenderMode)
+	{
+		if(iRenderer::GetInstancingEnabled()==false || mpGraphics->GetLowLevel()->GetCaps(eGraphicCaps_Instancing)==0) return NULL;
+
+		//Only modes without any object specific settings can be instanced.
+		if(aRenderMode != eMaterialRenderMode_Z && aRenderMode != eMaterialRenderMode_Diffuse) return NULL;
+
+		iGpuProgram *pProgram = GenerateProgram(apMaterial, aRenderMode, true);
+		if(pProgram==NULL) return NULL;
+
+		//Shaders without UseInstancing support do not have the matrix array, the material is then drawn one object at a time.
+		if(pProgram->GetVariableId("a_mtxInstanceModelView") < 0)
+		{
+			DestroyProgram(apMaterial, aRenderMode, pProgram, 0);
+			return NULL;
+		}
+
+		return pProgram;
+	}
+
+	//--------------------------------------------------------------------------
+
+	iGpuProgram* cMaterialType_SolidDiffuse::GenerateProgram(cMaterial *apMaterial, eMaterialRenderMode aRenderMode, bool abInstanced)
 	{
 		cMaterialType_SolidDiffuse_Vars *pVars = (cMaterialType_SolidDiffuse_Vars*)apMaterial->GetVars();
 
@@ -463,6 +510,7 @@ namespace hpl {
 			if(apMaterial->GetTexture(eMaterialTexture_Alpha))	lFlags |= eFeature_Z_UseAlpha;
 			if(apMaterial->HasUvAnimation())					lFlags |= eFeature_Z_UvAnimation;
 			if(pVars->mbAlphaDissolveFilter)					lFlags |= eFeature_Z_UseAlphaDissolveFilter;
+			if(abInstanced)										lFlags |= eFeature_Z_Instancing;
 
 			return mpGlobalProgramManager->GenerateProgram(eMaterialRenderMode_Z, lFlags);
 		}
@@ -494,6 +542,7 @@ namespace hpl {
 				if(apMaterial->GetTexture(eMaterialTexture_CubeMapAlpha))	lFlags |= eFeature_Diffuse_CubeMapAlpha;
 			}
 			if(apMaterial->HasUvAnimation())							lFlags |= eFeature_Diffuse_UvAnimation;
+			if(abInstanced)												lFlags |= eFeature_Diffuse_Instancing;
 			
 
 			return mpProgramManager->GenerateProgram(aRenderMode,lFlags);
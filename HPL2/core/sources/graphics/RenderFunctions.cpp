@@ -847,6 +847,15 @@ namespace hpl {
 		if(mpCurrentVtxBuffer) mpCurrentVtxBuffer->Draw(aDrawType);
 
 	}
+
+	//-----------------------------------------------------------------------
+
+	void iRenderFunctions::DrawCurrentInstanced(int alInstanceNum, eVertexBufferDrawType aDrawType)
+	{
+		if(mbLog) Log("   Drawing vertex buffer instanced %d times\n", alInstanceNum);
+
+		if(mpCurrentVtxBuffer) mpCurrentVtxBuffer->DrawInstanced(alInstanceNum, aDrawType);
+	}
 	
 	//-----------------------------------------------------------------------
 
@@ -33,10 +33,150 @@
 #include "math/Math.h"
 #include "math/Frustum.h"
 
+#include "system/JobScheduler.h"
+
 #include <algorithm>
+#include <cstring>
 
 namespace hpl {
 
+	//////////////////////////////////////////////////////////////////////////
+	// SORT KEYS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	// Sort keys. Each key is made so that sorting keys in increasing order gives the order to render in.
+	// Ids are masked to their bit count, so if there are more ids than fit, objects may interleave a bit but are still rendered.
+
+	//-----------------------------------------------------------------------
+
+	static inline tRenderListSortKey KeyBits(unsigned int alX, int alBits, int alShift)
+	{
+		return ((tRenderListSortKey)(alX & ((1u << alBits)-1))) << alShift;
+	}
+
+	//-----------------------------------------------------------------------
+
+	/**
+	 * Distance in front of the camera. The float bits of a positive float increase with the value, so the top bits are used as is.
+	 */
+	static inline unsigned int GetDepthBits(float afViewSpaceZ)
+	{
+		float fDist = cMath::Max(-afViewSpaceZ, 0.0f);
+		unsigned int lBits;
+		memcpy(&lBits, &fDist, sizeof(float));
+		return lBits;
+	}
+
+	//-----------------------------------------------------------------------
+
+	static inline unsigned int GetPointerBits(const void *apPtr)
+	{
+		size_t lX = (size_t)apPtr >> 4;
+		return (unsigned int)(lX ^ (lX >> 16));
+	}
+
+	//-----------------------------------------------------------------------
+
+	static tRenderListSortKey GetSortKey_Z(iRenderable* apObject, cMaterial *apMat)
+	{
+		//Alpha mode, then if alpha: program and texture, then depth (closest first)
+		tRenderListSortKey lKey = KeyBits(apMat->GetAlphaMode(), 2, 62);
+		if(apMat->GetAlphaMode() == eMaterialAlphaMode_Trans)
+		{
+			lKey |= KeyBits(apMat->GetProgramSortId(eMaterialRenderMode_Z), 12, 50);
+			lKey |= KeyBits(apMat->GetTextureSetSortId(eMaterialRenderMode_Z), 16, 34);
+		}
+
+		//When instancing, vertex buffer goes before depth so instances are next to each other.
+		if(iRenderer::GetInstancingEnabled())
+		{
+			lKey |= KeyBits(GetPointerBits(apObject->GetVertexBuffer()), 16, 18);
+			lKey |= KeyBits(GetDepthBits(apObject->GetViewSpaceZ()) >> 14, 18, 0);
+		}
+		else
+		{
+			lKey |= KeyBits(GetDepthBits(apObject->GetViewSpaceZ()) >> 12, 20, 14);
+		}
+
+		return lKey;
+	}
+
+	//-----------------------------------------------------------------------
+
+	static tRenderListSortKey GetSortKey_Diffuse(iRenderable* apObject, cMaterial *apMat)
+	{
+		//Program, textures, vertex buffer and then depth (closest first)
+		tRenderListSortKey lKey = KeyBits(apMat->GetProgramSortId(eMaterialRenderMode_Diffuse), 12, 52);
+		lKey |= KeyBits(apMat->GetTextureSetSortId(eMaterialRenderMode_Diffuse), 16, 36);
+		lKey |= KeyBits(GetPointerBits(apObject->GetVertexBuffer()), 16, 20);
+		lKey |= KeyBits(GetDepthBits(apObject->GetViewSpaceZ()) >> 12, 20, 0);
+
+		return lKey;
+	}
+
+	//-----------------------------------------------------------------------
+
+	static tRenderListSortKey GetSortKey_Translucent(iRenderable* apObject)
+	{
+		//Large plane placement, then depth (furthest first)
+		tRenderListSortKey lKey = KeyBits(apObject->GetLargePlaneSurfacePlacement()+1, 2, 62);
+		lKey |= KeyBits(~GetDepthBits(apObject->GetViewSpaceZ()), 32, 0);
+
+		return lKey;
+	}
+
+	//-----------------------------------------------------------------------
+
+	static tRenderListSortKey GetSortKey_Decal(iRenderable* apObject, cMaterial *apMat)
+	{
+		//Textures, vertex buffer, then the object so that the order between overlapping decals stays the same
+		tRenderListSortKey lKey = KeyBits(apMat->GetTextureSetSortId(eMaterialRenderMode_Diffuse), 16, 48);
+		lKey |= KeyBits(GetPointerBits(apObject->GetVertexBuffer()), 16, 32);
+		lKey |= KeyBits(GetPointerBits(apObject), 32, 0);
+
+		return lKey;
+	}
+
+	//-----------------------------------------------------------------------
+
+	static tRenderListSortKey GetSortKey_Illumination(iRenderable* apObject, cMaterial *apMat)
+	{
+		//Textures, vertex buffer, then illumination amount
+		tRenderListSortKey lKey = KeyBits(apMat->GetTextureSetSortId(eMaterialRenderMode_Illumination), 16, 48);
+		lKey |= KeyBits(GetPointerBits(apObject->GetVertexBuffer()), 16, 32);
+		
+		float fAmount = cMath::Clamp(apObject->GetIlluminationAmount(), 0.0f, 1.0f);
+		lKey |= KeyBits((unsigned int)(fAmount * 65535.0f), 16, 16);
+
+		return lKey;
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// JOBS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	class cRenderListGraphicsPrepareFunc : public iJobRangeFunc
+	{
+	public:
+		void RunJobRange(int alStart, int alEnd, int alThreadSlot)
+		{
+			for(int i=alStart; i<alEnd; ++i)
+			{
+				mpList->mvGraphicsPrepareObjects[i]->RunGraphicsPrepare(mpList->mpFrustum, mpList->mfFrameTime);
+			}
+		}
+
+		cRenderList *mpList;
+	};
+
+	//-----------------------------------------------------------------------
+
 	//////////////////////////////////////////////////////////////////////////
 	// CONSTRUCTORS
 	//////////////////////////////////////////////////////////////////////////
@@ -47,6 +187,7 @@ namespace hpl {
 	{
 		mfFrameTime =0;
 		mpFrustum = NULL;
+		mpJobScheduler = NULL;
 	}
 
 	//-----------------------------------------------------------------------
@@ -64,10 +205,11 @@ namespace hpl {
 	
 	//-----------------------------------------------------------------------
 
-	void cRenderList::Setup(float afFrameTime, cFrustum *apFrustum)
+	void cRenderList::Setup(float afFrameTime, cFrustum *apFrustum, cJobScheduler *apJobScheduler)
 	{
 		mfFrameTime = afFrameTime;
 		mpFrustum = apFrustum;
+		mpJobScheduler = apJobScheduler;
 	}
 
 	//-----------------------------------------------------------------------
@@ -111,6 +253,10 @@ namespace hpl {
 		else
 		{
 			apObject->SetModelMatrixPtr(apObject->GetModelMatrix(NULL));
+
+			//CPU side of the viewport update is done for all of these at once when compiling.
+			if(apObject->UsesGraphicsPrepare())
+				mvGraphicsPrepareObjects.push_back(apObject);
 		}
 
 		////////////////////////////////////////
@@ -174,18 +320,27 @@ namespace hpl {
 			if(pMaterialType->IsTranslucent())
 			{
 				if(pMaterialType->IsDecal())
+				{
 					mvDecalObjects.push_back(apObject);
+					mvSortEntries[eRenderListType_Decal].push_back(cRenderListSortEntry(GetSortKey_Decal(apObject, pMaterial), apObject));
+				}
 				else
+				{
 					mvTransObjects.push_back(apObject);
+				}
 			}
 			////////////////////////
 			// Solid
 			else
 			{
 				mvSolidObjects.push_back(apObject);
+				mvSortEntries[eRenderListType_Z].push_back(cRenderListSortEntry(GetSortKey_Z(apObject, pMaterial), apObject));
+				mvSortEntries[eRenderListType_Diffuse].push_back(cRenderListSortEntry(GetSortKey_Diffuse(apObject, pMaterial), apObject));
+
 				if(pMaterial->GetTexture(eMaterialTexture_Illumination) && apObject->GetIlluminationAmount()>0)
 				{
 					mvIllumObjects.push_back(apObject);
+					mvSortEntries[eRenderListType_Illumination].push_back(cRenderListSortEntry(GetSortKey_Illumination(apObject, pMaterial), apObject));
 				}
 			}
 		}
@@ -201,6 +356,7 @@ namespace hpl {
 		if(aFlags & eRenderListCompileFlag_Illumination) CompileArray(eRenderListType_Illumination);
 		if(aFlags & eRenderListCompileFlag_Translucent)
 		{
+			PrepareGraphics();
 			FindNearestLargeSurfacePlane();
 			CompileArray(eRenderListType_Translucent);
 		}
@@ -215,6 +371,7 @@ namespace hpl {
 		// needed unless there is a need to increase the vector size.
 
 		mvOcclusionQueryObjects.resize(0);
+		mvGraphicsPrepareObjects.resize(0);
 		mvTransObjects.resize(0);
 		mvDecalObjects.resize(0);
 		mvSolidObjects.resize(0);
@@ -225,6 +382,7 @@ namespace hpl {
 		for(int i=0; i<eRenderListType_LastEnum; ++i)
 		{
 			mvSortedArrays[i].resize(0);
+			mvSortEntries[i].resize(0);
 		}
 	}
 
@@ -289,184 +447,112 @@ namespace hpl {
 
 	//-----------------------------------------------------------------------
 
-	static bool SortFunc_Z(iRenderable* apObjectA, iRenderable *apObjectB)
+	void cRenderList::PrepareGraphics()
 	{
-		cMaterial *pMatA = apObjectA->GetMaterial();
-		cMaterial *pMatB = apObjectB->GetMaterial();
+		if(mvGraphicsPrepareObjects.empty()) return;
 
-		//////////////////////////
-		//Alpha mode
-		if(pMatA->GetAlphaMode() != pMatB->GetAlphaMode())
+		////////////////////////////
+		// Resolve shared data, so jobs only write to their own object
+		for(size_t i=0; i<mvGraphicsPrepareObjects.size(); ++i)
 		{
-			return pMatA->GetAlphaMode() < pMatB->GetAlphaMode();
+			mvGraphicsPrepareObjects[i]->BeforeGraphicsPrepare();
 		}
 
-		//////////////////////////
-		//If alpha, sort by texture (we know alpha is same for both materials, so can just test one)
-		if(	pMatA->GetAlphaMode() == eMaterialAlphaMode_Trans )
-		{
-			if(pMatA->GetProgram(0,eMaterialRenderMode_Z) != pMatB->GetProgram(0,eMaterialRenderMode_Z))
-			{
-				return pMatA->GetProgram(0,eMaterialRenderMode_Z) < pMatB->GetProgram(0,eMaterialRenderMode_Z);
-			}
+		////////////////////////////
+		// Build vertex data, the upload is done when the object is rendered.
+		cRenderListGraphicsPrepareFunc prepareFunc;
+		prepareFunc.mpList = this;
 
-			if(pMatA->GetTexture(eMaterialTexture_Diffuse) != pMatB->GetTexture(eMaterialTexture_Diffuse))
-			{
-				return pMatA->GetTexture(eMaterialTexture_Diffuse) < pMatB->GetTexture(eMaterialTexture_Diffuse);
-			}
-		}
+		int lObjectNum = (int)mvGraphicsPrepareObjects.size();
+		if(mpJobScheduler && mpJobScheduler->GetWorkerNum()>0 && lObjectNum>1)
+			mpJobScheduler->ParallelFor(0, lObjectNum, 1, &prepareFunc);
+		else
+			prepareFunc.RunJobRange(0, lObjectNum, -1);
 
-		//////////////////////////
-		//View space depth, no need to test further since Z should almost never be the same for two objects.
-		// use ">" since we want to render things closest to the screen first.
-		return apObjectA->GetViewSpaceZ() > apObjectB->GetViewSpaceZ();
-		//return apObjectA < apObjectB;
+		mvGraphicsPrepareObjects.resize(0);
 	}
 
 	//-----------------------------------------------------------------------
 
-	static bool SortFunc_Diffuse(iRenderable* apObjectA, iRenderable *apObjectB)
+	void cRenderList::CompileArray(eRenderListType aType)
 	{
-		cMaterial *pMatA = apObjectA->GetMaterial();
-		cMaterial *pMatB = apObjectB->GetMaterial();
+		tRenderListSortEntryVec& vEntries = mvSortEntries[aType];
 
-		//////////////////////////
-		//Program
-		if(pMatA->GetProgram(0,eMaterialRenderMode_Diffuse) != pMatB->GetProgram(0,eMaterialRenderMode_Diffuse))
+		////////////////////////////
+		// Translucent keys depend on the large surface plane, so can only be made now.
+		if(aType == eRenderListType_Translucent)
 		{
-			return pMatA->GetProgram(0,eMaterialRenderMode_Diffuse) < pMatB->GetProgram(0,eMaterialRenderMode_Diffuse);
-		}
-
-		//////////////////////////
-		//Texture
-		for(int i=0;i<kMaxTextureUnits; ++i)
-		{
-			iTexture *pTexA = pMatA->GetTextureInUnit(eMaterialRenderMode_Diffuse,i);
-			iTexture *pTexB = pMatB->GetTextureInUnit(eMaterialRenderMode_Diffuse,i);
-			if(pTexA != pTexB) return pTexA < pTexB;
+			vEntries.resize(mvTransObjects.size());
+			for(size_t i=0; i<mvTransObjects.size(); ++i)
+			{
+				vEntries[i] = cRenderListSortEntry(GetSortKey_Translucent(mvTransObjects[i]), mvTransObjects[i]);
+			}
 		}
 
-		//////////////////////////
-		//Vertex buffer
-        if(apObjectA->GetVertexBuffer() != apObjectB->GetVertexBuffer())
-		{
-			return apObjectA->GetVertexBuffer() < apObjectB->GetVertexBuffer();
-		}
+		SortEntries(vEntries);
 
-		//////////////////////////
-		//Matrix
-		if(apObjectA->GetModelMatrixPtr() != apObjectB->GetModelMatrixPtr())
+		tRenderableVec& vSorted = mvSortedArrays[aType];
+		vSorted.resize(vEntries.size());
+		for(size_t i=0; i<vEntries.size(); ++i)
 		{
-			return apObjectA->GetModelMatrixPtr() < apObjectB->GetModelMatrixPtr();
+			vSorted[i] = vEntries[i].mpObject;
 		}
-		
-		//////////////////////////
-		//Object
-        return apObjectA < apObjectB;
 	}
 
 	//-----------------------------------------------------------------------
 
-	static bool SortFunc_Translucent(iRenderable* apObjectA, iRenderable *apObjectB)
+	/**
+	 * LSD radix sort, 8 bits per pass. Passes where all keys have the same byte are skipped, which is most of
+	 * them for the id parts of the keys.
+	 */
+	void cRenderList::SortEntries(tRenderListSortEntryVec& avEntries)
 	{
-		////////////////////////
-		//If there is a large plane, then need to sort objects according to this first!
-		if(apObjectA->GetLargePlaneSurfacePlacement() != apObjectB->GetLargePlaneSurfacePlacement())
+		size_t lNum = avEntries.size();
+		if(lNum < 2) return;
+
+		////////////////////////////
+		// Count all bytes in one go
+		size_t vCounts[8][256];
+		memset(vCounts, 0, sizeof(vCounts));
+		for(size_t i=0; i<lNum; ++i)
 		{
-			return apObjectA->GetLargePlaneSurfacePlacement() < apObjectB->GetLargePlaneSurfacePlacement();
-		}
-
-		//////////////////////////
-		//View space depth, no need to test further since Z should almost never be the same for two objects.
-		return apObjectA->GetViewSpaceZ() < apObjectB->GetViewSpaceZ();		
-	}
-	
-	//-----------------------------------------------------------------------
-
-	static bool SortFunc_Decal(iRenderable* apObjectA, iRenderable *apObjectB)
-	{
-		cMaterial *pMatA = apObjectA->GetMaterial();
-		cMaterial *pMatB = apObjectB->GetMaterial();
-		
-		//////////////////////////
-		//Texture
-		if(pMatA->GetTexture(eMaterialTexture_Illumination) != pMatB->GetTexture(eMaterialTexture_Illumination))
-		{
-			return pMatA->GetTexture(eMaterialTexture_Illumination) < pMatB->GetTexture(eMaterialTexture_Illumination);
-		}
-
-		//////////////////////////
-		//Vertex buffer
-		if(apObjectA->GetVertexBuffer() != apObjectB->GetVertexBuffer())
-		{
-			return apObjectA->GetVertexBuffer() < apObjectB->GetVertexBuffer();
+			tRenderListSortKey lKey = avEntries[i].mlKey;
+			for(int pass=0; pass<8; ++pass)
+			{
+				vCounts[pass][(lKey >> (pass*8)) & 0xFF]++;
+			}
 		}
 
-		//////////////////////////
-		//Matrix
-		if(apObjectA->GetModelMatrixPtr() != apObjectB->GetModelMatrixPtr())
+		////////////////////////////
+		// Sort
+		mvTempSortEntries.resize(lNum);
+		cRenderListSortEntry *pSrc = &avEntries[0];
+		cRenderListSortEntry *pDest = &mvTempSortEntries[0];
+		for(int pass=0; pass<8; ++pass)
 		{
-			return apObjectA->GetModelMatrixPtr() < apObjectB->GetModelMatrixPtr();
-		}
-		
-		//////////////////////////
-		//Vector (just so that order stays the same
-        return apObjectA->GetWorldPosition()  < apObjectB->GetWorldPosition();
-	}
+			size_t *pCounts = vCounts[pass];
+			int lShift = pass*8;
+			if(pCounts[(pSrc[0].mlKey >> lShift) & 0xFF] == lNum) continue;
 
-	//-----------------------------------------------------------------------
-
-	static bool SortFunc_Illumination(iRenderable* apObjectA, iRenderable *apObjectB)
-	{
-		cMaterial *pMatA = apObjectA->GetMaterial();
-		cMaterial *pMatB = apObjectB->GetMaterial();
-
-		//////////////////////////
-		//Texture
-		if(pMatA->GetTexture(eMaterialTexture_Illumination) != pMatB->GetTexture(eMaterialTexture_Illumination))
-		{
-			return pMatA->GetTexture(eMaterialTexture_Illumination) < pMatB->GetTexture(eMaterialTexture_Illumination);
-		}
+			size_t lOffset = 0;
+			for(int i=0; i<256; ++i)
+			{
+				size_t lCount = pCounts[i];
+				pCounts[i] = lOffset;
+				lOffset += lCount;
+			}
 
-		//////////////////////////
-		//Vertex buffer
-		if(apObjectA->GetVertexBuffer() != apObjectB->GetVertexBuffer())
-		{
-			return apObjectA->GetVertexBuffer() < apObjectB->GetVertexBuffer();
-		}
+			for(size_t i=0; i<lNum; ++i)
+			{
+				pDest[pCounts[(pSrc[i].mlKey >> lShift) & 0xFF]++] = pSrc[i];
+			}
 
-		//////////////////////////
-		//Matrix
-		if(apObjectA->GetModelMatrixPtr() != apObjectB->GetModelMatrixPtr())
-		{
-			return apObjectA->GetModelMatrixPtr() < apObjectB->GetModelMatrixPtr();
+			cRenderListSortEntry *pTemp = pSrc;
+			pSrc = pDest;
+			pDest = pTemp;
 		}
 
-		//////////////////////////
-		//Illumination amount
-		return apObjectA->GetIlluminationAmount() < apObjectB->GetIlluminationAmount();
-	}
-
-	//-----------------------------------------------------------------------
-
-	typedef bool (*tSortRenderableFunc)(iRenderable*,iRenderable*); 
-
-	static tSortRenderableFunc vSortFunctions[eRenderListType_LastEnum] = {SortFunc_Z,SortFunc_Diffuse,SortFunc_Translucent,SortFunc_Decal,SortFunc_Illumination};
-
-	//-----------------------------------------------------------------------
-
-	
-	void cRenderList::CompileArray(eRenderListType aType)
-	{
-		tRenderableVec *pSourceVec = NULL;
-		if(aType == eRenderListType_Translucent)		pSourceVec = &mvTransObjects;
-		else if(aType == eRenderListType_Decal)			pSourceVec = &mvDecalObjects;
-		else if(aType == eRenderListType_Illumination)	pSourceVec = &mvIllumObjects;
-		else											pSourceVec = &mvSolidObjects;
-
-		mvSortedArrays[aType] = *pSourceVec;	//Should be fastest way to copy right, or use memcopy?
-		
-		std::sort(mvSortedArrays[aType].begin(), mvSortedArrays[aType].end(), vSortFunctions[aType]);
+		if(pSrc != &avEntries[0]) avEntries.swap(mvTempSortEntries);
 	}
 
 	//-----------------------------------------------------------------------
@@ -22,6 +22,7 @@
 #include "math/Math.h"
 #include "math/Frustum.h"
 #include "system/LowLevelSystem.h"
+#include "graphics/Renderer.h"
 
 namespace hpl {
 
@@ -65,6 +66,12 @@ namespace hpl {
 		mpRenderContainerNode = NULL;
 
 		mpRenderableUserData = NULL;
+
+		mbContainerUpdatePending = false;
+
+		mpGraphicsPreparedFrustum = NULL;
+		mlGraphicsPreparedFrameCount = -1;
+		mbGraphicsPreparedResult = false;
 	}
 	
 	//-----------------------------------------------------------------------
@@ -94,6 +101,28 @@ namespace hpl {
 		if(mpRenderCallback) mpRenderCallback->OnVisibleChange(this);
 	}
 
+	//-----------------------------------------------------------------------
+
+	void iRenderable::RunGraphicsPrepare(cFrustum *apFrustum,float afFrameTime)
+	{
+		mbGraphicsPreparedResult = PrepareGraphicsForViewport(apFrustum, afFrameTime);
+		mpGraphicsPreparedFrustum = apFrustum;
+		mlGraphicsPreparedFrameCount = iRenderer::GetRenderFrameCount();
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool iRenderable::EnsureGraphicsPrepared(cFrustum *apFrustum,float afFrameTime)
+	{
+		//Another frustum (a reflection and such) might have prepared in between, then it needs to be redone.
+		if(	mpGraphicsPreparedFrustum != apFrustum || mlGraphicsPreparedFrameCount != iRenderer::GetRenderFrameCount())
+		{
+			RunGraphicsPrepare(apFrustum, afFrameTime);
+		}
+
+		return mbGraphicsPreparedResult;
+	}
+
 	//-----------------------------------------------------------------------
 	
 	cMatrixf* iRenderable::GetInvModelMatrix()
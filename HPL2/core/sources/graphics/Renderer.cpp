@@ -25,6 +25,7 @@
 #include "system/LowLevelSystem.h"
 #include "system/PreprocessParser.h"
 #include "system/String.h"
+#include "system/JobScheduler.h"
 
 #include "graphics/Graphics.h"
 #include "graphics/Texture.h"
@@ -61,6 +62,18 @@
 
 namespace hpl {
 
+	//Texels around each shadow map atlas tile that are cleared but not rendered to, so filtering does not read other tiles.
+	#define kShadowMapAtlasBorder 4
+
+	//Occlusion object history not used for this many frames is removed.
+	#define kOcclusionQueryHistoryMaxUnusedFrames 60
+
+	//Max number of static objects rasterized into the software occlusion buffer each frame, and max triangles in total.
+	#define kSoftwareOcclusionMaxOccluders 32
+	#define kSoftwareOcclusionMaxTriangles 16384
+	//Objects are only used as occluders if radius / distance is above this.
+	#define kSoftwareOcclusionMinOccluderSize 0.15f
+
 	//////////////////////////////////////////////////////////////////////////
 	// STATIC VARAIBLES
 	//////////////////////////////////////////////////////////////////////////
@@ -73,6 +86,10 @@ namespace hpl {
 	bool iRenderer::mbParallaxEnabled=true;
 	int iRenderer::mlReflectionSizeDiv = 2;
 	bool iRenderer::mbRefractionEnabled=true;
+	bool iRenderer::mbInstancingEnabled=false;
+	bool iRenderer::mbShadowMapAtlasEnabled=false;
+	int iRenderer::mlOcclusionQueryLatency=0;
+	bool iRenderer::mbSoftwareOcclusionEnabled=false;
 
 	//-----------------------------------------------------------------------
 
@@ -187,6 +204,12 @@ namespace hpl {
 				hplDelete(mvLightOcclusionPairs[i].mpQuery);
 		}
 
+		for(tOcclusionQueryHistoryMapIt it = m_mapOcclusionQueryHistory.begin(); it != m_mapOcclusionQueryHistory.end(); ++it)
+		{
+			if(it->second.mpPendingQuery)
+				hplDelete(it->second.mpPendingQuery);
+		}
+
 		if(mpReflectionSettings) hplDelete(mpReflectionSettings);
 	}
 
@@ -262,6 +285,7 @@ namespace hpl {
 
 		cOcclusionQueryObject *pObject = mvOcclusionObjectPool[mlCurrentOcclusionObject];
 
+		pObject->mpSource = apSource;
 		pObject->mlCustomID = alCustomIndex;
 		pObject->mpQuery = apRenderer->GetOcclusionQuery();
 		pObject->mpVtxBuffer = apVtxBuffer;
@@ -306,18 +330,7 @@ namespace hpl {
 
 		//////////////////////////////////////
 		// Get the query and wait (if needed) for result to come in.
-		iOcclusionQuery *pQuery = pObject->mpQuery;
-		
-		//If query is null, then samples have already been retrieved.
-		if(pQuery==NULL) return pObject->mlSampleResults;
-		
-		while(pQuery->FetchResults()==false);
-
-		pObject->mlSampleResults = pQuery->GetSampleCount();
-		pObject->mpQuery = NULL;
-		apRenderer->ReleaseOcclusionQuery(pQuery);
-
-		return pObject->mlSampleResults;
+		return FetchOcclusionObjectSamples(apRenderer, pObject);
 	}
 
 	//-----------------------------------------------------------------------
@@ -326,15 +339,80 @@ namespace hpl {
 	{
 		for(int i=0; i<mlCurrentOcclusionObject; ++i)
 		{
-			iOcclusionQuery *pQuery = mvOcclusionObjectPool[i]->mpQuery;
-			if(pQuery==NULL) continue;
+			FetchOcclusionObjectSamples(apRenderer, mvOcclusionObjectPool[i]);
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	int cRenderSettings::FetchOcclusionObjectSamples(iRenderer *apRenderer, cOcclusionQueryObject *apObject)
+	{
+		iOcclusionQuery *pQuery = apObject->mpQuery;
+		
+		//If query is null, then samples have already been retrieved.
+		if(pQuery==NULL) return apObject->mlSampleResults;
+		apObject->mpQuery = NULL;
+
+		//////////////////////////////////////
+		// Stop and wait for result
+		int lMaxLatency = iRenderer::GetOcclusionQueryLatency();
+		if(lMaxLatency <= 0)
+		{
+			while(pQuery->FetchResults()==false);
+
+			apObject->mlSampleResults = pQuery->GetSampleCount();
+			apRenderer->ReleaseOcclusionQuery(pQuery);
 			
-            while(pQuery->FetchResults()==false);
+			return apObject->mlSampleResults;
+		}
 
-			mvOcclusionObjectPool[i]->mlSampleResults = pQuery->GetSampleCount();
-			mvOcclusionObjectPool[i]->mpQuery = NULL;
+		//////////////////////////////////////
+		// Latency tolerant, use the newest result that has arrived
+		int lFrame = iRenderer::GetRenderFrameCount();
+		cOcclusionQueryHistory &history = m_mapOcclusionQueryHistory[tOcclusionQueryHistoryKey(apObject->mpSource, apObject->mlCustomID)];
+		history.mlLastUsedFrame = lFrame;
+
+		//Query from an earlier frame
+		if(history.mpPendingQuery && history.mpPendingQuery->FetchResults())
+		{
+			history.mlSampleResults = history.mpPendingQuery->GetSampleCount();
+			history.mbHasResult = true;
+
+			apRenderer->ReleaseOcclusionQuery(history.mpPendingQuery);
+			history.mpPendingQuery = NULL;
+		}
+
+		//Query from this frame, if done it is newer than any pending one.
+		if(pQuery->FetchResults())
+		{
+			history.mlSampleResults = pQuery->GetSampleCount();
+			history.mbHasResult = true;
+			apRenderer->ReleaseOcclusionQuery(pQuery);
+
+			if(history.mpPendingQuery)
+			{
+				apRenderer->ReleaseOcclusionQuery(history.mpPendingQuery);
+				history.mpPendingQuery = NULL;
+			}
+		}
+		//Only keep one query waiting, unless the waiting one has become too old.
+		else if(history.mpPendingQuery==NULL || lFrame - history.mlPendingFrame > lMaxLatency)
+		{
+			if(history.mpPendingQuery) apRenderer->ReleaseOcclusionQuery(history.mpPendingQuery);
+
+			history.mpPendingQuery = pQuery;
+			history.mlPendingFrame = lFrame;
+		}
+		else
+		{
 			apRenderer->ReleaseOcclusionQuery(pQuery);
 		}
+
+		//////////////////////////////////////
+		// Predict visible if there is no result yet
+		apObject->mlSampleResults = history.mbHasResult ? history.mlSampleResults : cMath::Max(mlSampleVisiblilityLimit+1, 1);
+		
+		return apObject->mlSampleResults;
 	}
 
 	//-----------------------------------------------------------------------
@@ -353,6 +431,24 @@ namespace hpl {
 		}
 
 		mlCurrentOcclusionObject = 0;
+
+		//////////////////////////////
+		//Remove history of objects no longer rendered
+		int lFrame = iRenderer::GetRenderFrameCount();
+		tOcclusionQueryHistoryMapIt it = m_mapOcclusionQueryHistory.begin();
+		while(it != m_mapOcclusionQueryHistory.end())
+		{
+			cOcclusionQueryHistory &history = it->second;
+			if(lFrame - history.mlLastUsedFrame > kOcclusionQueryHistoryMaxUnusedFrames)
+			{
+				if(history.mpPendingQuery) apRenderer->ReleaseOcclusionQuery(history.mpPendingQuery);
+				m_mapOcclusionQueryHistory.erase(it++);
+			}
+			else
+			{
+				++it;
+			}
+		}
 	}
 
 	//-----------------------------------------------------------------------
@@ -379,6 +475,58 @@ namespace hpl {
 
 	//-----------------------------------------------------------------------
 
+	//////////////////////////////////////////////////////////////////////////
+	// SHADOW CASTER CULL DATA
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	void cShadowCasterCullData::Setup(cFrustum *apLightFrustum, cFrustum *apViewFrustum, tRenderableVec *apCasterVec, bool abNodesPrepared)
+	{
+		mpLightFrustum = apLightFrustum;
+		mpViewFrustum = apViewFrustum;
+		mpCasterVec = apCasterVec;
+		mbNodesPrepared = abNodesPrepared;
+
+		/////////////////////////
+		// Get the camera planes that face away from the light
+		mlBeyondLightAndViewPlaneNum =0;
+		cVector3f vLightForward = mpLightFrustum->GetForward();
+		for(int i=0; i<eFrustumPlane_LastEnum; ++i)
+		{
+			const cPlanef& cameraPlane = mpViewFrustum->GetPlane((eFrustumPlane)i);
+
+			//Check so plane is facing the light
+			// Above 0 because GetForward from frustum is inverted.
+			// Note that this is not optimal, but good enough for now. Should have some other way of choosing to make it better.
+			cVector3f vPlaneNormal = cameraPlane.GetNormal();
+			if(cMath::Vector3Dot(vPlaneNormal, vLightForward) > 0)	
+			{
+				mvBeyondLightAndViewPlanes[mlBeyondLightAndViewPlaneNum] = (eFrustumPlane)i;
+				++mlBeyondLightAndViewPlaneNum;
+			}
+		}
+		
+		/////////////////////////
+		// See if light is behind near plane
+		mbLightBehindNearPlane = cMath::PlaneToPointDist(mpViewFrustum->GetPlane(eFrustumPlane_Near), mpLightFrustum->GetOrigin()) < 0;
+
+		/////////////////////////
+		// AABB of the light frustum, used to skip nodes that have not been prepared.
+		if(mbNodesPrepared)
+		{
+			mvLightMin = mpLightFrustum->GetVertex(0);
+			mvLightMax = mvLightMin;
+			for(int i=1; i<8; ++i)
+			{
+				const cVector3f& vVertex = mpLightFrustum->GetVertex(i);
+				cMath::ExpandAABB(mvLightMin, mvLightMax, vVertex, vVertex);
+			}
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
 	//////////////////////////////////////////////////////////////////////////
 	// CONSTRUCTORS
 	//////////////////////////////////////////////////////////////////////////
@@ -426,6 +574,15 @@ namespace hpl {
 
 		mlActiveOcclusionQueryNum =0;
 
+		mlGatheredShadowCasterNum =0;
+		mlShadowCastersUnchanged = -1;
+
+		mpShadowMapAtlas = NULL;
+		mpShadowMapAtlasTexture = NULL;
+		mpShadowMapAtlasBuffer = NULL;
+
+		mbSoftwareOcclusionActive = false;
+
 		//////////////
 		// Create programs
 		cParserVarContainer vars;
@@ -449,6 +606,7 @@ namespace hpl {
 		DestroyShadowMaps();
 
 		STLDeleteAll(mvOcclusionQueryPool);
+		STLDeleteAll(mvGatheredShadowCasters);
 
 		if(mpShapeBox) hplDelete(mpShapeBox);
 
@@ -556,6 +714,13 @@ namespace hpl {
 
 		mbOcclusionPlanesActive = true;
 
+		if(abAtStartOfRendering)
+		{
+			mvInstanceMatrices.resize(0);
+			mShadowMapUpdateScheduler.BeginFrame();
+		}
+		mlGatheredShadowCasterNum =0;
+
 		////////////////////////////////
 		//Initialize render functions
 		InitAndResetRenderFunctions(apFrustum, apRenderTarget, apSettings->mbLog, 
@@ -790,22 +955,14 @@ namespace hpl {
 		
 		///////////////////////////
 		// Check if texture map and light are valid
-		bool bValid =	cacheData.mpLight == apLight &&	cacheData.mlTransformCount == apLight->GetTransformUpdateCount() &&
-						cacheData.mfRadius == apLight->GetRadius();
-
-		/////////////////////////////
-		// Spotlight specific
-		if(bValid && apLight->GetLightType() == eLightType_Spot)
-		{
-			cLightSpot *pSpotLight = static_cast<cLightSpot*>(apLight);
-			bValid = pSpotLight->GetAspect() == cacheData.mfAspect && pSpotLight->GetFOV() == cacheData.mfFOV;
-		}
+		bool bValid = ShadowMapCacheIsValid(apLight, cacheData);
 
 		/////////////////////////////
 		// Shadow casters
 		if(bValid)
 		{
-			bValid = apLight->ShadowCastersAreUnchanged(mvShadowCasters);
+			if(mlShadowCastersUnchanged >= 0)	bValid = mlShadowCastersUnchanged==1;
+			else								bValid = apLight->ShadowCastersAreUnchanged(mvShadowCasters);
 		}
 
 		/////////////////////////////
@@ -818,6 +975,24 @@ namespace hpl {
 		
 		return bValid ? false : true;
 	}
+
+	//-----------------------------------------------------------------------
+
+	bool iRenderer::ShadowMapCacheIsValid(iLight *apLight, cShadowMapLightCache &aCache)
+	{
+		bool bValid =	aCache.mpLight == apLight && aCache.mlTransformCount == apLight->GetTransformUpdateCount() &&
+						aCache.mfRadius == apLight->GetRadius();
+
+		/////////////////////////////
+		// Spotlight specific
+		if(bValid && apLight->GetLightType() == eLightType_Spot)
+		{
+			cLightSpot *pSpotLight = static_cast<cLightSpot*>(apLight);
+			bValid = pSpotLight->GetAspect() == aCache.mfAspect && pSpotLight->GetFOV() == aCache.mfFOV;
+		}
+
+		return bValid;
+	}
 	
 	//-----------------------------------------------------------------------
 
@@ -835,13 +1010,199 @@ namespace hpl {
 			}
 			STLDeleteAll(mvShadowMapData[res]);
 		}
-		
+
+		if(mpShadowMapAtlas)
+		{
+			mpGraphics->DestroyFrameBuffer(mpShadowMapAtlasBuffer);
+			mpGraphics->DestroyTexture(mpShadowMapAtlasTexture);
+			hplDelete(mpShadowMapAtlas);
+
+			mpShadowMapAtlas = NULL;
+			mpShadowMapAtlasTexture = NULL;
+			mpShadowMapAtlasBuffer = NULL;
+		}
+		m_mapShadowMapAtlasSlots.clear();
+	}
+
+	//-----------------------------------------------------------------------
+
+	void iRenderer::CreateShadowMapAtlas(int alSize, ePixelFormat aFormat)
+	{
+		//Driver hack in CreateAndAddShadowMap needs a color buffer of the same size, keep separate maps.
+		if(mpLowLevelGraphics->GetCaps(eGraphicCaps_OGL_ATIFragmentShader)) return;
+
+		////////////////////////////
+		//Smallest tile is the smallest shadow map
+		int lMinTileSize = alSize;
+		for(int res=0; res < eShadowMapResolution_LastEnum; ++res)
+		{
+			int lTileSize = GetShadowMapAtlasTileSize((eShadowMapResolution)res);
+			if(lTileSize > 0) lMinTileSize = cMath::Min(lMinTileSize, lTileSize);
+		}
+
+		mpShadowMapAtlas = hplNew(cShadowMapAtlas, (alSize, lMinTileSize));
+		int lSize = mpShadowMapAtlas->GetSize();
+
+		////////////////////////////
+		//Texture and buffer
+		tString sName = "ShadowMapAtlas"+cString::ToString(lSize)+"x"+cString::ToString(lSize);
+
+		mpShadowMapAtlasTexture = mpGraphics->CreateTexture(sName+"_Texture",eTextureType_2D, eTextureUsage_RenderTarget);
+		mpShadowMapAtlasTexture->CreateFromRawData(cVector3l(lSize, lSize, 1), aFormat, NULL);
+		mpShadowMapAtlasTexture->SetCompareMode(eTextureCompareMode_RToTexture);
+		mpShadowMapAtlasTexture->SetCompareFunc(eTextureCompareFunc_LessOrEqual);
+		mpShadowMapAtlasTexture->SetFilter(eTextureFilter_Nearest);	
+		mpShadowMapAtlasTexture->SetWrapSTR(eTextureWrap_ClampToEdge);
+
+		mpShadowMapAtlasBuffer = mpGraphics->CreateFrameBuffer(sName+"_Buffer");
+		mpShadowMapAtlasBuffer->SetDepthTexture2D(mpShadowMapAtlasTexture);
+		mpShadowMapAtlasBuffer->CompileAndValidate();
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool iRenderer::ShadowMapAtlasIsUsable(iLight *apLight)
+	{
+		//Gobos use the same projection as the shadow map, so they can not be shifted to a tile.
+		return mbShadowMapAtlasEnabled && mpShadowMapAtlas && apLight->GetGoboTexture()==NULL;
+	}
+
+	//-----------------------------------------------------------------------
+
+	int iRenderer::GetShadowMapAtlasTileSize(eShadowMapResolution aResolution)
+	{
+		if(mvShadowMapData[aResolution].empty()) return 0;
+
+		return mvShadowMapData[aResolution][0]->mpTexture->GetWidth();
+	}
+
+	//-----------------------------------------------------------------------
+
+	cShadowMapAtlasSlot* iRenderer::GetShadowMapAtlasSlot(iLight *apLight, int alTileSize)
+	{
+		////////////////////////////
+		//Check if light already has a tile of the right size
+		tShadowMapAtlasSlotMapIt it = m_mapShadowMapAtlasSlots.find(apLight);
+		if(it != m_mapShadowMapAtlasSlots.end())
+		{
+			cShadowMapAtlasSlot *pSlot = &it->second;
+			if(pSlot->mlSize == alTileSize)
+			{
+				pSlot->mlLastUsedFrame = mlRenderFrameCount;
+				return pSlot;
+			}
+
+			mpShadowMapAtlas->Free(pSlot->mvPos, pSlot->mlSize);
+			m_mapShadowMapAtlasSlots.erase(it);
+		}
+
+		////////////////////////////
+		//Allocate a new tile, evict the least recently used slots until there is room.
+		cVector2l vPos;
+		while(mpShadowMapAtlas->Allocate(alTileSize, vPos)==false)
+		{
+			tShadowMapAtlasSlotMapIt oldestIt = m_mapShadowMapAtlasSlots.end();
+			for(it = m_mapShadowMapAtlasSlots.begin(); it != m_mapShadowMapAtlasSlots.end(); ++it)
+			{
+				if(it->second.mlLastUsedFrame == mlRenderFrameCount) continue;
+
+				if(oldestIt == m_mapShadowMapAtlasSlots.end() || it->second.mlLastUsedFrame < oldestIt->second.mlLastUsedFrame)
+					oldestIt = it;
+			}
+			if(oldestIt == m_mapShadowMapAtlasSlots.end()) return NULL;
+
+			mpShadowMapAtlas->Free(oldestIt->second.mvPos, oldestIt->second.mlSize);
+			m_mapShadowMapAtlasSlots.erase(oldestIt);
+		}
+
+		cShadowMapAtlasSlot *pSlot = &m_mapShadowMapAtlasSlots[apLight];
+		pSlot->mvPos = vPos;
+		pSlot->mlSize = alTileSize;
+		pSlot->mlLastUsedFrame = mlRenderFrameCount;
+
+		return pSlot;
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool iRenderer::ShadowMapAtlasHasCachedStaticLight(iLight *apLight, int alTileSize)
+	{
+		if(ShadowMapAtlasIsUsable(apLight)==false || apLight->GetOcclusionCullShadowCasters()) return false;
+		if(apLight->GetShadowCastersAffected() != eObjectVariabilityFlag_Static) return false;
+
+		tShadowMapAtlasSlotMapIt it = m_mapShadowMapAtlasSlots.find(apLight);
+		if(it == m_mapShadowMapAtlasSlots.end()) return false;
+
+		cShadowMapAtlasSlot *pSlot = &it->second;
+		if(pSlot->mlSize != alTileSize || pSlot->mbRendered==false) return false;
+		if(ShadowMapCacheIsValid(apLight, pSlot->mCache)==false) return false;
+
+		//Mark as used so it is not evicted this frame.
+		pSlot->mlLastUsedFrame = mlRenderFrameCount;
+
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool iRenderer::ShadowMapAtlasSlotNeedsUpdate(iLight *apLight, cShadowMapAtlasSlot *apSlot, float afDistance)
+	{
+		///////////////////////////
+		// Set up request
+		cShadowMapUpdateRequest request;
+		request.mlTexels = apSlot->mlSize * apSlot->mlSize;
+		request.mfDistance = afDistance;
+		request.mlFramesSinceUpdate = mlRenderFrameCount - apSlot->mlLastUpdateFrame;
+		request.mbContentValid = apSlot->mbRendered && ShadowMapCacheIsValid(apLight, apSlot->mCache);
+
+		//Occlusion culling must always be updated!
+		if(apLight->GetOcclusionCullShadowCasters())	request.mbCastersChanged = true;
+		else if(mlShadowCastersUnchanged >= 0)			request.mbCastersChanged = mlShadowCastersUnchanged==0;
+		else											request.mbCastersChanged = apLight->ShadowCastersAreUnchanged(mvShadowCasters)==false;
+
+		///////////////////////////
+		// Schedule, cache is only updated when rendered so delayed maps are still seen as changed next frame.
+		if(mShadowMapUpdateScheduler.Schedule(request) != eShadowMapUpdate_Render) return false;
+
+		apSlot->mCache.SetFromLight(apLight);
+		apLight->SetShadowCasterCacheFromVec(mvShadowCasters);
+		apSlot->mbRendered = true;
+		apSlot->mlLastUpdateFrame = mlRenderFrameCount;
+
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	cMatrixf iRenderer::GetShadowMapAtlasTileMatrix(cShadowMapAtlasSlot *apSlot)
+	{
+		float fInvAtlasSize = 1.0f / (float)mpShadowMapAtlas->GetSize();
+		int lInnerSize = apSlot->mlSize - kShadowMapAtlasBorder*2;
+
+		//Tile positions have origin in upper left corner, texture coordinates in lower left.
+		float fScale = (float)lInnerSize * fInvAtlasSize;
+		float fOffsetX = (float)(apSlot->mvPos.x + kShadowMapAtlasBorder) * fInvAtlasSize;
+		float fOffsetY = (float)(mpShadowMapAtlas->GetSize() - apSlot->mvPos.y - apSlot->mlSize + kShadowMapAtlasBorder) * fInvAtlasSize;
+
+		//Coordinates are projective, so offset is multiplied by w.
+		return cMatrixf(fScale, 0,		0, fOffsetX,
+						0,		fScale, 0, fOffsetY,
+						0,		0,		1, 0,
+						0,		0,		0, 1);
 	}
 
 	//-----------------------------------------------------------------------
 
 	void iRenderer::RenderZObject(iRenderable *apObject, cFrustum *apCustomFrustum)
 	{
+		RenderZObjects(&apObject, 1, apCustomFrustum);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void iRenderer::RenderZObjects(iRenderable **apObjects, int alNum, cFrustum *apCustomFrustum)
+	{
+		iRenderable *apObject = apObjects[0];
 		cMaterial *pMaterial = apObject->GetMaterial();
 
 		eMaterialRenderMode renderMode = apObject->GetCoverageAmount()>=1 ? eMaterialRenderMode_Z : eMaterialRenderMode_Z_Dissolve;
@@ -856,6 +1217,14 @@ namespace hpl {
 		////////////////////////
 		//Set up textures
         SetMaterialTextures(renderMode, pMaterial);
+
+		////////////////////////
+		//Several objects, draw instanced
+		if(alNum > 1)
+		{
+			DrawInstancedRun(apObjects, alNum, renderMode, apCustomFrustum);
+			return;
+		}
 		
         ////////////////////////
 		//Set up program
@@ -880,7 +1249,7 @@ namespace hpl {
 	
 	//-----------------------------------------------------------------------
 
-	void iRenderer::CheckNodesAndAddToListIterative(iRenderableContainerNode *apNode, tRenderableFlag alNeededFlags)
+	void iRenderer::CheckNodesAndAddToListIterative(iRenderableContainerNode *apNode, tRenderableFlag alNeededFlags, eCollision aPrevCollision)
 	{
 		///////////////////////////////////////
 		//Make sure node is updated
@@ -888,7 +1257,7 @@ namespace hpl {
 
 		///////////////////////////////////////
 		//Get frustum collision, if previous was inside, then this is too!
-		eCollision frustumCollision = mpCurrentFrustum->CollideNode(apNode);
+		eCollision frustumCollision = aPrevCollision == eCollision_Inside ? aPrevCollision : mpCurrentFrustum->CollideNode(apNode);
 		
 		////////////////////////////////
 		//Do a visible check but always iterate the root node!	
@@ -906,7 +1275,7 @@ namespace hpl {
 			for(; childIt != apNode->GetChildNodeList()->end(); ++childIt)
 			{
 				iRenderableContainerNode *pChildNode = *childIt;
-				CheckNodesAndAddToListIterative(pChildNode, alNeededFlags);
+				CheckNodesAndAddToListIterative(pChildNode, alNeededFlags, frustumCollision);
 			}
 		}
 
@@ -935,6 +1304,24 @@ namespace hpl {
 	{
 		apContainer->UpdateBeforeRendering();
 
+		////////////////////////////
+		// Use the container's own culling if it has one. Node clip plane checks are not supported by it.
+		if(mvCurrentOcclusionPlanes.empty() || mbOcclusionPlanesActive==false)
+		{
+			mvTempContainerObjects.resize(0);
+			if(apContainer->GetObjectsInFrustum(mpCurrentFrustum, &mvTempContainerObjects))
+			{
+				for(size_t i=0; i<mvTempContainerObjects.size(); ++i)
+				{
+					iRenderable *pObject = mvTempContainerObjects[i];
+					if(CheckObjectIsVisible(pObject, alNeededFlags)==false) continue;
+
+					mpCurrentRenderList->AddObject(pObject);
+				}
+				return;
+			}
+		}
+
 		CheckNodesAndAddToListIterative(apContainer->GetRoot(), alNeededFlags);
 	}
 
@@ -1404,13 +1791,6 @@ namespace hpl {
 	
 	//-----------------------------------------------------------------------
 
-	static tRenderableVec* gpLightShadowCasterVec=NULL;
-	static cFrustum *gpLightFrustum=NULL;
-	static cFrustum *gpViewFrustum=NULL;
-	static eFrustumPlane gvBeyondLightAndViewPlanes[6]; //Use to check if an caster is not going to affect view.
-	static int glBeyondLightAndViewPlaneNum;
-	static bool gbLightBehindNearPlane;
-
 	//-----------------------------------------------------------------------
 	
 	static bool BoxIntersectOrInsidePlane(const cPlanef& aPlane,cVector3f *apCornerVec)
@@ -1443,7 +1823,7 @@ namespace hpl {
 
 	//-----------------------------------------------------------------------
 
-	bool iRenderer::CheckShadowCasterContributesToView(iRenderable *apObject)
+	bool iRenderer::CheckShadowCasterContributesToView(iRenderable *apObject, cShadowCasterCullData *apCullData)
 	{
 		//This should be always true since the shadow map might be saved and will then end up faulty if some objects have been dismissed!
 		return true;
@@ -1457,11 +1837,11 @@ namespace hpl {
 		//////////////////////////////////////
 		//If light is behind near plane, one must check if object in front of near plane
 		bool bObjectMightOnNearPlane=false;
-		if(gbLightBehindNearPlane)
+		if(apCullData->mbLightBehindNearPlane)
 		{
 			return true;	//Temp, until I can come up with a qay to resolve the issues.
 
-			const cPlanef& nearPlane = gpViewFrustum->GetPlane(eFrustumPlane_Near);
+			const cPlanef& nearPlane = apCullData->mpViewFrustum->GetPlane(eFrustumPlane_Near);
 			float fDist = cMath::PlaneToPointDist(nearPlane, pBV->GetWorldCenter());
 			
 			//Object is outside of near plane. 
@@ -1481,10 +1861,10 @@ namespace hpl {
 		// Sphere test
 		int lOutsideCount=0;
 		int lInsideCount=0;
-		for(int i=0; i<glBeyondLightAndViewPlaneNum; ++i)
+		for(int i=0; i<apCullData->mlBeyondLightAndViewPlaneNum; ++i)
 		{
-			eFrustumPlane frustumPlane = gvBeyondLightAndViewPlanes[i];
-			const cPlanef& cameraPlane = gpViewFrustum->GetPlane(frustumPlane);
+			eFrustumPlane frustumPlane = apCullData->mvBeyondLightAndViewPlanes[i];
+			const cPlanef& cameraPlane = apCullData->mpViewFrustum->GetPlane(frustumPlane);
 			
 			float fDist = cMath::PlaneToPointDist(cameraPlane, pBV->GetWorldCenter());
 			
@@ -1502,7 +1882,7 @@ namespace hpl {
 		
 		//Log("3\n");
 		// If all was inside, then we are sure it contributes
-		if(lInsideCount == glBeyondLightAndViewPlaneNum) return true;
+		if(lInsideCount == apCullData->mlBeyondLightAndViewPlaneNum) return true;
 
 		//Log("4\n");
 		// If any was outside, we are sure it does NOT contribute
@@ -1527,7 +1907,7 @@ namespace hpl {
 		if(lOutsideCount > 0 && bObjectMightOnNearPlane)
 		{
 			//If object is not fully inside, it contributes
-			if(BoxInsidePlane(gpViewFrustum->GetPlane(eFrustumPlane_Near),vCorners)==false)
+			if(BoxInsidePlane(apCullData->mpViewFrustum->GetPlane(eFrustumPlane_Near),vCorners)==false)
 			{
 				return true;
 			}
@@ -1542,7 +1922,7 @@ namespace hpl {
 		if(bObjectMightOnNearPlane)
 		{
 			//If object is not fully inside, it contributes
-			if(BoxInsidePlane(gpViewFrustum->GetPlane(eFrustumPlane_Near),vCorners)==false)
+			if(BoxInsidePlane(apCullData->mpViewFrustum->GetPlane(eFrustumPlane_Near),vCorners)==false)
 			{
 				return true;
 			}
@@ -1551,10 +1931,10 @@ namespace hpl {
 		//Log("7\n");
 		//Iterate all planes separating between contributing and not.
 		bool bContributes;
-		for(int plane=0; plane<glBeyondLightAndViewPlaneNum; ++plane)
+		for(int plane=0; plane<apCullData->mlBeyondLightAndViewPlaneNum; ++plane)
 		{
-			eFrustumPlane frustumPlane = gvBeyondLightAndViewPlanes[plane];
-			const cPlanef& cameraPlane = gpViewFrustum->GetPlane(frustumPlane);
+			eFrustumPlane frustumPlane = apCullData->mvBeyondLightAndViewPlanes[plane];
+			const cPlanef& cameraPlane = apCullData->mpViewFrustum->GetPlane(frustumPlane);
 			
 			bContributes = BoxIntersectOrInsidePlane(cameraPlane, vCorners);
 
@@ -1569,15 +1949,24 @@ namespace hpl {
 	//-----------------------------------------------------------------------
 
 
-	void iRenderer::GetShadowCastersIterative(iRenderableContainerNode *apNode, eCollision aPrevCollision)
+	void iRenderer::GetShadowCastersIterative(iRenderableContainerNode *apNode, eCollision aPrevCollision, cShadowCasterCullData *apCullData)
 	{
 		///////////////////////////////////////
-		//Make sure node is updated
-		apNode->UpdateBeforeUse();
+		//Make sure node is updated (prepared nodes were updated before the jobs started)
+		if(apCullData->mbNodesPrepared==false) apNode->UpdateBeforeUse();
+
+		///////////////////////////////////////
+		//Only nodes inside the light AABB are prepared, so skip all others.
+		if(apCullData->mbNodesPrepared && apNode->GetParent() &&
+			cMath::CheckAABBIntersection(apNode->GetMin(), apNode->GetMax(), apCullData->mvLightMin, apCullData->mvLightMax)==false)
+		{
+			return;
+		}
 
 		///////////////////////////////////////
 		//Get frustum collision, if previous was inside, then this is too!
-		eCollision frustumCollision = aPrevCollision == eCollision_Inside ? aPrevCollision : gpLightFrustum->CollideNode(apNode);
+		cFrustum *pLightFrustum = apCullData->mpLightFrustum;
+		eCollision frustumCollision = aPrevCollision == eCollision_Inside ? aPrevCollision : pLightFrustum->CollideNode(apNode);
 		
 		///////////////////////////////////
 		//Check if visible but always iterate the root node!	
@@ -1594,7 +1983,7 @@ namespace hpl {
 			for(tRenderableContainerNodeListIt childIt = apNode->GetChildNodeList()->begin(); childIt != apNode->GetChildNodeList()->end(); ++childIt)
 			{
 				iRenderableContainerNode *pChildNode = *childIt;
-				GetShadowCastersIterative(pChildNode, frustumCollision);
+				GetShadowCastersIterative(pChildNode, frustumCollision, apCullData);
 			}
 		}
 
@@ -1618,39 +2007,171 @@ namespace hpl {
 				/////////
 				//Check if in frustum
 				if(	frustumCollision != eCollision_Inside &&
-					gpLightFrustum->CollideBoundingVolume(pObject->GetBoundingVolume()) == eCollision_Outside)
+					pLightFrustum->CollideBoundingVolume(pObject->GetBoundingVolume()) == eCollision_Outside)
 				{
 					continue;
 				}
 				
 				/////////
 				// Check if it contributes to scene
-				if(CheckShadowCasterContributesToView(pObject)==false) continue;
+				if(CheckShadowCasterContributesToView(pObject, apCullData)==false) continue;
 
 				
 				///////////////////////////////
 				// Add object!
-				
-				//Calculate the view space Z (just a squared distance)
-				pObject->SetViewSpaceZ(cMath::Vector3DistSqr(pObject->GetBoundingVolume()->GetWorldCenter(), 
-															gpLightFrustum->GetOrigin()));
+				//  View space Z is set when sorting, objects are shared between lights so it can not be set from a job.
+				apCullData->mpCasterVec->push_back(pObject);				
+			}
+		}
+	}
+
+	//-----------------------------------------------------------------------
 
-				//Add to list
-				gpLightShadowCasterVec->push_back(pObject);				
+	void iRenderer::GetShadowCasters(iRenderableContainer *apContainer, cShadowCasterCullData *apCullData)
+	{
+		if(apCullData->mbNodesPrepared==false) apContainer->UpdateBeforeRendering();
+
+		GetShadowCastersIterative(apContainer->GetRoot(), eCollision_Outside, apCullData);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void iRenderer::PrepareShadowCasterNodesIterative(iRenderableContainerNode *apNode, const cVector3f& avMin, const cVector3f& avMax)
+	{
+		apNode->UpdateBeforeUse();
+
+		//Always iterate the root node
+		if(apNode->GetParent() && cMath::CheckAABBIntersection(apNode->GetMin(), apNode->GetMax(), avMin, avMax)==false) return;
+
+		if(apNode->HasChildNodes())
+		{
+			for(tRenderableContainerNodeListIt childIt = apNode->GetChildNodeList()->begin(); childIt != apNode->GetChildNodeList()->end(); ++childIt)
+			{
+				PrepareShadowCasterNodesIterative(*childIt, avMin, avMax);
+			}
+		}
+
+		////////////////////////
+		//Bounding volumes are updated lazily, so make sure that is done now and not in the jobs.
+		if(apNode->HasObjects())
+		{
+			for(tRenderableListIt it = apNode->GetObjectList()->begin(); it != apNode->GetObjectList()->end(); ++it)
+			{
+				iRenderable *pObject = *it;
+				pObject->GetBoundingVolume()->UpdateSize();
 			}
 		}
 	}
 
 	//-----------------------------------------------------------------------
 
-	void iRenderer::GetShadowCasters(iRenderableContainer *apContainer, tRenderableVec& avObjectVec, cFrustum *apLightFrustum)
+	class cShadowCasterGatherFunc : public iJobRangeFunc
 	{
-		apContainer->UpdateBeforeRendering();
+	public:
+		void RunJobRange(int alStart, int alEnd, int alThreadSlot)
+		{
+			for(int i=alStart; i<alEnd; ++i)
+			{
+				cGatheredShadowCasters *pData = (*mpGatheredVec)[i];
+				iLight *pLight = pData->mpLight;
 
-		gpLightFrustum = apLightFrustum;
-		gpLightShadowCasterVec = &avObjectVec;
+				pData->mvCasters.resize(0);
+
+				if(pLight->GetShadowCastersAffected() & eObjectVariabilityFlag_Dynamic)
+					mpRenderer->GetShadowCasters(mpDynamicContainer, &pData->mCullData);
+				
+				if(pLight->GetShadowCastersAffected() & eObjectVariabilityFlag_Static)
+					mpRenderer->GetShadowCasters(mpStaticContainer, &pData->mCullData);
+
+				//Only reads the cache of this light.
+				pData->mbCastersUnchanged = pLight->ShadowCastersAreUnchanged(pData->mvCasters);
+			}
+		}
+
+		iRenderer *mpRenderer;
+		tGatheredShadowCastersVec *mpGatheredVec;
+		iRenderableContainer *mpDynamicContainer;
+		iRenderableContainer *mpStaticContainer;
+	};
 
-		GetShadowCastersIterative(apContainer->GetRoot(), eCollision_Outside);
+	//////////////////////////////////////
+
+	void iRenderer::GatherShadowCasters(iLight **apLights, int alLightNum)
+	{
+		mlGatheredShadowCasterNum =0;
+
+		cJobScheduler *pJobScheduler = mpCurrentWorld->GetJobScheduler();
+		if(pJobScheduler==NULL || pJobScheduler->GetWorkerNum()==0) return;
+
+		///////////////////////////////
+		// Setup data for all lights that need casters gathered
+		cVector3f vMin, vMax;
+		for(int i=0; i<alLightNum; ++i)
+		{
+			iLight *pLight = apLights[i];
+			if(pLight->GetLightType() != eLightType_Spot || pLight->GetOcclusionCullShadowCasters()) continue;
+
+			if(mlGatheredShadowCasterNum == (int)mvGatheredShadowCasters.size())
+				mvGatheredShadowCasters.push_back(hplNew(cGatheredShadowCasters, ()));
+
+			cGatheredShadowCasters *pData = mvGatheredShadowCasters[mlGatheredShadowCasterNum];
+			++mlGatheredShadowCasterNum;
+
+			cLightSpot *pSpotLight = static_cast<cLightSpot*>(pLight);
+			pData->mpLight = pLight;
+			pData->mbUsed = false;
+			pData->mCullData.Setup(pSpotLight->GetFrustum(), mpCurrentFrustum, &pData->mvCasters, true);
+
+			if(mlGatheredShadowCasterNum==1)
+			{
+				vMin = pData->mCullData.mvLightMin;
+				vMax = pData->mCullData.mvLightMax;
+			}
+			else
+			{
+				cMath::ExpandAABB(vMin, vMax, pData->mCullData.mvLightMin, pData->mCullData.mvLightMax);
+			}
+		}
+
+		//No use in jobs for a single light.
+		if(mlGatheredShadowCasterNum < 2)
+		{
+			mlGatheredShadowCasterNum =0;
+			return;
+		}
+
+		///////////////////////////////
+		// Update containers, nodes and bounding volumes so the jobs only read.
+		iRenderableContainer *pDynamicContainer = mpCurrentWorld->GetRenderableContainer(eWorldContainerType_Dynamic);
+		iRenderableContainer *pStaticContainer = mpCurrentWorld->GetRenderableContainer(eWorldContainerType_Static);
+		
+		pDynamicContainer->UpdateBeforeRendering();
+		pStaticContainer->UpdateBeforeRendering();
+
+		PrepareShadowCasterNodesIterative(pDynamicContainer->GetRoot(), vMin, vMax);
+		PrepareShadowCasterNodesIterative(pStaticContainer->GetRoot(), vMin, vMax);
+
+		///////////////////////////////
+		// Gather
+		cShadowCasterGatherFunc gatherFunc;
+		gatherFunc.mpRenderer = this;
+		gatherFunc.mpGatheredVec = &mvGatheredShadowCasters;
+		gatherFunc.mpDynamicContainer = pDynamicContainer;
+		gatherFunc.mpStaticContainer = pStaticContainer;
+
+		pJobScheduler->ParallelFor(0, mlGatheredShadowCasterNum, 1, &gatherFunc);
+	}
+
+	//-----------------------------------------------------------------------
+
+	cGatheredShadowCasters* iRenderer::GetGatheredShadowCasters(iLight *apLight)
+	{
+		for(int i=0; i<mlGatheredShadowCasterNum; ++i)
+		{
+			cGatheredShadowCasters *pData = mvGatheredShadowCasters[i];
+			if(pData->mpLight == apLight && pData->mbUsed==false) return pData;
+		}
+		return NULL;
 	}
 
 	//-----------------------------------------------------------------------
@@ -1690,6 +2211,36 @@ namespace hpl {
 
 	//-----------------------------------------------------------------------
 
+	static bool SortFunc_ShadowCastersInstanced(iRenderable* apObjectA, iRenderable *apObjectB)
+	{
+		cMaterial *pMatA = apObjectA->GetMaterial();
+		cMaterial *pMatB = apObjectB->GetMaterial();
+
+		//////////////////////////
+		//Alpha mode
+		if(pMatA->GetAlphaMode() != pMatB->GetAlphaMode())
+		{
+			return pMatA->GetAlphaMode() < pMatB->GetAlphaMode();
+		}
+
+		//////////////////////////
+		//Vertex buffer and material, so objects that can be drawn instanced end up next to each other.
+		if(apObjectA->GetVertexBuffer() != apObjectB->GetVertexBuffer())
+		{
+			return apObjectA->GetVertexBuffer() < apObjectB->GetVertexBuffer();
+		}
+		if(pMatA != pMatB)
+		{
+			return pMatA < pMatB;
+		}
+
+		//////////////////////////
+		//View space depth
+		return apObjectA->GetViewSpaceZ() < apObjectB->GetViewSpaceZ();
+	}
+
+	//-----------------------------------------------------------------------
+
 	bool iRenderer::SetupShadowMapRendering(iLight *apLight)
 	{
 		/////////////////////////
@@ -1700,37 +2251,8 @@ namespace hpl {
 		cFrustum *pLightFrustum = pSpotLight->GetFrustum();
 
 		//Set the view frustum, needed in some functions cause the current is set for the light during rendering.
-		gpViewFrustum = mpCurrentFrustum;
-		
-		/////////////////////////
-		// Get the camera planes that face away from the light
-		glBeyondLightAndViewPlaneNum =0;
-		cVector3f vLightForward = pLightFrustum->GetForward();
-		for(int i=0; i<eFrustumPlane_LastEnum; ++i)
-		{
-			const cPlanef& cameraPlane = gpViewFrustum->GetPlane((eFrustumPlane)i);
-
-			//Check so plane is facing the light
-			// Above 0 because GetForward from frustum is inverted.
-			// Note that this is not optimal, but good enough for now. Should have some other way of choosing to make it better.
-			cVector3f vPlaneNormal = cameraPlane.GetNormal();
-			if(cMath::Vector3Dot(vPlaneNormal, vLightForward) > 0)	
-			{
-				gvBeyondLightAndViewPlanes[glBeyondLightAndViewPlaneNum] = (eFrustumPlane)i;
-				++glBeyondLightAndViewPlaneNum;
-			}
-		}
-		
-		/////////////////////////
-		// See if light is behind near plane
-		if(cMath::PlaneToPointDist(gpViewFrustum->GetPlane(eFrustumPlane_Near), pLightFrustum->GetOrigin()) < 0)
-		{
-			gbLightBehindNearPlane = true;	
-		}
-		else
-		{
-			gbLightBehindNearPlane = false;
-		}
+		mShadowCasterCullData.Setup(pLightFrustum, mpCurrentFrustum, &mvShadowCasters, false);
+		mlShadowCastersUnchanged = -1;
 
 		/////////////////////////
 		// If culling by occlusion, skip rest of function
@@ -1747,18 +2269,40 @@ namespace hpl {
 		//Clear list
 		mvShadowCasters.resize(0); //No clear, so we keep all in memory.
 
+		//Use the objects from GatherShadowCasters if any, swap so no memory is allocated.
+		cGatheredShadowCasters *pGathered = GetGatheredShadowCasters(apLight);
+		if(pGathered)
+		{
+			pGathered->mbUsed = true;
+			mvShadowCasters.swap(pGathered->mvCasters);
+			mlShadowCastersUnchanged = pGathered->mbCastersUnchanged ? 1 : 0;
+		}
 		//Get the objects
-		if(apLight->GetShadowCastersAffected() & eObjectVariabilityFlag_Dynamic)
-			GetShadowCasters(mpCurrentWorld->GetRenderableContainer(eWorldContainerType_Dynamic),mvShadowCasters, pSpotLight->GetFrustum());
+		else
+		{
+			if(apLight->GetShadowCastersAffected() & eObjectVariabilityFlag_Dynamic)
+				GetShadowCasters(mpCurrentWorld->GetRenderableContainer(eWorldContainerType_Dynamic), &mShadowCasterCullData);
 
-		if(apLight->GetShadowCastersAffected() & eObjectVariabilityFlag_Static)
-			GetShadowCasters(mpCurrentWorld->GetRenderableContainer(eWorldContainerType_Static),mvShadowCasters, pSpotLight->GetFrustum());
+			if(apLight->GetShadowCastersAffected() & eObjectVariabilityFlag_Static)
+				GetShadowCasters(mpCurrentWorld->GetRenderableContainer(eWorldContainerType_Static), &mShadowCasterCullData);
+		}
 
 		//See if any objects where added.
 		if(mvShadowCasters.empty()) return false;
 
-		//Sort the list
-		std::sort(mvShadowCasters.begin(), mvShadowCasters.end(), SortFunc_ShadowCasters);
+		//Calculate the view space Z (just a squared distance)
+		const cVector3f& vLightOrigin = pLightFrustum->GetOrigin();
+		for(size_t i=0; i<mvShadowCasters.size(); ++i)
+		{
+			iRenderable *pObject = mvShadowCasters[i];
+			pObject->SetViewSpaceZ(cMath::Vector3DistSqr(pObject->GetBoundingVolume()->GetWorldCenter(), vLightOrigin));
+		}
+
+		//Sort the list, when instancing objects sharing vertex buffer and material are grouped before depth.
+		if(mbInstancingEnabled)
+			std::sort(mvShadowCasters.begin(), mvShadowCasters.end(), SortFunc_ShadowCastersInstanced);
+		else
+			std::sort(mvShadowCasters.begin(), mvShadowCasters.end(), SortFunc_ShadowCasters);
 		
 		return true;
 	}
@@ -1782,7 +2326,7 @@ namespace hpl {
 		}
 
 		//Check so it affects the view frustum
-		if(CheckShadowCasterContributesToView(apObject)==false) return false;
+		if(CheckShadowCasterContributesToView(apObject, &mShadowCasterCullData)==false) return false;
 
 		//mvShadowCasters.push_back(apObject); //Debug. Only to see what object are rendered.
 		
@@ -1805,15 +2349,18 @@ namespace hpl {
 	void iRenderer::RenderShadowCastersNormal(cFrustum *apLightFrustum)
 	{
 		////////////////////////////////
-		// Iterate the objects to be rendered 
-		for(size_t i=0; i<mvShadowCasters.size(); ++i)
+		// Iterate the objects to be rendered, runs of equal objects are drawn instanced
+		int lNum = (int)mvShadowCasters.size();
+		for(int i=0; i<lNum; )
 		{
-			RenderShadowCaster(mvShadowCasters[i], apLightFrustum);
+			int lRunNum = GetInstanceRunLength(&mvShadowCasters[i], lNum-i, eMaterialRenderMode_Z, apLightFrustum);
+			RenderZObjects(&mvShadowCasters[i], lRunNum, apLightFrustum);
+			i += lRunNum;
 		}
 	}
 	//-----------------------------------------------------------------------
 
-	void iRenderer::RenderShadowMap(iLight *apLight, iFrameBuffer *apShadowBuffer)
+	void iRenderer::RenderShadowMap(iLight *apLight, iFrameBuffer *apShadowBuffer, const cVector2l &avTilePos, int alTileSize)
 	{
 		if(mbLog){ 
 			Log("---\nBegin Rendering Shadow Map for light '%s' / %d to buffer %d\n",apLight->GetName().c_str(), apLight, apShadowBuffer);
@@ -1849,7 +2396,22 @@ namespace hpl {
 		SetFrameBuffer(apShadowBuffer,false, false);
 
 		mpLowLevelGraphics->SetClearDepth(1);
-		ClearFrameBuffer(eClearFrameBufferFlag_Depth, false);
+
+		//Atlas tile, clear the entire tile (border included) and only render to the inner part.
+		if(alTileSize > 0)
+		{
+			mpLowLevelGraphics->SetCurrentFrameBuffer(apShadowBuffer,	avTilePos + cVector2l(kShadowMapAtlasBorder), 
+																		cVector2l(alTileSize - kShadowMapAtlasBorder*2));
+			
+			mpLowLevelGraphics->SetScissorActive(true);
+			mpLowLevelGraphics->SetScissorRect(avTilePos, cVector2l(alTileSize));
+			ClearFrameBuffer(eClearFrameBufferFlag_Depth, false);
+			mpLowLevelGraphics->SetScissorActive(false);
+		}
+		else
+		{
+			ClearFrameBuffer(eClearFrameBufferFlag_Depth, false);
+		}
 		
 		/////////////////////////
 		// Setup projection
@@ -2008,9 +2570,9 @@ namespace hpl {
 			if(pQuery == NULL) continue;
 
 			//Wait for results if specfied.
-			if(abWaitForResult)
+			if(abWaitForResult && mlOcclusionQueryLatency <= 0)
 			{
-				while(pQuery->FetchResults());
+				while(pQuery->FetchResults()==false);
 			}
 
 			//Get result and set resulting samples
@@ -2096,10 +2658,10 @@ namespace hpl {
 	//-----------------------------------------------------------------------
 
 	
-	void iRenderer::SetMaterialProgram(eMaterialRenderMode aRenderMode, cMaterial *apMaterial)
+	void iRenderer::SetMaterialProgram(eMaterialRenderMode aRenderMode, cMaterial *apMaterial, bool abInstanced)
 	{
 		iMaterialType *pMatType = apMaterial->GetType();
-		iGpuProgram *pProgram = apMaterial->GetProgram(0,aRenderMode);
+		iGpuProgram *pProgram = abInstanced ? apMaterial->GetInstancedProgram(aRenderMode) : apMaterial->GetProgram(0,aRenderMode);
 		
 		///////////////////////////////////////
 		// Check if program is set
@@ -2191,6 +2753,84 @@ namespace hpl {
 
 		DrawCurrent();
 	}
+
+	//-----------------------------------------------------------------------
+
+	static inline cMatrixf* GetObjectModelMatrix(iRenderable *apObject, cFrustum *apCustomFrustum)
+	{
+		return apCustomFrustum ? apObject->GetModelMatrix(apCustomFrustum) : apObject->GetModelMatrixPtr();
+	}
+
+	static bool ObjectCanBeInstanced(iRenderable *apObject, eMaterialRenderMode aRenderMode, cFrustum *apCustomFrustum)
+	{
+		if(GetObjectModelMatrix(apObject, apCustomFrustum)==NULL) return false;
+		
+		//Dissolving objects use a different render mode with object specific settings
+		if(aRenderMode == eMaterialRenderMode_Z && apObject->GetCoverageAmount()<1) return false;
+
+		return apObject->GetMaterial()->HasObjectSpecificsSettings(aRenderMode)==false;
+	}
+
+	//-----------------------------------------------------------------------
+
+	int iRenderer::GetInstanceRunLength(iRenderable **apObjects, int alNum, eMaterialRenderMode aRenderMode, cFrustum *apCustomFrustum)
+	{
+		if(mbInstancingEnabled==false || alNum < 2) return 1;
+
+		iRenderable *pFirst = apObjects[0];
+		cMaterial *pMaterial = pFirst->GetMaterial();
+		iVertexBuffer *pVtxBuffer = pFirst->GetVertexBuffer();
+		
+		if(pMaterial->GetInstancedProgram(aRenderMode)==NULL) return 1;
+		if(ObjectCanBeInstanced(pFirst, aRenderMode, apCustomFrustum)==false) return 1;
+		
+		int lCount = 1;
+		int lMax = cMath::Min(alNum, kMaxInstancesPerDraw);
+		while(lCount < lMax)
+		{
+			iRenderable *pObject = apObjects[lCount];
+			if(	pObject->GetMaterial() != pMaterial || pObject->GetVertexBuffer() != pVtxBuffer ||
+				ObjectCanBeInstanced(pObject, aRenderMode, apCustomFrustum)==false)
+			{
+				break;
+			}
+			++lCount;
+		}
+
+		return lCount;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void iRenderer::DrawInstancedRun(iRenderable **apObjects, int alNum, eMaterialRenderMode aRenderMode, cFrustum *apCustomFrustum)
+	{
+		iRenderable *pFirst = apObjects[0];
+		cMaterial *pMaterial = pFirst->GetMaterial();
+
+		if(mbLog) Log("  Drawing %d instances of %d\n", alNum, pFirst);
+
+		SetMaterialProgram(aRenderMode, pMaterial, true);
+
+		////////////////////////
+		//Add the model view matrices to the frame's instance data
+		size_t lStart = mvInstanceMatrices.size();
+		mvInstanceMatrices.resize(lStart + alNum);
+
+		const cMatrixf& mtxView = mpCurrentFrustum->GetViewMatrix();
+		for(int i=0; i<alNum; ++i)
+		{
+			mvInstanceMatrices[lStart+i] = cMath::MatrixMul(mtxView, *GetObjectModelMatrix(apObjects[i], apCustomFrustum));
+		}
+		pMaterial->GetType()->SetupInstanceData(aRenderMode, mpCurrentProgram, &mvInstanceMatrices[lStart], alNum, this);
+
+		////////////////////////
+		//Matrices are taken from instance data, so only view is set.
+		SetMatrix(NULL);
+
+		SetVertexBuffer(pFirst->GetVertexBuffer());
+
+		DrawCurrentInstanced(alNum);
+	}
 	
 	//-----------------------------------------------------------------------
 
@@ -2260,6 +2900,14 @@ namespace hpl {
 				if(cMath::CheckPlaneBVCollision(plane, *pBV)==eCollision_Outside) return false;
 			}
 		}
+
+		/////////////////////////////
+		// Software occlusion check
+		if(mbSoftwareOcclusionActive)
+		{
+			cBoundingVolume *pBV = apObject->GetBoundingVolume();
+			if(CheckBVIsSoftwareOccluded(pBV->GetMin(), pBV->GetMax())) return false;
+		}
 		
 		return true;
 	}
@@ -2268,6 +2916,8 @@ namespace hpl {
 
 	bool iRenderer::CheckNodeIsVisible(iRenderableContainerNode *apNode)
 	{
+		if(mbSoftwareOcclusionActive && CheckBVIsSoftwareOccluded(apNode->GetMin(), apNode->GetMax())) return false;
+
 		if(mbOcclusionPlanesActive==false || mvCurrentOcclusionPlanes.empty()) return true;
 
 		// NOTE: This shall always be the user clip planes! The render function ones might not be active when culling is needed and so on.
@@ -2287,6 +2937,117 @@ namespace hpl {
 
 	//-----------------------------------------------------------------------
 
+	void iRenderer::BeginSoftwareOcclusion()
+	{
+		mbSoftwareOcclusionActive = false;
+		if(mbSoftwareOcclusionEnabled==false) return;
+
+		mSoftwareOcclusionBuffer.Clear(cMath::MatrixMul(mpCurrentFrustum->GetProjectionMatrix(), mpCurrentFrustum->GetViewMatrix()));
+
+		////////////////////////////
+		// Get the static objects that cover most of the screen
+		mvSoftwareOccluders.resize(0);
+
+		iRenderableContainer *pContainer = mpCurrentWorld->GetRenderableContainer(eWorldContainerType_Static);
+		pContainer->UpdateBeforeRendering();
+		CollectSoftwareOccluders(pContainer->GetRoot());
+
+		if(mvSoftwareOccluders.empty()) return;
+
+		std::sort(mvSoftwareOccluders.begin(), mvSoftwareOccluders.end());
+
+		////////////////////////////
+		// Rasterize the largest ones first (sorted with smallest first)
+		int lOccluderNum =0;
+		int lTriangleNum =0;
+		for(int i=(int)mvSoftwareOccluders.size()-1; i>=0 && lOccluderNum < kSoftwareOcclusionMaxOccluders; --i)
+		{
+			iRenderable *pObject = mvSoftwareOccluders[i].second;
+			iVertexBuffer *pVtxBuffer = pObject->GetVertexBuffer();
+
+			float *pPositions = pVtxBuffer->GetFloatArray(eVertexBufferElement_Position);
+			unsigned int *pIndices = pVtxBuffer->GetIndices();
+			if(pPositions==NULL || pIndices==NULL) continue;
+
+			int lObjectTriangles = pVtxBuffer->GetIndexNum()/3;
+			if(lTriangleNum + lObjectTriangles > kSoftwareOcclusionMaxTriangles) continue;
+
+			cMatrixf *pMatrix = pObject->GetModelMatrixPtr();
+			mSoftwareOcclusionBuffer.AddOccluder(	pMatrix ? *pMatrix : cMatrixf::Identity,
+													pPositions, pVtxBuffer->GetElementNum(eVertexBufferElement_Position), pVtxBuffer->GetVertexNum(),
+													pIndices, pVtxBuffer->GetIndexNum());
+
+			lTriangleNum += lObjectTriangles;
+			++lOccluderNum;
+		}
+
+		if(mbLog) Log("  Software occlusion: %d occluders with %d triangles\n", lOccluderNum, lTriangleNum);
+
+		mbSoftwareOcclusionActive = mSoftwareOcclusionBuffer.IsEmpty()==false;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void iRenderer::CollectSoftwareOccluders(iRenderableContainerNode *apNode)
+	{
+		apNode->UpdateBeforeUse();
+
+		if(apNode->GetParent())
+		{
+			if(mpCurrentFrustum->CollideNode(apNode)==eCollision_Outside) return;
+			if(CheckNodeIsVisible(apNode)==false) return;
+		}
+
+		if(apNode->HasChildNodes())
+		{
+			tRenderableContainerNodeListIt childIt = apNode->GetChildNodeList()->begin();
+			for(; childIt != apNode->GetChildNodeList()->end(); ++childIt)
+			{
+				CollectSoftwareOccluders(*childIt);
+			}
+		}
+
+		if(apNode->HasObjects()==false) return;
+
+		const cVector3f& vCamPos = mpCurrentFrustum->GetOrigin();
+		float fNearPlane = mpCurrentFrustum->GetNearPlane();
+
+		tRenderableListIt it = apNode->GetObjectList()->begin();
+		for(; it != apNode->GetObjectList()->end(); ++it)
+		{
+			iRenderable *pObject = *it;
+
+			//Only solid meshes, alpha tested or translucent materials have holes.
+			if(pObject->GetRenderType() != eRenderableType_SubMesh) continue;
+			
+			cMaterial *pMaterial = pObject->GetMaterial();
+			if(	pMaterial==NULL || pMaterial->GetType()->IsTranslucent() || pMaterial->GetType()->IsDecal() ||
+				pMaterial->GetAlphaMode() != eMaterialAlphaMode_Solid)
+			{
+				continue;
+			}
+
+			if(CheckObjectIsVisible(pObject, 0)==false) continue;
+
+			cBoundingVolume *pBV = pObject->GetBoundingVolume();
+			float fSize = pBV->GetRadius() / cMath::Max(cMath::Vector3Dist(pBV->GetWorldCenter(), vCamPos), fNearPlane);
+			if(fSize < kSoftwareOcclusionMinOccluderSize) continue;
+
+			if(mpCurrentFrustum->CollideBoundingVolume(pBV)==eCollision_Outside) continue;
+
+			mvSoftwareOccluders.push_back(std::pair<float, iRenderable*>(fSize, pObject));
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool iRenderer::CheckBVIsSoftwareOccluded(const cVector3f& avMin, const cVector3f& avMax)
+	{
+		return mSoftwareOcclusionBuffer.TestAABB(avMin, avMax)==false;
+	}
+
+	//-----------------------------------------------------------------------
+
 	bool iRenderer::CheckFogAreaInsideNearPlane(cMatrixf &a_mtxInvBoxModelMatrix)
 	{
 		cPlanef boxspaceNearPlane = cMath::TransformPlane(a_mtxInvBoxModelMatrix, mpCurrentFrustum->GetPlane(eFrustumPlane_Near));
@@ -78,6 +78,7 @@ namespace hpl {
 	float cRendererDeferred::mfSSAOSkipEdgeLimit = 3.0f;
 	eDeferredSSAO cRendererDeferred::mSSAOType = eDeferredSSAO_OnColorBuffer;
 	bool cRendererDeferred::mbEdgeSmoothLoaded = false;
+	bool cRendererDeferred::mbClusteredLightsLoaded = false;
 	
 	//debug
 	bool cRendererDeferred::mbOcclusionTestLargeLights = true;
@@ -164,6 +165,20 @@ namespace hpl {
 	#define kVar_afFalloffExp						20
 	#define kVar_afDepthDiffMul						21
 	#define kVar_afSkipEdgeLimit					22
+	#define kVar_avClusterGridSize					23
+	#define kVar_avClusterSliceScaleBias			24
+
+	//////////////////////////////////////////////////////////////////////////
+	// CLUSTERED LIGHT DEFINES
+	//////////////////////////////////////////////////////////////////////////
+
+	#define kClusteredMaxLights					256
+	#define kClusteredMaxLightsPerFroxel		32
+	#define kClusteredGridSizeX					16
+	#define kClusteredGridSizeY					9
+	#define kClusteredGridSizeZ					24
+	#define kClusteredIndexTextureWidth			1024
+	#define kClusteredIndexTextureHeight		64
 
 
 	//////////////////////////////////////////////////////////////////////////
@@ -195,6 +210,12 @@ namespace hpl {
 
 		mlMaxBatchLights = 100;
 
+		mpClusteredLightDataTexture = NULL;
+		mpClusteredFroxelTexture = NULL;
+		mpClusteredLightIndexTexture = NULL;
+		mpClusteredFalloffMap = NULL;
+		mpClusteredLightProgram = NULL;
+
 		mbReflectionTextureCleared = false;
 	}
 
@@ -353,6 +374,14 @@ namespace hpl {
 			CreateAndAddShadowMap(eShadowMapResolution_Medium, vShadowSize[lStartSize + eShadowMapResolution_Medium],ePixelFormat_Depth16);
 		for(int i=0; i<6; ++i)
 			CreateAndAddShadowMap(eShadowMapResolution_Low, vShadowSize[lStartSize + eShadowMapResolution_Low],ePixelFormat_Depth16);
+
+		//Atlas with room for 16 high resolution maps, updates limited to two of them each frame.
+		if(GetShadowMapAtlasEnabled())
+		{
+			int lHighSize = vShadowSize[lStartSize + eShadowMapResolution_High].x;
+			CreateShadowMapAtlas(lHighSize*4, ePixelFormat_Depth16);
+			mShadowMapUpdateScheduler.SetMaxTexelsPerFrame(lHighSize*lHighSize*2);
+		}
 		
 		
 		// Select samples depending quality and shader model (if dynamic branching is supported)
@@ -646,6 +675,58 @@ namespace hpl {
 			}
 		}
 
+		////////////////////////////////////
+		//Create clustered light program and textures
+		if(mbClusteredLightsLoaded && mpLowLevelGraphics->GetCaps(eGraphicCaps_TextureFloat)==0)
+		{
+			mbClusteredLightsLoaded = false;
+			Warning("System does not support float textures! Clustered lights are disabled.\n");
+		}
+		if(mbClusteredLightsLoaded)
+		{
+			/////////////////////////////////////
+			// Program
+			cParserVarContainer programVars;
+			programVars.Add("DeferredLight");
+			if(mGBufferType == eDeferredGBuffer_32Bit)	programVars.Add("Deferred_32bit");
+			else										programVars.Add("Deferred_64bit");
+			if(mlNumOfGBufferTextures == 4)				programVars.Add("RenderTargets_4");
+			else										programVars.Add("RenderTargets_3");
+			programVars.Add("ClusteredMaxLights", kClusteredMaxLights);
+			programVars.Add("ClusteredIndexTextureWidth", kClusteredIndexTextureWidth);
+
+			mpClusteredLightProgram = mpGraphics->CreateGpuProgramFromShaders("ClusteredLights","deferred_base_vtx.glsl", "deferred_light_clustered_frag.glsl",&programVars);
+			if(mpClusteredLightProgram)
+			{
+				mpClusteredLightProgram->GetVariableAsId("afNegFarPlane",kVar_afNegFarPlane);
+				mpClusteredLightProgram->GetVariableAsId("avScreenSize",kVar_avScreenSize);
+				mpClusteredLightProgram->GetVariableAsId("avClusterGridSize",kVar_avClusterGridSize);
+				mpClusteredLightProgram->GetVariableAsId("avClusterSliceScaleBias",kVar_avClusterSliceScaleBias);
+			}
+			else
+			{
+				mbClusteredLightsLoaded = false;
+				Warning("Could not load clustered light program! Clustered lights are disabled.\n");
+			}
+		}
+		if(mbClusteredLightsLoaded)
+		{
+			/////////////////////////////////////
+			// Textures
+			mpClusteredLightDataTexture = CreateRenderTexture(	"ClusteredLightData", cVector2l(kClusteredMaxLights, 2), 
+																ePixelFormat_RGBA32, eTextureFilter_Nearest);
+			mpClusteredFroxelTexture = CreateRenderTexture(		"ClusteredFroxels", cVector2l(kClusteredGridSizeX*kClusteredGridSizeY, kClusteredGridSizeZ), 
+																ePixelFormat_LuminanceAlpha32, eTextureFilter_Nearest);
+			mpClusteredLightIndexTexture = CreateRenderTexture(	"ClusteredLightIndices", cVector2l(kClusteredIndexTextureWidth, kClusteredIndexTextureHeight), 
+																ePixelFormat_Luminance32, eTextureFilter_Nearest);
+
+			mvClusteredLightData.resize(kClusteredMaxLights*2*4);
+			mvClusteredFroxelData.resize(kClusteredGridSizeX*kClusteredGridSizeY*kClusteredGridSizeZ*2);
+			mvClusteredLightIndexData.resize(kClusteredIndexTextureWidth*kClusteredIndexTextureHeight);
+
+			mLightFroxelGrid.SetMaxLightsPerFroxel(kClusteredMaxLightsPerFroxel);
+		}
+
 		////////////////////////////////////
 		//Create light shapes
 		tFlag lVtxFlag = eVertexElementFlag_Position | eVertexElementFlag_Color0 | eVertexElementFlag_Texture0;
@@ -758,6 +839,17 @@ namespace hpl {
 			mpGraphics->DestroyGpuProgram(mpEdgeSmooth_UnpackDepthProgram);
 			mpGraphics->DestroyGpuProgram(mpEdgeSmooth_RenderProgram);
 		}
+
+		/////////////////////////////
+		// Clustered lights
+		if(mbClusteredLightsLoaded)
+		{
+			mpGraphics->DestroyTexture(mpClusteredLightDataTexture);
+			mpGraphics->DestroyTexture(mpClusteredFroxelTexture);
+			mpGraphics->DestroyTexture(mpClusteredLightIndexTexture);
+
+			mpGraphics->DestroyGpuProgram(mpClusteredLightProgram);
+		}
 		
 		/////////////////////////
 		//Gpu programs
@@ -834,7 +926,7 @@ namespace hpl {
 	
 	void cRendererDeferred::SetupRenderList()
 	{
-		mpCurrentRenderList->Setup(mfCurrentFrameTime,mpCurrentFrustum);
+		mpCurrentRenderList->Setup(mfCurrentFrameTime,mpCurrentFrustum, mpCurrentWorld->GetJobScheduler());
 	}
 
 		//-----------------------------------------------------------------------
@@ -850,6 +942,9 @@ namespace hpl {
 		tRenderableFlag lVisibleFlags=0;
 		if(mpCurrentSettings->mbIsReflection)	lVisibleFlags |= eRenderableFlag_VisibleInReflection;
 		else									lVisibleFlags |= eRenderableFlag_VisibleInNonReflection;
+
+		//Large static occluders on the CPU, culls before any queries are needed.
+		BeginSoftwareOcclusion();
 		
 		///////////////////////////
 		//Occlusion testing
@@ -857,6 +952,7 @@ namespace hpl {
 		{
 			CheckForVisibleObjectsAddToListAndRenderZ(	mpCurrentSettings->mpVisibleNodeTracker,eObjectVariabilityFlag_All, lVisibleFlags, 
 														true, NULL);
+			EndSoftwareOcclusion();
 
 			AssignAndRenderOcclusionQueryObjects(false, NULL, true);
 
@@ -876,6 +972,7 @@ namespace hpl {
 		{
 			CheckForVisibleAndAddToList(mpCurrentWorld->GetRenderableContainer(eWorldContainerType_Static), lVisibleFlags);
 			CheckForVisibleAndAddToList(mpCurrentWorld->GetRenderableContainer(eWorldContainerType_Dynamic), lVisibleFlags);
+			EndSoftwareOcclusion();
 			
 			mpCurrentRenderList->Compile(	eRenderListCompileFlag_Z |
 											eRenderListCompileFlag_Diffuse |
@@ -987,11 +1084,15 @@ namespace hpl {
 
 		SetTextureRange(NULL,0);
 
-		cRenderableVecIterator zIt = mpCurrentRenderList->GetArrayIterator(eRenderListType_Z);
-		while(zIt.HasNext())
+		////////////////////////////////////
+		//Runs of objects with same vertex buffer and material are drawn instanced
+		tRenderableVec *pZObjects = mpCurrentRenderList->GetSortedArray(eRenderListType_Z);
+		int lNum = (int)pZObjects->size();
+		for(int i=0; i<lNum; )
 		{
-			iRenderable *pObject = zIt.Next();
-			RenderZObject(pObject, NULL);
+			int lRunNum = GetInstanceRunLength(&(*pZObjects)[i], lNum-i, eMaterialRenderMode_Z, NULL);
+			RenderZObjects(&(*pZObjects)[i], lRunNum, NULL);
+			i += lRunNum;
 		}
 
 		END_RENDER_PASS();
@@ -1056,13 +1157,24 @@ namespace hpl {
 
 		
 		////////////////////////////////////
-		//Iterate renderable objects and render to G-Buffer
-		cRenderableVecIterator diffuseIt = mpCurrentRenderList->GetArrayIterator(eRenderListType_Diffuse);
-		while(diffuseIt.HasNext())
+		//Iterate renderable objects and render to G-Buffer. Runs with same vertex buffer and material are drawn instanced.
+		tRenderableVec *pDiffuseObjects = mpCurrentRenderList->GetSortedArray(eRenderListType_Diffuse);
+		int lNum = (int)pDiffuseObjects->size();
+		for(int i=0; i<lNum; )
 		{
-			iRenderable *pObject = diffuseIt.Next();
+			iRenderable *pObject = (*pDiffuseObjects)[i];
 			cMaterial *pMaterial = pObject->GetMaterial();
 
+			int lRunNum = GetInstanceRunLength(&(*pDiffuseObjects)[i], lNum-i, eMaterialRenderMode_Diffuse, NULL);
+			if(lRunNum > 1)
+			{
+				SetMaterialTextures(eMaterialRenderMode_Diffuse, pMaterial);
+				DrawInstancedRun(&(*pDiffuseObjects)[i], lRunNum, eMaterialRenderMode_Diffuse, NULL);
+				i += lRunNum;
+				continue;
+			}
+			++i;
+
 			SetMaterialProgram(eMaterialRenderMode_Diffuse,pMaterial);
 
 			SetMaterialTextures(eMaterialRenderMode_Diffuse, pMaterial);
@@ -1391,6 +1503,8 @@ namespace hpl {
 			if(pLight->GetGoboTexture() || apLightData->mbCastShadows)
 			{
 				cMatrixf mtxFinal = cMath::MatrixMul(pLightSpot->GetViewProjMatrix(), m_mtxInvView);
+				//Lights in the atlas have no gobo, so the tile transform can be added to the matrix.
+				if(apLightData->mbShadowInAtlas) mtxFinal = cMath::MatrixMul(apLightData->m_mtxShadowAtlasTile, mtxFinal);
 				apProgram->SetMatrixf(kVar_a_mtxSpotViewProj, mtxFinal);
 			}
 		}
@@ -1489,15 +1603,40 @@ namespace hpl {
 		iLight *pLight = apLightData->mpLight;
 		eShadowMapResolution shadowMapRes = apLightData->mShadowResolution;
 
-		cShadowMapData *pShadowData = GetShadowMapData(shadowMapRes, pLight);
-		apLightData->mpShadowTexture = pShadowData->mpTexture;
+		cShadowMapAtlasSlot *pAtlasSlot = NULL;
+		if(ShadowMapAtlasIsUsable(pLight)) pAtlasSlot = GetShadowMapAtlasSlot(pLight, GetShadowMapAtlasTileSize(shadowMapRes));
 
-        if(ShadowMapNeedsUpdate(pLight, pShadowData))
+		///////////////////////
+		// Tile in atlas, update decided by scheduler
+		if(pAtlasSlot)
 		{
-			RenderShadowMap(pLight, pShadowData->mpBuffer);
+			apLightData->mpShadowTexture = mpShadowMapAtlasTexture;
+			apLightData->mbShadowInAtlas = true;
+			apLightData->m_mtxShadowAtlasTile = GetShadowMapAtlasTileMatrix(pAtlasSlot);
 
-			//Reset to previous frame buffer
-			SetAccumulationBuffer();
+			if(	apLightData->mbShadowCachedInAtlas==false && 
+				ShadowMapAtlasSlotNeedsUpdate(pLight, pAtlasSlot, apLightData->mfShadowDistance))
+			{
+				RenderShadowMap(pLight, mpShadowMapAtlasBuffer, pAtlasSlot->mvPos, pAtlasSlot->mlSize);
+
+				//Reset to previous frame buffer
+				SetAccumulationBuffer();
+			}
+		}
+		///////////////////////
+		// Separate shadow map
+		else
+		{
+			cShadowMapData *pShadowData = GetShadowMapData(shadowMapRes, pLight);
+			apLightData->mpShadowTexture = pShadowData->mpTexture;
+
+			if(ShadowMapNeedsUpdate(pLight, pShadowData))
+			{
+				RenderShadowMap(pLight, pShadowData->mpBuffer);
+
+				//Reset to previous frame buffer
+				SetAccumulationBuffer();
+			}
 		}
 
 		//Set back G-buffer textures
@@ -1627,7 +1766,9 @@ namespace hpl {
 																						SortFunc_Default, //<- Batches, not used!
 																						
 																						SortFunc_Box,
-																						SortFunc_Box};
+																						SortFunc_Box,
+																						
+																						SortFunc_Default};
 
 	//-----------------------------------------------------------------------
 
@@ -1756,6 +1897,7 @@ namespace hpl {
 					float fDistToLight = cMath::Vector3Dist(mpCurrentFrustum->GetOrigin(), vIntersection);
 					
 					pLightData->mbCastShadows = true;
+					pLightData->mfShadowDistance = fDistToLight;
 					pLightData->mShadowResolution = GetShadowMapResolution(pLight->GetShadowMapResolution(), mpCurrentSettings->mMaxShadowMapResolution);
 					
 					///////////////////////
@@ -1820,6 +1962,22 @@ namespace hpl {
 		{
 			mpLowLevelGraphics->FlushRendering();
 		}
+
+		///////////////////////////////
+		//Gather shadow casters for all shadow casting lights in parallel, used when the lights are rendered.
+		//Lights with a cached static tile in the atlas need no casters.
+		mvTempShadowCastingLights.resize(0);
+		for(size_t i=0; i<mvTempDeferredLights.size(); ++i)
+		{
+			cDeferredLight* pLightData = mvTempDeferredLights[i];
+			if(pLightData->mbCastShadows==false) continue;
+
+			pLightData->mbShadowCachedInAtlas = ShadowMapAtlasHasCachedStaticLight(pLightData->mpLight, 
+																					GetShadowMapAtlasTileSize(pLightData->mShadowResolution));
+			if(pLightData->mbShadowCachedInAtlas==false) mvTempShadowCastingLights.push_back(pLightData->mpLight);
+		}
+		if(mvTempShadowCastingLights.empty()==false)
+			GatherShadowCasters(&mvTempShadowCastingLights[0], (int)mvTempShadowCastingLights.size());
 	}
 
 
@@ -1856,6 +2014,7 @@ namespace hpl {
 		//////////////////////////////
 		//Fill lists
 		mpCurrentSettings->mlNumberOfLightsRendered =0;
+		mpClusteredFalloffMap = NULL;
 		for(size_t i=0; i<mvTempDeferredLights.size(); ++i)
 		{
 			cDeferredLight* pLightData =  mvTempDeferredLights[i];
@@ -1918,6 +2077,14 @@ namespace hpl {
 			
 			mpCurrentSettings->mlNumberOfLightsRendered++;
 
+			////////////////////////
+			//Simple point lights are all rendered in one pass
+			if(mbClusteredLightsLoaded && CanRenderLightClustered(pLightData))
+			{
+				mvSortedLights[eDeferredLightList_Clustered].push_back(pLightData);
+				continue;
+			}
+
 			////////////////////////
 			//Check what list to put light in
 			if(pLightData->mbInsideNearPlane)
@@ -2054,7 +2221,7 @@ namespace hpl {
 
 				//////////////////
 				// Render shadow (if light is caster)
-				if(pLightData->mbCastShadows && SetupShadowMapRendering(pLight))
+				if(pLightData->mbCastShadows && (pLightData->mbShadowCachedInAtlas || SetupShadowMapRendering(pLight)))
 				{
 					if(mbDepthCullLights) 
 					{
@@ -2222,7 +2389,7 @@ namespace hpl {
 				
 				//////////////////
 				// Render shadow (if light is caster)
-				if(pLightData->mbCastShadows && SetupShadowMapRendering(pLight))
+				if(pLightData->mbCastShadows && (pLightData->mbShadowCachedInAtlas || SetupShadowMapRendering(pLight)))
 				{
 					//Setup render modes for shadow map rendering
 					SetCullMode(eCullMode_CounterClockwise);
@@ -2322,7 +2489,7 @@ namespace hpl {
 
 			//////////////////
 			// Render shadow (if light is caster)
-			if(pLightData->mbCastShadows && SetupShadowMapRendering(pLight))
+			if(pLightData->mbCastShadows && (pLightData->mbShadowCachedInAtlas || SetupShadowMapRendering(pLight)))
 			{
 				//Setup render modes for shadow map rendering
 				SetCullMode(eCullMode_CounterClockwise);
@@ -2533,6 +2700,134 @@ namespace hpl {
 	
 	//------------------------------------------------------------------------------
 
+	bool cRendererDeferred::CanRenderLightClustered(cDeferredLight* apLightData)
+	{
+		iLight *pLight = apLightData->mpLight;
+		if(pLight->GetLightType() != eLightType_Point || pLight->GetGoboTexture()) return false;
+		if((int)mvSortedLights[eDeferredLightList_Clustered].size() >= kClusteredMaxLights) return false;
+
+		//All lights in the pass must share falloff map, the first light decides which.
+		if(mpClusteredFalloffMap==NULL) mpClusteredFalloffMap = pLight->GetFalloffMap();
+		
+		return pLight->GetFalloffMap() == mpClusteredFalloffMap;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cRendererDeferred::UploadClusteredLightData()
+	{
+		std::vector<cDeferredLight*>& vLights = mvSortedLights[eDeferredLightList_Clustered];
+
+		//////////////////////////////
+		// Lights, first row has view space position and inverse radius, second row has color
+		for(size_t i=0; i<vLights.size(); ++i)
+		{
+			iLight *pLight = vLights[i]->mpLight;
+			cVector3f vPos = vLights[i]->m_mtxViewSpaceRender.GetTranslation();
+			const cColor& color = pLight->GetDiffuseColor();
+
+			float *pPosData = &mvClusteredLightData[i*4];
+			pPosData[0] = vPos.x;	pPosData[1] = vPos.y;	pPosData[2] = vPos.z;
+			pPosData[3] = 1.0f / pLight->GetRadius();
+
+			float *pColorData = &mvClusteredLightData[(kClusteredMaxLights + i)*4];
+			pColorData[0] = color.r;	pColorData[1] = color.g;	pColorData[2] = color.b;	pColorData[3] = color.a;
+		}
+		mpClusteredLightDataTexture->SetRawData(0, 0, cVector3l(kClusteredMaxLights, 2, 1), ePixelFormat_RGBA32, &mvClusteredLightData[0]);
+
+		//////////////////////////////
+		// Froxels have offset and number of lights in the index list. Lists are cut when index texture is full.
+		int lMaxIndexNum = kClusteredIndexTextureWidth*kClusteredIndexTextureHeight;
+		int lIndexNum =0;
+		for(int i=0; i<mLightFroxelGrid.GetFroxelNum(); ++i)
+		{
+			int lNum = cMath::Min(mLightFroxelGrid.GetFroxelLightNum(i), lMaxIndexNum - lIndexNum);
+			const unsigned short *pLights = mLightFroxelGrid.GetFroxelLights(i);
+
+			mvClusteredFroxelData[i*2 + 0] = (float)lIndexNum;
+			mvClusteredFroxelData[i*2 + 1] = (float)lNum;
+
+			for(int j=0; j<lNum; ++j) mvClusteredLightIndexData[lIndexNum + j] = (float)pLights[j];
+			lIndexNum += lNum;
+		}
+		mpClusteredFroxelTexture->SetRawData(	0, 0, cVector3l(kClusteredGridSizeX*kClusteredGridSizeY, kClusteredGridSizeZ, 1), 
+												ePixelFormat_LuminanceAlpha32, &mvClusteredFroxelData[0]);
+		
+		//Only upload the rows used
+		int lIndexRows = (lIndexNum + kClusteredIndexTextureWidth-1) / kClusteredIndexTextureWidth;
+		if(lIndexRows > 0)
+		{
+			mpClusteredLightIndexTexture->SetRawData(	0, 0, cVector3l(kClusteredIndexTextureWidth, lIndexRows, 1), 
+														ePixelFormat_Luminance32, &mvClusteredLightIndexData[0]);
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cRendererDeferred::RenderLights_Clustered()
+	{
+		std::vector<cDeferredLight*>& vLights = mvSortedLights[eDeferredLightList_Clustered];
+		if(vLights.empty()) return;
+
+		if(mbLog) Log("---\nRendering %d clustered lights\n", (int)vLights.size());
+
+		//////////////////////////////
+		// Bin the lights
+		mLightFroxelGrid.Setup(	mpCurrentFrustum->GetFOV(), mpCurrentFrustum->GetAspect(), mpCurrentFrustum->GetNearPlane(), mfFarPlane,
+								cVector3l(kClusteredGridSizeX, kClusteredGridSizeY, kClusteredGridSizeZ));
+
+		mLightFroxelGrid.ClearLights();
+		for(size_t i=0; i<vLights.size(); ++i)
+		{
+			mLightFroxelGrid.AddLight(vLights[i]->m_mtxViewSpaceRender.GetTranslation(), vLights[i]->mpLight->GetRadius());
+		}
+		mLightFroxelGrid.Bin(mpCurrentWorld->GetJobScheduler());
+
+		if(mbLog && mLightFroxelGrid.GetOverflowNum() > 0)
+			Log(" %d light froxel entries did not fit!\n", mLightFroxelGrid.GetOverflowNum());
+
+		UploadClusteredLightData();
+
+		//////////////////////////////
+		// Render states
+		SetStencilActive(false);
+		SetScissorActive(false);
+		SetDepthTest(false);
+		SetChannelMode(eMaterialChannelMode_RGBA);
+		SetBlendMode(eMaterialBlendMode_Add);
+		SetFlatProjectionMinMax(cVector3f(mfFarLeft,mfFarBottom,-mfFarPlane*1.5f),cVector3f(mfFarRight,mfFarTop,mfFarPlane*1.5f));
+		SetCullMode(eCullMode_CounterClockwise);
+
+		//////////////////////////////
+		// Program and textures
+		SetProgram(mpClusteredLightProgram);
+		mpClusteredLightProgram->SetFloat(kVar_afNegFarPlane, -mfFarPlane);
+		mpClusteredLightProgram->SetVec2f(kVar_avScreenSize, mvScreenSizeFloat);
+		mpClusteredLightProgram->SetVec3f(kVar_avClusterGridSize, cVector3f(kClusteredGridSizeX, kClusteredGridSizeY, kClusteredGridSizeZ));
+		mpClusteredLightProgram->SetVec2f(kVar_avClusterSliceScaleBias, mLightFroxelGrid.GetSliceScale(), mLightFroxelGrid.GetSliceBias());
+
+		SetTexture(4, mpClusteredFalloffMap);
+		SetTexture(5, mpClusteredLightDataTexture);
+		SetTexture(6, mpClusteredFroxelTexture);
+		SetTexture(7, mpClusteredLightIndexTexture);
+
+		//////////////////////////////
+		// Draw all lights
+		SetVertexBuffer(mpFullscreenLightQuad);
+		DrawCurrent();
+
+		//////////////////////////////
+		// Reset
+		SetNormalFrustumProjection();
+		SetCullMode(eCullMode_Clockwise);
+		SetDepthTest(true);
+		SetTextureRange(NULL, 5);
+
+		if(mbLog) Log("Rendering clustered lights End\n---\n");
+	}
+
+	//-----------------------------------------------------------------------
+
 	void cRendererDeferred::RenderLights()
 	{
 		START_RENDER_PASS(Lights);
@@ -2583,6 +2878,10 @@ namespace hpl {
 		///////////////////////
 		// Simple rendering with no stencil
 		RenderLights_RenderBack();
+
+		///////////////////////
+		// Render all clustered lights in one pass
+		RenderLights_Clustered();
 		
 		///////////////////////
 		// Batch lights and renderer several at a time.
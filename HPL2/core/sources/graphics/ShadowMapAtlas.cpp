@@ -0,0 +1,269 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "graphics/ShadowMapAtlas.h"
+
+#include "math/Math.h"
+
+namespace hpl {
+
+	//////////////////////////////////////////////////////////////////////////
+	// ATLAS CONSTRUCTORS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	cShadowMapAtlas::cShadowMapAtlas(int alSize, int alMinTileSize)
+	{
+		mlMinTileSize = 1;
+		while(mlMinTileSize < alMinTileSize) mlMinTileSize *= 2;
+		
+		mlSize = mlMinTileSize;
+		while(mlSize < alSize) mlSize *= 2;
+
+		mvFreeTiles.resize(GetLevel(mlMinTileSize)+1);
+
+		Clear();
+	}
+
+	//-----------------------------------------------------------------------
+
+	cShadowMapAtlas::~cShadowMapAtlas()
+	{
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// ATLAS PUBLIC METHODS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	bool cShadowMapAtlas::Allocate(int alSize, cVector2l &avPos)
+	{
+		int lTileSize = GetTileSize(alSize);
+		if(lTileSize > mlSize) return false;
+
+		int lLevel = GetLevel(lTileSize);
+		if(mvFreeTiles[lLevel].empty() && SplitLevel(lLevel-1)==false) return false;
+
+		avPos = mvFreeTiles[lLevel].back();
+		mvFreeTiles[lLevel].pop_back();
+
+		mlFreeTexels -= lTileSize*lTileSize;
+
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cShadowMapAtlas::Free(const cVector2l &avPos, int alSize)
+	{
+		int lTileSize = GetTileSize(alSize);
+		int lLevel = GetLevel(lTileSize);
+		cVector2l vPos = avPos;
+
+		mlFreeTexels += lTileSize*lTileSize;
+
+		////////////////////////////
+		//Merge with the siblings as long as all of them are free
+		while(lLevel > 0)
+		{
+			int lParentSize = lTileSize*2;
+			cVector2l vParentPos(vPos.x & ~(lParentSize-1), vPos.y & ~(lParentSize-1));
+
+			bool bAllFree = true;
+			for(int i=0; i<4; ++i)
+			{
+				cVector2l vSiblingPos(vParentPos.x + (i&1)*lTileSize, vParentPos.y + (i>>1)*lTileSize);
+				if(vSiblingPos == vPos) continue;
+				if(FindFreeTile(lLevel, vSiblingPos) < 0)
+				{
+					bAllFree = false;
+					break;
+				}
+			}
+			if(bAllFree==false) break;
+
+			for(int i=0; i<4; ++i)
+			{
+				cVector2l vSiblingPos(vParentPos.x + (i&1)*lTileSize, vParentPos.y + (i>>1)*lTileSize);
+				if(vSiblingPos == vPos) continue;
+				
+				std::vector<cVector2l>& vFree = mvFreeTiles[lLevel];
+				int lIdx = FindFreeTile(lLevel, vSiblingPos);
+				vFree[lIdx] = vFree.back();
+				vFree.pop_back();
+			}
+
+			vPos = vParentPos;
+			lTileSize = lParentSize;
+			--lLevel;
+		}
+
+		mvFreeTiles[lLevel].push_back(vPos);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cShadowMapAtlas::Clear()
+	{
+		for(size_t i=0; i<mvFreeTiles.size(); ++i) mvFreeTiles[i].clear();
+
+		mvFreeTiles[0].push_back(cVector2l(0,0));
+		mlFreeTexels = mlSize*mlSize;
+	}
+
+	//-----------------------------------------------------------------------
+
+	int cShadowMapAtlas::GetTileSize(int alSize)
+	{
+		int lTileSize = mlMinTileSize;
+		while(lTileSize < alSize) lTileSize *= 2;
+		return lTileSize;
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// ATLAS PRIVATE METHODS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	int cShadowMapAtlas::GetLevel(int alTileSize)
+	{
+		int lLevel =0;
+		for(int lSize = mlSize; lSize > alTileSize; lSize /= 2) ++lLevel;
+		return lLevel;
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cShadowMapAtlas::SplitLevel(int alLevel)
+	{
+		if(alLevel < 0) return false;
+		if(mvFreeTiles[alLevel].empty() && SplitLevel(alLevel-1)==false) return false;
+
+		cVector2l vPos = mvFreeTiles[alLevel].back();
+		mvFreeTiles[alLevel].pop_back();
+
+		//Add in reverse so the upper left tile is used first.
+		int lHalfSize = (mlSize >> alLevel) / 2;
+		for(int i=3; i>=0; --i)
+		{
+			mvFreeTiles[alLevel+1].push_back(cVector2l(vPos.x + (i&1)*lHalfSize, vPos.y + (i>>1)*lHalfSize));
+		}
+
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	int cShadowMapAtlas::FindFreeTile(int alLevel, const cVector2l &avPos)
+	{
+		std::vector<cVector2l>& vFree = mvFreeTiles[alLevel];
+		for(size_t i=0; i<vFree.size(); ++i)
+		{
+			if(vFree[i] == avPos) return (int)i;
+		}
+		return -1;
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// SCHEDULER CONSTRUCTORS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	cShadowMapUpdateScheduler::cShadowMapUpdateScheduler()
+	{
+		mlMaxTexelsPerFrame = 1024*1024*2;
+		mfReducedRateStart = 8;
+		mfReducedRateStep = 4;
+		mlMaxUpdateInterval = 8;
+
+		BeginFrame();
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// SCHEDULER PUBLIC METHODS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	void cShadowMapUpdateScheduler::BeginFrame()
+	{
+		mlRenderedTexels =0;
+		mlRenderedNum =0;
+		mlDelayedNum =0;
+	}
+
+	//-----------------------------------------------------------------------
+
+	eShadowMapUpdate cShadowMapUpdateScheduler::Schedule(const cShadowMapUpdateRequest &aRequest)
+	{
+		////////////////////////////
+		//Nothing has changed, keep the map
+		if(aRequest.mbContentValid && aRequest.mbCastersChanged==false) return eShadowMapUpdate_Cached;
+
+		////////////////////////////
+		//Only the casters have changed, check rate and budget. 
+		//Updates delayed for too long are forced so that no map is starved.
+		if(aRequest.mbContentValid && aRequest.mlFramesSinceUpdate < mlMaxUpdateInterval*2)
+		{
+			if(aRequest.mlFramesSinceUpdate < GetUpdateInterval(aRequest.mfDistance))
+			{
+				++mlDelayedNum;
+				return eShadowMapUpdate_Delayed;
+			}
+
+			//At least one update is always allowed, so maps larger than the budget are still rendered.
+			if(mlRenderedNum > 0 && mlRenderedTexels + aRequest.mlTexels > mlMaxTexelsPerFrame)
+			{
+				++mlDelayedNum;
+				return eShadowMapUpdate_Delayed;
+			}
+		}
+
+		////////////////////////////
+		//Render, invalid content is always rendered since the shadow would be wrong otherwise.
+		mlRenderedTexels += aRequest.mlTexels;
+		++mlRenderedNum;
+
+		return eShadowMapUpdate_Render;
+	}
+
+	//-----------------------------------------------------------------------
+
+	int cShadowMapUpdateScheduler::GetUpdateInterval(float afDistance)
+	{
+		if(afDistance <= mfReducedRateStart || mfReducedRateStep <= 0) return 1;
+
+		int lInterval = 2 + (int)((afDistance - mfReducedRateStart) / mfReducedRateStep);
+		return cMath::Max(cMath::Min(lInterval, mlMaxUpdateInterval), 1);
+	}
+
+	//-----------------------------------------------------------------------
+}
@@ -0,0 +1,467 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "graphics/Skinning.h"
+
+#include <cstring>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+	#define HPL_SKINNING_X86
+	#include <emmintrin.h>
+	#include <immintrin.h>
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+		#define HPL_TARGET_AVX2
+	#else
+		#include <cpuid.h>
+		#define HPL_TARGET_AVX2 __attribute__((target("avx2,fma")))
+	#endif
+#endif
+
+namespace hpl {
+
+	//////////////////////////////////////////////////////////////////////////
+	// CPU FEATURES
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+#ifdef HPL_SKINNING_X86
+	static void GetCpuId(int alLeaf, int alSubLeaf, unsigned int *apRegs)
+	{
+	#if defined(_MSC_VER)
+		int vRegs[4];
+		__cpuidex(vRegs, alLeaf, alSubLeaf);
+		for(int i=0; i<4; ++i) apRegs[i] = (unsigned int)vRegs[i];
+	#else
+		__cpuid_count(alLeaf, alSubLeaf, apRegs[0], apRegs[1], apRegs[2], apRegs[3]);
+	#endif
+	}
+
+	static unsigned long long GetXCR0()
+	{
+	#if defined(_MSC_VER)
+		return _xgetbv(0);
+	#else
+		unsigned int lEax, lEdx;
+		__asm__ __volatile__("xgetbv" : "=a"(lEax), "=d"(lEdx) : "c"(0));
+		return ((unsigned long long)lEdx << 32) | lEax;
+	#endif
+	}
+#endif
+
+	//-----------------------------------------------------------------------
+
+	static bool gvKernelSupported[eSkinningKernel_LastEnum];
+
+	static eSkinningKernel DetectKernels()
+	{
+		gvKernelSupported[eSkinningKernel_Scalar] = true;
+		gvKernelSupported[eSkinningKernel_SSE2] = false;
+		gvKernelSupported[eSkinningKernel_AVX2] = false;
+
+	#ifdef HPL_SKINNING_X86
+		unsigned int vRegs[4];
+		GetCpuId(0, 0, vRegs);
+		unsigned int lMaxLeaf = vRegs[0];
+		if(lMaxLeaf < 1) return eSkinningKernel_Scalar;
+
+		GetCpuId(1, 0, vRegs);
+		bool bSSE2 = (vRegs[3] & (1u << 26)) != 0;
+		bool bFMA = (vRegs[2] & (1u << 12)) != 0;
+		bool bOSXSave = (vRegs[2] & (1u << 27)) != 0;
+		bool bAVX = (vRegs[2] & (1u << 28)) != 0;
+
+		gvKernelSupported[eSkinningKernel_SSE2] = bSSE2;
+
+		//AVX2 needs the OS to save the ymm registers too.
+		if(lMaxLeaf >= 7 && bOSXSave && bAVX && bFMA && (GetXCR0() & 0x6) == 0x6)
+		{
+			GetCpuId(7, 0, vRegs);
+			gvKernelSupported[eSkinningKernel_AVX2] = (vRegs[1] & (1u << 5)) != 0;
+		}
+	#endif
+
+		for(int i=eSkinningKernel_LastEnum-1; i>0; --i)
+		{
+			if(gvKernelSupported[i]) return (eSkinningKernel)i;
+		}
+		return eSkinningKernel_Scalar;
+	}
+
+	static eSkinningKernel gBestSkinningKernel = DetectKernels();
+	static eSkinningKernel gSkinningKernel = gBestSkinningKernel;
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// SKINNING STREAMS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	cSkinningStreams::cSkinningStreams()
+	{
+		mlVertexNum = 0;
+		mlMaxInfluences = 0;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cSkinningStreams::Setup(const float *apWeights, const unsigned char *apBones, int alVertexNum)
+	{
+		mlVertexNum = alVertexNum;
+		mlMaxInfluences = 1;
+
+		for(int i=0; i<kMaxSkinningInfluences; ++i)
+		{
+			mvWeights[i].assign(alVertexNum, 0.0f);
+			mvBones[i].assign(alVertexNum, 0);
+		}
+
+		for(int vtx=0; vtx<alVertexNum; ++vtx)
+		{
+			const float *pWeight = &apWeights[vtx*4];
+			const unsigned char *pBone = &apBones[vtx*4];
+
+			//Weights are packed at the start, first 0 ends the list.
+			for(int i=0; i<kMaxSkinningInfluences && pWeight[i]!=0; ++i)
+			{
+				mvWeights[i][vtx] = pWeight[i];
+				mvBones[i][vtx] = pBone[i];
+				if(i+1 > mlMaxInfluences) mlMaxInfluences = i+1;
+			}
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cSkinningStreams::Clear()
+	{
+		mlVertexNum = 0;
+		mlMaxInfluences = 0;
+		for(int i=0; i<kMaxSkinningInfluences; ++i)
+		{
+			mvWeights[i].clear();
+			mvBones[i].clear();
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	cSkinningParams::cSkinningParams()
+	{
+		mpStreams = NULL;
+		mpBoneMatrices = NULL;
+		mpBindPos = NULL;
+		mpBindNormal = NULL;
+		mpBindTangent = NULL;
+		mpSkinPos = NULL;
+		mpSkinNormal = NULL;
+		mpSkinTangent = NULL;
+		mlPosStride = 4;
+		mlStartVertex = 0;
+		mlEndVertex = -1;
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// SCALAR KERNEL
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	static inline void MatrixFloatTransformAdd(float *pDest, const cMatrixf &a_mtxA, const float* pSrc, const float fWeight)
+	{
+		pDest[0] += ( a_mtxA.m[0][0] * pSrc[0] + a_mtxA.m[0][1] * pSrc[1] + a_mtxA.m[0][2] * pSrc[2] + a_mtxA.m[0][3] ) * fWeight;
+		pDest[1] += ( a_mtxA.m[1][0] * pSrc[0] + a_mtxA.m[1][1] * pSrc[1] + a_mtxA.m[1][2] * pSrc[2] + a_mtxA.m[1][3] ) * fWeight;
+		pDest[2] += ( a_mtxA.m[2][0] * pSrc[0] + a_mtxA.m[2][1] * pSrc[1] + a_mtxA.m[2][2] * pSrc[2] + a_mtxA.m[2][3] ) * fWeight;
+	}
+
+	static inline void MatrixFloatRotateAdd(float *pDest, const cMatrixf &a_mtxA, const float* pSrc, const float fWeight)
+	{
+		pDest[0] += ( a_mtxA.m[0][0] * pSrc[0] + a_mtxA.m[0][1] * pSrc[1] + a_mtxA.m[0][2] * pSrc[2] ) * fWeight;
+		pDest[1] += ( a_mtxA.m[1][0] * pSrc[0] + a_mtxA.m[1][1] * pSrc[1] + a_mtxA.m[1][2] * pSrc[2] ) * fWeight;
+		pDest[2] += ( a_mtxA.m[2][0] * pSrc[0] + a_mtxA.m[2][1] * pSrc[1] + a_mtxA.m[2][2] * pSrc[2] ) * fWeight;
+	}
+
+	//-----------------------------------------------------------------------
+
+	static void SkinVerticesScalar(const cSkinningParams& aParams, int alStart, int alEnd)
+	{
+		const cSkinningStreams *pStreams = aParams.mpStreams;
+		const cMatrixf *pBoneMatrices = aParams.mpBoneMatrices;
+
+		for(int vtx=alStart; vtx < alEnd; ++vtx)
+		{
+			//Vertices without any bone are left as they are.
+			if(pStreams->mvWeights[0][vtx]==0) continue;
+
+			const float *pBindPos = &aParams.mpBindPos[vtx*aParams.mlPosStride];
+			const float *pBindNormal = &aParams.mpBindNormal[vtx*3];
+			const float *pBindTangent = &aParams.mpBindTangent[vtx*4];
+			float *pSkinPos = &aParams.mpSkinPos[vtx*aParams.mlPosStride];
+			float *pSkinNormal = &aParams.mpSkinNormal[vtx*3];
+			float *pSkinTangent = &aParams.mpSkinTangent[vtx*4];
+
+			pSkinPos[0] = pSkinPos[1] = pSkinPos[2] = 0;
+			pSkinNormal[0] = pSkinNormal[1] = pSkinNormal[2] = 0;
+			pSkinTangent[0] = pSkinTangent[1] = pSkinTangent[2] = 0;
+
+			for(int i=0; i<pStreams->mlMaxInfluences; ++i)
+			{
+				float fWeight = pStreams->mvWeights[i][vtx];
+				if(fWeight==0) break;
+
+				const cMatrixf &mtxTransform = pBoneMatrices[pStreams->mvBones[i][vtx]];
+
+				MatrixFloatTransformAdd(pSkinPos,mtxTransform, pBindPos, fWeight);
+				MatrixFloatRotateAdd(pSkinNormal,mtxTransform, pBindNormal, fWeight);
+				MatrixFloatRotateAdd(pSkinTangent,mtxTransform, pBindTangent, fWeight);
+			}
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+#ifdef HPL_SKINNING_X86
+
+	//////////////////////////////////////////////////////////////////////////
+	// SSE2 KERNEL
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	static inline void StoreVec3(float *apDest, __m128 aX)
+	{
+		_mm_storel_pi((__m64*)apDest, aX);
+		_mm_store_ss(apDest+2, _mm_movehl_ps(aX, aX));
+	}
+
+	//-----------------------------------------------------------------------
+
+	/**
+	 * Blends the bone matrices of a vertex first and then transforms once with the blended matrix.
+	 * Since skinning is linear this is the same as weighting each transformed vector.
+	 */
+	static void SkinVerticesSSE2(const cSkinningParams& aParams, int alStart, int alEnd)
+	{
+		const cSkinningStreams *pStreams = aParams.mpStreams;
+		const cMatrixf *pBoneMatrices = aParams.mpBoneMatrices;
+		const int lMaxInfluences = pStreams->mlMaxInfluences;
+
+		const float *pWeights[kMaxSkinningInfluences];
+		const unsigned char *pBones[kMaxSkinningInfluences];
+		for(int i=0; i<lMaxInfluences; ++i)
+		{
+			pWeights[i] = &pStreams->mvWeights[i][0];
+			pBones[i] = &pStreams->mvBones[i][0];
+		}
+
+		for(int vtx=alStart; vtx < alEnd; ++vtx)
+		{
+			if(pWeights[0][vtx]==0) continue;
+
+			////////////////////////////
+			// Blend the matrix rows
+			const cMatrixf *pMtx = &pBoneMatrices[pBones[0][vtx]];
+			__m128 vWeight = _mm_set1_ps(pWeights[0][vtx]);
+			__m128 vRow0 = _mm_mul_ps(_mm_loadu_ps(pMtx->m[0]), vWeight);
+			__m128 vRow1 = _mm_mul_ps(_mm_loadu_ps(pMtx->m[1]), vWeight);
+			__m128 vRow2 = _mm_mul_ps(_mm_loadu_ps(pMtx->m[2]), vWeight);
+
+			for(int i=1; i<lMaxInfluences; ++i)
+			{
+				pMtx = &pBoneMatrices[pBones[i][vtx]];
+				vWeight = _mm_set1_ps(pWeights[i][vtx]);
+				vRow0 = _mm_add_ps(vRow0, _mm_mul_ps(_mm_loadu_ps(pMtx->m[0]), vWeight));
+				vRow1 = _mm_add_ps(vRow1, _mm_mul_ps(_mm_loadu_ps(pMtx->m[1]), vWeight));
+				vRow2 = _mm_add_ps(vRow2, _mm_mul_ps(_mm_loadu_ps(pMtx->m[2]), vWeight));
+			}
+
+			//Turn into columns, last one is the translation.
+			__m128 vRow3 = _mm_setzero_ps();
+			_MM_TRANSPOSE4_PS(vRow0, vRow1, vRow2, vRow3);
+
+			////////////////////////////
+			// Transform
+			const float *pBindPos = &aParams.mpBindPos[vtx*aParams.mlPosStride];
+			const float *pBindNormal = &aParams.mpBindNormal[vtx*3];
+			const float *pBindTangent = &aParams.mpBindTangent[vtx*4];
+
+			__m128 vPos = _mm_add_ps(	_mm_add_ps(_mm_mul_ps(vRow0, _mm_set1_ps(pBindPos[0])), _mm_mul_ps(vRow1, _mm_set1_ps(pBindPos[1]))),
+										_mm_add_ps(_mm_mul_ps(vRow2, _mm_set1_ps(pBindPos[2])), vRow3));
+			__m128 vNormal = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vRow0, _mm_set1_ps(pBindNormal[0])), _mm_mul_ps(vRow1, _mm_set1_ps(pBindNormal[1]))),
+										_mm_mul_ps(vRow2, _mm_set1_ps(pBindNormal[2])));
+			__m128 vTangent = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vRow0, _mm_set1_ps(pBindTangent[0])), _mm_mul_ps(vRow1, _mm_set1_ps(pBindTangent[1]))),
+										_mm_mul_ps(vRow2, _mm_set1_ps(pBindTangent[2])));
+
+			StoreVec3(&aParams.mpSkinPos[vtx*aParams.mlPosStride], vPos);
+			StoreVec3(&aParams.mpSkinNormal[vtx*3], vNormal);
+			StoreVec3(&aParams.mpSkinTangent[vtx*4], vTangent);
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// AVX2 KERNEL
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	/**
+	 * Same as the SSE2 kernel, but the first two rows are blended as one 8 wide register and fused multiply-add is used.
+	 */
+	HPL_TARGET_AVX2 static void SkinVerticesAVX2(const cSkinningParams& aParams, int alStart, int alEnd)
+	{
+		const cSkinningStreams *pStreams = aParams.mpStreams;
+		const cMatrixf *pBoneMatrices = aParams.mpBoneMatrices;
+		const int lMaxInfluences = pStreams->mlMaxInfluences;
+
+		const float *pWeights[kMaxSkinningInfluences];
+		const unsigned char *pBones[kMaxSkinningInfluences];
+		for(int i=0; i<lMaxInfluences; ++i)
+		{
+			pWeights[i] = &pStreams->mvWeights[i][0];
+			pBones[i] = &pStreams->mvBones[i][0];
+		}
+
+		for(int vtx=alStart; vtx < alEnd; ++vtx)
+		{
+			if(pWeights[0][vtx]==0) continue;
+
+			////////////////////////////
+			// Blend the matrix rows
+			const cMatrixf *pMtx = &pBoneMatrices[pBones[0][vtx]];
+			__m256 vWeight8 = _mm256_set1_ps(pWeights[0][vtx]);
+			__m256 vRow01 = _mm256_mul_ps(_mm256_loadu_ps(pMtx->m[0]), vWeight8);
+			__m128 vRow2 = _mm_mul_ps(_mm_loadu_ps(pMtx->m[2]), _mm256_castps256_ps128(vWeight8));
+
+			for(int i=1; i<lMaxInfluences; ++i)
+			{
+				pMtx = &pBoneMatrices[pBones[i][vtx]];
+				vWeight8 = _mm256_set1_ps(pWeights[i][vtx]);
+				vRow01 = _mm256_fmadd_ps(_mm256_loadu_ps(pMtx->m[0]), vWeight8, vRow01);
+				vRow2 = _mm_fmadd_ps(_mm_loadu_ps(pMtx->m[2]), _mm256_castps256_ps128(vWeight8), vRow2);
+			}
+
+			__m128 vRow0 = _mm256_castps256_ps128(vRow01);
+			__m128 vRow1 = _mm256_extractf128_ps(vRow01, 1);
+			__m128 vRow3 = _mm_setzero_ps();
+			_MM_TRANSPOSE4_PS(vRow0, vRow1, vRow2, vRow3);
+
+			////////////////////////////
+			// Transform
+			const float *pBindPos = &aParams.mpBindPos[vtx*aParams.mlPosStride];
+			const float *pBindNormal = &aParams.mpBindNormal[vtx*3];
+			const float *pBindTangent = &aParams.mpBindTangent[vtx*4];
+
+			__m128 vPos = _mm_fmadd_ps(vRow0, _mm_set1_ps(pBindPos[0]), vRow3);
+			vPos = _mm_fmadd_ps(vRow1, _mm_set1_ps(pBindPos[1]), vPos);
+			vPos = _mm_fmadd_ps(vRow2, _mm_set1_ps(pBindPos[2]), vPos);
+
+			__m128 vNormal = _mm_mul_ps(vRow0, _mm_set1_ps(pBindNormal[0]));
+			vNormal = _mm_fmadd_ps(vRow1, _mm_set1_ps(pBindNormal[1]), vNormal);
+			vNormal = _mm_fmadd_ps(vRow2, _mm_set1_ps(pBindNormal[2]), vNormal);
+
+			__m128 vTangent = _mm_mul_ps(vRow0, _mm_set1_ps(pBindTangent[0]));
+			vTangent = _mm_fmadd_ps(vRow1, _mm_set1_ps(pBindTangent[1]), vTangent);
+			vTangent = _mm_fmadd_ps(vRow2, _mm_set1_ps(pBindTangent[2]), vTangent);
+
+			StoreVec3(&aParams.mpSkinPos[vtx*aParams.mlPosStride], vPos);
+			StoreVec3(&aParams.mpSkinNormal[vtx*3], vNormal);
+			StoreVec3(&aParams.mpSkinTangent[vtx*4], vTangent);
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+#endif
+
+	//////////////////////////////////////////////////////////////////////////
+	// PUBLIC METHODS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	void cSkinning::SkinVertices(const cSkinningParams& aParams)
+	{
+		SkinVertices(aParams, gSkinningKernel);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cSkinning::SkinVertices(const cSkinningParams& aParams, eSkinningKernel aKernel)
+	{
+		if(aParams.mpStreams==NULL || aParams.mpStreams->IsEmpty()) return;
+
+		int lStart = aParams.mlStartVertex;
+		int lEnd = aParams.mlEndVertex < 0 ? aParams.mpStreams->mlVertexNum : aParams.mlEndVertex;
+		if(lEnd > aParams.mpStreams->mlVertexNum) lEnd = aParams.mpStreams->mlVertexNum;
+		if(lStart >= lEnd) return;
+
+		if(KernelIsSupported(aKernel)==false) aKernel = gBestSkinningKernel;
+
+		switch(aKernel)
+		{
+	#ifdef HPL_SKINNING_X86
+		case eSkinningKernel_AVX2:	SkinVerticesAVX2(aParams, lStart, lEnd);	break;
+		case eSkinningKernel_SSE2:	SkinVerticesSSE2(aParams, lStart, lEnd);	break;
+	#endif
+		default:					SkinVerticesScalar(aParams, lStart, lEnd);	break;
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	eSkinningKernel cSkinning::GetKernel()
+	{
+		return gSkinningKernel;
+	}
+
+	void cSkinning::SetKernel(eSkinningKernel aKernel)
+	{
+		gSkinningKernel = KernelIsSupported(aKernel) ? aKernel : gBestSkinningKernel;
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cSkinning::KernelIsSupported(eSkinningKernel aKernel)
+	{
+		if(aKernel < 0 || aKernel >= eSkinningKernel_LastEnum) return false;
+		return gvKernelSupported[aKernel];
+	}
+
+	//-----------------------------------------------------------------------
+
+	const char* cSkinning::GetKernelName(eSkinningKernel aKernel)
+	{
+		switch(aKernel)
+		{
+		case eSkinningKernel_Scalar:	return "Scalar";
+		case eSkinningKernel_SSE2:		return "SSE2";
+		case eSkinningKernel_AVX2:		return "AVX2";
+		default:						return "Unknown";
+		}
+	}
+
+	//-----------------------------------------------------------------------
+}
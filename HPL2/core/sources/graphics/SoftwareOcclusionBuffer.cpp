@@ -0,0 +1,311 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "graphics/SoftwareOcclusionBuffer.h"
+
+#include "math/Math.h"
+
+#include <cmath>
+#include <algorithm>
+
+namespace hpl {
+
+	//Vertices closer to the eye plane than this (in clip space w) are clipped away.
+	#define kSoftwareOcclusionNearW (0.001f)
+	//Relative depth difference needed for a box to be behind an occluder. Keeps occluders from hiding their own box.
+	#define kSoftwareOcclusionDepthEpsilon (0.0005f)
+
+	//////////////////////////////////////////////////////////////////////////
+	// CONSTRUCTORS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	cSoftwareOcclusionBuffer::cSoftwareOcclusionBuffer()
+	{
+		mlWidth =0;
+		mlHeight =0;
+		m_mtxViewProj = cMatrixf::Identity;
+		mlTriangleNum =0;
+		mlOccludedNum =0;
+
+		SetSize(256, 128);
+	}
+
+	//-----------------------------------------------------------------------
+
+	cSoftwareOcclusionBuffer::~cSoftwareOcclusionBuffer()
+	{
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// PUBLIC METHODS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	void cSoftwareOcclusionBuffer::SetSize(int alWidth, int alHeight)
+	{
+		mlWidth = cMath::Max(alWidth, 1);
+		mlHeight = cMath::Max(alHeight, 1);
+		mvInvDepth.resize(mlWidth*mlHeight);
+
+		Clear(m_mtxViewProj);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cSoftwareOcclusionBuffer::Clear(const cMatrixf& a_mtxViewProj)
+	{
+		m_mtxViewProj = a_mtxViewProj;
+		std::fill(mvInvDepth.begin(), mvInvDepth.end(), 0.0f);
+
+		mlTriangleNum =0;
+		mlOccludedNum =0;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cSoftwareOcclusionBuffer::AddOccluder(	const cMatrixf& a_mtxWorld, const float *apPositions, int alPosStride, int alVertexNum,
+												const unsigned int *apIndices, int alIndexNum)
+	{
+		if(apPositions==NULL || apIndices==NULL || alVertexNum<=0) return;
+
+		////////////////////////////
+		// Transform all vertices to clip space
+		cMatrixf mtxWorldViewProj = cMath::MatrixMul(m_mtxViewProj, a_mtxWorld);
+		mvTransformedPos.resize(alVertexNum*4);
+		for(int i=0; i<alVertexNum; ++i)
+		{
+			const float *pPos = &apPositions[i*alPosStride];
+			float *pOut = &mvTransformedPos[i*4];
+			for(int j=0; j<4; ++j)
+			{
+				pOut[j] =	mtxWorldViewProj.m[j][0]*pPos[0] + mtxWorldViewProj.m[j][1]*pPos[1] +
+							mtxWorldViewProj.m[j][2]*pPos[2] + mtxWorldViewProj.m[j][3];
+			}
+		}
+
+		////////////////////////////
+		// Rasterize triangles
+		for(int i=0; i+2<alIndexNum; i+=3)
+		{
+			unsigned int lIdx0 = apIndices[i], lIdx1 = apIndices[i+1], lIdx2 = apIndices[i+2];
+			if((int)lIdx0 >= alVertexNum || (int)lIdx1 >= alVertexNum || (int)lIdx2 >= alVertexNum) continue;
+
+			RasterizeClipTriangle(&mvTransformedPos[lIdx0*4], &mvTransformedPos[lIdx1*4], &mvTransformedPos[lIdx2*4]);
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cSoftwareOcclusionBuffer::TestAABB(const cVector3f& avMin, const cVector3f& avMax)
+	{
+		if(mlTriangleNum<=0) return true;
+
+		////////////////////////////
+		// Get the screen rect and closest depth of the box
+		cVector2f vScreenMin(99999999.0f), vScreenMax(-99999999.0f);
+		float fMaxInvDepth = 0.0f;
+		for(int i=0; i<8; ++i)
+		{
+			float vCorner[4] = {	(i&1) ? avMax.x : avMin.x,
+									(i&2) ? avMax.y : avMin.y,
+									(i&4) ? avMax.z : avMin.z, 1.0f };
+			float vClip[4];
+			for(int j=0; j<4; ++j)
+			{
+				vClip[j] =	m_mtxViewProj.m[j][0]*vCorner[0] + m_mtxViewProj.m[j][1]*vCorner[1] +
+							m_mtxViewProj.m[j][2]*vCorner[2] + m_mtxViewProj.m[j][3];
+			}
+			if(vClip[3] < kSoftwareOcclusionNearW) return true;
+
+			cVector3f vScreen = ClipToScreen(vClip);
+			vScreenMin.x = cMath::Min(vScreenMin.x, vScreen.x);
+			vScreenMin.y = cMath::Min(vScreenMin.y, vScreen.y);
+			vScreenMax.x = cMath::Max(vScreenMax.x, vScreen.x);
+			vScreenMax.y = cMath::Max(vScreenMax.y, vScreen.y);
+			fMaxInvDepth = cMath::Max(fMaxInvDepth, vScreen.z);
+		}
+
+		////////////////////////////
+		// Get pixels, with one pixel border
+		int lMinX = cMath::Max((int)std::floor(vScreenMin.x) - 1, 0);
+		int lMinY = cMath::Max((int)std::floor(vScreenMin.y) - 1, 0);
+		int lMaxX = cMath::Min((int)std::floor(vScreenMax.x) + 1, mlWidth-1);
+		int lMaxY = cMath::Min((int)std::floor(vScreenMax.y) + 1, mlHeight-1);
+		
+		//Outside of screen, leave it to frustum culling.
+		if(lMinX > lMaxX || lMinY > lMaxY) return true;
+
+		////////////////////////////
+		// Visible as soon as any pixel is further away than the box
+		float fTestInvDepth = fMaxInvDepth * (1.0f + kSoftwareOcclusionDepthEpsilon);
+		for(int y=lMinY; y<=lMaxY; ++y)
+		{
+			const float *pRow = &mvInvDepth[y*mlWidth];
+			for(int x=lMinX; x<=lMaxX; ++x)
+			{
+				if(fTestInvDepth >= pRow[x]) return true;
+			}
+		}
+
+		++mlOccludedNum;
+		return false;
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// PRIVATE METHODS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	static void ClipEdgeAgainstNearW(const float *apA, const float *apB, float *apOut)
+	{
+		float fT = (kSoftwareOcclusionNearW - apA[3]) / (apB[3] - apA[3]);
+		for(int i=0; i<4; ++i) apOut[i] = apA[i] + (apB[i]-apA[i])*fT;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cSoftwareOcclusionBuffer::RasterizeClipTriangle(const float *apV0, const float *apV1, const float *apV2)
+	{
+		const float *pVtx[3] = {apV0, apV1, apV2};
+
+		////////////////////////////
+		// Clip against the near w plane. Gives at most four vertices.
+		float vPoly[4][4];
+		int lPolyNum =0;
+		for(int i=0; i<3; ++i)
+		{
+			const float *pA = pVtx[i];
+			const float *pB = pVtx[(i+1)%3];
+			bool bAInside = pA[3] >= kSoftwareOcclusionNearW;
+			bool bBInside = pB[3] >= kSoftwareOcclusionNearW;
+
+			if(bAInside)
+			{
+				for(int j=0; j<4; ++j) vPoly[lPolyNum][j] = pA[j];
+				++lPolyNum;
+			}
+			if(bAInside != bBInside)
+			{
+				ClipEdgeAgainstNearW(pA, pB, vPoly[lPolyNum]);
+				++lPolyNum;
+			}
+		}
+		if(lPolyNum < 3) return;
+
+		////////////////////////////
+		// Rasterize as a fan
+		cVector3f vScreen[4];
+		for(int i=0; i<lPolyNum; ++i) vScreen[i] = ClipToScreen(vPoly[i]);
+
+		for(int i=2; i<lPolyNum; ++i)
+		{
+			RasterizeTriangle(vScreen[0], vScreen[i-1], vScreen[i]);
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cSoftwareOcclusionBuffer::RasterizeTriangle(const cVector3f& avP0, const cVector3f& avP1, const cVector3f& avP2)
+	{
+		////////////////////////////
+		// Get winding and skip degenerate triangles
+		float fArea = (avP1.x-avP0.x)*(avP2.y-avP0.y) - (avP1.y-avP0.y)*(avP2.x-avP0.x);
+		if(std::fabs(fArea) < 0.0001f) return;
+
+		const cVector3f *pP0 = &avP0;
+		const cVector3f *pP1 = &avP1;
+		const cVector3f *pP2 = &avP2;
+		if(fArea < 0)
+		{
+			pP1 = &avP2;
+			pP2 = &avP1;
+			fArea = -fArea;
+		}
+
+		////////////////////////////
+		// Bounding rect of pixel centers
+		int lMinX = cMath::Max((int)std::ceil(cMath::Min(pP0->x, cMath::Min(pP1->x, pP2->x)) - 0.5f), 0);
+		int lMinY = cMath::Max((int)std::ceil(cMath::Min(pP0->y, cMath::Min(pP1->y, pP2->y)) - 0.5f), 0);
+		int lMaxX = cMath::Min((int)std::floor(cMath::Max(pP0->x, cMath::Max(pP1->x, pP2->x)) - 0.5f), mlWidth-1);
+		int lMaxY = cMath::Min((int)std::floor(cMath::Max(pP0->y, cMath::Max(pP1->y, pP2->y)) - 0.5f), mlHeight-1);
+		if(lMinX > lMaxX || lMinY > lMaxY) return;
+
+		++mlTriangleNum;
+
+		////////////////////////////
+		// Edge functions, each is positive on the inside and weighs the opposite vertex.
+		float fInvArea = 1.0f / fArea;
+		
+		float fA0 = pP1->y - pP2->y, fB0 = pP2->x - pP1->x;
+		float fA1 = pP2->y - pP0->y, fB1 = pP0->x - pP2->x;
+		float fA2 = pP0->y - pP1->y, fB2 = pP1->x - pP0->x;
+
+		float fStartX = (float)lMinX + 0.5f;
+		float fStartY = (float)lMinY + 0.5f;
+		float fRowE0 = fA0*(fStartX - pP1->x) + fB0*(fStartY - pP1->y);
+		float fRowE1 = fA1*(fStartX - pP2->x) + fB1*(fStartY - pP2->y);
+		float fRowE2 = fA2*(fStartX - pP0->x) + fB2*(fStartY - pP0->y);
+
+		//Inverse depth is affine in screen space
+		float fDepthDX = (fA0*pP0->z + fA1*pP1->z + fA2*pP2->z) * fInvArea;
+		float fDepthDY = (fB0*pP0->z + fB1*pP1->z + fB2*pP2->z) * fInvArea;
+		float fRowDepth = (fRowE0*pP0->z + fRowE1*pP1->z + fRowE2*pP2->z) * fInvArea;
+
+		for(int y=lMinY; y<=lMaxY; ++y)
+		{
+			float fE0 = fRowE0, fE1 = fRowE1, fE2 = fRowE2;
+			float fDepth = fRowDepth;
+			float *pRow = &mvInvDepth[y*mlWidth];
+			
+			for(int x=lMinX; x<=lMaxX; ++x)
+			{
+				if(fE0 >= 0 && fE1 >= 0 && fE2 >= 0 && fDepth > pRow[x])
+				{
+					pRow[x] = fDepth;
+				}
+				fE0 += fA0; fE1 += fA1; fE2 += fA2;
+				fDepth += fDepthDX;
+			}
+
+			fRowE0 += fB0; fRowE1 += fB1; fRowE2 += fB2;
+			fRowDepth += fDepthDY;
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	cVector3f cSoftwareOcclusionBuffer::ClipToScreen(const float *apClipPos)
+	{
+		float fInvW = 1.0f / apClipPos[3];
+		return cVector3f(	(apClipPos[0]*fInvW*0.5f + 0.5f) * (float)mlWidth,
+							(apClipPos[1]*fInvW*0.5f + 0.5f) * (float)mlHeight,
+							fInvW);
+	}
+
+	//-----------------------------------------------------------------------
+
+}
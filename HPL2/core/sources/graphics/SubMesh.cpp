@@ -361,6 +361,10 @@ namespace hpl {
 		{
 			Warning("Some vertices in sub mesh '%s' in mesh '%s' are not connected to a bone!\n",GetName().c_str(), mpParent->GetName().c_str());
 		}
+
+		/////////////////////////////////
+		// Transpose into one stream per influence for the skinning kernels
+		mSkinningStreams.Setup(mpVertexWeights, mpVertexBones, mpVtxBuffer->GetVertexNum());
 	}
 
 	//-----------------------------------------------------------------------
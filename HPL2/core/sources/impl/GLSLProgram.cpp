@@ -348,6 +348,20 @@ namespace hpl{
 		return false;
 	}
 
+	//-----------------------------------------------------------------------
+
+	bool cGLSLProgram::SetMatrixfArray(int alVarId, const cMatrixf* apMatrices, int alNum)
+	{
+		if(alVarId<0 || alVarId >= (int)mvParameters.size()) return false;
+
+		if(mlCurrentProgram != mlHandle) Bind();
+
+		//Matrices are tightly packed, so can all be sent at once.
+		glUniformMatrix4fv(mvParameters[alVarId].mlId, alNum, true, apMatrices[0].v);
+
+		return true;
+	}
+
 		
 	//-----------------------------------------------------------------------
 	
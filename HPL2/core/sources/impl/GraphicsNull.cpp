@@ -0,0 +1,432 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "impl/GraphicsNull.h"
+
+#include "impl/LowLevelGraphicsNull.h"
+
+#include "graphics/Bitmap.h"
+
+namespace hpl {
+
+	//////////////////////////////////////////////////////////////////////////
+	// TEXTURE
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	cTextureNull::cTextureNull(const tString &asName, eTextureType aType, eTextureUsage aUsage, cLowLevelGraphicsNull* apLowLevelGraphics)
+		: iTexture(asName,_W(""),aType, aUsage, apLowLevelGraphics)
+	{
+		mpNullGraphics = apLowLevelGraphics;
+	}
+
+	cTextureNull::~cTextureNull()
+	{
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cTextureNull::CreateFromBitmap(cBitmap* pBmp)
+	{
+		SetSizeAndFormat(pBmp->GetSize(), pBmp->GetPixelFormat(), pBmp->GetNumOfImages());
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cTextureNull::CreateAnimFromBitmapVec(std::vector<cBitmap*> *avBitmaps)
+	{
+		if(avBitmaps->empty()) return false;
+
+		cBitmap *pBmp = (*avBitmaps)[0];
+		SetSizeAndFormat(pBmp->GetSize(), pBmp->GetPixelFormat(), (int)avBitmaps->size());
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cTextureNull::CreateCubeFromBitmapVec(std::vector<cBitmap*> *avBitmaps)
+	{
+		if(avBitmaps->size() < 6) return false;
+
+		cBitmap *pBmp = (*avBitmaps)[0];
+		SetSizeAndFormat(pBmp->GetSize(), pBmp->GetPixelFormat(), 6);
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cTextureNull::CreateFromRawData(const cVector3l &avSize,ePixelFormat aPixelFormat, unsigned char *apData)
+	{
+		SetSizeAndFormat(avSize, aPixelFormat, mType == eTextureType_CubeMap ? 6 : 1);
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cTextureNull::SetRawData(	int alLevel, const cVector3l& avOffset, const cVector3l& avSize, 
+									ePixelFormat aPixelFormat, void *apData)
+	{
+		mpNullGraphics->AddCommand(eNullGraphicsCommand_UploadTexture, this, avSize.x * avSize.y * avSize.z * GetBytesPerPixel(aPixelFormat));
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cTextureNull::SetSizeAndFormat(const cVector3l &avSize,ePixelFormat aPixelFormat, int alImageNum)
+	{
+		mvSize = avSize;
+		if(mvSize.z < 1) mvSize.z = 1;
+		mPixelFormat = aPixelFormat;
+
+		mlMemorySize = mvSize.x * mvSize.y * mvSize.z * GetBytesPerPixel(mPixelFormat) * alImageNum;
+		if(mbUseMipMaps) mlMemorySize += mlMemorySize / 3;
+
+		mpNullGraphics->AddCommand(eNullGraphicsCommand_UploadTexture, this, mlMemorySize);
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// VERTEX BUFFER
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	cVertexBufferNull::cVertexBufferNull(	cLowLevelGraphicsNull* apLowLevelGraphics, eVertexBufferType aType,
+											eVertexBufferDrawType aDrawType,eVertexBufferUsageType aUsageType,
+											int alReserveVtxSize,int alReserveIdxSize) :
+		iVertexBufferOpenGL(apLowLevelGraphics, aType, aDrawType, aUsageType, alReserveVtxSize, alReserveIdxSize)
+	{
+		mpNullGraphics = apLowLevelGraphics;
+	}
+
+	cVertexBufferNull::~cVertexBufferNull()
+	{
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cVertexBufferNull::UpdateData(tVertexElementFlag aTypes, bool abIndices)
+	{
+		mpNullGraphics->AddCommand(eNullGraphicsCommand_UploadVertexBuffer, this, GetVertexNum());
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cVertexBufferNull::Draw(eVertexBufferDrawType aDrawType)
+	{
+		int lSize = mlElementNum >= 0 ? mlElementNum : GetIndexNum();
+		mpNullGraphics->AddCommand(eNullGraphicsCommand_Draw, this, lSize);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cVertexBufferNull::DrawIndices(unsigned int *apIndices, int alCount, eVertexBufferDrawType aDrawType)
+	{
+		mpNullGraphics->AddCommand(eNullGraphicsCommand_Draw, this, alCount);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cVertexBufferNull::DrawInstanced(int alInstanceNum, eVertexBufferDrawType aDrawType)
+	{
+		mpNullGraphics->AddCommand(eNullGraphicsCommand_DrawInstanced, this, alInstanceNum);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cVertexBufferNull::Bind()
+	{
+		mpNullGraphics->AddCommand(eNullGraphicsCommand_BindVertexBuffer, this);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cVertexBufferNull::CompileSpecific()
+	{
+		mpNullGraphics->AddCommand(eNullGraphicsCommand_UploadVertexBuffer, this, GetVertexNum());
+	}
+
+	//-----------------------------------------------------------------------
+
+	iVertexBufferOpenGL* cVertexBufferNull::CreateDataCopy(	tVertexElementFlag aFlags, eVertexBufferDrawType aDrawType,
+															eVertexBufferUsageType aUsageType,
+															int alReserveVtxSize,int alReserveIdxSize)
+	{
+		return hplNew( cVertexBufferNull, (mpNullGraphics, mType, aDrawType,aUsageType,alReserveVtxSize,alReserveIdxSize) );
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// FRAME BUFFER
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	cFrameBufferNull::cFrameBufferNull(const tString& asName, cLowLevelGraphicsNull* apLowLevelGraphics) 
+		: iFrameBuffer(asName, apLowLevelGraphics)
+	{
+	}
+
+	cFrameBufferNull::~cFrameBufferNull()
+	{
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cFrameBufferNull::SetTexture2D(int alColorIdx, iTexture *apTexture, int alMipmapLevel)
+	{
+		mpColorBuffer[alColorIdx] = apTexture;
+		if(apTexture) SetFirstSize(apTexture->GetSizeInt2D());
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cFrameBufferNull::SetTexture3D(int alColorIdx, iTexture *apTexture, int alZ, int alMipmapLevel)
+	{
+		mpColorBuffer[alColorIdx] = apTexture;
+		if(apTexture) SetFirstSize(apTexture->GetSizeInt2D());
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cFrameBufferNull::SetTextureCubeMap(int alColorIdx, iTexture *apTexture, int alFace, int alMipmapLevel)
+	{
+		mpColorBuffer[alColorIdx] = apTexture;
+		if(apTexture) SetFirstSize(apTexture->GetSizeInt2D());
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cFrameBufferNull::SetDepthTexture2D(iTexture *apTexture, int alMipmapLevel)
+	{
+		mpDepthBuffer = apTexture;
+		if(apTexture) SetFirstSize(apTexture->GetSizeInt2D());
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cFrameBufferNull::SetDepthTextureCubeMap(iTexture *apTexture, int alFace, int alMipmapLevel)
+	{
+		mpDepthBuffer = apTexture;
+		if(apTexture) SetFirstSize(apTexture->GetSizeInt2D());
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cFrameBufferNull::SetDepthStencilBuffer(iDepthStencilBuffer* apBuffer)
+	{
+		if(apBuffer == NULL)
+		{
+			mpDepthBuffer = NULL;
+			mpStencilBuffer = NULL;
+			return;
+		}
+
+		if(apBuffer->GetDepthBits() > 0)	mpDepthBuffer = apBuffer;
+		if(apBuffer->GetStencilBits() > 0)	mpStencilBuffer = apBuffer;
+
+		SetFirstSize(apBuffer->GetSize());
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cFrameBufferNull::SetFirstSize(const cVector2l& avSize)
+	{
+		if(mvSize.x > -1) return;
+
+		mvSize = avSize;
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// GPU SHADER
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	cGpuShaderNull::cGpuShaderNull(const tString& asName, eGpuShaderType aType)
+		: iGpuShader(asName, _W(""), aType, eGpuProgramFormat_GLSL)
+	{
+	}
+
+	cGpuShaderNull::~cGpuShaderNull()
+	{
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cGpuShaderNull::CreateFromFile(const tWString& asFile, const tString& asEntry, bool abPrintInfoIfFail)
+	{
+		SetFullPath(asFile);
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cGpuShaderNull::CreateFromString(const char *apStringData, const tString& asEntry, bool abPrintInfoIfFail)
+	{
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// GPU PROGRAM
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	//Ids handed out by GetVariableId start here so they never collide with ids set up with GetVariableAsId.
+	static const int kNullProgramFirstFreeVarId = 1024;
+
+	//-----------------------------------------------------------------------
+
+	cGpuProgramNull::cGpuProgramNull(const tString& asName, cLowLevelGraphicsNull* apLowLevelGraphics)
+		: iGpuProgram(asName, eGpuProgramFormat_GLSL)
+	{
+		mpNullGraphics = apLowLevelGraphics;
+		mlNextFreeVarId = kNullProgramFirstFreeVarId;
+	}
+
+	cGpuProgramNull::~cGpuProgramNull()
+	{
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cGpuProgramNull::Bind()
+	{
+		mpNullGraphics->AddCommand(eNullGraphicsCommand_BindProgram, this);
+	}
+
+	//-----------------------------------------------------------------------
+
+	int cGpuProgramNull::GetVariableId(const tString& asName)
+	{
+		tNullProgramVariableMapIt it = m_mapVariables.find(asName);
+		if(it != m_mapVariables.end()) return it->second;
+
+		int lId = mlNextFreeVarId++;
+		m_mapVariables.insert(tNullProgramVariableMap::value_type(asName, lId));
+		return lId;
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cGpuProgramNull::GetVariableAsId(const tString& asName, int alId)
+	{
+		if(alId<0) return false;
+
+		////////////////////////
+		// Check if the variable already has an id, or if the id is taken
+		for(tNullProgramVariableMapIt it = m_mapVariables.begin(); it != m_mapVariables.end(); ++it)
+		{
+			if(it->first == asName) return it->second == alId;
+			if(it->second == alId) return false;
+		}
+
+		m_mapVariables.insert(tNullProgramVariableMap::value_type(asName, alId));
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cGpuProgramNull::SetInt(int alVarId, int alX)
+	{
+		return SetVariable(alVarId, 1);
+	}
+
+	bool cGpuProgramNull::SetFloat(int alVarId, float afX)
+	{
+		return SetVariable(alVarId, 1);
+	}
+
+	bool cGpuProgramNull::SetVec2f(int alVarId, float afX,float afY)
+	{
+		return SetVariable(alVarId, 1);
+	}
+
+	bool cGpuProgramNull::SetVec3f(int alVarId, float afX,float afY,float afZ)
+	{
+		return SetVariable(alVarId, 1);
+	}
+
+	bool cGpuProgramNull::SetVec4f(int alVarId, float afX,float afY,float afZ, float afW)
+	{
+		return SetVariable(alVarId, 1);
+	}
+
+	bool cGpuProgramNull::SetMatrixf(int alVarId, const cMatrixf& mMtx)
+	{
+		return SetVariable(alVarId, 1);
+	}
+
+	bool cGpuProgramNull::SetMatrixf(int alVarId, eGpuShaderMatrix mType, eGpuShaderMatrixOp mOp)
+	{
+		return SetVariable(alVarId, 1);
+	}
+
+	bool cGpuProgramNull::SetMatrixfArray(int alVarId, const cMatrixf* apMatrices, int alNum)
+	{
+		return SetVariable(alVarId, alNum);
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cGpuProgramNull::SetVariable(int alVarId, int alNum)
+	{
+		if(alVarId<0) return false;
+
+		mpNullGraphics->AddCommand(eNullGraphicsCommand_SetProgramVariable, this, alNum);
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// OCCLUSION QUERY
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	cOcclusionQueryNull::cOcclusionQueryNull(cLowLevelGraphicsNull* apLowLevelGraphics)
+	{
+		mpNullGraphics = apLowLevelGraphics;
+		mlSampleCount = 0;
+	}
+
+	cOcclusionQueryNull::~cOcclusionQueryNull()
+	{
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cOcclusionQueryNull::End()
+	{
+		mlSampleCount = mpNullGraphics->GetOcclusionQuerySampleCount();
+		mpNullGraphics->AddCommand(eNullGraphicsCommand_OcclusionQuery, this, (int)mlSampleCount);
+	}
+
+	//-----------------------------------------------------------------------
+
+}
@@ -0,0 +1,637 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "impl/LowLevelGraphicsNull.h"
+
+#include "impl/GraphicsNull.h"
+#include "impl/SDLFontData.h"
+
+#include "graphics/Bitmap.h"
+
+#include "system/LowLevelSystem.h"
+
+#include <string.h>
+
+namespace hpl {
+
+	//////////////////////////////////////////////////////////////////////////
+	// CONSTRUCTORS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	cLowLevelGraphicsNull::cLowLevelGraphicsNull()
+	{
+		mvScreenSize = cVector2l(0,0);
+		mGpuProgramFormat = eGpuProgramFormat_GLSL;
+		mfGammaCorrection = 1.0f;
+		mpFrameBuffer = NULL;
+		mlBatchVertexNum = 0;
+
+		mlOcclusionQuerySampleCount = 1000;
+
+		mbCommandLogActive = false;
+		mlFrameCount = 0;
+
+		ResetCounters();
+	}
+
+	//-----------------------------------------------------------------------
+
+	cLowLevelGraphicsNull::~cLowLevelGraphicsNull()
+	{
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// PUBLIC METHODS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	bool cLowLevelGraphicsNull::Init(	int alWidth, int alHeight, int alDisplay, int alBpp, int abFullscreen, int alMultisampling,
+										eGpuProgramFormat aGpuProgramFormat, const tString& asWindowCaption,
+										const cVector2l& avWindowPos)
+	{
+		mvScreenSize = cVector2l(alWidth, alHeight);
+		mGpuProgramFormat = aGpuProgramFormat;
+
+		Log(" Using null graphics, nothing will be rendered. Screen size: %d x %d\n", alWidth, alHeight);
+
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	int cLowLevelGraphicsNull::GetCaps(eGraphicCaps aType)
+	{
+		switch(aType)
+		{
+		case eGraphicCaps_MaxTextureImageUnits:		return 16;
+		case eGraphicCaps_MaxTextureCoordUnits:		return 8;
+		case eGraphicCaps_MaxUserClipPlanes:		return kMaxClipPlanes;
+		case eGraphicCaps_MaxAnisotropicFiltering:	return 16;
+		case eGraphicCaps_MaxDrawBuffers:			return kMaxDrawColorBuffers;
+		case eGraphicCaps_MaxColorRenderTargets:	return kMaxDrawColorBuffers;
+		case eGraphicCaps_OGL_ATIFragmentShader:	return 0;
+		default:									return 1;
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	iFontData* cLowLevelGraphicsNull::CreateFontData(const tString& asName)
+	{
+		return hplNew(cSDLFontData, (asName, this));
+	}
+
+	//-----------------------------------------------------------------------
+
+	iTexture* cLowLevelGraphicsNull::CreateTexture(const tString& asName, eTextureType aType, eTextureUsage aUsage)
+	{
+		return hplNew(cTextureNull, (asName, aType, aUsage, this));
+	}
+
+	//-----------------------------------------------------------------------
+
+	iVertexBuffer* cLowLevelGraphicsNull::CreateVertexBuffer(	eVertexBufferType aType,
+																eVertexBufferDrawType aDrawType,
+																eVertexBufferUsageType aUsageType,
+																int alReserveVtxSize, int alReserveIdxSize)
+	{
+		return hplNew(cVertexBufferNull, (this, aType, aDrawType, aUsageType, alReserveVtxSize, alReserveIdxSize));
+	}
+
+	//-----------------------------------------------------------------------
+
+	iGpuProgram* cLowLevelGraphicsNull::CreateGpuProgram(const tString& asName)
+	{
+		return hplNew(cGpuProgramNull, (asName, this));
+	}
+
+	//-----------------------------------------------------------------------
+
+	iGpuShader* cLowLevelGraphicsNull::CreateGpuShader(const tString& asName, eGpuShaderType aType)
+	{
+		return hplNew(cGpuShaderNull, (asName, aType));
+	}
+
+	//-----------------------------------------------------------------------
+
+	iFrameBuffer* cLowLevelGraphicsNull::CreateFrameBuffer(const tString& asName)
+	{
+		return hplNew(cFrameBufferNull, (asName, this));
+	}
+
+	//-----------------------------------------------------------------------
+
+	iDepthStencilBuffer* cLowLevelGraphicsNull::CreateDepthStencilBuffer(const cVector2l& avSize, int alDepthBits, int alStencilBits)
+	{
+		return hplNew(cDepthStencilBufferNull, (avSize, alDepthBits, alStencilBits));
+	}
+
+	//-----------------------------------------------------------------------
+
+	iOcclusionQuery* cLowLevelGraphicsNull::CreateOcclusionQuery()
+	{
+		return hplNew(cOcclusionQueryNull, (this));
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cLowLevelGraphicsNull::ClearFrameBuffer(tClearFrameBufferFlag aFlags)
+	{
+		AddCommand(eNullGraphicsCommand_Clear, mpFrameBuffer, (int)aFlags);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cLowLevelGraphicsNull::SetClearColor(const cColor& aCol)
+	{
+		AddCommand(eNullGraphicsCommand_RenderState);
+	}
+
+	void cLowLevelGraphicsNull::SetClearDepth(float afDepth)
+	{
+		AddCommand(eNullGraphicsCommand_RenderState);
+	}
+
+	void cLowLevelGraphicsNull::SetClearStencil(int alVal)
+	{
+		AddCommand(eNullGraphicsCommand_RenderState);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cLowLevelGraphicsNull::CopyFrameBufferToTexure(iTexture* apTex, const cVector2l& avPos,
+														const cVector2l& avSize, const cVector2l& avTexOffset)
+	{
+		AddCommand(eNullGraphicsCommand_CopyFrameBuffer, apTex, avSize.x * avSize.y);
+	}
+
+	//-----------------------------------------------------------------------
+
+	cBitmap* cLowLevelGraphicsNull::CopyFrameBufferToBitmap(const cVector2l& avScreenPos, const cVector2l& avScreenSize)
+	{
+		cVector2l vSize = avScreenSize;
+		if(vSize.x <= 0 || vSize.y <= 0) vSize = mpFrameBuffer ? mpFrameBuffer->GetSize() : mvScreenSize;
+
+		AddCommand(eNullGraphicsCommand_CopyFrameBuffer, NULL, vSize.x * vSize.y);
+
+		cBitmap* pBitmap = hplNew(cBitmap, ());
+		pBitmap->CreateData(cVector3l(vSize.x, vSize.y, 1), ePixelFormat_RGBA, 0, 0);
+		memset(pBitmap->GetData(0,0)->mpData, 0, vSize.x * vSize.y * 4);
+
+		return pBitmap;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cLowLevelGraphicsNull::SwapBuffers()
+	{
+		AddCommand(eNullGraphicsCommand_SwapBuffers);
+
+		for(int i=0; i<eNullGraphicsCommand_LastEnum; ++i)
+		{
+			mvLastFrameCommandCount[i] = mvCommandCount[i];
+			mvLastFrameCommandValueSum[i] = mvCommandValueSum[i];
+			mvCommandCount[i] = 0;
+			mvCommandValueSum[i] = 0;
+		}
+		mvCommandLog.clear();
+
+		++mlFrameCount;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cLowLevelGraphicsNull::SetCurrentFrameBuffer(iFrameBuffer* apFrameBuffer, const cVector2l& avPos, const cVector2l& avSize)
+	{
+		iFrameBuffer* pPrevFameBuffer = mpFrameBuffer;
+		mpFrameBuffer = apFrameBuffer;
+		if(pPrevFameBuffer) pPrevFameBuffer->PostBindUpdate();
+
+		AddCommand(eNullGraphicsCommand_SetFrameBuffer, apFrameBuffer);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cLowLevelGraphicsNull::SetFrameBufferDrawTargets(int* apTargets, int alNumOfTargets)
+	{
+		AddCommand(eNullGraphicsCommand_SetFrameBuffer, mpFrameBuffer, alNumOfTargets);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cLowLevelGraphicsNull::SetColorWriteActive(bool abR, bool abG, bool abB, bool abA)
+	{
+		AddCommand(eNullGraphicsCommand_RenderState);
+	}
+
+	void cLowLevelGraphicsNull::SetDepthWriteActive(bool abX)
+	{
+		AddCommand(eNullGraphicsCommand_RenderState);
+	}
+
+	void cLowLevelGraphicsNull::SetCullActive(bool abX)
+	{
+		AddCommand(eNullGraphicsCommand_RenderState);
+	}
+
+	void cLowLevelGraphicsNull::SetCullMode(eCullMode aMode)
+	{
+		AddCommand(eNullGraphicsCommand_RenderState);
+	}
+
+	void cLowLevelGraphicsNull::SetDepthTestActive(bool abX)
+	{
+		AddCommand(eNullGraphicsCommand_RenderState);
+	}
+
+	void cLowLevelGraphicsNull::SetDepthTestFunc(eDepthTestFunc aFunc)
+	{
+		AddCommand(eNullGraphicsCommand_RenderState);
+	}
+
+	void cLowLevelGraphicsNull::SetAlphaTestActive(bool abX)
+	{
+		AddCommand(eNullGraphicsCommand_RenderState);
+	}
+
+	void cLowLevelGraphicsNull::SetAlphaTestFunc(eAlphaTestFunc aFunc, float afRef)
+	{
+		AddCommand(eNullGraphicsCommand_RenderState);
+	}
+
+	void cLowLevelGraphicsNull::SetStencilActive(bool abX)
+	{
+		AddCommand(eNullGraphicsCommand_RenderState);
+	}
+
+	void cLowLevelGraphicsNull::SetStencilWriteMask(unsigned int alMask)
+	{
+		AddCommand(eNullGraphicsCommand_RenderState);
+	}
+
+	void cLowLevelGraphicsNull::SetStencil(	eStencilFunc aFunc, int alRef, unsigned int aMask,
+											eStencilOp aFailOp, eStencilOp aZFailOp, eStencilOp aZPassOp)
+	{
+		AddCommand(eNullGraphicsCommand_RenderState);
+	}
+
+	void cLowLevelGraphicsNull::SetStencilTwoSide(	eStencilFunc aFrontFunc, eStencilFunc aBackFunc,
+													int alRef, unsigned int aMask,
+													eStencilOp aFrontFailOp, eStencilOp aFrontZFailOp, eStencilOp aFrontZPassOp,
+													eStencilOp aBackFailOp, eStencilOp aBackZFailOp, eStencilOp aBackZPassOp)
+	{
+		AddCommand(eNullGraphicsCommand_RenderState);
+	}
+
+	void cLowLevelGraphicsNull::SetScissorActive(bool abX)
+	{
+		AddCommand(eNullGraphicsCommand_RenderState);
+	}
+
+	void cLowLevelGraphicsNull::SetScissorRect(const cVector2l& avPos, const cVector2l& avSize)
+	{
+		AddCommand(eNullGraphicsCommand_RenderState);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cLowLevelGraphicsNull::SetClipPlane(int alIdx, const cPlanef& aPlane)
+	{
+		mvClipPlanes[alIdx] = aPlane;
+		AddCommand(eNullGraphicsCommand_RenderState);
+	}
+
+	cPlanef cLowLevelGraphicsNull::GetClipPlane(int alIdx)
+	{
+		return mvClipPlanes[alIdx];
+	}
+
+	void cLowLevelGraphicsNull::SetClipPlaneActive(int alIdx, bool abX)
+	{
+		AddCommand(eNullGraphicsCommand_RenderState);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cLowLevelGraphicsNull::SetColor(const cColor& aColor)
+	{
+		AddCommand(eNullGraphicsCommand_RenderState);
+	}
+
+	void cLowLevelGraphicsNull::SetBlendActive(bool abX)
+	{
+		AddCommand(eNullGraphicsCommand_RenderState);
+	}
+
+	void cLowLevelGraphicsNull::SetBlendFunc(eBlendFunc aSrcFactor, eBlendFunc aDestFactor)
+	{
+		AddCommand(eNullGraphicsCommand_RenderState);
+	}
+
+	void cLowLevelGraphicsNull::SetBlendFuncSeparate(	eBlendFunc aSrcFactorColor, eBlendFunc aDestFactorColor,
+														eBlendFunc aSrcFactorAlpha, eBlendFunc aDestFactorAlpha)
+	{
+		AddCommand(eNullGraphicsCommand_RenderState);
+	}
+
+	void cLowLevelGraphicsNull::SetPolygonOffsetActive(bool abX)
+	{
+		AddCommand(eNullGraphicsCommand_RenderState);
+	}
+
+	void cLowLevelGraphicsNull::SetPolygonOffset(float afBias, float afSlopeScaleBias)
+	{
+		AddCommand(eNullGraphicsCommand_RenderState);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cLowLevelGraphicsNull::PushMatrix(eMatrix aMtxType)
+	{
+		AddCommand(eNullGraphicsCommand_Matrix, NULL, (int)aMtxType);
+	}
+
+	void cLowLevelGraphicsNull::PopMatrix(eMatrix aMtxType)
+	{
+		AddCommand(eNullGraphicsCommand_Matrix, NULL, (int)aMtxType);
+	}
+
+	void cLowLevelGraphicsNull::SetIdentityMatrix(eMatrix aMtxType)
+	{
+		AddCommand(eNullGraphicsCommand_Matrix, NULL, (int)aMtxType);
+	}
+
+	void cLowLevelGraphicsNull::SetMatrix(eMatrix aMtxType, const cMatrixf& a_mtxA)
+	{
+		AddCommand(eNullGraphicsCommand_Matrix, NULL, (int)aMtxType);
+	}
+
+	void cLowLevelGraphicsNull::SetOrthoProjection(const cVector2f& avSize, float afMin, float afMax)
+	{
+		AddCommand(eNullGraphicsCommand_Matrix, NULL, (int)eMatrix_Projection);
+	}
+
+	void cLowLevelGraphicsNull::SetOrthoProjection(const cVector3f& avMin, const cVector3f& avMax)
+	{
+		AddCommand(eNullGraphicsCommand_Matrix, NULL, (int)eMatrix_Projection);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cLowLevelGraphicsNull::SetTexture(unsigned int alUnit, iTexture* apTex)
+	{
+		AddCommand(eNullGraphicsCommand_SetTexture, apTex, (int)alUnit);
+	}
+
+	void cLowLevelGraphicsNull::SetActiveTextureUnit(unsigned int alUnit)
+	{
+		AddCommand(eNullGraphicsCommand_RenderState);
+	}
+
+	void cLowLevelGraphicsNull::SetTextureEnv(eTextureParam aParam, int alVal)
+	{
+		AddCommand(eNullGraphicsCommand_RenderState);
+	}
+
+	void cLowLevelGraphicsNull::SetTextureConstantColor(const cColor& aColor)
+	{
+		AddCommand(eNullGraphicsCommand_RenderState);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cLowLevelGraphicsNull::DrawTriangle(tVertexVec& avVtx)
+	{
+		AddCommand(eNullGraphicsCommand_DrawImmediate, NULL, 3);
+	}
+
+	void cLowLevelGraphicsNull::DrawQuad(const cVector3f& avPos, const cVector2f& avSize, const cColor& aColor)
+	{
+		AddCommand(eNullGraphicsCommand_DrawImmediate, NULL, 4);
+	}
+
+	void cLowLevelGraphicsNull::DrawQuad(	const cVector3f& avPos, const cVector2f& avSize,
+											const cVector2f& avMinTexCoord, const cVector2f& avMaxTexCoord,
+											const cColor& aColor)
+	{
+		AddCommand(eNullGraphicsCommand_DrawImmediate, NULL, 4);
+	}
+
+	void cLowLevelGraphicsNull::DrawQuad(	const cVector3f& avPos, const cVector2f& avSize,
+											const cVector2f& avMinTexCoord0, const cVector2f& avMaxTexCoord0,
+											const cVector2f& avMinTexCoord1, const cVector2f& avMaxTexCoord1,
+											const cColor& aColor)
+	{
+		AddCommand(eNullGraphicsCommand_DrawImmediate, NULL, 4);
+	}
+
+	void cLowLevelGraphicsNull::DrawQuad(const tVertexVec& avVtx)
+	{
+		AddCommand(eNullGraphicsCommand_DrawImmediate, NULL, 4);
+	}
+
+	void cLowLevelGraphicsNull::DrawQuad(const tVertexVec& avVtx, const cColor aCol)
+	{
+		AddCommand(eNullGraphicsCommand_DrawImmediate, NULL, 4);
+	}
+
+	void cLowLevelGraphicsNull::DrawQuad(const tVertexVec& avVtx, const float afZ)
+	{
+		AddCommand(eNullGraphicsCommand_DrawImmediate, NULL, 4);
+	}
+
+	void cLowLevelGraphicsNull::DrawQuad(const tVertexVec& avVtx, const float afZ, const cColor& aCol)
+	{
+		AddCommand(eNullGraphicsCommand_DrawImmediate, NULL, 4);
+	}
+
+	void cLowLevelGraphicsNull::DrawQuadMultiTex(const tVertexVec& avVtx, const tVector3fVec& avExtraUvs)
+	{
+		AddCommand(eNullGraphicsCommand_DrawImmediate, NULL, 4);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cLowLevelGraphicsNull::DrawLine(const cVector3f& avBegin, const cVector3f& avEnd, cColor aCol)
+	{
+		AddCommand(eNullGraphicsCommand_DrawImmediate, NULL, 2);
+	}
+
+	void cLowLevelGraphicsNull::DrawLine(const cVector3f& avBegin, const cColor& aBeginCol, const cVector3f& avEnd, const cColor& aEndCol)
+	{
+		AddCommand(eNullGraphicsCommand_DrawImmediate, NULL, 2);
+	}
+
+	void cLowLevelGraphicsNull::DrawBoxMinMax(const cVector3f& avMin, const cVector3f& avMax, cColor aCol)
+	{
+		AddCommand(eNullGraphicsCommand_DrawImmediate, NULL, 24);
+	}
+
+	void cLowLevelGraphicsNull::DrawSphere(const cVector3f& avPos, float afRadius, cColor aCol)
+	{
+		AddCommand(eNullGraphicsCommand_DrawImmediate, NULL, 0);
+	}
+
+	void cLowLevelGraphicsNull::DrawSphere(const cVector3f& avPos, float afRadius, cColor aColX, cColor aColY, cColor aColZ)
+	{
+		AddCommand(eNullGraphicsCommand_DrawImmediate, NULL, 0);
+	}
+
+	void cLowLevelGraphicsNull::DrawLineQuad(const cRect2f& aRect, float afZ, cColor aCol)
+	{
+		AddCommand(eNullGraphicsCommand_DrawImmediate, NULL, 8);
+	}
+
+	void cLowLevelGraphicsNull::DrawLineQuad(const cVector3f& avPos, const cVector2f& avSize, cColor aCol)
+	{
+		AddCommand(eNullGraphicsCommand_DrawImmediate, NULL, 8);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cLowLevelGraphicsNull::AddVertexToBatch(const cVertex* apVtx)
+	{
+		++mlBatchVertexNum;
+	}
+
+	void cLowLevelGraphicsNull::AddVertexToBatch(const cVertex* apVtx, const cVector3f* avTransform)
+	{
+		++mlBatchVertexNum;
+	}
+
+	void cLowLevelGraphicsNull::AddVertexToBatch(const cVertex* apVtx, const cMatrixf* aMtx)
+	{
+		++mlBatchVertexNum;
+	}
+
+	void cLowLevelGraphicsNull::AddVertexToBatch_Size2D(	const cVertex* apVtx, const cVector3f* avTransform,
+														const cColor* apCol, const float& mfW, const float& mfH)
+	{
+		++mlBatchVertexNum;
+	}
+
+	void cLowLevelGraphicsNull::AddVertexToBatch_Raw(const cVector3f& avPos, const cColor& aColor, const cVector3f& avTex)
+	{
+		++mlBatchVertexNum;
+	}
+
+	void cLowLevelGraphicsNull::AddIndexToBatch(int alIndex)
+	{
+	}
+
+	void cLowLevelGraphicsNull::AddTexCoordToBatch(unsigned int alUnit, const cVector3f* apCoord)
+	{
+	}
+
+	void cLowLevelGraphicsNull::SetBatchTextureUnitActive(unsigned int alUnit, bool abActive)
+	{
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cLowLevelGraphicsNull::FlushTriBatch(tVtxBatchFlag aTypeFlags, bool abAutoClear)
+	{
+		AddCommand(eNullGraphicsCommand_DrawImmediate, NULL, mlBatchVertexNum);
+		if(abAutoClear) ClearBatch();
+	}
+
+	void cLowLevelGraphicsNull::FlushQuadBatch(tVtxBatchFlag aTypeFlags, bool abAutoClear)
+	{
+		AddCommand(eNullGraphicsCommand_DrawImmediate, NULL, mlBatchVertexNum);
+		if(abAutoClear) ClearBatch();
+	}
+
+	void cLowLevelGraphicsNull::ClearBatch()
+	{
+		mlBatchVertexNum = 0;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cLowLevelGraphicsNull::AddCommand(eNullGraphicsCommand aType, const void *apObject, int alValue)
+	{
+		++mvCommandCount[aType];
+		mvCommandValueSum[aType] += alValue;
+
+		if(mbCommandLogActive)
+		{
+			mvCommandLog.push_back(cNullGraphicsCommand(aType, apObject, alValue));
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cLowLevelGraphicsNull::ResetCounters()
+	{
+		for(int i=0; i<eNullGraphicsCommand_LastEnum; ++i)
+		{
+			mvCommandCount[i] = 0;
+			mvCommandValueSum[i] = 0;
+			mvLastFrameCommandCount[i] = 0;
+			mvLastFrameCommandValueSum[i] = 0;
+		}
+		mvCommandLog.clear();
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cLowLevelGraphicsNull::LogLastFrameCounters()
+	{
+		Log("Null graphics frame %d:\n", mlFrameCount);
+		for(int i=0; i<eNullGraphicsCommand_LastEnum; ++i)
+		{
+			Log(" %s: %d (value sum: %d)\n",	GetCommandName((eNullGraphicsCommand)i), 
+												mvLastFrameCommandCount[i], mvLastFrameCommandValueSum[i]);
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	const char* cLowLevelGraphicsNull::GetCommandName(eNullGraphicsCommand aType)
+	{
+		switch(aType)
+		{
+		case eNullGraphicsCommand_Clear:				return "Clear";
+		case eNullGraphicsCommand_SwapBuffers:			return "SwapBuffers";
+		case eNullGraphicsCommand_SetFrameBuffer:		return "SetFrameBuffer";
+		case eNullGraphicsCommand_CopyFrameBuffer:		return "CopyFrameBuffer";
+		case eNullGraphicsCommand_RenderState:			return "RenderState";
+		case eNullGraphicsCommand_Matrix:				return "Matrix";
+		case eNullGraphicsCommand_SetTexture:			return "SetTexture";
+		case eNullGraphicsCommand_BindProgram:			return "BindProgram";
+		case eNullGraphicsCommand_SetProgramVariable:	return "SetProgramVariable";
+		case eNullGraphicsCommand_BindVertexBuffer:		return "BindVertexBuffer";
+		case eNullGraphicsCommand_Draw:					return "Draw";
+		case eNullGraphicsCommand_DrawInstanced:		return "DrawInstanced";
+		case eNullGraphicsCommand_DrawImmediate:		return "DrawImmediate";
+		case eNullGraphicsCommand_UploadTexture:		return "UploadTexture";
+		case eNullGraphicsCommand_UploadVertexBuffer:	return "UploadVertexBuffer";
+		case eNullGraphicsCommand_OcclusionQuery:		return "OcclusionQuery";
+		default:										return "Unknown";
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+}
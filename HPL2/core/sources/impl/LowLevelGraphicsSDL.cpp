@@ -446,6 +446,8 @@ namespace hpl {
 
 		Log("  OGL ATIFragmentShader: %d\n", GetCaps(eGraphicCaps_OGL_ATIFragmentShader));
 
+		Log("  Instancing: %d\n", GetCaps(eGraphicCaps_Instancing));
+
 	}
 	//-----------------------------------------------------------------------
 
@@ -545,6 +547,8 @@ namespace hpl {
 			glGetIntegerv(GL_MAX_COLOR_ATTACHMENTS_EXT, &lMax);
 			return lMax;
 		}
+
+		case eGraphicCaps_Instancing:			return GLEW_ARB_draw_instanced ? 1 : 0;
 		}
 		return 0;
 	}
@@ -188,7 +188,9 @@ namespace hpl {
 			
 			if(cResources::GetForceCacheLoadingAndSkipSaving() || mshDate > currentDate || cPlatform::FileExists(asFile)==false)
 			{
-				cMesh *pMesh = mpMeshLoaderMSH->LoadMesh(sMSHFile, aFlags);
+				//If the source can be loaded, a cache with other animation compression is re-created.
+				bool bCurrentVersionOnly = cResources::GetForceCacheLoadingAndSkipSaving()==false && cPlatform::FileExists(asFile);
+				cMesh *pMesh = mpMeshLoaderMSH->LoadMesh(sMSHFile, aFlags, bCurrentVersionOnly);
 				if(pMesh)
 				{
 					pMesh->SetFullPath(asFile);//Use dae as full path! (otherwise file will be loaded several times!)
@@ -695,11 +697,11 @@ namespace hpl {
 				//Update the state and end times if needed
 				if(pTrack->GetKeyFrameNum() >0)
 				{
-					cKeyFrame *pFirst = pTrack->GetKeyFrame(0);
-					cKeyFrame *pLast = pTrack->GetKeyFrame(pTrack->GetKeyFrameNum()-1);
+					float fFirstTime = pTrack->GetKeyFrameTime(0);
+					float fLastTime = pTrack->GetKeyFrameTime(pTrack->GetKeyFrameNum()-1);
 
-					if(fStart > pFirst->time)	fStart = pFirst->time;
-					if(fEnd < pLast->time)		fEnd = pLast->time;
+					if(fStart > fFirstTime)	fStart = fFirstTime;
+					if(fEnd < fLastTime)		fEnd = fLastTime;
 				}
 			}
 			
@@ -743,7 +745,7 @@ namespace hpl {
 
 						for(int j = 0; j < pTrack->GetKeyFrameNum(); ++j)
 						{
-							pTrack->GetKeyFrame(j)->trans = pTrack->GetKeyFrame(j)->trans * mfUnitScale;
+							pTrack->SetKeyFrameTrans(j, pTrack->GetKeyFrameTrans(j) * mfUnitScale);
 						}
 					}
 				}
@@ -816,7 +818,9 @@ namespace hpl {
 			if(	cResources::GetForceCacheLoadingAndSkipSaving() ||
 				mshDate > currentDate || cPlatform::FileExists(asFile)==false)
 			{
-				cAnimation *pAnim = mpMeshLoaderMSH->LoadAnimation(sMSHFile);
+				//If the source can be loaded, a cache with other animation compression is re-created.
+				bool bCurrentVersionOnly = cResources::GetForceCacheLoadingAndSkipSaving()==false && cPlatform::FileExists(asFile);
+				cAnimation *pAnim = mpMeshLoaderMSH->LoadAnimation(sMSHFile, bCurrentVersionOnly);
 				if(pAnim)
 				{
 					pAnim->SetFullPath(asFile);//Use dae as full path! (otherwise file will be loaded several times!)
@@ -920,11 +924,11 @@ namespace hpl {
 				//Update the state and end times if needed
 				if(pTrack->GetKeyFrameNum() >0)
 				{
-					cKeyFrame *pFirst = pTrack->GetKeyFrame(0);
-					cKeyFrame *pLast = pTrack->GetKeyFrame(pTrack->GetKeyFrameNum()-1);
+					float fFirstTime = pTrack->GetKeyFrameTime(0);
+					float fLastTime = pTrack->GetKeyFrameTime(pTrack->GetKeyFrameNum()-1);
 
-					if(fStart > pFirst->time)	fStart = pFirst->time;
-					if(fEnd < pLast->time)		fEnd = pLast->time;
+					if(fStart > fFirstTime)	fStart = fFirstTime;
+					if(fEnd < fLastTime)		fEnd = fLastTime;
 				}
 			}
 
@@ -964,7 +968,7 @@ namespace hpl {
 
 					for(int j = 0; j < pTrack->GetKeyFrameNum(); ++j)
 					{
-						pTrack->GetKeyFrame(j)->trans = pTrack->GetKeyFrame(j)->trans * mfUnitScale;
+						pTrack->SetKeyFrameTrans(j, pTrack->GetKeyFrameTrans(j) * mfUnitScale);
 					}
 				}
 			}
@@ -1021,14 +1025,15 @@ namespace hpl {
 						cVector3f vTransChange = mtxLocal.GetTranslation() - mtxBone.GetTranslation();
 						
 						cAnimationTrack * pTrack = apAnimation->CreateTrack(pBone->GetName(),eAnimTransformFlag_Rotate | eAnimTransformFlag_Translate);
-						cKeyFrame *pFrame = pTrack->CreateKeyFrame(0);
+						int lFrameIdx = pTrack->CreateKeyFrame(0);
 
 						//Translation
-						pFrame->trans = vTransChange;
+						pTrack->SetKeyFrameTrans(lFrameIdx, vTransChange);
 						
 						//Quaternion
-						pFrame->rotation = cQuaternion::Identity;
-						pFrame->rotation.FromRotationMatrix(mtxRotChange);
+						cQuaternion qRot = cQuaternion::Identity;
+						qRot.FromRotationMatrix(mtxRotChange);
+						pTrack->SetKeyFrameRotation(lFrameIdx, qRot);
 					}
 					else
 					{
@@ -1051,17 +1056,18 @@ namespace hpl {
 				{
 					cAnimationTrack * pTrack = apAnimation->CreateTrack(pNode->msId, eAnimTransformFlag_Rotate | eAnimTransformFlag_Translate);
 					pTrack->SetNodeIndex(-1);
-					cKeyFrame *pFrame = pTrack->CreateKeyFrame(0);
+					int lFrameIdx = pTrack->CreateKeyFrame(0);
 
 					cMatrixf mtxFrameTransform = pNode->m_mtxTransform;
 					
 					//translation
-					pFrame->trans = mtxFrameTransform.GetTranslation();
+					pTrack->SetKeyFrameTrans(lFrameIdx, mtxFrameTransform.GetTranslation());
 					
 					//Quaternion
 					mtxFrameTransform.SetTranslation(0);
-					pFrame->rotation = cQuaternion::Identity;
-					pFrame->rotation.FromRotationMatrix(mtxFrameTransform);
+					cQuaternion qRot = cQuaternion::Identity;
+					qRot.FromRotationMatrix(mtxFrameTransform);
+					pTrack->SetKeyFrameRotation(lFrameIdx, qRot);
 				}
 				else if(mbZToY || mfUnitScale != 1.0f)
 				{
@@ -1072,12 +1078,14 @@ namespace hpl {
 						if(mbZToY)
 						{
 							cMatrixf mtxRot;
-							pTrack->GetKeyFrame(i)->rotation.ToRotationMatrix(mtxRot);
+							cQuaternion qRot = pTrack->GetKeyFrameRotation(i);
+							qRot.ToRotationMatrix(mtxRot);
 							mtxRot = cMath::MatrixMul(mtxRot, m_mtxZToY);
-							pTrack->GetKeyFrame(i)->rotation.FromRotationMatrix(mtxRot);
+							qRot.FromRotationMatrix(mtxRot);
+							pTrack->SetKeyFrameRotation(i, qRot);
 						}
 
-						pTrack->GetKeyFrame(i)->trans = pTrack->GetKeyFrame(i)->trans * mfUnitScale;
+						pTrack->SetKeyFrameTrans(i, pTrack->GetKeyFrameTrans(i) * mfUnitScale);
 					}
 				}
 			}
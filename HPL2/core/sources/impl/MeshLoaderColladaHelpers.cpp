@@ -538,7 +538,7 @@ namespace hpl {
 		//Iterate the temporary data and add to the track.
 		for(size_t i=0; i < vTempData.size(); i++)
 		{
-			cKeyFrame *pFrame = pTrack->CreateKeyFrame(vTempData[i].mfTime - apScene->mfStartTime);
+			int lFrameIdx = pTrack->CreateKeyFrame(vTempData[i].mfTime - apScene->mfStartTime);
 
 			//////////////////
 			//Get the the node matrix offset
@@ -558,11 +558,11 @@ namespace hpl {
             //Set Translation
 			if(bLoadedTranslation)
 			{
-				pFrame->trans = vTempData[i].mvTrans;
+				pTrack->SetKeyFrameTrans(lFrameIdx, vTempData[i].mvTrans);
 			}
 			else
 			{
-				pFrame->trans = vTransChange;
+				pTrack->SetKeyFrameTrans(lFrameIdx, vTransChange);
 			}
 			
 			///////////////////////////
@@ -576,12 +576,14 @@ namespace hpl {
 				cQuaternion qRot;
 				qRot.FromRotationMatrix(mtxRot);
 
-				pFrame->rotation = qRot;
+				pTrack->SetKeyFrameRotation(lFrameIdx, qRot);
 				//pFrame->base_angles = vRadRot;
 			}
 			else
 			{
-				pFrame->rotation.FromRotationMatrix(mtxRotChange);
+				cQuaternion qRot;
+				qRot.FromRotationMatrix(mtxRotChange);
+				pTrack->SetKeyFrameRotation(lFrameIdx, qRot);
 				//pFrame->base_angles = cMath::MatrixToEulerAngles(mtxRotChange, eEulerRotationOrder_XYZ);
 			}
 		}
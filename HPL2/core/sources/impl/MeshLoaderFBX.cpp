@@ -125,7 +125,9 @@ namespace hpl {
 			
 			if(cResources::GetForceCacheLoadingAndSkipSaving() || mshDate > currentDate || cPlatform::FileExists(asFile)==false)
 			{
-				cMesh *pMesh = mpMeshLoaderMSH->LoadMesh(sMSHFile, aFlags);
+				//If the source can be loaded, a cache with other animation compression is re-created.
+				bool bCurrentVersionOnly = cResources::GetForceCacheLoadingAndSkipSaving()==false && cPlatform::FileExists(asFile);
+				cMesh *pMesh = mpMeshLoaderMSH->LoadMesh(sMSHFile, aFlags, bCurrentVersionOnly);
 				if(pMesh)
 				{
 					pMesh->SetFullPath(asFile);//Use dae as full path! (otherwise file will be loaded several times!)
@@ -251,7 +253,9 @@ namespace hpl {
 			if(	cResources::GetForceCacheLoadingAndSkipSaving() ||
 				mshDate > currentDate || cPlatform::FileExists(asFile)==false)
 			{
-				cAnimation *pAnim = mpMeshLoaderMSH->LoadAnimation(sMSHFile);
+				//If the source can be loaded, a cache with other animation compression is re-created.
+				bool bCurrentVersionOnly = cResources::GetForceCacheLoadingAndSkipSaving()==false && cPlatform::FileExists(asFile);
+				cAnimation *pAnim = mpMeshLoaderMSH->LoadAnimation(sMSHFile, bCurrentVersionOnly);
 				if(pAnim)
 				{
 					pAnim->SetFullPath(asFile);//Use dae as full path! (otherwise file will be loaded several times!)
@@ -603,13 +607,14 @@ namespace hpl {
 			{
 				cTempKeyFrameData *data = &vTempKeyFrame[i];
 				
-				cKeyFrame *pKeyFrame = pTrack->CreateKeyFrame(data->mfTime);
-				pKeyFrame->trans = data->vTrans - boneLocal.GetTranslation();
+				int lFrameIdx = pTrack->CreateKeyFrame(data->mfTime);
+				pTrack->SetKeyFrameTrans(lFrameIdx, data->vTrans - boneLocal.GetTranslation());
 				
 				data->qFinalRot.Normalize();
 
-				pKeyFrame->rotation = cMath::QuaternionMul(qInvBoneRot, data->qFinalRot );
-				pKeyFrame->rotation.Normalize();
+				cQuaternion qRotation = cMath::QuaternionMul(qInvBoneRot, data->qFinalRot );
+				qRotation.Normalize();
+				pTrack->SetKeyFrameRotation(lFrameIdx, qRotation);
 			}
 		}
 
@@ -33,6 +33,7 @@
 #include "graphics/SubMesh.h"
 #include "resources/MaterialManager.h"
 #include "resources/MeshManager.h"
+#include "resources/Resources.h"
 #include "graphics/Material.h"
 
 #include "scene/Node3D.h"
@@ -51,6 +52,83 @@ namespace hpl {
 	
 	//-----------------------------------------------------------------------
 
+	//////////////////////////////////////////////////////////////////////////
+	// COMPRESSED KEY FRAMES
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	static const unsigned char kKeyFrameEncoding_ConstantTrans = 0x01;
+	static const unsigned char kKeyFrameEncoding_ConstantRot = 0x02;
+
+	//Largest value the three smallest components of a unit quaternion can have (1/sqrt(2)).
+	static const float kfSmallestThreeRange = 0.70710678f;
+
+	//-----------------------------------------------------------------------
+
+	static unsigned short QuantizeUnitFloat(float afX, int alMaxValue)
+	{
+		int lX = (int)(cMath::Clamp(afX, 0.0f, 1.0f) * (float)alMaxValue + 0.5f);
+		return (unsigned short)lX;
+	}
+
+	//-----------------------------------------------------------------------
+
+	/**
+	 * Stores the rotation as the three smallest components in 15 bits each, plus 2 bits for the index of the largest.
+	 */
+	static void EncodeRotation(const cQuaternion& aqRot, unsigned short *apDest)
+	{
+		cQuaternion qRot = aqRot;
+		qRot.Normalize();
+
+		float vComp[4] = {qRot.v.x, qRot.v.y, qRot.v.z, qRot.w};
+		int lLargest = 0;
+		for(int i=1; i<4; ++i)
+		{
+			if(cMath::Abs(vComp[i]) > cMath::Abs(vComp[lLargest])) lLargest = i;
+		}
+
+		//q and -q are the same rotation, make the largest positive so it can be rebuilt from the others.
+		float fSign = vComp[lLargest] < 0 ? -1.0f : 1.0f;
+		
+		unsigned short vQuant[3];
+		for(int i=0, lOut=0; i<4; ++i)
+		{
+			if(i == lLargest) continue;
+			vQuant[lOut++] = QuantizeUnitFloat((vComp[i]*fSign / kfSmallestThreeRange)*0.5f + 0.5f, 32767);
+		}
+
+		apDest[0] = (unsigned short)((lLargest << 14) | (vQuant[0] >> 1));
+		apDest[1] = (unsigned short)(((vQuant[0] & 1) << 15) | vQuant[1]);
+		apDest[2] = vQuant[2];
+	}
+
+	static cQuaternion DecodeRotation(const unsigned short *apSrc)
+	{
+		int lLargest = apSrc[0] >> 14;
+		unsigned short vQuant[3];
+		vQuant[0] = (unsigned short)(((apSrc[0] & 0x3FFF) << 1) | (apSrc[1] >> 15));
+		vQuant[1] = apSrc[1] & 0x7FFF;
+		vQuant[2] = apSrc[2] & 0x7FFF;
+
+		float vComp[4];
+		float fSqrSum = 0;
+		for(int i=0, lIn=0; i<4; ++i)
+		{
+			if(i == lLargest) continue;
+			vComp[i] = ((float)vQuant[lIn++] / 32767.0f - 0.5f) * 2.0f * kfSmallestThreeRange;
+			fSqrSum += vComp[i]*vComp[i];
+		}
+		vComp[lLargest] = sqrtf(cMath::Max(1.0f - fSqrSum, 0.0f));
+
+		cQuaternion qRot(vComp[3], vComp[0], vComp[1], vComp[2]);
+		qRot.Normalize();
+		return qRot;
+	}
+
+	//-----------------------------------------------------------------------
+
 	//////////////////////////////////////////////////////////////////////////
 	// CONSTRUCTORS
 	//////////////////////////////////////////////////////////////////////////
@@ -85,6 +163,13 @@ namespace hpl {
 	//-----------------------------------------------------------------------
 
 	cMesh* cMeshLoaderMSH::LoadMesh(const tWString& asFile,tMeshLoadFlag aFlags)
+	{
+		return LoadMesh(asFile, aFlags, false);
+	}
+
+	//-----------------------------------------------------------------------
+
+	cMesh* cMeshLoaderMSH::LoadMesh(const tWString& asFile,tMeshLoadFlag aFlags, bool abCurrentVersionOnly)
 	{
 		if(gbLogMSHLoad) Log("------ Loading ---------\n");
 		/////////////////////////////////////////////////
@@ -109,11 +194,8 @@ namespace hpl {
 		}
 
 		//Check so file has he right version
-		if(lVersion != MSH_FORMAT_VERSION)
-		{
-			Error("File '%s' does not have right MSH version!\n", cString::To8Char(asFile).c_str());
-			return NULL;
-		}
+		if(CheckVersion(lVersion, asFile, abCurrentVersionOnly)==false) return NULL;
+		bool bCompressedAnimations = lVersion == MSH_FORMAT_COMPRESSED_ANIMATION_VERSION;
 
 		/////////////////////////////////////////////////
 		// General properties
@@ -300,7 +382,7 @@ namespace hpl {
 
 			for(int i=0; i<lAnimationNum; ++i)
 			{
-				cAnimation *pAnim = GetAnimation(&binBuff, asFile);
+				cAnimation *pAnim = GetAnimation(&binBuff, asFile, bCompressedAnimations);
 				pMesh->AddAnimation(pAnim);
 			}
 		}
@@ -317,10 +399,12 @@ namespace hpl {
 
 		if(gbLogMSHLoad) Log("------ Saving ---------\n");
 
+		bool bCompressAnimations = cResources::GetCompressAnimations();
+
 		////////////////////////////////////////
 		// Header
         binBuff.AddInt32(MSH_FORMAT_MAGIC_NUMBER);
-		binBuff.AddInt32(MSH_FORMAT_VERSION);
+		binBuff.AddInt32(GetCurrentVersion());
 		
 		////////////////////////////////////////
 		// General Data
@@ -476,7 +560,7 @@ namespace hpl {
 
             for(int i=0; i<apMesh->GetAnimationNum(); ++i)
 			{
-				AddAnimation(apMesh->GetAnimation(i), &binBuff);
+				AddAnimation(apMesh->GetAnimation(i), &binBuff, bCompressAnimations);
 			}
 		}
 		
@@ -491,6 +575,13 @@ namespace hpl {
 	//-----------------------------------------------------------------------
 
 	cAnimation* cMeshLoaderMSH::LoadAnimation(const tWString& asFile)
+	{
+		return LoadAnimation(asFile, false);
+	}
+
+	//-----------------------------------------------------------------------
+
+	cAnimation* cMeshLoaderMSH::LoadAnimation(const tWString& asFile, bool abCurrentVersionOnly)
 	{
 		if(gbLogMSHLoad) Log("------ Loading Anim ---------\n");
 		/////////////////////////////////////////////////
@@ -515,15 +606,11 @@ namespace hpl {
 		}
 
 		//Check so file has he right version
-		if(lVersion != MSH_FORMAT_VERSION)
-		{
-			Warning("File '%s' does not have right MSH version!\n", cString::To8Char(asFile).c_str());
-			return NULL;
-		}
+		if(CheckVersion(lVersion, asFile, abCurrentVersionOnly)==false) return NULL;
 
 		/////////////////////////////////////////////////
 		// Animation
-		cAnimation *pAnimation = GetAnimation(&binBuff, asFile);
+		cAnimation *pAnimation = GetAnimation(&binBuff, asFile, lVersion == MSH_FORMAT_COMPRESSED_ANIMATION_VERSION);
 		
 		return pAnimation;
 	}
@@ -536,14 +623,16 @@ namespace hpl {
 
 		if(gbLogMSHLoad) Log("------ Saving ---------\n");
 
+		bool bCompressAnimations = cResources::GetCompressAnimations();
+
 		////////////////////////////////////////
 		// Header
 		binBuff.AddInt32(MSH_FORMAT_MAGIC_NUMBER);
-		binBuff.AddInt32(MSH_FORMAT_VERSION);
+		binBuff.AddInt32(GetCurrentVersion());
 
 		////////////////////////////////////////
 		// Animation
-        AddAnimation(apAnimation, &binBuff);
+        AddAnimation(apAnimation, &binBuff, bCompressAnimations);
 
 		////////////////////////////
 		// Save data
@@ -555,13 +644,40 @@ namespace hpl {
 
 	//-----------------------------------------------------------------------
 
+	int cMeshLoaderMSH::GetCurrentVersion()
+	{
+		return cResources::GetCompressAnimations() ? MSH_FORMAT_COMPRESSED_ANIMATION_VERSION : MSH_FORMAT_VERSION;
+	}
+
+	//-----------------------------------------------------------------------
+
 	//////////////////////////////////////////////////////////////////////////
 	// PRIVATE METHODS
 	//////////////////////////////////////////////////////////////////////////
 
 	//-----------------------------------------------------------------------
 
-	void cMeshLoaderMSH::AddAnimation(cAnimation *apAnimation, cBinaryBuffer* apBuffer)
+	bool cMeshLoaderMSH::CheckVersion(int alVersion, const tWString& asFile, bool abCurrentVersionOnly)
+	{
+		if(alVersion != MSH_FORMAT_VERSION && alVersion != MSH_FORMAT_COMPRESSED_ANIMATION_VERSION)
+		{
+			Error("File '%s' does not have right MSH version!\n", cString::To8Char(asFile).c_str());
+			return false;
+		}
+
+		//Both versions can be read, but a cache saved with the other compression setting is re-created.
+		if(abCurrentVersionOnly && alVersion != GetCurrentVersion())
+		{
+			Log("File '%s' has stale animation compression, re-creating it.\n", cString::To8Char(asFile).c_str());
+			return false;
+		}
+
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cMeshLoaderMSH::AddAnimation(cAnimation *apAnimation, cBinaryBuffer* apBuffer, bool abCompressed)
 	{
 		////////////////////////
 		// General properties
@@ -577,6 +693,33 @@ namespace hpl {
 		{
 			cAnimationTrack *pTrack = apAnimation->GetTrack(track);
 
+			/////////////////////////
+			// Compressed
+			if(abCompressed)
+			{
+				tIntVec vFrames;
+				if(apAnimation->GetKeyFramesReduced())
+				{
+					//Already reduced, doing it again would add to the error.
+					vFrames.resize(pTrack->GetKeyFrameNum());
+					for(size_t i=0; i<vFrames.size(); ++i) vFrames[i] = (int)i;
+				}
+				else
+				{
+					pTrack->GetReducedKeyFrames(&vFrames,	cResources::GetAnimationCompressionTransTolerance(), 
+															cResources::GetAnimationCompressionRotTolerance());
+				}
+
+				apBuffer->AddString(pTrack->GetName());
+				apBuffer->AddShort16(pTrack->GetTransformFlags());
+				apBuffer->AddInt32((int)vFrames.size());
+
+				if(gbLogMSHLoad) Log("  Track %d %s: %d %d (%d)\n", track, pTrack->GetName().c_str(), pTrack->GetTransformFlags(), (int)vFrames.size(), pTrack->GetKeyFrameNum());
+
+				AddCompressedKeyFrames(pTrack, vFrames, apBuffer);
+				continue;
+			}
+
 			/////////////////////////
 			// General Properties
             apBuffer->AddString(pTrack->GetName());
@@ -589,21 +732,21 @@ namespace hpl {
 			// Key Frames
 			for(int frame=0; frame<pTrack->GetKeyFrameNum(); ++frame)
 			{
-				cKeyFrame *pFrame = pTrack->GetKeyFrame(frame);
+				cKeyFrame keyFrame = pTrack->GetKeyFrame(frame);
 
-				//if(gbLogMSHLoad) Log("   Frame%d (%s) (%s, %f) %f\n",	frame, pFrame->trans.ToString().c_str(), 
-				//														pFrame->rotation.v.ToString().c_str(), pFrame->rotation.w, pFrame->time);
+				//if(gbLogMSHLoad) Log("   Frame%d (%s) (%s, %f) %f\n",	frame, keyFrame.trans.ToString().c_str(), 
+				//														keyFrame.rotation.v.ToString().c_str(), keyFrame.rotation.w, keyFrame.time);
 
-                apBuffer->AddFloat32(pFrame->time);
-				apBuffer->AddVector3f(pFrame->trans);
-				apBuffer->AddQuaternion(pFrame->rotation);
+                apBuffer->AddFloat32(keyFrame.time);
+				apBuffer->AddVector3f(keyFrame.trans);
+				apBuffer->AddQuaternion(keyFrame.rotation);
 			}
 		}
 	}
 	
 	//-----------------------------------------------------------------------
 
-	cAnimation* cMeshLoaderMSH::GetAnimation(cBinaryBuffer* apBuffer, const tWString &asFullPath)
+	cAnimation* cMeshLoaderMSH::GetAnimation(cBinaryBuffer* apBuffer, const tWString &asFullPath, bool abCompressed)
 	{
 		/////////////////////////
 		// General Properties
@@ -614,6 +757,7 @@ namespace hpl {
 		
 		cAnimation *pAnimation = hplNew(cAnimation, (cString::To8Char(asFullPath), asFullPath, cString::GetFileName(cString::To8Char(asFullPath))));
 		pAnimation->SetLength(fLength);
+		pAnimation->SetKeyFramesReduced(abCompressed);
 
 		if(gbLogMSHLoad) Log(" Animation %s: %f %d\n", pAnimation->GetName().c_str(), pAnimation->GetLength(), lTrackNum);
 
@@ -633,17 +777,28 @@ namespace hpl {
 			
 			if(gbLogMSHLoad) Log("  Track %d %s: %d %d\n", track, pTrack->GetName().c_str(), pTrack->GetTransformFlags(), lFrameNum);
 
+			if(abCompressed)
+			{
+				GetCompressedKeyFrames(pTrack, lFrameNum, apBuffer);
+				continue;
+			}
+
 			/////////////////////////
 			// Key Frames
 			for(int frame=0; frame<lFrameNum; ++frame)
 			{
-				cKeyFrame *pFrame = pTrack->CreateKeyFrame(apBuffer->GetFloat32());
+				int lFrameIdx = pTrack->CreateKeyFrame(apBuffer->GetFloat32());
+
+				cVector3f vTrans;
+				cQuaternion qRotation;
+				apBuffer->GetVector3f(&vTrans);
+				apBuffer->GetQuaternion(&qRotation);
 
-				apBuffer->GetVector3f(&pFrame->trans);
-				apBuffer->GetQuaternion(&pFrame->rotation);
+				pTrack->SetKeyFrameTrans(lFrameIdx, vTrans);
+				pTrack->SetKeyFrameRotation(lFrameIdx, qRotation);
 				
-				//if(gbLogMSHLoad) Log("   Frame%d (%s) (%s, %f) %f\n",	frame, pFrame->trans.ToString().c_str(), 
-				//														pFrame->rotation.v.ToString().c_str(), pFrame->rotation.w, pFrame->time);
+				//if(gbLogMSHLoad) Log("   Frame%d (%s) (%s, %f) %f\n",	frame, vTrans.ToString().c_str(), 
+				//														qRotation.v.ToString().c_str(), qRotation.w, pTrack->GetKeyFrameTime(lFrameIdx));
 
 			}
 		}
@@ -651,6 +806,180 @@ namespace hpl {
 		return pAnimation;
 	}
 
+	//-----------------------------------------------------------------------
+
+	/**
+	 * Layout: encoding flags, first and last time, the other times as 16 bit fractions between them,
+	 * then translation and rotation. A constant translation / rotation is stored once at full precision,
+	 * otherwise translations are 16 bit per axis inside the track bounds and rotations use smallest three.
+	 */
+	void cMeshLoaderMSH::AddCompressedKeyFrames(cAnimationTrack *apTrack, const tIntVec& avFrames, cBinaryBuffer* apBuffer)
+	{
+		int lFrameNum = (int)avFrames.size();
+		if(lFrameNum==0) return;
+
+		float fTransTolerance = cResources::GetAnimationCompressionTransTolerance();
+		float fRotTolerance = cResources::GetAnimationCompressionRotTolerance();
+
+		////////////////////////
+		// Check for constant values and get bounds
+		const cVector3f& vFirstTrans = apTrack->GetKeyFrameTrans(avFrames[0]);
+		cQuaternion qFirstRot = apTrack->GetKeyFrameRotation(avFrames[0]);
+		qFirstRot.Normalize();
+
+		cVector3f vMin = vFirstTrans;
+		cVector3f vMax = vFirstTrans;
+		bool bConstantTrans = true;
+		bool bConstantRot = true;
+		for(int i=1; i<lFrameNum; ++i)
+		{
+			const cVector3f& vTrans = apTrack->GetKeyFrameTrans(avFrames[i]);
+			cQuaternion qRot = apTrack->GetKeyFrameRotation(avFrames[i]);
+			qRot.Normalize();
+
+			cMath::ExpandAABB(vMin, vMax, vTrans, vTrans);
+			if(cMath::Vector3Dist(vTrans, vFirstTrans) > fTransTolerance) bConstantTrans = false;
+
+			float fRotDot = cMath::Abs(cMath::QuaternionDot(qRot, qFirstRot));
+			if(2.0f * acosf(cMath::Min(fRotDot, 1.0f)) > fRotTolerance) bConstantRot = false;
+		}
+
+		unsigned char lEncoding = 0;
+		if(bConstantTrans)	lEncoding |= kKeyFrameEncoding_ConstantTrans;
+		if(bConstantRot)	lEncoding |= kKeyFrameEncoding_ConstantRot;
+		apBuffer->AddUnsignedChar(lEncoding);
+
+		////////////////////////
+		// Times
+		float fStartTime = apTrack->GetKeyFrameTime(avFrames[0]);
+		float fEndTime = apTrack->GetKeyFrameTime(avFrames[lFrameNum-1]);
+		apBuffer->AddFloat32(fStartTime);
+		if(lFrameNum > 1)
+		{
+			apBuffer->AddFloat32(fEndTime);
+
+			float fTimeMul = fEndTime > fStartTime ? 1.0f / (fEndTime - fStartTime) : 0.0f;
+			std::vector<short> vTimes(lFrameNum-2);
+			for(int i=1; i<lFrameNum-1; ++i)
+			{
+				float fT = (apTrack->GetKeyFrameTime(avFrames[i]) - fStartTime) * fTimeMul;
+				vTimes[i-1] = (short)QuantizeUnitFloat(fT, 65535);
+			}
+			if(vTimes.empty()==false) apBuffer->AddShort16Array(&vTimes[0], vTimes.size());
+		}
+
+		////////////////////////
+		// Translation
+		if(bConstantTrans)
+		{
+			apBuffer->AddVector3f(vFirstTrans);
+		}
+		else
+		{
+			apBuffer->AddVector3f(vMin);
+			apBuffer->AddVector3f(vMax);
+
+			cVector3f vSize = vMax - vMin;
+			std::vector<short> vTrans(lFrameNum*3);
+			for(int i=0; i<lFrameNum; ++i)
+			{
+				cVector3f vPos = apTrack->GetKeyFrameTrans(avFrames[i]) - vMin;
+				for(int j=0; j<3; ++j)
+					vTrans[i*3 + j] = (short)QuantizeUnitFloat(vSize.v[j] > 0 ? vPos.v[j] / vSize.v[j] : 0.0f, 65535);
+			}
+			apBuffer->AddShort16Array(&vTrans[0], vTrans.size());
+		}
+
+		////////////////////////
+		// Rotation
+		if(bConstantRot)
+		{
+			apBuffer->AddQuaternion(qFirstRot);
+		}
+		else
+		{
+			std::vector<unsigned short> vRot(lFrameNum*3);
+			for(int i=0; i<lFrameNum; ++i)
+			{
+				EncodeRotation(apTrack->GetKeyFrameRotation(avFrames[i]), &vRot[i*3]);
+			}
+			apBuffer->AddShort16Array((short*)&vRot[0], vRot.size());
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cMeshLoaderMSH::GetCompressedKeyFrames(cAnimationTrack *apTrack, int alFrameNum, cBinaryBuffer* apBuffer)
+	{
+		if(alFrameNum<=0) return;
+
+		unsigned char lEncoding = apBuffer->GetUnsignedChar();
+
+		////////////////////////
+		// Times
+		apTrack->ResizeKeyFrames(alFrameNum);
+
+		float fStartTime = apBuffer->GetFloat32();
+		apTrack->CreateKeyFrame(fStartTime);
+		if(alFrameNum > 1)
+		{
+			float fEndTime = apBuffer->GetFloat32();
+
+			std::vector<unsigned short> vTimes(alFrameNum-2);
+			if(vTimes.empty()==false) apBuffer->GetShort16Array((short*)&vTimes[0], vTimes.size());
+			for(size_t i=0; i<vTimes.size(); ++i)
+			{
+				apTrack->CreateKeyFrame(fStartTime + (fEndTime - fStartTime) * ((float)vTimes[i] / 65535.0f));
+			}
+
+			apTrack->CreateKeyFrame(fEndTime);
+		}
+
+		////////////////////////
+		// Translation
+		if(lEncoding & kKeyFrameEncoding_ConstantTrans)
+		{
+			cVector3f vTrans;
+			apBuffer->GetVector3f(&vTrans);
+			for(int i=0; i<alFrameNum; ++i) apTrack->SetKeyFrameTrans(i, vTrans);
+		}
+		else
+		{
+			cVector3f vMin, vMax;
+			apBuffer->GetVector3f(&vMin);
+			apBuffer->GetVector3f(&vMax);
+			cVector3f vSize = vMax - vMin;
+
+			std::vector<unsigned short> vTrans(alFrameNum*3);
+			apBuffer->GetShort16Array((short*)&vTrans[0], vTrans.size());
+			for(int i=0; i<alFrameNum; ++i)
+			{
+				cVector3f vPos;
+				for(int j=0; j<3; ++j)
+					vPos.v[j] = vMin.v[j] + vSize.v[j] * ((float)vTrans[i*3 + j] / 65535.0f);
+				apTrack->SetKeyFrameTrans(i, vPos);
+			}
+		}
+
+		////////////////////////
+		// Rotation
+		if(lEncoding & kKeyFrameEncoding_ConstantRot)
+		{
+			cQuaternion qRot;
+			apBuffer->GetQuaternion(&qRot);
+			for(int i=0; i<alFrameNum; ++i) apTrack->SetKeyFrameRotation(i, qRot);
+		}
+		else
+		{
+			std::vector<unsigned short> vRot(alFrameNum*3);
+			apBuffer->GetShort16Array((short*)&vRot[0], vRot.size());
+			for(int i=0; i<alFrameNum; ++i)
+			{
+				apTrack->SetKeyFrameRotation(i, DecodeRotation(&vRot[i*3]));
+			}
+		}
+	}
+
 	//-----------------------------------------------------------------------
 	
 	static tString gsLevelTemp = "";
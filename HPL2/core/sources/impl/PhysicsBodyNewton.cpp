@@ -107,6 +107,9 @@ namespace hpl {
 
 		cPhysicsBodyNewton *pRigidBody = static_cast<cPhysicsBodyNewton*>(apEntity);
 		NewtonBodySetMatrix(pRigidBody->mpNewtonBody, &apEntity->GetLocalMatrix().GetTranspose().m[0][0]);
+
+		//Characters are moved every frame and are never part of cached queries.
+		if(pRigidBody->IsCharacter()==false) pRigidBody->mpWorld->IncBodyLayoutCount();
 	}
 
 	//-----------------------------------------------------------------------
@@ -336,6 +339,10 @@ namespace hpl {
 	{
 		NewtonBodySetFreezeState(mpNewtonBody, 0);
 	}
+	void cPhysicsBodyNewton::Disable()
+	{
+		NewtonBodySetFreezeState(mpNewtonBody, 1);
+	}
 	bool cPhysicsBodyNewton::GetEnabled() const
 	{
 		return NewtonBodyGetSleepState(mpNewtonBody) ==0?true: false;
@@ -449,6 +456,16 @@ namespace hpl {
 
 		pRigidBody->m_mtxLocalTransform.FromTranspose(apMatrix);
 
+		//During simulation children and callbacks are notified once when the world is done.
+		if(iEntity3D::IsTransformBatchOpen())
+		{
+			//Called from all solver threads, the batch list is shared.
+			NewtonWorldCriticalSectionLock(NewtonBodyGetWorld(apBody));
+			pRigidBody->SetTransformUpdatedBatched();
+			NewtonWorldCriticalSectionUnlock(NewtonBodyGetWorld(apBody));
+			return;
+		}
+
 		mbUseCallback = false;
 		pRigidBody->SetTransformUpdated(true);
 		mbUseCallback = true;
@@ -456,15 +473,16 @@ namespace hpl {
 
 	//-----------------------------------------------------------------------
 	
-	//callback for buoyancy
-	static cPlanef gSurfacePlane;
+	//callback for buoyancy, context is the body (no global plane since several solver threads can call this)
 	static int BuoyancyPlaneCallback (const int alCollisionID, void *apContext, 
 									const float* afGlobalSpaceMatrix, float* afGlobalSpacePlane)
 	{
-		afGlobalSpacePlane[0] = gSurfacePlane.a;
-		afGlobalSpacePlane[1] = gSurfacePlane.b;
-		afGlobalSpacePlane[2] = gSurfacePlane.c;
-		afGlobalSpacePlane[3] = gSurfacePlane.d;
+		cPlanef surfacePlane = static_cast<cPhysicsBodyNewton*>(apContext)->SetBuoyancySurface();
+
+		afGlobalSpacePlane[0] = surfacePlane.a;
+		afGlobalSpacePlane[1] = surfacePlane.b;
+		afGlobalSpacePlane[2] = surfacePlane.c;
+		afGlobalSpacePlane[3] = surfacePlane.d;
 		return 1;   
 	} 
 
@@ -487,7 +505,10 @@ namespace hpl {
 			//If not in update list, add body.
 			if(pRigidBody->IsInUpdateList()==false)
 			{
+				//The update list is shared by all solver threads.
+				NewtonWorldCriticalSectionLock(NewtonBodyGetWorld(apBody));
 				pRigidBody->GetWorld()->AddBodyToUpdateList(pRigidBody);	
+				NewtonWorldCriticalSectionUnlock(NewtonBodyGetWorld(apBody));
 			}
 		}
 		
@@ -508,8 +529,6 @@ namespace hpl {
 		{
 			cVector3f vGravity = pRigidBody->mpWorld->GetGravity();
 
-			gSurfacePlane = pRigidBody->mBuoyancy.mSurface;
-			
 			NewtonBodyAddBuoyancyForce( apBody, 
 										pRigidBody->mBuoyancy.mfDensity * pRigidBody->mfBuoyancyDensityMul,
 										pRigidBody->mBuoyancy.mfLinearViscosity,
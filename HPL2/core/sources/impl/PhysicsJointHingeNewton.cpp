@@ -202,7 +202,7 @@ namespace hpl {
 			//Min
 			if (fAngle < mfMinAngle && bSkipLimitCheck ==false)
 			{
-				OnMinLimit();
+				static_cast<cPhysicsWorldNewton*>(mpWorld)->OnJointLimit(this, false);
 				
 				float fRelAngle = fAngle - mfMinAngle;
 
@@ -219,7 +219,7 @@ namespace hpl {
 			//Max
 			else if (fAngle > mfMaxAngle  && bSkipLimitCheck ==false)
 			{
-				OnMaxLimit();
+				static_cast<cPhysicsWorldNewton*>(mpWorld)->OnJointLimit(this, true);
 
 				float fRelAngle = fAngle - mfMaxAngle;
 
@@ -138,7 +138,7 @@ namespace hpl {
 
 		if (fDistance < pScrewJoint->mfMinDistance)
 		{
-			pScrewJoint->OnMinLimit();
+			static_cast<cPhysicsWorldNewton*>(pScrewJoint->mpWorld)->OnJointLimit(pScrewJoint, false);
 
 			pDesc->m_accel = NewtonCorkscrewCalculateStopAccel (pScrew, pDesc, pScrewJoint->mfMinDistance);
 			pDesc->m_minFriction =0;
@@ -146,7 +146,7 @@ namespace hpl {
 		} 
 		else if (fDistance > pScrewJoint->mfMaxDistance)
 		{
-			pScrewJoint->OnMaxLimit();
+			static_cast<cPhysicsWorldNewton*>(pScrewJoint->mpWorld)->OnJointLimit(pScrewJoint, true);
 
 			pDesc->m_accel = NewtonCorkscrewCalculateStopAccel (pScrew, pDesc, pScrewJoint->mfMaxDistance);
 			pDesc->m_maxFriction =0;
@@ -135,7 +135,7 @@ namespace hpl {
 
 		if (fDistance < pSliderJoint->mfMinDistance)
 		{
-			pSliderJoint->OnMinLimit();
+			static_cast<cPhysicsWorldNewton*>(pSliderJoint->mpWorld)->OnJointLimit(pSliderJoint, false);
 
 			pDesc->m_accel = NewtonSliderCalculateStopAccel (pSlider, pDesc, pSliderJoint->mfMinDistance);
 			pDesc->m_minFriction =0;
@@ -148,7 +148,7 @@ namespace hpl {
 		} 
 		else if (fDistance > pSliderJoint->mfMaxDistance)
 		{
-			pSliderJoint->OnMaxLimit();
+			static_cast<cPhysicsWorldNewton*>(pSliderJoint->mpWorld)->OnJointLimit(pSliderJoint, true);
 			
 			pDesc->m_accel = NewtonSliderCalculateStopAccel (pSlider, pDesc, pSliderJoint->mfMaxDistance);
 			pDesc->m_maxFriction =0;
@@ -258,9 +258,8 @@ namespace hpl {
 		//Log("----- Begin contact between body '%s' and '%s'.\n",mpContactBody1->GetName().c_str(),
 		//													mpContactBody2->GetName().c_str());
 
-		//Thread lock
-		cNewtonLockBodyUntilReturn criticalLock1(apBody1);
-		cNewtonLockBodyUntilReturn criticalLock2(apBody2);
+		//Thread lock, both bodies are in the same world and the lock can not be taken twice.
+		cNewtonLockBodyUntilReturn criticalLock(apBody1);
 		
 		//Call the callbacks
 		if(pContactBody1->OnAABBCollision(pContactBody2)==false) return 0;
@@ -346,64 +345,81 @@ namespace hpl {
 
 		////////////////////////////////
 		//End contact process
-		iPhysicsMaterial *pMaterial1 = pContactBody1->GetMaterial();
-		iPhysicsMaterial *pMaterial2 = pContactBody2->GetMaterial();
-
 		contactData.mvContactNormal = contactData.mvContactNormal / (float)lContactNum;
 		contactData.mvContactPosition = contactData.mvContactPosition / (float)lContactNum;
 
 		//Thread lock
 		NewtonWorldCriticalSectionLock (NewtonBodyGetWorld (pBody0));
-		NewtonWorldCriticalSectionLock (NewtonBodyGetWorld (pBody1));
+
+		cPhysicsWorldNewton *pWorld = static_cast<cPhysicsWorldNewton*>(pContactBody1->GetWorld());
+		if(pWorld->GetDeferSolverEvents())
+		{
+			cPhysicsContactEventNewton event;
+			event.mpBody1 = pContactBody1;
+			event.mpBody2 = pContactBody2;
+			event.mContactData = contactData;
+			event.mlContactNum = lContactNum;
+			pWorld->AddContactEvent(event);
+		}
+		else
+		{
+			ProcessContact(pContactBody1, pContactBody2, &contactData, lContactNum);
+		}
+
+		//Thread unlock
+		NewtonWorldCriticalSectionUnlock (NewtonBodyGetWorld (pBody0));
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cPhysicsMaterialNewton::ProcessContact(cPhysicsBodyNewton *apBody1, cPhysicsBodyNewton *apBody2,
+												cPhysicsContactData *apContactData, int alContactNum)
+	{
+		iPhysicsMaterial *pMaterial1 = apBody1->GetMaterial();
+		iPhysicsMaterial *pMaterial2 = apBody2->GetMaterial();
 
 		////////////////////////////
 		//Surface data stuff
 		//Only do the effects if both bodies uses surfaces effects!
 		if(	pMaterial1->GetSurfaceData() && pMaterial2->GetSurfaceData() &&
-			pContactBody1->GetUseSurfaceEffects() && pContactBody2->GetUseSurfaceEffects() &&
-			pContactBody1->GetBuoyancyActive()==false && pContactBody2->GetBuoyancyActive()==false)
+			apBody1->GetUseSurfaceEffects() && apBody2->GetUseSurfaceEffects() &&
+			apBody1->GetBuoyancyActive()==false && apBody2->GetBuoyancyActive()==false)
 		{
-			pMaterial1->GetSurfaceData()->CreateImpactEffect(contactData.mfMaxContactNormalSpeed,
-																contactData.mvContactPosition,
-																lContactNum,pMaterial2->GetSurfaceData(),
-																pContactBody1->GetWorld());
+			pMaterial1->GetSurfaceData()->CreateImpactEffect(apContactData->mfMaxContactNormalSpeed,
+																apContactData->mvContactPosition,
+																alContactNum,pMaterial2->GetSurfaceData(),
+																apBody1->GetWorld());
 
 			int lPrio1 = pMaterial1->GetSurfaceData()->GetPriority();
 			int lPrio2 = pMaterial2->GetSurfaceData()->GetPriority();
 
 			if(lPrio1 >= lPrio2)
 			{
-				if(std::abs(contactData.mfMaxContactNormalSpeed) > 0)
-					pMaterial1->GetSurfaceData()->OnImpact(contactData.mfMaxContactNormalSpeed,
-															contactData.mvContactPosition,
-															lContactNum,pContactBody1);
-				if(std::abs(contactData.mfMaxContactTangentSpeed) > 0)
-					pMaterial1->GetSurfaceData()->OnSlide(contactData.mfMaxContactTangentSpeed,
-															contactData.mvContactPosition,
-															lContactNum,pContactBody1,pContactBody2);
+				if(std::abs(apContactData->mfMaxContactNormalSpeed) > 0)
+					pMaterial1->GetSurfaceData()->OnImpact(apContactData->mfMaxContactNormalSpeed,
+															apContactData->mvContactPosition,
+															alContactNum,apBody1);
+				if(std::abs(apContactData->mfMaxContactTangentSpeed) > 0)
+					pMaterial1->GetSurfaceData()->OnSlide(apContactData->mfMaxContactTangentSpeed,
+															apContactData->mvContactPosition,
+															alContactNum,apBody1,apBody2);
 			}
 			
 			if(lPrio2 >= lPrio1 && pMaterial2 != pMaterial1)
 			{
-				if(std::abs(contactData.mfMaxContactNormalSpeed) > 0)
-					pMaterial2->GetSurfaceData()->OnImpact(contactData.mfMaxContactNormalSpeed,
-															contactData.mvContactPosition,
-															lContactNum,pContactBody2);
-				if(std::abs(contactData.mfMaxContactTangentSpeed) > 0)
-					pMaterial2->GetSurfaceData()->OnSlide(contactData.mfMaxContactTangentSpeed,
-															contactData.mvContactPosition,
-															lContactNum,pContactBody2,pContactBody1);
+				if(std::abs(apContactData->mfMaxContactNormalSpeed) > 0)
+					pMaterial2->GetSurfaceData()->OnImpact(apContactData->mfMaxContactNormalSpeed,
+															apContactData->mvContactPosition,
+															alContactNum,apBody2);
+				if(std::abs(apContactData->mfMaxContactTangentSpeed) > 0)
+					pMaterial2->GetSurfaceData()->OnSlide(apContactData->mfMaxContactTangentSpeed,
+															apContactData->mvContactPosition,
+															alContactNum,apBody2,apBody1);
 			}
 		}
 
-		pContactBody1->OnCollide(pContactBody2,&contactData);
-		pContactBody2->OnCollide(pContactBody1,&contactData);
-
-		//Thread unlock
-		NewtonWorldCriticalSectionUnlock (NewtonBodyGetWorld (pBody0));
-		NewtonWorldCriticalSectionUnlock (NewtonBodyGetWorld (pBody1));
-
-
+		apBody1->OnCollide(apBody2,apContactData);
+		apBody2->OnCollide(apBody1,apContactData);
 	}
 
 	//-----------------------------------------------------------------------
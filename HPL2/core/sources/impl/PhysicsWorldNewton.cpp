@@ -39,6 +39,9 @@
 #include "graphics/LowLevelGraphics.h"
 #include "math/Math.h"
 #include "resources/BinaryBuffer.h"
+#include "system/JobScheduler.h"
+
+#include <algorithm>
 
 namespace hpl {
 
@@ -65,6 +68,10 @@ namespace hpl {
 
 		mvGravity = cVector3f(0,-9.81f,0);
 		mfMaxTimeStep = 1.0f/60.0f;
+
+		mbDeferSolverEvents = false;
+		mlBodyCreationCount = 0;
+		mlJointCreationCount = 0;
 		
 		/////////////////////////////////
 		//Create default material.
@@ -105,13 +112,22 @@ namespace hpl {
 		//static lUpdate =0;
         //if(lUpdate % 30==0)
 		{
+			//Bodies moved in several sub steps only update children, containers and such once.
+			iEntity3D::BeginTransformBatch();
 
 			while(afTimeStep>mfMaxTimeStep)
 			{
 				NewtonUpdate(mpNewtonWorld, mfMaxTimeStep);
+				FlushSolverEvents();
 				afTimeStep -= mfMaxTimeStep;
 			}
 			NewtonUpdate(mpNewtonWorld, afTimeStep);
+			FlushSolverEvents();
+
+			//The transforms came from Newton, so do not set them back.
+			cPhysicsBodyNewton::SetUseCallback(false);
+			iEntity3D::EndTransformBatch();
+			cPhysicsBodyNewton::SetUseCallback(true);
 		}
 		//lUpdate++;
 		//cPhysicsBodyNewton::SetUseCallback(true);
@@ -205,7 +221,14 @@ namespace hpl {
 
 	void cPhysicsWorldNewton::SetNumberOfThreads(int alThreads)
 	{
+		int lMaxThreads = NewtonGetMaxThreadsCount(mpNewtonWorld);
+		if(alThreads > lMaxThreads) alThreads = lMaxThreads;
+		if(alThreads < 1) alThreads = 1;
+
 		NewtonSetThreadsCount(mpNewtonWorld, alThreads);
+
+		//Game code is not thread safe, so contacts found by the solver threads are handled after the step.
+		mbDeferSolverEvents = NewtonGetThreadsCount(mpNewtonWorld) > 1;
 	}
 	
 	int cPhysicsWorldNewton::GetNumberOfThreads()
@@ -339,7 +362,9 @@ namespace hpl {
 	{
 		iPhysicsJointBall *pJoint = hplNew( cPhysicsJointBallNewton, (asName,apParentBody,apChildBody,this,
 														avPivotPoint,avPinDir) );
+		pJoint->SetCreationIndex(mlJointCreationCount++);
 		mlstJoints.push_back(pJoint);
+		mJointNameIndex.Add(pJoint);
 		return pJoint;
 	}
 
@@ -349,7 +374,9 @@ namespace hpl {
 	{
 		iPhysicsJointHinge *pJoint = hplNew( cPhysicsJointHingeNewton, (asName,apParentBody,apChildBody,this,
 										avPivotPoint,avPinDir) );
+		pJoint->SetCreationIndex(mlJointCreationCount++);
 		mlstJoints.push_back(pJoint);
+		mJointNameIndex.Add(pJoint);
 		return pJoint;
 	}
 
@@ -359,7 +386,9 @@ namespace hpl {
 	{
 		iPhysicsJointSlider *pJoint = hplNew( cPhysicsJointSliderNewton, (asName,apParentBody,apChildBody,this,
 											avPivotPoint,avPinDir) );
+		pJoint->SetCreationIndex(mlJointCreationCount++);
 		mlstJoints.push_back(pJoint);
+		mJointNameIndex.Add(pJoint);
 		return pJoint;
 	}
 
@@ -369,7 +398,9 @@ namespace hpl {
 	{
 		iPhysicsJointScrew *pJoint = hplNew( cPhysicsJointScrewNewton, (asName,apParentBody,apChildBody,this,
 											avPivotPoint,avPinDir) );
+		pJoint->SetCreationIndex(mlJointCreationCount++);
 		mlstJoints.push_back(pJoint);
+		mJointNameIndex.Add(pJoint);
 		return pJoint;
 	}
 
@@ -378,8 +409,11 @@ namespace hpl {
 	iPhysicsBody* cPhysicsWorldNewton::CreateBody(const tString &asName,iCollideShape *apShape)
 	{
 		cPhysicsBodyNewton *pBody = hplNew( cPhysicsBodyNewton, (asName,this, apShape) );
+		pBody->SetCreationIndex(mlBodyCreationCount++);
 
 		mlstBodies.push_back(pBody);
+		mBodyNameIndex.Add(pBody);
+		IncBodyLayoutCount();
 
 		return pBody;
 	}
@@ -444,6 +478,7 @@ namespace hpl {
 		iPhysicsRope *pRope = hplNew( cPhysicsRopeNewton, (asName, this,avStartPos, avEndPos));
 		
 		mlstRopes.push_back(pRope);
+		mRopeNameIndex.Add(pRope);
 
 		return pRope;
 	}
@@ -529,6 +564,7 @@ namespace hpl {
 		gfRayLength = gvRayDelta.Length();
 
         gpRayCallback = apCallback;
+		gRayParams.mlRayIdx = -1;
 
 		////////////
 		//Temp:
@@ -550,6 +586,330 @@ namespace hpl {
 		else
 			NewtonWorldRayCast(mpNewtonWorld, avOrigin.v, avEnd.v,RayCastFilterFunc, NULL, NULL);
 	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////
+	// Batched rays, all data is kept per ray instead of in the globals used by CastRay.
+
+	class cNewtonBatchRay
+	{
+	public:
+		iPhysicsRayCallback *mpCallback;
+		cPhysicsRay *mpRay;
+		cVector3f mvDelta;
+		float mfLength;
+		cVector3f mvBoxMin;
+		cVector3f mvBoxMax;
+		cPhysicsRayParams mParams;
+	};
+
+	static unsigned BatchRayCastPrefilterFunc(const NewtonBody* apNewtonBody,const NewtonCollision* collision, void* apUserData)
+	{
+		cNewtonBatchRay *pRay = (cNewtonBatchRay*)apUserData;
+
+		cPhysicsBodyNewton* pRigidBody = (cPhysicsBodyNewton*) NewtonBodyGetUserData(apNewtonBody);
+		if(pRigidBody->IsActive()==false) return 0;
+
+		//Use the Newton AABB since the bounding volume might be updated when read.
+		cVector3f vMin, vMax;
+		NewtonBodyGetAABB(apNewtonBody, vMin.v, vMax.v);
+		if(cMath::CheckAABBIntersection(pRay->mvBoxMin, pRay->mvBoxMax, vMin, vMax)==false)
+		{
+			return 0;
+		}
+
+		return pRay->mpCallback->BeforeIntersect(pRigidBody) ? 1 : 0;
+	}
+
+	static float BatchRayCastFilterFunc(const NewtonBody* apNewtonBody, const float* apNormalVec, 
+										int alCollisionID, void* apUserData, float afIntersetParam)
+	{
+		cNewtonBatchRay *pRay = (cNewtonBatchRay*)apUserData;
+
+		cPhysicsBodyNewton* pRigidBody = (cPhysicsBodyNewton*) NewtonBodyGetUserData(apNewtonBody);
+		if(pRigidBody->IsActive()==false) return 1;
+
+		pRay->mParams.mfT = afIntersetParam;
+		pRay->mParams.mfDist = pRay->mfLength * afIntersetParam;
+		pRay->mParams.mvNormal.FromVec(apNormalVec);
+		pRay->mParams.mvPoint = pRay->mpRay->mvStart + pRay->mvDelta * afIntersetParam;
+
+		if(pRay->mpCallback->OnIntersect(pRigidBody,&pRay->mParams)) return 1;
+
+		pRay->mpRay->mbHit = true;
+		return 0;
+	}
+
+	//////////////////////////////////////
+
+	void cPhysicsWorldNewton::CastRays(iPhysicsRayCallback *apCallback, cPhysicsRay *apRays, int alRayNum, bool abUsePrefilter)
+	{
+		//The rays are cast one at a time on the calling thread. Newton 2.31 gives no guarantee that ray casts can run at the
+		//same time, and the callback is free to change state. Only the filter-only packet version below is run in parallel.
+		for(int i=0; i<alRayNum; ++i)
+		{
+			cPhysicsRay *pPhysicsRay = &apRays[i];
+
+			cNewtonBatchRay ray;
+			ray.mpCallback = apCallback;
+			ray.mpRay = pPhysicsRay;
+			ray.mvDelta = pPhysicsRay->mvEnd - pPhysicsRay->mvStart;
+			ray.mfLength = ray.mvDelta.Length();
+			ray.mParams.mlRayIdx = i;
+			ray.mvBoxMin = cMath::Vector3Min(pPhysicsRay->mvStart, pPhysicsRay->mvEnd);
+			ray.mvBoxMax = cMath::Vector3Max(pPhysicsRay->mvStart, pPhysicsRay->mvEnd);
+
+			pPhysicsRay->mbHit = false;
+
+			NewtonWorldRayCast(	mpNewtonWorld, pPhysicsRay->mvStart.v, pPhysicsRay->mvEnd.v, BatchRayCastFilterFunc, &ray, 
+								abUsePrefilter ? BatchRayCastPrefilterFunc : NULL);
+		}
+	}
+	
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////
+	// Ray packets, rays that are close to each other share the gathering of bodies from the broadphase.
+
+	static const int kMaxRayPacketSize = 16;
+
+	//Packets are only cast in parallel when there are at least this many rays.
+	static const int kMinParallelRayNum = 32;
+
+	class cNewtonRayPacket
+	{
+	public:
+		const cPhysicsRay *mpRays;
+		cPhysicsRayHit *mpHits;
+		int mlRayNum;
+		int mlActiveRayNum;
+		tPhysicsRayFlag mFlags;
+		iPhysicsRayCallback *mpFilter;
+
+		cVector3f mvInvDelta[kMaxRayPacketSize];
+		bool mbDone[kMaxRayPacketSize];
+	};
+
+	static bool CheckRaySegmentAABB(const cVector3f& avStart, const cVector3f& avInvDelta, float afMaxT,
+									const cVector3f& avMin, const cVector3f& avMax)
+	{
+		float fTMin = 0;
+		float fTMax = afMaxT;
+		for(int i=0; i<3; ++i)
+		{
+			float fT1 = (avMin.v[i] - avStart.v[i]) * avInvDelta.v[i];
+			float fT2 = (avMax.v[i] - avStart.v[i]) * avInvDelta.v[i];
+			if(fT1 > fT2) std::swap(fT1, fT2);
+
+			if(fT1 > fTMin) fTMin = fT1;
+			if(fT2 < fTMax) fTMax = fT2;
+			if(fTMin > fTMax) return false;
+		}
+		return true;
+	}
+
+	static void RayPacketBodyFunc(const NewtonBody* apNewtonBody, void* apUserData)
+	{
+		cNewtonRayPacket *pPacket = (cNewtonRayPacket*)apUserData;
+		if(pPacket->mlActiveRayNum <= 0) return;
+
+		cPhysicsBodyNewton* pRigidBody = (cPhysicsBodyNewton*) NewtonBodyGetUserData(apNewtonBody);
+		if(pRigidBody->IsActive()==false) return;
+
+		const NewtonCollision *pCollision = NewtonBodyGetCollision(apNewtonBody);
+		if(pCollision==NULL) return;
+
+		//Use the Newton AABB since the bounding volume might be updated when read.
+		cVector3f vBodyMin, vBodyMax;
+		NewtonBodyGetAABB(apNewtonBody, vBodyMin.v, vBodyMax.v);
+
+		bool bFilterChecked = false;
+		bool bHasMatrix = false;
+		cMatrixf mtxBody, mtxInvBody;
+
+		for(int i=0; i<pPacket->mlRayNum; ++i)
+		{
+			if(pPacket->mbDone[i]) continue;
+
+			const cPhysicsRay &ray = pPacket->mpRays[i];
+			cPhysicsRayHit &hit = pPacket->mpHits[i];
+
+			//Only the part in front of the closest hit so far needs checking.
+			float fMaxT = hit.mbHit ? hit.mfT : 1.0f;
+			if(CheckRaySegmentAABB(ray.mvStart, pPacket->mvInvDelta[i], fMaxT, vBodyMin, vBodyMax)==false) continue;
+
+			//Filter and local space are only needed if some ray reaches the body.
+			if(bFilterChecked==false)
+			{
+				bFilterChecked = true;
+				if(pPacket->mpFilter && pPacket->mpFilter->BeforeIntersect(pRigidBody)==false) return;
+			}
+			if(bHasMatrix==false)
+			{
+				float fMatrix[16];
+				NewtonBodyGetMatrix(apNewtonBody, fMatrix);
+				mtxBody.FromTranspose(fMatrix);
+				mtxInvBody = cMath::MatrixInverse(mtxBody);
+				bHasMatrix = true;
+			}
+
+			cVector3f vLocalStart = cMath::MatrixMul(mtxInvBody, ray.mvStart);
+			cVector3f vLocalEnd = cMath::MatrixMul(mtxInvBody, ray.mvEnd);
+			cVector3f vLocalNormal;
+			int lAttribute = 0;
+
+			//Newton returns a value larger than 1 when there is no hit.
+			float fT = NewtonCollisionRayCast(pCollision, vLocalStart.v, vLocalEnd.v, vLocalNormal.v, &lAttribute);
+			if(fT < 0 || fT >= fMaxT) continue;
+
+			hit.mbHit = true;
+			hit.mpBody = pRigidBody;
+			hit.mfT = fT;
+			if((pPacket->mFlags & ePhysicsRayFlag_NoNormal)==0)
+			{
+				hit.mvNormal = cMath::MatrixMul3x3(mtxBody, vLocalNormal);
+			}
+
+			if(pPacket->mFlags & ePhysicsRayFlag_AnyHit)
+			{
+				pPacket->mbDone[i] = true;
+				pPacket->mlActiveRayNum--;
+			}
+		}
+	}
+
+	class cNewtonRayPacketFunc : public iJobRangeFunc
+	{
+	public:
+		void RunJobRange(int alStart, int alEnd, int alThreadSlot)
+		{
+			for(int i=alStart; i<alEnd; ++i)
+			{
+				CastPacket(mpPacketStarts[i], mpPacketStarts[i+1]);
+			}
+		}
+
+		void CastPacket(int alFirstRay, int alEndRay)
+		{
+			cNewtonRayPacket packet;
+			packet.mpRays = &mpRays[alFirstRay];
+			packet.mpHits = &mpHits[alFirstRay];
+			packet.mlRayNum = alEndRay - alFirstRay;
+			packet.mlActiveRayNum = packet.mlRayNum;
+			packet.mFlags = mFlags;
+			packet.mpFilter = mpFilter;
+
+			cVector3f vBoxMin = packet.mpRays[0].mvStart;
+			cVector3f vBoxMax = packet.mpRays[0].mvStart;
+
+			for(int i=0; i<packet.mlRayNum; ++i)
+			{
+				const cPhysicsRay &ray = packet.mpRays[i];
+				cPhysicsRayHit &hit = packet.mpHits[i];
+
+				hit.mbHit = false;
+				hit.mpBody = NULL;
+				hit.mfT = 1;
+				hit.mvNormal = 0;
+
+				cVector3f vDelta = ray.mvEnd - ray.mvStart;
+				for(int j=0; j<3; ++j)
+				{
+					//Large instead of infinite so that 0 * inv never is NaN.
+					packet.mvInvDelta[i].v[j] = vDelta.v[j]!=0 ? 1.0f / vDelta.v[j] : 1e30f;
+				}
+				packet.mbDone[i] = false;
+
+				vBoxMin = cMath::Vector3Min(vBoxMin, cMath::Vector3Min(ray.mvStart, ray.mvEnd));
+				vBoxMax = cMath::Vector3Max(vBoxMax, cMath::Vector3Max(ray.mvStart, ray.mvEnd));
+			}
+
+			NewtonWorldForEachBodyInAABBDo(mpNewtonWorld, vBoxMin.v, vBoxMax.v, RayPacketBodyFunc, &packet);
+
+			for(int i=0; i<packet.mlRayNum; ++i)
+			{
+				cPhysicsRayHit &hit = packet.mpHits[i];
+				if(hit.mbHit==false) continue;
+
+				const cPhysicsRay &ray = packet.mpRays[i];
+				cVector3f vDelta = ray.mvEnd - ray.mvStart;
+				hit.mfDist = vDelta.Length() * hit.mfT;
+				hit.mvPoint = ray.mvStart + vDelta * hit.mfT;
+			}
+		}
+
+		NewtonWorld *mpNewtonWorld;
+		const cPhysicsRay *mpRays;
+		cPhysicsRayHit *mpHits;
+		const int *mpPacketStarts;
+		tPhysicsRayFlag mFlags;
+		iPhysicsRayCallback *mpFilter;
+	};
+
+	//////////////////////////////////////
+
+	void cPhysicsWorldNewton::CastRays(	const cPhysicsRay *apRays, int alRayNum, tPhysicsRayFlag aFlags, cPhysicsRayHit *apHits,
+										iPhysicsRayCallback *apFilter)
+	{
+		if(alRayNum <= 0) return;
+
+		////////////////////////////
+		// Split the rays into packets, a ray joins the packet before it if the packet box stays about as small as its longest ray.
+		std::vector<int> vPacketStarts;
+		vPacketStarts.reserve(alRayNum / 4 + 2);
+
+		cVector3f vPacketMin(0), vPacketMax(0);
+		float fPacketMaxLength = 0;
+		int lPacketSize = 0;
+		for(int i=0; i<alRayNum; ++i)
+		{
+			const cPhysicsRay &ray = apRays[i];
+			cVector3f vRayMin = cMath::Vector3Min(ray.mvStart, ray.mvEnd);
+			cVector3f vRayMax = cMath::Vector3Max(ray.mvStart, ray.mvEnd);
+			float fLength = cMath::Vector3Dist(ray.mvStart, ray.mvEnd);
+
+			if(lPacketSize > 0 && lPacketSize < kMaxRayPacketSize)
+			{
+				cVector3f vNewMin = cMath::Vector3Min(vPacketMin, vRayMin);
+				cVector3f vNewMax = cMath::Vector3Max(vPacketMax, vRayMax);
+				cVector3f vSize = vNewMax - vNewMin;
+				float fMaxLength = cMath::Max(fPacketMaxLength, fLength);
+
+				if(cMath::Max(vSize.x, cMath::Max(vSize.y, vSize.z)) <= fMaxLength*1.5f + 0.5f)
+				{
+					vPacketMin = vNewMin;
+					vPacketMax = vNewMax;
+					fPacketMaxLength = fMaxLength;
+					lPacketSize++;
+					continue;
+				}
+			}
+
+			vPacketStarts.push_back(i);
+			vPacketMin = vRayMin;
+			vPacketMax = vRayMax;
+			fPacketMaxLength = fLength;
+			lPacketSize = 1;
+		}
+		int lPacketNum = (int)vPacketStarts.size();
+		vPacketStarts.push_back(alRayNum);
+
+		////////////////////////////
+		// Cast the packets
+		cNewtonRayPacketFunc packetFunc;
+		packetFunc.mpNewtonWorld = mpNewtonWorld;
+		packetFunc.mpRays = apRays;
+		packetFunc.mpHits = apHits;
+		packetFunc.mpPacketStarts = &vPacketStarts[0];
+		packetFunc.mFlags = aFlags;
+		packetFunc.mpFilter = apFilter;
+
+		if(mpJobScheduler && mpJobScheduler->GetWorkerNum()>0 && alRayNum >= kMinParallelRayNum && lPacketNum > 1)
+			mpJobScheduler->ParallelFor(0, lPacketNum, 1, &packetFunc);
+		else
+			packetFunc.RunJobRange(0, lPacketNum, -1);
+	}
 	
 	//-----------------------------------------------------------------------
 
@@ -563,6 +923,33 @@ namespace hpl {
 		}
 	}
 
+	//Gets the world AABB of a (sub) shape, its bounding volume is in the space of the parent shape.
+	static void GetSubShapeWorldAABB(iCollideShape *apShape, const cMatrixf& a_mtxWorld, cVector3f& avMin, cVector3f& avMax)
+	{
+		cBoundingVolume& shapeBV = apShape->GetBoundingVolume();
+		cVector3f vLocalMin = shapeBV.GetMin();
+		cVector3f vLocalMax = shapeBV.GetMax();
+
+		cVector3f vCenter = cMath::MatrixMul(a_mtxWorld, (vLocalMin + vLocalMax) * 0.5f);
+		cVector3f vHalfSize = (vLocalMax - vLocalMin) * 0.5f;
+
+		cVector3f vWorldHalfSize;
+		for(int i=0; i<3; ++i)
+		{
+			vWorldHalfSize.v[i] =	std::abs(a_mtxWorld.m[i][0]) * vHalfSize.x +
+									std::abs(a_mtxWorld.m[i][1]) * vHalfSize.y +
+									std::abs(a_mtxWorld.m[i][2]) * vHalfSize.z;
+		}
+
+		//Small padding, Newton also reports contacts for shapes that are just touching.
+		vWorldHalfSize += cVector3f(0.01f);
+
+		avMin = vCenter - vWorldHalfSize;
+		avMax = vCenter + vWorldHalfSize;
+	}
+
+	//-----------------------------------------------------------------------
+
 	bool cPhysicsWorldNewton::CheckShapeCollision(	iCollideShape* apShapeA, const cMatrixf& a_mtxA,
 										iCollideShape* apShapeB, const cMatrixf& a_mtxB,
 										cCollideData & aCollideData, int alMaxPoints,
@@ -589,11 +976,28 @@ namespace hpl {
 			aCollideData.mlNumOfPoints = 0;
 			int lCollideDataStart =0;
 
+			//World AABBs of the B sub shapes, so pairs that are far apart can skip the narrow phase.
+			if((int)mvTempSubShapeMin.size() < lBCount)
+			{
+				mvTempSubShapeMin.resize(lBCount);
+				mvTempSubShapeMax.resize(lBCount);
+			}
+			for(int b=0; b< lBCount; b++)
+			{
+				GetSubShapeWorldAABB(pNewtonShapeB->GetSubShape(b), a_mtxB, mvTempSubShapeMin[b], mvTempSubShapeMax[b]);
+			}
+
 			for(int a=0; a< lACount; a++)
 			{
+				cCollideShapeNewton *pSubShapeA = static_cast<cCollideShapeNewton*>(pNewtonShapeA->GetSubShape(a));
+
+				cVector3f vMinA, vMaxA;
+				GetSubShapeWorldAABB(pSubShapeA, a_mtxA, vMinA, vMaxA);
+
 				for(int b=0; b< lBCount; b++)
 				{
-					cCollideShapeNewton *pSubShapeA = static_cast<cCollideShapeNewton*>(pNewtonShapeA->GetSubShape(a));
+					if(cMath::CheckAABBIntersection(vMinA, vMaxA, mvTempSubShapeMin[b], mvTempSubShapeMax[b])==false) continue;
+
 					cCollideShapeNewton *pSubShapeB = static_cast<cCollideShapeNewton*>(pNewtonShapeB->GetSubShape(b));
 					
 					int lNum = NewtonCollisionCollide(mpNewtonWorld, alMaxPoints,
@@ -733,4 +1137,77 @@ namespace hpl {
 	}
 
 	//-----------------------------------------------------------------------
+
+	void cPhysicsWorldNewton::OnJointLimit(iPhysicsJoint *apJoint, bool abMaxLimit)
+	{
+		if(mbDeferSolverEvents==false)
+		{
+			if(abMaxLimit)	apJoint->OnMaxLimit();
+			else			apJoint->OnMinLimit();
+			return;
+		}
+
+		cPhysicsJointLimitEventNewton event;
+		event.mpJoint = apJoint;
+		event.mbMaxLimit = abMaxLimit;
+
+		NewtonWorldCriticalSectionLock(mpNewtonWorld);
+		mvJointLimitEvents.push_back(event);
+		NewtonWorldCriticalSectionUnlock(mpNewtonWorld);
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// PRIVATE METHODS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	static bool SortFunc_ContactEvents(const cPhysicsContactEventNewton& aEventA, const cPhysicsContactEventNewton& aEventB)
+	{
+		int lMinA = cMath::Min(aEventA.mpBody1->GetCreationIndex(), aEventA.mpBody2->GetCreationIndex());
+		int lMinB = cMath::Min(aEventB.mpBody1->GetCreationIndex(), aEventB.mpBody2->GetCreationIndex());
+		if(lMinA != lMinB) return lMinA < lMinB;
+
+		int lMaxA = cMath::Max(aEventA.mpBody1->GetCreationIndex(), aEventA.mpBody2->GetCreationIndex());
+		int lMaxB = cMath::Max(aEventB.mpBody1->GetCreationIndex(), aEventB.mpBody2->GetCreationIndex());
+		return lMaxA < lMaxB;
+	}
+
+	static bool SortFunc_JointLimitEvents(const cPhysicsJointLimitEventNewton& aEventA, const cPhysicsJointLimitEventNewton& aEventB)
+	{
+		if(aEventA.mpJoint != aEventB.mpJoint) return aEventA.mpJoint->GetCreationIndex() < aEventB.mpJoint->GetCreationIndex();
+		
+		return aEventA.mbMaxLimit < aEventB.mbMaxLimit;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cPhysicsWorldNewton::FlushSolverEvents()
+	{
+		//The solver threads queue events in any order, sort them so the callbacks run in the same order every time.
+		std::stable_sort(mvContactEvents.begin(), mvContactEvents.end(), SortFunc_ContactEvents);
+		std::stable_sort(mvJointLimitEvents.begin(), mvJointLimitEvents.end(), SortFunc_JointLimitEvents);
+
+		//Callbacks are not allowed to destroy bodies or joints (same as when they are called from within the step).
+		for(size_t i=0; i<mvContactEvents.size(); ++i)
+		{
+			cPhysicsContactEventNewton &event = mvContactEvents[i];
+			cPhysicsMaterialNewton::ProcessContact(	event.mpBody1, event.mpBody2,
+													&event.mContactData, event.mlContactNum);
+		}
+		mvContactEvents.clear();
+
+		for(size_t i=0; i<mvJointLimitEvents.size(); ++i)
+		{
+			cPhysicsJointLimitEventNewton &event = mvJointLimitEvents[i];
+			if(event.mbMaxLimit)	event.mpJoint->OnMaxLimit();
+			else					event.mpJoint->OnMinLimit();
+		}
+		mvJointLimitEvents.clear();
+	}
+
+	//-----------------------------------------------------------------------
+
 }
@@ -489,6 +489,14 @@ namespace hpl {
 		return 0x0;
 	}
 
+	//-----------------------------------------------------------------------
+
+	int cPlatform::GetNumberOfCores()
+	{
+		long lCores = sysconf(_SC_NPROCESSORS_ONLN);
+		return lCores > 0 ? (int)lCores : 1;
+	}
+
 	//////////////////////////////////////////////////////////////////////////
 	// SYSTEM COMMANDS
 	//////////////////////////////////////////////////////////////////////////
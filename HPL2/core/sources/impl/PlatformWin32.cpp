@@ -569,6 +569,14 @@ namespace hpl {
 
 	//-----------------------------------------------------------------------
 
+	int cPlatform::GetNumberOfCores()
+	{
+		int lCores = SDL_GetNumLogicalCPUCores();
+		return lCores > 0 ? lCores : 1;
+	}
+
+	//-----------------------------------------------------------------------
+
 	void cPlatform::GetAvailableVideoModes(tVideoModeVec& avDestVidModes, int alMinBpp, int alMinRefreshRate)
 	{
 		bool bSkipBppCheck = (alMinBpp == -1);
@@ -32,6 +32,7 @@
 #include "impl/KeyboardSDL.h"
 #include "impl/MouseSDL.h"
 #include "impl/LowLevelGraphicsSDL.h"
+#include "impl/LowLevelGraphicsNull.h"
 #include "impl/LowLevelResourcesSDL.h"
 #include "impl/LowLevelSystemSDL.h"
 #include "impl/LowLevelInputSDL.h"
@@ -58,7 +59,9 @@ namespace hpl {
 		// SDL3: Hint names unchanged
 		SDL_SetHint(SDL_HINT_VIDEO_MAC_FULLSCREEN_SPACES, "0");
 
-		if (alHplSetupFlags & (eHplSetup_Screen | eHplSetup_Video))
+		bool bNullGraphics = (alHplSetupFlags & eHplSetup_NullGraphics) != 0;
+
+		if ((alHplSetupFlags & (eHplSetup_Screen | eHplSetup_Video)) && bNullGraphics==false)
 		{
 			// SDL3: Timer is always available, SDL_Init returns bool
 			if (!SDL_Init(SDL_INIT_VIDEO)) {
@@ -81,7 +84,8 @@ namespace hpl {
 
 		//////////////////////////
 		// Graphics
-		mpLowLevelGraphics = hplNew(cLowLevelGraphicsSDL, ());
+		if (bNullGraphics)	mpLowLevelGraphics = hplNew(cLowLevelGraphicsNull, ());
+		else				mpLowLevelGraphics = hplNew(cLowLevelGraphicsSDL, ());
 
 		//////////////////////////
 		// Input
@@ -197,6 +197,7 @@ namespace hpl {
 
 		GLenum GLTarget = TextureTypeToGLTarget(mType);
 		GLenum GLFormat = PixelFormatToGLFormat(aPixelFormat);
+		GLenum glType = PixelFormatIsFloatingPoint(aPixelFormat) ? GL_FLOAT : GL_UNSIGNED_BYTE;
 
 		glEnable(GLTarget);
 		glBindTexture(GLTarget, mvTextureHandles[0]);
@@ -204,18 +205,18 @@ namespace hpl {
 		if(mType == eTextureType_1D)
 		{
 			glTexSubImage1D(GLTarget,alLevel,avOffset.x, avSize.x,
-							GLFormat,GL_UNSIGNED_BYTE,apData);
+							GLFormat,glType,apData);
 		}
 		else if(mType == eTextureType_2D || mType == eTextureType_Rect)
 		{
 			glTexSubImage2D(GLTarget,alLevel,avOffset.x,avOffset.y, avSize.x,avSize.y,
-							GLFormat,GL_UNSIGNED_BYTE,apData);
+							GLFormat,glType,apData);
 		}
 		else if(mType == eTextureType_3D)
 		{
 			glTexSubImage3D(GLTarget,alLevel,avOffset.x,avOffset.y,avOffset.z, 
 							avSize.x,avSize.y,avSize.z,
-							GLFormat,GL_UNSIGNED_BYTE,apData);
+							GLFormat,glType,apData);
 		}
 
 		glDisable(GLTarget);
@@ -54,6 +54,9 @@ namespace hpl {
 		mlHandle = alHandle;
 
 		mpContext = mpScriptEngine->CreateContext();
+		mpModule = NULL;
+
+		mlStringTypeId = mpScriptEngine->GetTypeIdByDecl("string");
 
 		//Create a unique module name
 		msModuleName = "Module_"+cString::ToString(cMath::RandRectl(0,1000000))+
@@ -65,6 +68,17 @@ namespace hpl {
 	{
 		mpScriptEngine->DiscardModule(msModuleName.c_str());
 		mpContext->Release();
+
+		for(size_t i=0; i<mvContexts.size(); ++i)
+		{
+			cSqScriptContext *pContext = mvContexts[i];
+			for(int j=0; j<kMaxScriptCallArgs; ++j)
+			{
+				if(pContext->mvStrings[j]) pContext->mvStrings[j]->Release();
+			}
+			pContext->mpContext->Release();
+		}
+		STLDeleteAll(mvContexts);
 	}
 
 	//-----------------------------------------------------------------------
@@ -148,6 +162,7 @@ namespace hpl {
 		
 		/////////////////////////////////////////
 		// Create module
+		m_mapFuncs.clear();
 		mpModule = mpScriptEngine->GetModule(msModuleName.c_str(), asGM_ALWAYS_CREATE);
 		if(mpModule->AddScriptSection("main", pCharBuffer, lLength)<0)
 		{
@@ -214,12 +229,175 @@ namespace hpl {
 
 	//-----------------------------------------------------------------------
 
+	bool cSqScript::Run(const cScriptCall& aCall)
+	{
+		cSqScriptFunc *pFunc = GetCachedFunc(aCall);
+		
+		//No exact match (missing, overloaded or needs conversions), let the compiler sort it out.
+		if(pFunc->mlFuncId < 0)
+		{
+			return Run(aCall.ToFuncLine());
+		}
+
+		/////////////////////////////////////////
+		// Set up the call, a context of its own is used so callbacks can be run from within script calls.
+		cSqScriptContext *pContext = PopContext();
+		asIScriptContext *pCtx = pContext->mpContext;
+
+		if(pCtx->Prepare(pFunc->mlFuncId) < 0)
+		{
+			PushContext(pContext);
+			return Run(aCall.ToFuncLine());
+		}
+
+		for(int i=0; i<aCall.GetArgNum(); ++i)
+		{
+			const cScriptCallArg &arg = aCall.GetArg(i);
+			switch(pFunc->mvArgBind[i])
+			{
+			case eSqScriptArgBind_String:
+				{
+					//Strings are reused between calls, so assigning normally does not allocate.
+					if(pContext->mvStrings[i]==NULL) pContext->mvStrings[i] = new CScriptString();
+					pContext->mvStrings[i]->buffer = *arg.mpString;
+					pCtx->SetArgObject(i, pContext->mvStrings[i]);
+				}
+				break;
+			case eSqScriptArgBind_DWord:	pCtx->SetArgDWord(i, (asDWORD)arg.mlInt); break;
+			case eSqScriptArgBind_Byte:		pCtx->SetArgByte(i, (asBYTE)arg.mlInt); break;
+			case eSqScriptArgBind_Float:	
+				pCtx->SetArgFloat(i, arg.mType==eScriptArgType_Int ? (float)arg.mlInt : arg.mfFloat); break;
+			case eSqScriptArgBind_Double:	
+				pCtx->SetArgDouble(i, arg.mType==eScriptArgType_Int ? (double)arg.mlInt : (double)arg.mfFloat); break;
+			default: break;
+			}
+		}
+
+		/////////////////////////////////////////
+		// Run
+		pCtx->Execute();
+		pCtx->Unprepare();
+
+		PushContext(pContext);
+
+		//Same as running the func line, errors are reported by the engine message callback.
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
 	//////////////////////////////////////////////////////////////////////////
 	// PRIVATE METHODS
 	//////////////////////////////////////////////////////////////////////////
 
 	//-----------------------------------------------------------------------
 
+	cSqScriptFunc* cSqScript::GetCachedFunc(const cScriptCall& aCall)
+	{
+		const tString& sFunc = aCall.GetFunc();
+		unsigned int lSignature = aCall.GetArgSignature();
+		unsigned long long lKey = ((unsigned long long)cString::GetHash(sFunc) << 32) | lSignature;
+
+		tSqScriptFuncMapIt it = m_mapFuncs.find(lKey);
+		if(it != m_mapFuncs.end() && it->second.msName == sFunc)
+		{
+			return &it->second;
+		}
+
+		//////////////////////////
+		// Not cached (or hash collision), look it up
+		cSqScriptFunc &func = m_mapFuncs[lKey];
+		func.msName = sFunc;
+		func.mlArgSignature = lSignature;
+		ResolveFunc(aCall, &func);
+
+		return &func;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cSqScript::ResolveFunc(const cScriptCall& aCall, cSqScriptFunc *apFunc)
+	{
+		apFunc->mlFuncId = -1;
+		if(mpModule==NULL) return;
+
+		//Fails if there is no function or if it is overloaded
+		int lFuncId = mpModule->GetFunctionIdByName(aCall.GetFunc().c_str());
+		if(lFuncId < 0) return;
+
+		asIScriptFunction *pFunction = mpModule->GetFunctionDescriptorById(lFuncId);
+		if(pFunction==NULL || pFunction->GetParamCount() != aCall.GetArgNum()) return;
+
+		//////////////////////////
+		// Check that the args can be set without any conversions the compiler would do
+		for(int i=0; i<aCall.GetArgNum(); ++i)
+		{
+			asDWORD lFlags = 0;
+			int lTypeId = pFunction->GetParamTypeId(i, &lFlags);
+			eScriptArgType argType = aCall.GetArg(i).mType;
+
+			if(lTypeId == mlStringTypeId && (lFlags==asTM_NONE || lFlags==asTM_INREF) && argType == eScriptArgType_String)
+			{
+				apFunc->mvArgBind[i] = eSqScriptArgBind_String;
+				continue;
+			}
+			
+			if(lFlags != asTM_NONE) return;
+
+			if(lTypeId == asTYPEID_INT32 && argType == eScriptArgType_Int)
+				apFunc->mvArgBind[i] = eSqScriptArgBind_DWord;
+			else if(lTypeId == asTYPEID_BOOL && argType == eScriptArgType_Bool)
+				apFunc->mvArgBind[i] = eSqScriptArgBind_Byte;
+			else if(lTypeId == asTYPEID_FLOAT && (argType == eScriptArgType_Float || argType == eScriptArgType_Int))
+				apFunc->mvArgBind[i] = eSqScriptArgBind_Float;
+			else if(lTypeId == asTYPEID_DOUBLE && (argType == eScriptArgType_Float || argType == eScriptArgType_Int))
+				apFunc->mvArgBind[i] = eSqScriptArgBind_Double;
+			else
+				return;
+		}
+
+		apFunc->mlFuncId = lFuncId;
+	}
+
+	//-----------------------------------------------------------------------
+
+	cSqScriptContext* cSqScript::PopContext()
+	{
+		if(mvFreeContexts.empty())
+		{
+			cSqScriptContext *pContext = hplNew(cSqScriptContext, ());
+			pContext->mpContext = mpScriptEngine->CreateContext();
+			for(int i=0; i<kMaxScriptCallArgs; ++i) pContext->mvStrings[i] = NULL;
+
+			mvContexts.push_back(pContext);
+			return pContext;
+		}
+
+		cSqScriptContext *pContext = mvFreeContexts.back();
+		mvFreeContexts.pop_back();
+		return pContext;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cSqScript::PushContext(cSqScriptContext* apContext)
+	{
+		//If the script kept a handle to an arg string it can no longer be reused
+		for(int i=0; i<kMaxScriptCallArgs; ++i)
+		{
+			CScriptString *pString = apContext->mvStrings[i];
+			if(pString && pString->GetRefCount() > 1)
+			{
+				pString->Release();
+				apContext->mvStrings[i] = NULL;
+			}
+		}
+
+		mvFreeContexts.push_back(apContext);
+	}
+
+	//-----------------------------------------------------------------------
+
 	char* cSqScript::LoadCharBuffer(const tWString& asFileName, int& alLength)
 	{
 		FILE *pFile = cPlatform::OpenFile(asFileName, _W("rb"));
@@ -92,6 +92,20 @@ namespace hpl {
 		glDrawElements(mode, alCount, GL_UNSIGNED_INT, apIndices);
 	}
 
+	void cVertexBufferOGL_Array::DrawInstanced(int alInstanceNum, eVertexBufferDrawType aDrawType)
+	{
+		eVertexBufferDrawType drawType = aDrawType == eVertexBufferDrawType_LastEnum ? mDrawType : aDrawType;
+
+		///////////////////////////////
+		//Get the draw type
+		GLenum mode = GetDrawModeFromDrawType(drawType);
+
+		int lSize = mlElementNum;
+		if(mlElementNum<0) lSize = GetIndexNum();
+
+		glDrawElementsInstancedARB(mode,lSize,GL_UNSIGNED_INT, &mvIndexArray[0], alInstanceNum);
+	}
+
 
 	//-----------------------------------------------------------------------
 
@@ -155,6 +155,28 @@ namespace hpl {
 		glDrawElements(mode, alCount, GL_UNSIGNED_INT, apIndices);
 	}
 
+	//-----------------------------------------------------------------------
+
+	void cVertexBufferOGL_VBO::DrawInstanced(int alInstanceNum, eVertexBufferDrawType aDrawType)
+	{
+		eVertexBufferDrawType drawType = aDrawType == eVertexBufferDrawType_LastEnum ? mDrawType : aDrawType;
+
+		///////////////////////////////
+		//Get the draw type
+		GLenum mode = GetDrawModeFromDrawType(drawType);
+
+		//////////////////////////////////
+		//Bind and draw the buffer
+		glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB,mlElementHandle);
+
+		int lSize = mlElementNum;
+		if(mlElementNum<0) lSize = GetIndexNum();
+
+		glDrawElementsInstancedARB(mode,lSize,GL_UNSIGNED_INT, (char*) NULL, alInstanceNum);
+
+		glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB,0);
+	}
+
 
 	//-----------------------------------------------------------------------
 
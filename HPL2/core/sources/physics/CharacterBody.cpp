@@ -302,6 +302,10 @@ namespace hpl {
 
 		mlCurrentShapeIdx =0;
 
+		mpContactCacheShape = NULL;
+		mlContactCacheLayoutCount = 0;
+		mfContactCacheMargin = 0.5f;
+
 		mfYaw =0;
 		mfPitch =0;
 
@@ -1936,12 +1940,11 @@ namespace hpl {
 		
 		//////////////////////////////
         // Iterate bodies		
-		mvTempBodies.resize(0);
-		mpWorld->GetBodiesInBV(&boundingVolume, &mvTempBodies);
+		std::vector<iPhysicsBody*> *pBodies = GetContactCandidates(mvPosition, mpCurrentShape);
 
-		for(size_t i=0; i<mvTempBodies.size(); ++i)
+		for(size_t i=0; i<pBodies->size(); ++i)
 		{
-			iPhysicsBody *pBody = mvTempBodies[i];
+			iPhysicsBody *pBody = (*pBodies)[i];
 
 			if(pBody->IsActive()==false) continue;
             if(pBody->GetMass() == 0) continue;
@@ -2269,10 +2272,96 @@ namespace hpl {
 		if(alShapeIdx <0) alShapeIdx = mlCurrentShapeIdx;
 		iCollideShape *pShape = mvShapes[alShapeIdx];
 
+		//Only the current shape is cached, checks with other sizes are rare.
+		std::vector<iPhysicsBody*> *pCandidates = NULL;
+		if(pShape == mpCurrentShape) pCandidates = GetContactCandidates(avPos, pShape);
+
 		return mpWorld->CheckShapeWorldCollision(apPushBackVector, pShape, cMath::MatrixTranslate(avPos),
 												mpCurrentBody, false, true, 
 												apCallback, true,mlMinBodyPushStrength, 
-												mlCollideFlags, false);
+												mlCollideFlags, false, pCandidates);
+	}
+
+	//-----------------------------------------------------------------------
+
+	std::vector<iPhysicsBody*>* iCharacterBody::GetContactCandidates(const cVector3f& avPos, iCollideShape *apShape)
+	{
+		cBoundingVolume boundingVolume = apShape->GetBoundingVolume();
+		boundingVolume.SetTransform(cMath::MatrixMul(cMath::MatrixTranslate(avPos), boundingVolume.GetTransform()));
+		cVector3f vMin = boundingVolume.GetMin();
+		cVector3f vMax = boundingVolume.GetMax();
+
+		////////////////////////////
+		// Refresh the cached bodies if the character left the cached area or bodies in the world changed
+		cVector3f vDist = avPos - mvContactCacheCenter;
+		if(	mpContactCacheShape != apShape || mlContactCacheLayoutCount != mpWorld->GetBodyLayoutCount() ||
+			std::abs(vDist.x) > mfContactCacheMargin || std::abs(vDist.y) > mfContactCacheMargin ||
+			std::abs(vDist.z) > mfContactCacheMargin)
+		{
+			cBoundingVolume cacheBV;
+			cacheBV.SetLocalMinMax(vMin - cVector3f(mfContactCacheMargin), vMax + cVector3f(mfContactCacheMargin));
+
+			mvTempBodies.resize(0);
+			mpWorld->GetBodiesInBV(&cacheBV, &mvTempBodies);
+
+			//Characters move all the time, so they are gathered for each check instead.
+			mvCachedContactBodies.resize(0);
+			for(size_t i=0; i<mvTempBodies.size(); ++i)
+			{
+				if(mvTempBodies[i]->IsCharacter()) continue;
+				mvCachedContactBodies.push_back(mvTempBodies[i]);
+			}
+
+			mvContactCacheCenter = avPos;
+			mpContactCacheShape = apShape;
+			mlContactCacheLayoutCount = mpWorld->GetBodyLayoutCount();
+		}
+
+		mvContactCandidates.resize(0);
+
+		////////////////////////////
+		// Cached bodies, the ones being simulated might have moved and are added below
+		for(size_t i=0; i<mvCachedContactBodies.size(); ++i)
+		{
+			iPhysicsBody *pBody = mvCachedContactBodies[i];
+			if(pBody->IsInUpdateList()) continue;
+
+			cBoundingVolume *pBV = pBody->GetBoundingVolume();
+			if(cMath::CheckAABBIntersection(vMin, vMax, pBV->GetMin(), pBV->GetMax())==false) continue;
+
+			mvContactCandidates.push_back(pBody);
+		}
+
+		////////////////////////////
+		// Simulated bodies
+		tPhysicsBodySet *pUpdateBodies = mpWorld->GetUpdateBodySet();
+		for(tPhysicsBodySetIt it = pUpdateBodies->begin(); it != pUpdateBodies->end(); ++it)
+		{
+			iPhysicsBody *pBody = *it;
+			if(pBody->IsCharacter()) continue;
+
+			cBoundingVolume *pBV = pBody->GetBoundingVolume();
+			if(cMath::CheckAABBIntersection(vMin, vMax, pBV->GetMin(), pBV->GetMax())==false) continue;
+
+			mvContactCandidates.push_back(pBody);
+		}
+
+		////////////////////////////
+		// Other characters
+		tCharacterBodyList *pCharBodies = mpWorld->GetCharacterBodyList();
+		for(tCharacterBodyListIt it = pCharBodies->begin(); it != pCharBodies->end(); ++it)
+		{
+			iCharacterBody *pCharBody = *it;
+			if(pCharBody == this) continue;
+
+			iPhysicsBody *pBody = pCharBody->GetCurrentBody();
+			cBoundingVolume *pBV = pBody->GetBoundingVolume();
+			if(cMath::CheckAABBIntersection(vMin, vMax, pBV->GetMin(), pBV->GetMax())==false) continue;
+
+			mvContactCandidates.push_back(pBody);
+		}
+
+		return &mvContactCandidates;
 	}
 	
 	//-----------------------------------------------------------------------
@@ -42,6 +42,8 @@ namespace hpl {
 	cPhysics::cPhysics(iLowLevelPhysics *apLowLevelPhysics)  : iUpdateable("HPL_Physics")
 	{
 		mpLowLevelPhysics = apLowLevelPhysics;
+		mpJobScheduler = NULL;
+		mlNumberOfThreads = 1;
 
 		mlMaxImpacts = 6;
 		mfImpactDuration = 0.4f;
@@ -87,6 +89,8 @@ namespace hpl {
 	iPhysicsWorld* cPhysics::CreateWorld(bool abAddSurfaceData)
 	{
 		iPhysicsWorld * pWorld = mpLowLevelPhysics->CreateWorld();
+		pWorld->SetJobScheduler(mpJobScheduler);
+		if(mlNumberOfThreads > 1) pWorld->SetNumberOfThreads(mlNumberOfThreads);
 		mlstWorlds.push_back(pWorld);
 
 		if(abAddSurfaceData)
@@ -0,0 +1,622 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "physics/PhysicsActivationManager.h"
+
+#include <algorithm>
+
+#include "physics/PhysicsWorld.h"
+#include "physics/PhysicsBody.h"
+#include "physics/PhysicsJoint.h"
+#include "physics/PhysicsRope.h"
+#include "physics/PhysicsController.h"
+#include "physics/CharacterBody.h"
+#include "math/BoundingVolume.h"
+#include "math/Math.h"
+
+namespace hpl {
+
+	//////////////////////////////////////////////////////////////////////////
+	// CONSTRUCTORS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	cPhysicsActivationManager::cPhysicsActivationManager(iPhysicsWorld *apWorld)
+	{
+		mpWorld = apWorld;
+
+		mbActive = false;
+		mfCellSize = 8.0f;
+		mfActivateRadius = 24.0f;
+		mfDeactivateRadius = 32.0f;
+		mfDeactivateDelay = 3.0f;
+		mfCheckInterval = 0.5f;
+		mlMaxReactivatedBodiesPerUpdate = 32;
+
+		mfCheckCount = 0;
+	}
+
+	//-----------------------------------------------------------------------
+
+	cPhysicsActivationManager::~cPhysicsActivationManager()
+	{
+		STLDeleteAll(mlstIslands);
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// PUBLIC METHODS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	void cPhysicsActivationManager::Update(float afTimeStep)
+	{
+		if(mbActive==false)
+		{
+			mvExtraSources.resize(0);
+			return;
+		}
+
+		mStats.mlFrozenBodiesLastUpdate = 0;
+		mStats.mlReactivatedBodiesLastUpdate = 0;
+
+		GatherSources();
+
+		//////////////////////////////
+		// Restore islands that sources have come close to
+		if(m_mapCells.empty()==false) CheckReactivation();
+		ReactivatePending();
+
+		//////////////////////////////
+		// Freeze islands far away from all sources
+		mfCheckCount += afTimeStep;
+		if(mfCheckCount >= mfCheckInterval)
+		{
+			CheckDeactivation(mfCheckCount);
+			mfCheckCount = 0;
+		}
+
+		mvExtraSources.resize(0);
+
+		//////////////////////////////
+		// Stats
+		mStats.mlSourceNum = (int)mvSources.size();
+		mStats.mlFrozenCellNum = (int)m_mapCells.size();
+		mStats.mlFrozenIslandNum = (int)mlstIslands.size();
+		mStats.mlFrozenBodyNum = (int)m_mapFrozenBodies.size();
+		mStats.mlPendingIslandNum = (int)m_mapPendingIslands.size();
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cPhysicsActivationManager::SetActive(bool abX)
+	{
+		if(mbActive == abX) return;
+
+		mbActive = abX;
+		if(mbActive==false) ReactivateAll();
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cPhysicsActivationManager::SetCellSize(float afX)
+	{
+		if(mfCellSize == afX) return;
+
+		ReactivateAll();
+		mfCellSize = afX;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cPhysicsActivationManager::AddSource(const cVector3f& avPosition)
+	{
+		mvExtraSources.push_back(avPosition);
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cPhysicsActivationManager::IsBodyFrozen(iPhysicsBody *apBody)
+	{
+		return m_mapFrozenBodies.find(apBody) != m_mapFrozenBodies.end();
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cPhysicsActivationManager::ReactivateBody(iPhysicsBody *apBody)
+	{
+		tPhysicsFrozenBodyMapIt it = m_mapFrozenBodies.find(apBody);
+		if(it == m_mapFrozenBodies.end()) return;
+
+		ReactivateIsland(it->second);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cPhysicsActivationManager::ReactivateAll()
+	{
+		while(mlstIslands.empty()==false)
+		{
+			ReactivateIsland(mlstIslands.front());
+		}
+		m_mapOutOfRangeTime.clear();
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cPhysicsActivationManager::OnBodyDestroyed(iPhysicsBody *apBody)
+	{
+		m_mapOutOfRangeTime.erase(apBody);
+
+		tPhysicsFrozenBodyMapIt it = m_mapFrozenBodies.find(apBody);
+		if(it == m_mapFrozenBodies.end()) return;
+
+		cPhysicsFrozenIsland *pIsland = it->second;
+		m_mapFrozenBodies.erase(it);
+
+		for(size_t i=0; i<pIsland->mvBodies.size(); ++i)
+		{
+			if(pIsland->mvBodies[i].mpBody == apBody)
+			{
+				pIsland->mvBodies.erase(pIsland->mvBodies.begin() + i);
+				break;
+			}
+		}
+
+		if(pIsland->mvBodies.empty()) RemoveIsland(pIsland);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cPhysicsActivationManager::Reset()
+	{
+		STLDeleteAll(mlstIslands);
+		m_mapCells.clear();
+		m_mapFrozenBodies.clear();
+		m_mapPendingIslands.clear();
+		m_mapOutOfRangeTime.clear();
+		mfCheckCount = 0;
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// PRIVATE METHODS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	void cPhysicsActivationManager::GatherSources()
+	{
+		mvSources.resize(0);
+
+		tCharacterBodyList *pCharList = mpWorld->GetCharacterBodyList();
+		for(tCharacterBodyListIt it = pCharList->begin(); it != pCharList->end(); ++it)
+		{
+			iCharacterBody *pCharBody = *it;
+			if(pCharBody->IsActive()==false) continue;
+
+			mvSources.push_back(pCharBody->GetPosition());
+		}
+
+		for(size_t i=0; i<mvExtraSources.size(); ++i)
+		{
+			mvSources.push_back(mvExtraSources[i]);
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cPhysicsActivationManager::CheckReactivation()
+	{
+		float fMaxSqrDist = mfActivateRadius * mfActivateRadius;
+
+		for(size_t i=0; i<mvSources.size(); ++i)
+		{
+			cVector3l vMinCell = GetCell(mvSources[i] - mfActivateRadius);
+			cVector3l vMaxCell = GetCell(mvSources[i] + mfActivateRadius);
+			cVector3l vCellNum = vMaxCell - vMinCell + 1;
+
+			//////////////////////////////
+			// Check all frozen cells if there are fewer of them than cells in range
+			if(vCellNum.x * vCellNum.y * vCellNum.z > (int)m_mapCells.size())
+			{
+				vMinCell = cVector3l(-0x7FFFFFFF);
+				vMaxCell = cVector3l(0x7FFFFFFF);
+			}
+
+			tPhysicsFrozenCellMapIt cellIt = m_mapCells.lower_bound(vMinCell);
+			for(; cellIt != m_mapCells.end(); ++cellIt)
+			{
+				const cVector3l& vCell = cellIt->first;
+				if(vCell.x > vMaxCell.x) break;
+				if(	vCell.y < vMinCell.y || vCell.y > vMaxCell.y ||
+					vCell.z < vMinCell.z || vCell.z > vMaxCell.z)
+				{
+					continue;
+				}
+
+				tPhysicsFrozenIslandVec &vIslands = cellIt->second;
+				for(size_t j=0; j<vIslands.size(); ++j)
+				{
+					cPhysicsFrozenIsland *pIsland = vIslands[j];
+					if(pIsland->mbPending) continue;
+
+					float fSqrDist = GetCellsSqrDistToSources(pIsland->mvMinCell, pIsland->mvMaxCell);
+					if(fSqrDist > fMaxSqrDist) continue;
+
+					pIsland->mbPending = true;
+					m_mapPendingIslands.insert(tPhysicsFrozenIslandQueue::value_type(fSqrDist, pIsland));
+				}
+			}
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cPhysicsActivationManager::ReactivatePending()
+	{
+		int lCount = 0;
+		while(m_mapPendingIslands.empty()==false)
+		{
+			tPhysicsFrozenIslandQueueIt it = m_mapPendingIslands.begin();
+			cPhysicsFrozenIsland *pIsland = it->second;
+
+			int lBodyNum = (int)pIsland->mvBodies.size();
+			if(lCount > 0 && lCount + lBodyNum > mlMaxReactivatedBodiesPerUpdate) break;
+
+			m_mapPendingIslands.erase(it);
+			pIsland->mbPending = false;
+
+			lCount += lBodyNum;
+			ReactivateIsland(pIsland);
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cPhysicsActivationManager::CheckDeactivation(float afTimeStep)
+	{
+		//////////////////////////////
+		// Islands woken up by something else are restored first thing next update
+		for(tPhysicsFrozenIslandListIt it = mlstIslands.begin(); it != mlstIslands.end(); ++it)
+		{
+			cPhysicsFrozenIsland *pIsland = *it;
+			if(pIsland->mbPending) continue;
+
+			for(size_t i=0; i<pIsland->mvBodies.size(); ++i)
+			{
+				if(pIsland->mvBodies[i].mpBody->GetEnabled())
+				{
+					pIsland->mbPending = true;
+					m_mapPendingIslands.insert(tPhysicsFrozenIslandQueue::value_type(-1.0f, pIsland));
+					break;
+				}
+			}
+		}
+
+		//No sources (no player yet and such), freeze nothing
+		if(mvSources.empty())
+		{
+			m_mapOutOfRangeTime.clear();
+			return;
+		}
+
+		//////////////////////////////
+		// Gather bodies that can be frozen
+		mvTempBodies.resize(0);
+		mvTempIslandParent.resize(0);
+		mvTempBodyBlocked.resize(0);
+		m_mapTempBodyIdx.clear();
+
+		cPhysicsBodyIterator bodyIt = mpWorld->GetBodyIterator();
+		while(bodyIt.HasNext())
+		{
+			iPhysicsBody *pBody = bodyIt.Next();
+			if(pBody->GetMass() <= 0 || pBody->IsCharacter() || pBody->IsActive()==false) continue;
+			if(IsBodyFrozen(pBody)) continue;
+
+			int lIdx = (int)mvTempBodies.size();
+			m_mapTempBodyIdx.insert(std::pair<iPhysicsBody*, int>(pBody, lIdx));
+			mvTempBodies.push_back(pBody);
+			mvTempIslandParent.push_back(lIdx);
+			mvTempBodyBlocked.push_back(0);
+		}
+
+		if(mvTempBodies.empty())
+		{
+			m_mapOutOfRangeTime.clear();
+			return;
+		}
+
+		//////////////////////////////
+		// Joints join bodies into islands.
+		// A joint to a frozen body means the island has changed since freezing, so wait until that is restored.
+		cPhysicsJointIterator jointIt = mpWorld->GetJointIterator();
+		while(jointIt.HasNext())
+		{
+			iPhysicsJoint *pJoint = jointIt.Next();
+			int lParent = GetTempBodyIdx(pJoint->GetParentBody());
+			int lChild = GetTempBodyIdx(pJoint->GetChildBody());
+
+			if(lParent >= 0 && lChild >= 0)
+			{
+				mvTempIslandParent[FindIslandRoot(lParent)] = FindIslandRoot(lChild);
+			}
+			else if(lParent >= 0 && pJoint->GetChildBody() && IsBodyFrozen(pJoint->GetChildBody()))
+			{
+				mvTempBodyBlocked[lParent] = 1;
+			}
+			else if(lChild >= 0 && pJoint->GetParentBody() && IsBodyFrozen(pJoint->GetParentBody()))
+			{
+				mvTempBodyBlocked[lChild] = 1;
+			}
+		}
+
+		//////////////////////////////
+		// Ropes and controllers move bodies outside of the simulation, never freeze these
+		for(tPhysicsRopeListIt it = mpWorld->mlstRopes.begin(); it != mpWorld->mlstRopes.end(); ++it)
+		{
+			iPhysicsRope *pRope = *it;
+			int lStart = GetTempBodyIdx(pRope->GetAttachedStartBody());
+			int lEnd = GetTempBodyIdx(pRope->GetAttachedEndBody());
+			if(lStart >= 0) mvTempBodyBlocked[lStart] = 1;
+			if(lEnd >= 0) mvTempBodyBlocked[lEnd] = 1;
+		}
+
+		for(tPhysicsControllerListIt it = mpWorld->mlstControllers.begin(); it != mpWorld->mlstControllers.end(); ++it)
+		{
+			iPhysicsController *pController = *it;
+			if(pController->IsActive()==false) continue;
+
+			int lIdx = GetTempBodyIdx(pController->GetBody());
+			if(lIdx >= 0) mvTempBodyBlocked[lIdx] = 1;
+		}
+
+		//////////////////////////////
+		// Sort bodies by island
+		mvTempIslandSort.resize(mvTempBodies.size());
+		for(size_t i=0; i<mvTempBodies.size(); ++i)
+		{
+			mvTempIslandSort[i] = std::pair<int, int>(FindIslandRoot((int)i), (int)i);
+		}
+		std::sort(mvTempIslandSort.begin(), mvTempIslandSort.end());
+
+		//////////////////////////////
+		// Check islands
+		float fMinSqrDist = mfDeactivateRadius * mfDeactivateRadius;
+		m_mapTempOutOfRangeTime.clear();
+
+		size_t lStart = 0;
+		while(lStart < mvTempIslandSort.size())
+		{
+			int lRoot = mvTempIslandSort[lStart].first;
+
+			mvTempIslandBodies.resize(0);
+			bool bAwake = false;
+			bool bBlocked = false;
+			float fTime = mfDeactivateDelay;
+			cVector3f vMin, vMax;
+
+			size_t lEnd = lStart;
+			for(; lEnd < mvTempIslandSort.size() && mvTempIslandSort[lEnd].first == lRoot; ++lEnd)
+			{
+				int lIdx = mvTempIslandSort[lEnd].second;
+				iPhysicsBody *pBody = mvTempBodies[lIdx];
+				mvTempIslandBodies.push_back(lIdx);
+
+				if(pBody->GetEnabled()) bAwake = true;
+				if(mvTempBodyBlocked[lIdx]) bBlocked = true;
+
+				cBoundingVolume *pBV = pBody->GetBoundingVolume();
+				if(lEnd == lStart)
+				{
+					vMin = pBV->GetMin();
+					vMax = pBV->GetMax();
+				}
+				else
+				{
+					vMin = cMath::Vector3Min(vMin, pBV->GetMin());
+					vMax = cMath::Vector3Max(vMax, pBV->GetMax());
+				}
+
+				tPhysicsBodyTimeMapIt timeIt = m_mapOutOfRangeTime.find(pBody);
+				fTime = cMath::Min(fTime, timeIt != m_mapOutOfRangeTime.end() ? timeIt->second : 0.0f);
+			}
+			lStart = lEnd;
+
+			//Sleeping islands are not simulated anyway
+			if(bAwake==false || bBlocked) continue;
+
+			cVector3l vMinCell = GetCell(vMin);
+			cVector3l vMaxCell = GetCell(vMax);
+			cVector3l vCellNum = vMaxCell - vMinCell + 1;
+			if(vCellNum.x * vCellNum.y * vCellNum.z > 64) continue;
+
+			if(GetCellsSqrDistToSources(vMinCell, vMaxCell) <= fMinSqrDist) continue;
+
+			fTime += afTimeStep;
+			if(fTime >= mfDeactivateDelay)
+			{
+				FreezeIsland(mvTempIslandBodies, vMinCell, vMaxCell);
+			}
+			else
+			{
+				for(size_t i=0; i<mvTempIslandBodies.size(); ++i)
+				{
+					m_mapTempOutOfRangeTime.insert(tPhysicsBodyTimeMap::value_type(mvTempBodies[mvTempIslandBodies[i]], fTime));
+				}
+			}
+		}
+
+		m_mapOutOfRangeTime.swap(m_mapTempOutOfRangeTime);
+		m_mapTempOutOfRangeTime.clear();
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cPhysicsActivationManager::FreezeIsland(const std::vector<int> &avBodyIdx, const cVector3l& avMinCell, const cVector3l& avMaxCell)
+	{
+		cPhysicsFrozenIsland *pIsland = hplNew( cPhysicsFrozenIsland, () );
+		pIsland->mvMinCell = avMinCell;
+		pIsland->mvMaxCell = avMaxCell;
+		pIsland->mbPending = false;
+
+		pIsland->mvBodies.resize(avBodyIdx.size());
+		for(size_t i=0; i<avBodyIdx.size(); ++i)
+		{
+			iPhysicsBody *pBody = mvTempBodies[avBodyIdx[i]];
+
+			cPhysicsFrozenBody &frozenBody = pIsland->mvBodies[i];
+			frozenBody.mpBody = pBody;
+			frozenBody.mvLinearVelocity = pBody->GetLinearVelocity();
+			frozenBody.mvAngularVelocity = pBody->GetAngularVelocity();
+
+			pBody->Disable();
+			m_mapFrozenBodies.insert(tPhysicsFrozenBodyMap::value_type(pBody, pIsland));
+		}
+
+		mlstIslands.push_back(pIsland);
+
+		for(int x=avMinCell.x; x<=avMaxCell.x; ++x)
+		for(int y=avMinCell.y; y<=avMaxCell.y; ++y)
+		for(int z=avMinCell.z; z<=avMaxCell.z; ++z)
+		{
+			m_mapCells[cVector3l(x,y,z)].push_back(pIsland);
+		}
+
+		mStats.mlFrozenBodiesLastUpdate += (int)avBodyIdx.size();
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cPhysicsActivationManager::ReactivateIsland(cPhysicsFrozenIsland *apIsland)
+	{
+		for(size_t i=0; i<apIsland->mvBodies.size(); ++i)
+		{
+			cPhysicsFrozenBody &frozenBody = apIsland->mvBodies[i];
+			iPhysicsBody *pBody = frozenBody.mpBody;
+
+			m_mapFrozenBodies.erase(pBody);
+
+			//Woken up by something else, keep the velocity it got from that.
+			if(pBody->GetEnabled()) continue;
+
+			pBody->Enable();
+			pBody->SetLinearVelocity(frozenBody.mvLinearVelocity);
+			pBody->SetAngularVelocity(frozenBody.mvAngularVelocity);
+		}
+
+		mStats.mlReactivatedBodiesLastUpdate += (int)apIsland->mvBodies.size();
+
+		RemoveIsland(apIsland);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cPhysicsActivationManager::RemoveIsland(cPhysicsFrozenIsland *apIsland)
+	{
+		for(int x=apIsland->mvMinCell.x; x<=apIsland->mvMaxCell.x; ++x)
+		for(int y=apIsland->mvMinCell.y; y<=apIsland->mvMaxCell.y; ++y)
+		for(int z=apIsland->mvMinCell.z; z<=apIsland->mvMaxCell.z; ++z)
+		{
+			tPhysicsFrozenCellMapIt cellIt = m_mapCells.find(cVector3l(x,y,z));
+			if(cellIt == m_mapCells.end()) continue;
+
+			tPhysicsFrozenIslandVec &vIslands = cellIt->second;
+			tPhysicsFrozenIslandVec::iterator it = std::find(vIslands.begin(), vIslands.end(), apIsland);
+			if(it != vIslands.end()) vIslands.erase(it);
+
+			if(vIslands.empty()) m_mapCells.erase(cellIt);
+		}
+
+		if(apIsland->mbPending)
+		{
+			for(tPhysicsFrozenIslandQueueIt it = m_mapPendingIslands.begin(); it != m_mapPendingIslands.end(); ++it)
+			{
+				if(it->second == apIsland)
+				{
+					m_mapPendingIslands.erase(it);
+					break;
+				}
+			}
+		}
+
+		STLFindAndDelete(mlstIslands, apIsland);
+	}
+
+	//-----------------------------------------------------------------------
+
+	int cPhysicsActivationManager::FindIslandRoot(int alIdx)
+	{
+		while(mvTempIslandParent[alIdx] != alIdx)
+		{
+			mvTempIslandParent[alIdx] = mvTempIslandParent[mvTempIslandParent[alIdx]];
+			alIdx = mvTempIslandParent[alIdx];
+		}
+		return alIdx;
+	}
+
+	//-----------------------------------------------------------------------
+
+	int cPhysicsActivationManager::GetTempBodyIdx(iPhysicsBody *apBody)
+	{
+		if(apBody==NULL) return -1;
+
+		std::map<iPhysicsBody*, int>::iterator it = m_mapTempBodyIdx.find(apBody);
+		if(it == m_mapTempBodyIdx.end()) return -1;
+
+		return it->second;
+	}
+
+	//-----------------------------------------------------------------------
+
+	cVector3l cPhysicsActivationManager::GetCell(const cVector3f& avPos)
+	{
+		return cVector3l(	(int)floor(avPos.x / mfCellSize),
+							(int)floor(avPos.y / mfCellSize),
+							(int)floor(avPos.z / mfCellSize));
+	}
+
+	//-----------------------------------------------------------------------
+
+	float cPhysicsActivationManager::GetCellsSqrDistToSources(const cVector3l& avMinCell, const cVector3l& avMaxCell)
+	{
+		cVector3f vMin = cVector3f((float)avMinCell.x, (float)avMinCell.y, (float)avMinCell.z) * mfCellSize;
+		cVector3f vMax = cVector3f((float)(avMaxCell.x+1), (float)(avMaxCell.y+1), (float)(avMaxCell.z+1)) * mfCellSize;
+
+		float fMinSqrDist = 99999999.0f;
+		for(size_t i=0; i<mvSources.size(); ++i)
+		{
+			const cVector3f& vPos = mvSources[i];
+
+			cVector3f vClosest = cMath::Vector3Max(vMin, cMath::Vector3Min(vMax, vPos));
+			float fSqrDist = cMath::Vector3DistSqr(vClosest, vPos);
+			if(fSqrDist < fMinSqrDist) fMinSqrDist = fSqrDist;
+		}
+
+		return fMinSqrDist;
+	}
+
+	//-----------------------------------------------------------------------
+
+}
@@ -61,6 +61,8 @@ namespace hpl {
 		//Set the default material so that body always has a material.
 		mpMaterial = mpWorld->GetMaterialFromName("Default");
 
+		mlCreationIndex = -1;
+
 		mpCharacterBody = NULL;
 
 		mbBlocksSound = false;
@@ -52,6 +52,7 @@ namespace hpl {
 		: msName(asName), mpParentBody(apParentBody), mpChildBody(apChildBody), mpWorld(apWorld)
 	{
 		mlUniqueID = -1;
+		mlCreationIndex = -1;
 
 		mMaxLimit.msSound = "";
 		mMinLimit.msSound = "";
@@ -26,6 +26,7 @@
 #include "physics/PhysicsJoint.h"
 #include "physics/PhysicsController.h"
 #include "physics/PhysicsRope.h"
+#include "physics/PhysicsActivationManager.h"
 #include "physics/SurfaceData.h"
 #include "system/LowLevelSystem.h"
 #include "system/System.h"
@@ -46,13 +47,17 @@ namespace hpl {
 	iPhysicsWorld::iPhysicsWorld()
 	{
 		mbLogDebug = false;
+		mpJobScheduler = NULL;
+		mlBodyLayoutCount = 0;
+
+		mpActivationManager = hplNew( cPhysicsActivationManager, (this) );
 	}
 
 	//-----------------------------------------------------------------------
 
 	iPhysicsWorld::~iPhysicsWorld()
 	{
-		
+		hplDelete(mpActivationManager);
 	}
 
 	//-----------------------------------------------------------------------
@@ -68,6 +73,10 @@ namespace hpl {
 		//Clear all contact points.
 		mvContactPoints.clear();
 
+		////////////////////////////////////
+		//Freeze and restore bodies depending on distance to characters
+		mpActivationManager->Update(afTimeStep);
+
 		////////////////////////////////////
 		//Update controllers
 		for(tPhysicsControllerListIt CtrlIt = mlstControllers.begin(); CtrlIt != mlstControllers.end(); ++CtrlIt)
@@ -146,6 +155,7 @@ namespace hpl {
             
 			if(pJoint->CheckBreakage())
 			{
+				mJointNameIndex.Remove(pJoint);
 				JointIt = mlstJoints.erase(JointIt);
 				hplDelete(pJoint);
 			}
@@ -191,6 +201,8 @@ namespace hpl {
 	void iPhysicsWorld::DestroyBody(iPhysicsBody* apBody)
 	{
 		if(apBody->IsInUpdateList()) RemoveBodyFromUpdateList(apBody, true);
+		IncBodyLayoutCount();
+		mpActivationManager->OnBodyDestroyed(apBody);
 				
 		tPhysicsBodyListIt it = mlstBodies.begin();
 		for(; it != mlstBodies.end(); ++it)
@@ -198,6 +210,7 @@ namespace hpl {
 			iPhysicsBody *pBody = *it;
 			if(pBody == apBody)
 			{
+				mBodyNameIndex.Remove(pBody);
 				pBody->Destroy();
 				hplDelete(pBody);
 				mlstBodies.erase(it);
@@ -208,7 +221,7 @@ namespace hpl {
 
 	iPhysicsBody *iPhysicsWorld::GetBody(const tString &asName)
 	{
-		return (iPhysicsBody*)STLFindByName(mlstBodies, asName);
+		return mBodyNameIndex.Find(asName);
 	}
 
 	cPhysicsBodyIterator iPhysicsWorld::GetBodyIterator()
@@ -229,7 +242,8 @@ namespace hpl {
 			
 			if(pBody->GetMass() > 0 && cMath::CheckBVIntersection(*apBV,*pBody->GetBoundingVolume()))
 			{
-				pBody->Enable();
+				if(mpActivationManager->IsBodyFrozen(pBody))	mpActivationManager->ReactivateBody(pBody);
+				else											pBody->Enable();
 			}
 		}
 	}
@@ -252,18 +266,22 @@ namespace hpl {
 
 		m_setUpdateBodies.erase(apBody);
 		apBody->SetInUpdateList(false);
+
+		//The body might have moved while simulated and is not checked as simulated any more.
+		IncBodyLayoutCount();
 	}
 
 	//-----------------------------------------------------------------------
 
 	void iPhysicsWorld::DestroyJoint(iPhysicsJoint* apJoint)
 	{
+		mJointNameIndex.Remove(apJoint);
 		STLFindAndDelete(mlstJoints, apJoint);
 	}
 
 	iPhysicsJoint *iPhysicsWorld::GetJoint(const tString &asName)
 	{
-		return (iPhysicsJoint*)STLFindByName(mlstJoints, asName);
+		return mJointNameIndex.Find(asName);
 	}
 
 	bool iPhysicsWorld::JointExists(iPhysicsJoint* apJoint)
@@ -324,7 +342,7 @@ namespace hpl {
 
 	iPhysicsRope* iPhysicsWorld::GetRope(const tString &asName)
 	{
-		return (iPhysicsRope*) STLFindByName(mlstRopes, asName);
+		return mRopeNameIndex.Find(asName);
 	}
 
 	iPhysicsRope* iPhysicsWorld::GetRopeFromUniqueID(int alID)
@@ -340,6 +358,7 @@ namespace hpl {
 
 	void iPhysicsWorld::DestroyRope(iPhysicsRope* apRope)
 	{
+		mRopeNameIndex.Remove(apRope);
 		STLFindAndDelete(mlstRopes, apRope);
 	}
 
@@ -347,6 +366,8 @@ namespace hpl {
 	
 	void iPhysicsWorld::DestroyAll()
 	{
+		mpActivationManager->Reset();
+
 		STLDeleteAll(mlstCharBodies);
 		
 		//Bodies
@@ -359,12 +380,15 @@ namespace hpl {
 			hplDelete(pBody);
 		}
 		mlstBodies.clear();
+		mBodyNameIndex.Clear();
 		m_setUpdateBodies.clear();
 
 		STLDeleteAll(mlstRopes);
+		mRopeNameIndex.Clear();
 
 		STLDeleteAll(mlstShapes);
 		STLDeleteAll(mlstJoints);
+		mJointNameIndex.Clear();
 		STLDeleteAll(mlstControllers);
 		STLMapDeleteAll(m_mapMaterials);
 	}
@@ -436,7 +460,8 @@ namespace hpl {
 							bool abCollideCharacter,
 							int alMinPushStrength,
 							tFlag alCollideFlags,
-							bool abDebug)
+							bool abDebug,
+							std::vector<iPhysicsBody*> *apCandidateBodies)
 	{
 		cCollideData collideData;
 
@@ -454,12 +479,18 @@ namespace hpl {
 		int lBefore =0;
 		int lAfter =0;
 		
-		mvTempBodies.resize(0);
-		GetBodiesInBV(&boundingVolume, &mvTempBodies);
+		//Use the candidates if given (these must cover the bounding volume), else ask the broadphase.
+		std::vector<iPhysicsBody*> *pBodies = apCandidateBodies;
+		if(pBodies==NULL)
+		{
+			mvTempBodies.resize(0);
+			GetBodiesInBV(&boundingVolume, &mvTempBodies);
+			pBodies = &mvTempBodies;
+		}
 		
-		for(size_t i=0; i<mvTempBodies.size(); ++i)
+		for(size_t i=0; i<pBodies->size(); ++i)
 		{
-			iPhysicsBody *pBody = mvTempBodies[i];
+			iPhysicsBody *pBody = (*pBodies)[i];
 			
 			if(pBody->IsActive()==false)continue;
 			if(pBody->IsCharacter() && abCollideCharacter==false) continue;
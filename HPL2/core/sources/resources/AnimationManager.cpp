@@ -98,6 +98,13 @@ namespace hpl {
 		{
 			cMeshLoaderHandler *pMeshLoadHandler = mpResources->GetMeshLoaderHandler();
 			pAnimation = pMeshLoadHandler->LoadAnimation(sPath);
+
+			//Animations loaded from a compressed file are already reduced.
+			if(pAnimation && cResources::GetCompressAnimations() && pAnimation->GetKeyFramesReduced()==false)
+			{
+				pAnimation->ReduceKeyFrames(cResources::GetAnimationCompressionTransTolerance(), 
+											cResources::GetAnimationCompressionRotTolerance());
+			}
 			
 			AddResource(pAnimation);
 		}
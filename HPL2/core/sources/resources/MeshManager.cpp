@@ -22,6 +22,7 @@
 #include "system/System.h"
 #include "resources/Resources.h"
 #include "graphics/Mesh.h"
+#include "graphics/Animation.h"
 #include "system/LowLevelSystem.h"
 #include "resources/MeshLoaderHandler.h"
 #include "resources/FileSearcher.h"
@@ -124,6 +125,19 @@ namespace hpl {
 				return NULL;
 			}
 
+			//Animations loaded from a compressed file are already reduced.
+			if(cResources::GetCompressAnimations())
+			{
+				for(int i=0; i<pMesh->GetAnimationNum(); ++i)
+				{
+					cAnimation *pAnim = pMesh->GetAnimation(i);
+					if(pAnim->GetKeyFramesReduced()) continue;
+					
+					pAnim->ReduceKeyFrames(	cResources::GetAnimationCompressionTransTolerance(), 
+											cResources::GetAnimationCompressionRotTolerance());
+				}
+			}
+
 			AddResource(pMesh);
 		}
 
@@ -62,6 +62,9 @@ namespace hpl {
 
 	bool cResources::mbForceCacheLoadingAndSkipSaving = false;
 	bool cResources::mbCreateAndLoadCompressedMaps= false; 
+	bool cResources::mbCompressAnimations = false;
+	float cResources::mfAnimationCompressionTransTolerance = 0.0005f;
+	float cResources::mfAnimationCompressionRotTolerance = 0.0015f;
 
 	//-----------------------------------------------------------------------
 
@@ -59,6 +59,8 @@ namespace hpl {
 		mfSpecialEventTime =0;
 
 		mfFadeStep=0;
+
+		mvTrackKeyCursors.resize(mpAnimation->GetTrackNum(), 0);
 	}
 	
 	//-----------------------------------------------------------------------
@@ -291,6 +293,15 @@ namespace hpl {
 
 	//-----------------------------------------------------------------------
 
+	int* cAnimationState::GetTrackKeyCursor(int alTrack)
+	{
+		if(alTrack < 0 || alTrack >= (int)mvTrackKeyCursors.size()) return NULL;
+
+		return &mvTrackKeyCursors[alTrack];
+	}
+
+	//-----------------------------------------------------------------------
+
 	cAnimationEvent *cAnimationState::CreateEvent()
 	{
 		cAnimationEvent *pEvent = hplNew( cAnimationEvent, () );
@@ -402,7 +402,8 @@ namespace hpl {
 		{
 			///////////////////////
 			//Calculate the alpha
-			float fAlpha = (float)lSamples / (float)lMaxSamples;
+			//Results can be from different frames if occlusion queries are latency tolerant.
+			float fAlpha = cMath::Min((float)lSamples / (float)lMaxSamples, 1.0f);
 			
 			///////////////////////
 			//Check if inside screen
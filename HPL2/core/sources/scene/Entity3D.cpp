@@ -23,8 +23,22 @@
 
 #include "system/LowLevelSystem.h"
 
+#include <algorithm>
+
 namespace hpl {
 
+	//////////////////////////////////////////////////////////////////////////
+	// STATIC VARIABLES
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	int iEntity3D::mlTransformBatchDepth =0;
+	int iEntity3D::mlTransformNotifyStampCount =0;
+	std::vector<iEntity3D*> iEntity3D::mvTransformBatchEntities;
+
+	//-----------------------------------------------------------------------
+
 	//////////////////////////////////////////////////////////////////////////
 	// CONSTRUCTORS
 	//////////////////////////////////////////////////////////////////////////
@@ -55,10 +69,16 @@ namespace hpl {
 
 		mbIsSaved = true;
 		mlUniqueID = -1;
+
+		mbInTransformBatch = false;
+		mlTransformNotifyStamp = 0;
 	}
 
 	iEntity3D::~iEntity3D()
 	{
+		if(mbInTransformBatch)
+			STLFindAndRemove(mvTransformBatchEntities, this);
+
 		if(mpParentNode)
 			mpParentNode->RemoveEntity(this);
 		else if(mpParent) 
@@ -168,6 +188,9 @@ namespace hpl {
 	
 	void iEntity3D::SetTransformUpdated(bool abUpdateCallbacks)
 	{
+		//Used by EndTransformBatch to skip entities already notified through a parent.
+		mlTransformNotifyStamp = mlTransformNotifyStampCount;
+
 		mbTransformUpdated = true;
 		mlCount++;
 
@@ -206,6 +229,73 @@ namespace hpl {
 	{
 		return mbTransformUpdated;
 	}
+
+	//-----------------------------------------------------------------------
+
+	void iEntity3D::BeginTransformBatch()
+	{
+		++mlTransformBatchDepth;
+	}
+
+	//-----------------------------------------------------------------------
+
+	static bool SortFunc_TransformBatchDepth(const std::pair<int, iEntity3D*>& aA, const std::pair<int, iEntity3D*>& aB)
+	{
+		return aA.first < aB.first;
+	}
+
+	void iEntity3D::EndTransformBatch()
+	{
+		if(mlTransformBatchDepth <=0) return;
+		--mlTransformBatchDepth;
+		if(mlTransformBatchDepth > 0 || mvTransformBatchEntities.empty()) return;
+
+		////////////////////////////
+		// Sort so parents are notified before children
+		std::vector<std::pair<int, iEntity3D*> > vSortedEntities;
+		vSortedEntities.reserve(mvTransformBatchEntities.size());
+		for(size_t i=0; i<mvTransformBatchEntities.size(); ++i)
+		{
+			iEntity3D *pEntity = mvTransformBatchEntities[i];
+			pEntity->mbInTransformBatch = false;
+			vSortedEntities.push_back(std::pair<int, iEntity3D*>(pEntity->GetHierarchyDepth(), pEntity));
+		}
+		mvTransformBatchEntities.clear();
+
+		std::stable_sort(vSortedEntities.begin(), vSortedEntities.end(), SortFunc_TransformBatchDepth);
+
+		////////////////////////////
+		// Notify, a parent notifies all of its children so they are skipped.
+		++mlTransformNotifyStampCount;
+		if(mlTransformNotifyStampCount==0) mlTransformNotifyStampCount = 1;
+		
+		for(size_t i=0; i<vSortedEntities.size(); ++i)
+		{
+			iEntity3D *pEntity = vSortedEntities[i].second;
+			if(pEntity->mlTransformNotifyStamp == mlTransformNotifyStampCount) continue;
+
+			pEntity->SetTransformUpdated(true);
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	void iEntity3D::SetTransformUpdatedBatched()
+	{
+		if(mlTransformBatchDepth <= 0)
+		{
+			SetTransformUpdated(true);
+			return;
+		}
+
+		//Own world transform must be right at once, children and callbacks can wait.
+		mbTransformUpdated = true;
+		mbUpdateBoundingVolume = true;
+
+		if(mbInTransformBatch) return;
+		mbInTransformBatch = true;
+		mvTransformBatchEntities.push_back(this);
+	}
 	
 	//-----------------------------------------------------------------------
 	
@@ -342,6 +432,16 @@ namespace hpl {
 	// PRIVATE METHODS
 	//////////////////////////////////////////////////////////////////////////
 
+	//-----------------------------------------------------------------------
+
+	int iEntity3D::GetHierarchyDepth()
+	{
+		int lDepth =0;
+		for(iEntity3D *pParent = mpParent; pParent; pParent = pParent->mpParent) ++lDepth;
+
+		return lDepth;
+	}
+
 	//-----------------------------------------------------------------------
 	void iEntity3D::UpdateWorldTransform()
 	{
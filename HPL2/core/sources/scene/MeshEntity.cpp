@@ -87,6 +87,13 @@ namespace hpl {
 		mlBoneMatricesTransformCount = -1;
 
 		mbBoneMatricesNeedUpdate = true;
+		mlBoneMatricesUpdateCount = 0;
+
+		mbLogicUpdateStarted = false;
+		mbAnimationUpdated = false;
+		mbSkeletonAnimationPending = false;
+		mbSkeletonAnimationActive = false;
+		mbSkeletonUpdateTransform = false;
 
 		mbStatic = false;
 
@@ -362,8 +369,22 @@ namespace hpl {
 	
 	void cMeshEntity::UpdateLogic(float afTimeStep)
 	{	
+		UpdateLogicBeforeAnimation(afTimeStep);
+		UpdateSkeletonAnimation(afTimeStep);
+		UpdateLogicAfterAnimation(afTimeStep);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cMeshEntity::UpdateLogicBeforeAnimation(float afTimeStep)
+	{
+		mbSkeletonAnimationPending = false;
+		mbAnimationUpdated = false;
+
 		if(mbStatic) return; //No update on static models
 
+		mbLogicUpdateStarted = true;
+
 		/////////////////////////////////////////////
 		//Update the skeleton physics fade
 		if(mbSkeletonPhysicsFading && mbSkeletonPhysics)
@@ -403,6 +424,8 @@ namespace hpl {
 		//Update animations and skeleton physics
 		if(mvAnimationStates.empty()==false || mbSkeletonPhysics)
 		{
+			mbAnimationUpdated = true;
+
 			////////////////////////
 			//Check if it is animated
 			bool bAnimationActive = false;
@@ -418,8 +441,10 @@ namespace hpl {
 			// SKELETON
 			if(mpMesh->GetSkeleton())
 			{
+				mbSkeletonAnimationActive = bAnimationActive;
+
 				//If transform needs to be updated.
-				bool bUpdateTransform = false;
+				mbSkeletonUpdateTransform = false;
 
 				//////////
 				//Reset all bones states
@@ -444,7 +469,7 @@ namespace hpl {
 						}
 					}
 
-					bUpdateTransform = true;
+					mbSkeletonUpdateTransform = true;
 				}
 
 				///////////////////////////
@@ -475,108 +500,33 @@ namespace hpl {
 					}
 				}
 
-				//////////////////////////////////
-				//Go the weight mul (in case weights are normalized!)
-				float fAnimationWeightMul = GetAnimationWeightMul();
-
-				//////////////////////////////////
-				//Go through all animations states and update the bones 
+				///////////////////////////////////
+				//Set the bone index of tracks not yet set. Done here since animations
+				//are shared between entities and the rest of the update can be run in parallel.
 				for(size_t i=0; i< mvAnimationStates.size(); i++)
 				{
 					cAnimationState *pAnimState = mvAnimationStates[i];
+					if(pAnimState->IsActive()==false) continue;
 
-					if(pAnimState->IsActive())
-					{
-						cAnimation *pAnim = pAnimState->GetAnimation();
-
-						/////////////////////////////////////
-						//Go through all tracks in animation and apply to nodes
-						for(int i=0; i<pAnim->GetTrackNum(); i++)
-						{
-							cAnimationTrack *pTrack = pAnim->GetTrack(i);
-							
-							///////////////////////////////////
-							//If index not yet set, get it!
-							if(pTrack->GetNodeIndex()==-1)
-							{
-								int lBoneIdx = mpMesh->GetSkeleton()->GetBoneIndexByName(pTrack->GetName());
-								if(lBoneIdx==-1)
-								{
-									// XXX: This line is commented to avoid log clutter 
-									//Error("Track '%s' in '%s' does not have a corresponding bone! Skeleton bone name mismatch?\n", pTrack->GetName().c_str(), mpMesh->GetName().c_str());
-									pTrack->SetNodeIndex(-2);
-								}
-								else
-									pTrack->SetNodeIndex(lBoneIdx);
-							}
-							
-							cNode3D* pState = GetBoneState(pTrack->GetNodeIndex());
-							
-							///////////////////////////////////
-							//Apply the animation track to node.
-							if(pState && pState->IsActive())
-							{
-								pTrack->ApplyToNode(pState,pAnimState->GetTimePosition(),pAnimState->GetWeight() * fAnimationWeightMul, pAnimState->IsLooping());
-							}
-						}
-
-					
-						pAnimState->Update(afTimeStep);
-					}
-				}
-				
-				//////////////////////////////////
-				//Go through all states and update the matrices (and thereby adding the animations together).
-				if(bAnimationActive)
-				{
-					cNode3DIterator NodeIt = mpBoneStateRoot->GetChildIterator();
-					while(NodeIt.HasNext())
-					{
-						cNode3D *pBoneState = static_cast<cNode3D*>(NodeIt.Next());
-						UpdateNodeMatrixRec(pBoneState);
-					}
-
-					//Entities are updated after BV is calculated, as the entity has the rootnode attached to it.
-				}
-
-				////////////////////////////
-				//Update attached entities
-				if(bAnimationActive || mbSkeletonPhysics)
-				{
-					for(size_t i=0;i < mvBoneStates.size(); i++)
+					cAnimation *pAnim = pAnimState->GetAnimation();
+					for(int j=0; j<pAnim->GetTrackNum(); j++)
 					{
-						mvBoneStates[i]->UpdateEntityChildren();
-					}
-				}
-				
-				//////////////////////////////////
-				//Update the colliders if they are active
-				//Note this must be done after all bone states are updated.
-				if(mbSkeletonColliders && mbSkeletonPhysics==false)
-				{
-					for(size_t i=0;i < mvBoneStates.size(); i++)
-					{
-						cBoneState *pState = mvBoneStates[i];
-						iPhysicsBody *pColliderBody = pState->GetColliderBody();
+						cAnimationTrack *pTrack = pAnim->GetTrack(j);
+						if(pTrack->GetNodeIndex()!=-1) continue;
 
-						if(pColliderBody)
+						int lBoneIdx = mpMesh->GetSkeleton()->GetBoneIndexByName(pTrack->GetName());
+						if(lBoneIdx==-1)
 						{
-							cMatrixf mtxBody = cMath::MatrixMul(pState->GetWorldMatrix(), pState->GetBodyMatrix());
-							pColliderBody->SetMatrix(mtxBody);
+							// XXX: This line is commented to avoid log clutter 
+							//Error("Track '%s' in '%s' does not have a corresponding bone! Skeleton bone name mismatch?\n", pTrack->GetName().c_str(), mpMesh->GetName().c_str());
+							pTrack->SetNodeIndex(-2);
 						}
+						else
+							pTrack->SetNodeIndex(lBoneIdx);
 					}
 				}
 
-				/////////////////////////////////////
-				//Update the sub entity transform, so that they are updated in the renderable container.
-				if(bUpdateTransform)
-				{
-					for(size_t i=0; i<mvSubMeshes.size(); ++i)
-					{
-						mvSubMeshes[i]->SetTransformUpdated(true);
-					}
-				}
-				
+				mbSkeletonAnimationPending = true;
 			}
 			//////////////////////////
 			// NODES
@@ -617,7 +567,7 @@ namespace hpl {
 								cNode3D* pNodeState = GetNodeState(pTrack->GetNodeIndex());
 
 								if(pNodeState->IsActive()) 
-									pTrack->ApplyToNode(pNodeState,pAnimState->GetTimePosition(),pAnimState->GetWeight() * fAnimationWeightMul);
+									pTrack->ApplyToNode(pNodeState,pAnimState->GetTimePosition(),pAnimState->GetWeight() * fAnimationWeightMul, true, pAnimState->GetTrackKeyCursor(i));
 							}
 
 							pAnimState->Update(afTimeStep);
@@ -651,7 +601,116 @@ namespace hpl {
 					mbHasUpdatedAnimation = false;
 				}
 			}
-			
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cMeshEntity::UpdateSkeletonAnimation(float afTimeStep)
+	{
+		if(mbSkeletonAnimationPending==false) return;
+		mbSkeletonAnimationPending = false;
+
+		//////////////////////////////////
+		//Go the weight mul (in case weights are normalized!)
+		float fAnimationWeightMul = GetAnimationWeightMul();
+
+		//////////////////////////////////
+		//Go through all animations states and update the bones 
+		for(size_t i=0; i< mvAnimationStates.size(); i++)
+		{
+			cAnimationState *pAnimState = mvAnimationStates[i];
+
+			if(pAnimState->IsActive())
+			{
+				cAnimation *pAnim = pAnimState->GetAnimation();
+
+				/////////////////////////////////////
+				//Go through all tracks in animation and apply to nodes
+				for(int i=0; i<pAnim->GetTrackNum(); i++)
+				{
+					cAnimationTrack *pTrack = pAnim->GetTrack(i);
+					
+					cNode3D* pState = GetBoneState(pTrack->GetNodeIndex());
+					
+					///////////////////////////////////
+					//Apply the animation track to node.
+					if(pState && pState->IsActive())
+					{
+						pTrack->ApplyToNode(pState,pAnimState->GetTimePosition(),pAnimState->GetWeight() * fAnimationWeightMul, pAnimState->IsLooping(), pAnimState->GetTrackKeyCursor(i));
+					}
+				}
+
+				pAnimState->Update(afTimeStep);
+			}
+		}
+		
+		//////////////////////////////////
+		//Go through all states and update the matrices (and thereby adding the animations together).
+		if(mbSkeletonAnimationActive)
+		{
+			cNode3DIterator NodeIt = mpBoneStateRoot->GetChildIterator();
+			while(NodeIt.HasNext())
+			{
+				cNode3D *pBoneState = static_cast<cNode3D*>(NodeIt.Next());
+				UpdateNodeMatrixRec(pBoneState);
+			}
+
+			//Entities are updated after BV is calculated, as the entity has the rootnode attached to it.
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cMeshEntity::UpdateLogicAfterAnimation(float afTimeStep)
+	{
+		//Only run if the first step was run, the entity might have been activated in between.
+		if(mbLogicUpdateStarted==false) return;
+		mbLogicUpdateStarted = false;
+
+		if(mbAnimationUpdated)
+		{
+			if(mpMesh->GetSkeleton())
+			{
+				////////////////////////////
+				//Update attached entities
+				if(mbSkeletonAnimationActive || mbSkeletonPhysics)
+				{
+					for(size_t i=0;i < mvBoneStates.size(); i++)
+					{
+						mvBoneStates[i]->UpdateEntityChildren();
+					}
+				}
+				
+				//////////////////////////////////
+				//Update the colliders if they are active
+				//Note this must be done after all bone states are updated.
+				if(mbSkeletonColliders && mbSkeletonPhysics==false)
+				{
+					for(size_t i=0;i < mvBoneStates.size(); i++)
+					{
+						cBoneState *pState = mvBoneStates[i];
+						iPhysicsBody *pColliderBody = pState->GetColliderBody();
+
+						if(pColliderBody)
+						{
+							cMatrixf mtxBody = cMath::MatrixMul(pState->GetWorldMatrix(), pState->GetBodyMatrix());
+							pColliderBody->SetMatrix(mtxBody);
+						}
+					}
+				}
+
+				/////////////////////////////////////
+				//Update the sub entity transform, so that they are updated in the renderable container.
+				if(mbSkeletonUpdateTransform)
+				{
+					for(size_t i=0; i<mvSubMeshes.size(); ++i)
+					{
+						mvSubMeshes[i]->SetTransformUpdated(true);
+					}
+				}
+			}
+
 			//////////////////
 			//Call callback
 			if(mpCallback )mpCallback->AfterAnimationUpdate(this,afTimeStep);
@@ -1201,6 +1260,8 @@ namespace hpl {
 				
 				mvBoneMatrices[i] = cMath::MatrixMul(mtxLocal,pBone->GetInvWorldTransform());
 			}
+
+			++mlBoneMatricesUpdateCount;
 		}
 	}
 
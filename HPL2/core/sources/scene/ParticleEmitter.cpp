@@ -306,6 +306,32 @@ namespace hpl {
 	}
 
 	bool iParticleEmitter::UpdateGraphicsForViewport(cFrustum *apFrustum,float afFrameTime)
+	{
+		if(EnsureGraphicsPrepared(apFrustum, afFrameTime)==false) return false;
+		if(mPEType == ePEType_Beam) return true;
+
+		//////////////////////////
+		// Upload the vertex data built in PrepareGraphicsForViewport
+		if(mvSubDivUV.size() > 1)
+			mpVtxBuffer->UpdateData(eVertexElementFlag_Position | eVertexElementFlag_Color0 | eVertexElementFlag_Texture0, false);
+		else
+			mpVtxBuffer->UpdateData(eVertexElementFlag_Position | eVertexElementFlag_Color0, false);
+
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void iParticleEmitter::BeforeGraphicsPrepare()
+	{
+		//Parent is shared by all emitters in the system, make sure its lazy data is up to date.
+		mpParentSystem->GetWorldMatrix();
+		mpParentSystem->GetBoundingVolume()->GetWorldCenter();
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool iParticleEmitter::PrepareGraphicsForViewport(cFrustum *apFrustum,float afFrameTime)
 	{
 		//if(mbUpdateGfx == false) return;
 
@@ -665,14 +691,6 @@ namespace hpl {
 			}
 
 			mpVtxBuffer->SetElementNum(mlNumOfParticles * 6);
-
-			//Update the vertex buffer data
-
-			if(mvSubDivUV.size() > 1)
-				mpVtxBuffer->UpdateData(eVertexElementFlag_Position | eVertexElementFlag_Color0 | eVertexElementFlag_Texture0, false);
-			else
-				mpVtxBuffer->UpdateData(eVertexElementFlag_Position | eVertexElementFlag_Color0, false);
-
 		}
 		
 		return true;
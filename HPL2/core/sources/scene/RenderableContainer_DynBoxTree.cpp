@@ -149,8 +149,10 @@ namespace hpl {
 		////////////////////////////////////////////
 		//Get renderable object
 		iRenderable *pObject = static_cast<iRenderable*>(apEntity);
+		if(pObject->GetContainerUpdatePending()) return;
 
-		mpContainer->m_setObjectsToUpdate.insert(pObject);
+		pObject->SetContainerUpdatePending(true);
+		mpContainer->mvObjectsToUpdate.push_back(pObject);
 	}
 
 	//-----------------------------------------------------------------------
@@ -707,9 +709,10 @@ namespace hpl {
 	{
 		//////////////////////////////////
 		// Remove from to-update list
-		if(m_setObjectsToUpdate.empty()==false)
+		if(apRenderable->GetContainerUpdatePending())
 		{
-			m_setObjectsToUpdate.erase(apRenderable);
+			STLFindAndRemove(mvObjectsToUpdate, apRenderable);
+			apRenderable->SetContainerUpdatePending(false);
 		}
 		
 		//////////////////////////////////
@@ -824,17 +827,17 @@ namespace hpl {
 	void cRenderableContainer_DynBoxTree::SpecificUpdateBeforeRendering()
 	{
 		///////////////////////////////////
-		// Update tree for objects that have moved
-		if(m_setObjectsToUpdate.empty()==false)
+		// Update tree for objects that have moved, all moves since last rendering are applied together.
+		if(mvObjectsToUpdate.empty()==false)
 		{
-			tRenderableSetIt it = m_setObjectsToUpdate.begin();
-			for(; it != m_setObjectsToUpdate.end(); ++it)
+			for(size_t i=0; i<mvObjectsToUpdate.size(); ++i)
 			{
-				iRenderable *pObject = *it;
+				iRenderable *pObject = mvObjectsToUpdate[i];
+				pObject->SetContainerUpdatePending(false);
 				
 				UpdateObjectInContainer(pObject);
 			}
-            m_setObjectsToUpdate.clear();
+            mvObjectsToUpdate.clear();
 		}
 
 
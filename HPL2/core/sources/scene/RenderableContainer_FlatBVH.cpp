@@ -0,0 +1,348 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "scene/RenderableContainer_FlatBVH.h"
+
+#include "graphics/Renderable.h"
+#include "math/Frustum.h"
+#include "math/Math.h"
+
+#include "system/LowLevelSystem.h"
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+	#define HPL_FLAT_BVH_SSE
+	#include <xmmintrin.h>
+#endif
+
+namespace hpl {
+
+	//////////////////////////////////////////////////////////////////////////
+	// BOX ARRAY
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	void cRCFlatBoxArray::Clear()
+	{
+		mlSize = 0;
+		for(int i=0; i<3; ++i)
+		{
+			mvCenter[i].clear();
+			mvExtent[i].clear();
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cRCFlatBoxArray::Add(const cVector3f& avMin, const cVector3f& avMax)
+	{
+		for(int i=0; i<3; ++i)
+		{
+			mvCenter[i].push_back((avMax.v[i] + avMin.v[i]) * 0.5f);
+			mvExtent[i].push_back((avMax.v[i] - avMin.v[i]) * 0.5f);
+		}
+		mlSize++;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cRCFlatBoxArray::AddPadding()
+	{
+		for(int i=0; i<3; ++i)
+		{
+			mvCenter[i].resize(mlSize+3, 0.0f);
+			mvExtent[i].resize(mlSize+3, 0.0f);
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// CONSTRUCTORS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	cRenderableContainer_FlatBVH::cRenderableContainer_FlatBVH()
+	{
+		mNodeBoxes.Clear();
+		mObjectBoxes.Clear();
+	}
+
+	//-----------------------------------------------------------------------
+
+	cRenderableContainer_FlatBVH::~cRenderableContainer_FlatBVH()
+	{
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// PUBLIC METHODS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	void cRenderableContainer_FlatBVH::Compile()
+	{
+		cRenderableContainer_BoxTree::Compile();
+
+		mvNodes.clear();
+		mvObjects.clear();
+		mNodeBoxes.Clear();
+		mObjectBoxes.Clear();
+
+		////////////////////////////
+		// Flatten the tree. Children of a node are stored next to each other and objects are stored
+		// depth first, so all objects under a node are in one range.
+		iRenderableContainerNode *pRoot = GetRoot();
+		
+		mvNodes.push_back(cRCFlatNode());
+		mNodeBoxes.Add(pRoot->GetMin(), pRoot->GetMax());
+		FlattenNode(pRoot, 0);
+
+		mNodeBoxes.AddPadding();
+		mObjectBoxes.AddPadding();
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cRenderableContainer_FlatBVH::GetObjectsInFrustum(cFrustum *apFrustum, tRenderableVec *apObjectVec)
+	{
+		if(mvNodes.empty()) return true;
+
+		////////////////////////////
+		// Set up planes and frustum bounds
+		int lPlaneNum = apFrustum->GetInfFarPlane() ? 5 : 6;
+		for(int i=0; i<lPlaneNum; ++i)
+		{
+			const cPlanef& plane = apFrustum->GetPlane((eFrustumPlane)i);
+			mvPlaneData[i][0] = plane.a;
+			mvPlaneData[i][1] = plane.b;
+			mvPlaneData[i][2] = plane.c;
+			mvPlaneData[i][3] = plane.d;
+		}
+
+		mvFrustumMin = apFrustum->GetVertex(0);
+		mvFrustumMax = apFrustum->GetVertex(0);
+		for(int i=1; i<8; ++i)
+		{
+			const cVector3f& vVtx = apFrustum->GetVertex(i);
+			cMath::ExpandAABB(mvFrustumMin, mvFrustumMax, vVtx, vVtx);
+		}
+
+		////////////////////////////
+		// Iterate nodes. Each stack entry is node index and the planes the node still intersects.
+		int vPlaneMasks[4];
+
+		mvNodeStack.resize(0);
+		mvNodeStack.push_back(cVector2l(0, (1 << lPlaneNum) - 1));
+		while(mvNodeStack.empty()==false)
+		{
+			cVector2l vEntry = mvNodeStack.back();
+			mvNodeStack.pop_back();
+
+			const cRCFlatNode& node = mvNodes[vEntry.x];
+			int lPlaneMask = vEntry.y;
+
+			////////////////////////////
+			// Fully inside, add everything below without tests
+			if(lPlaneMask == 0)
+			{
+				for(int i=node.mlFirstObject; i<node.mlSubTreeObjectEnd; ++i)
+					apObjectVec->push_back(mvObjects[i]);
+				continue;
+			}
+
+			////////////////////////////
+			// Objects
+			for(int i=0; i<node.mlObjectNum; i+=4)
+			{
+				int lStart = node.mlFirstObject + i;
+				int lVisible = CollideBoxes(mObjectBoxes, lStart, cMath::Min(4, node.mlObjectNum - i), lPlaneMask, NULL);
+				for(int lane=0; lane<4; ++lane)
+				{
+					if(lVisible & (1<<lane)) apObjectVec->push_back(mvObjects[lStart + lane]);
+				}
+			}
+
+			////////////////////////////
+			// Children
+			for(int i=0; i<node.mlChildNum; i+=4)
+			{
+				int lStart = node.mlFirstChild + i;
+				int lVisible = CollideBoxes(mNodeBoxes, lStart, cMath::Min(4, node.mlChildNum - i), lPlaneMask, vPlaneMasks);
+				for(int lane=0; lane<4; ++lane)
+				{
+					if(lVisible & (1<<lane)) mvNodeStack.push_back(cVector2l(lStart + lane, vPlaneMasks[lane]));
+				}
+			}
+		}
+
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// PRIVATE METHODS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	void cRenderableContainer_FlatBVH::FlattenNode(iRenderableContainerNode *apNode, int alNodeIdx)
+	{
+		////////////////////////////
+		// Objects
+		mvNodes[alNodeIdx].mlFirstObject = (int)mvObjects.size();
+		mvNodes[alNodeIdx].mlObjectNum = apNode->GetObjectNum();
+
+		tRenderableListIt objIt = apNode->GetObjectList()->begin();
+		for(; objIt != apNode->GetObjectList()->end(); ++objIt)
+		{
+			iRenderable *pObject = *objIt;
+			cBoundingVolume *pBV = pObject->GetBoundingVolume();
+
+			mvObjects.push_back(pObject);
+			mObjectBoxes.Add(pBV->GetMin(), pBV->GetMax());
+		}
+
+		////////////////////////////
+		// Children, added together before going down, so they are next to each other.
+		int lFirstChild = (int)mvNodes.size();
+		int lChildNum = (int)apNode->GetChildNodeList()->size();
+		mvNodes[alNodeIdx].mlFirstChild = lFirstChild;
+		mvNodes[alNodeIdx].mlChildNum = lChildNum;
+
+		tRenderableContainerNodeListIt childIt = apNode->GetChildNodeList()->begin();
+		for(; childIt != apNode->GetChildNodeList()->end(); ++childIt)
+		{
+			iRenderableContainerNode *pChildNode = *childIt;
+			
+			mvNodes.push_back(cRCFlatNode());
+			mNodeBoxes.Add(pChildNode->GetMin(), pChildNode->GetMax());
+		}
+
+		int lChild = lFirstChild;
+		for(childIt = apNode->GetChildNodeList()->begin(); childIt != apNode->GetChildNodeList()->end(); ++childIt, ++lChild)
+		{
+			FlattenNode(*childIt, lChild);
+		}
+
+		mvNodes[alNodeIdx].mlSubTreeObjectEnd = (int)mvObjects.size();
+	}
+
+	//-----------------------------------------------------------------------
+
+	/**
+	 * Tests up to four boxes against the planes in alPlaneMask and the frustum bounds.
+	 * \return bit mask of boxes not outside. If apPlaneMasks is set, it gets the planes each box intersects.
+	 */
+	int cRenderableContainer_FlatBVH::CollideBoxes(const cRCFlatBoxArray& aBoxes, int alStart, int alCount, int alPlaneMask, int *apPlaneMasks)
+	{
+		int lCountMask = (1 << alCount) - 1;
+		int vIntersectBits[6] = {0, 0, 0, 0, 0, 0};
+		int lOutsideBits = 0;
+
+	#ifdef HPL_FLAT_BVH_SSE
+		const __m128 vZero = _mm_setzero_ps();
+		__m128 vCenterX = _mm_loadu_ps(&aBoxes.mvCenter[0][alStart]);
+		__m128 vCenterY = _mm_loadu_ps(&aBoxes.mvCenter[1][alStart]);
+		__m128 vCenterZ = _mm_loadu_ps(&aBoxes.mvCenter[2][alStart]);
+		__m128 vExtentX = _mm_loadu_ps(&aBoxes.mvExtent[0][alStart]);
+		__m128 vExtentY = _mm_loadu_ps(&aBoxes.mvExtent[1][alStart]);
+		__m128 vExtentZ = _mm_loadu_ps(&aBoxes.mvExtent[2][alStart]);
+
+		////////////////////////////
+		// Frustum planes, signed distance of the center and the projected radius of the box.
+		__m128 vOutside = vZero;
+		for(int i=0; i<6; ++i)
+		{
+			if((alPlaneMask & (1<<i))==0) continue;
+			const float *pPlane = mvPlaneData[i];
+
+			__m128 vDist = _mm_add_ps(	_mm_add_ps(	_mm_mul_ps(_mm_set1_ps(pPlane[0]), vCenterX),
+													_mm_mul_ps(_mm_set1_ps(pPlane[1]), vCenterY)),
+										_mm_add_ps(	_mm_mul_ps(_mm_set1_ps(pPlane[2]), vCenterZ),
+													_mm_set1_ps(pPlane[3])));
+			__m128 vRadius = _mm_add_ps(_mm_add_ps(	_mm_mul_ps(_mm_set1_ps(fabsf(pPlane[0])), vExtentX),
+													_mm_mul_ps(_mm_set1_ps(fabsf(pPlane[1])), vExtentY)),
+										_mm_mul_ps(_mm_set1_ps(fabsf(pPlane[2])), vExtentZ));
+
+			vOutside = _mm_or_ps(vOutside, _mm_cmplt_ps(_mm_add_ps(vDist, vRadius), vZero));
+			vIntersectBits[i] = _mm_movemask_ps(_mm_cmplt_ps(_mm_sub_ps(vDist, vRadius), vZero));
+		}
+
+		////////////////////////////
+		// Frustum bounds, same as testing the frustum corners against the box sides.
+		vOutside = _mm_or_ps(vOutside, _mm_cmpgt_ps(_mm_sub_ps(vCenterX, vExtentX), _mm_set1_ps(mvFrustumMax.x)));
+		vOutside = _mm_or_ps(vOutside, _mm_cmpgt_ps(_mm_sub_ps(vCenterY, vExtentY), _mm_set1_ps(mvFrustumMax.y)));
+		vOutside = _mm_or_ps(vOutside, _mm_cmpgt_ps(_mm_sub_ps(vCenterZ, vExtentZ), _mm_set1_ps(mvFrustumMax.z)));
+		vOutside = _mm_or_ps(vOutside, _mm_cmplt_ps(_mm_add_ps(vCenterX, vExtentX), _mm_set1_ps(mvFrustumMin.x)));
+		vOutside = _mm_or_ps(vOutside, _mm_cmplt_ps(_mm_add_ps(vCenterY, vExtentY), _mm_set1_ps(mvFrustumMin.y)));
+		vOutside = _mm_or_ps(vOutside, _mm_cmplt_ps(_mm_add_ps(vCenterZ, vExtentZ), _mm_set1_ps(mvFrustumMin.z)));
+
+		lOutsideBits = _mm_movemask_ps(vOutside);
+	#else
+		for(int lane=0; lane<alCount; ++lane)
+		{
+			int lIdx = alStart + lane;
+			cVector3f vCenter(aBoxes.mvCenter[0][lIdx], aBoxes.mvCenter[1][lIdx], aBoxes.mvCenter[2][lIdx]);
+			cVector3f vExtent(aBoxes.mvExtent[0][lIdx], aBoxes.mvExtent[1][lIdx], aBoxes.mvExtent[2][lIdx]);
+			
+			bool bOutside = false;
+			for(int i=0; i<6; ++i)
+			{
+				if((alPlaneMask & (1<<i))==0) continue;
+				const float *pPlane = mvPlaneData[i];
+
+				float fDist = pPlane[0]*vCenter.x + pPlane[1]*vCenter.y + pPlane[2]*vCenter.z + pPlane[3];
+				float fRadius = fabsf(pPlane[0])*vExtent.x + fabsf(pPlane[1])*vExtent.y + fabsf(pPlane[2])*vExtent.z;
+
+				if(fDist + fRadius < 0) bOutside = true;
+				if(fDist - fRadius < 0) vIntersectBits[i] |= 1<<lane;
+			}
+
+			for(int i=0; i<3; ++i)
+			{
+				if(vCenter.v[i] - vExtent.v[i] > mvFrustumMax.v[i] || vCenter.v[i] + vExtent.v[i] < mvFrustumMin.v[i]) bOutside = true;
+			}
+
+			if(bOutside) lOutsideBits |= 1<<lane;
+		}
+	#endif
+
+		if(apPlaneMasks)
+		{
+			for(int lane=0; lane<4; ++lane)
+			{
+				int lMask = 0;
+				for(int i=0; i<6; ++i)
+				{
+					if(vIntersectBits[i] & (1<<lane)) lMask |= 1<<i;
+				}
+				apPlaneMasks[lane] = lMask;
+			}
+		}
+
+		return ~lOutsideBits & lCountMask;
+	}
+
+	//-----------------------------------------------------------------------
+}
@@ -68,6 +68,7 @@ namespace hpl {
 		mpAI = apAI;
 		mpGui = apGui;
 		mpHaptic = apHaptic;
+		mpJobScheduler = NULL;
 
 		mpCurrentListener = NULL;
 	}
@@ -182,6 +183,18 @@ namespace hpl {
 		//Increase the frame count (do this at top, so render count is valid until this Render is called again!)
 		iRenderer::IncRenderFrameCount();
 
+		///////////////////////////////////////////
+		// Skin the animated meshes of all rendered worlds before any rendering is done
+		if(alFlags & tSceneRenderFlag_World)
+		{
+			for(tViewportListIt viewIt = mlstViewports.begin(); viewIt != mlstViewports.end(); ++viewIt)
+			{
+				cViewport *pViewPort = *viewIt;
+				if(pViewPort->IsVisible()==false || pViewPort->GetWorld()==NULL) continue;
+
+				pViewPort->GetWorld()->UpdateSkinnedMeshesForFrame(afFrameTime);
+			}
+		}
 
 		///////////////////////////////////////////
 		// Iterate all viewports and render
@@ -326,6 +339,7 @@ namespace hpl {
 	{
 		cWorld* pWorld = hplNew( cWorld, (asName,mpGraphics,mpResources,mpSound,mpPhysics,this,
 										mpSystem,mpAI,mpHaptic) );
+		pWorld->SetJobScheduler(mpJobScheduler);
 
 		mlstWorlds.push_back(pWorld);
 
@@ -27,6 +27,7 @@
 #include "graphics/Material.h"
 #include "graphics/Mesh.h"
 #include "graphics/SubMesh.h"
+#include "graphics/Skinning.h"
 
 #include "graphics/Animation.h"
 #include "graphics/AnimationTrack.h"
@@ -57,6 +58,8 @@ namespace hpl {
 		mpMaterialManager = apMaterialManager;
 
 		mbGraphicsUpdated = false;
+		mlSkinnedBoneMatricesCount = -1;
+		mbDynVtxBufferNeedsUpload = false;
 
 		if(mpMeshEntity->GetMesh()->GetSkeleton())
 		{
@@ -150,40 +153,6 @@ namespace hpl {
 
 	//-----------------------------------------------------------------------
 
-	// Set Src as private variable to give this a little boost! Or?
-	static inline void MatrixFloatTransformSet(float *pDest, const cMatrixf &a_mtxA, const float* pSrc, const float fWeight)
-	{
-		pDest[0] = ( a_mtxA.m[0][0] * pSrc[0] + a_mtxA.m[0][1] * pSrc[1] + a_mtxA.m[0][2] * pSrc[2] + a_mtxA.m[0][3] ) * fWeight;
-		pDest[1] = ( a_mtxA.m[1][0] * pSrc[0] + a_mtxA.m[1][1] * pSrc[1] + a_mtxA.m[1][2] * pSrc[2] + a_mtxA.m[1][3] ) * fWeight;
-		pDest[2] = ( a_mtxA.m[2][0] * pSrc[0] + a_mtxA.m[2][1] * pSrc[1] + a_mtxA.m[2][2] * pSrc[2] + a_mtxA.m[2][3] ) * fWeight;
-	}
-
-	static inline void MatrixFloatRotateSet(float *pDest, const cMatrixf &a_mtxA, const float* pSrc, const float fWeight)
-	{
-		pDest[0] = ( a_mtxA.m[0][0] * pSrc[0] + a_mtxA.m[0][1] * pSrc[1] + a_mtxA.m[0][2] * pSrc[2] ) * fWeight;
-		pDest[1] = ( a_mtxA.m[1][0] * pSrc[0] + a_mtxA.m[1][1] * pSrc[1] + a_mtxA.m[1][2] * pSrc[2] ) * fWeight;
-		pDest[2] = ( a_mtxA.m[2][0] * pSrc[0] + a_mtxA.m[2][1] * pSrc[1] + a_mtxA.m[2][2] * pSrc[2] ) * fWeight;
-	}
-
-	//-----------------------------------------------------------------------
-
-	// Set Src as private variable to give this a little boost!Or?
-	static inline void MatrixFloatTransformAdd(float *pDest, const cMatrixf &a_mtxA, const float* pSrc, const float fWeight)
-	{
-		pDest[0] += ( a_mtxA.m[0][0] * pSrc[0] + a_mtxA.m[0][1] * pSrc[1] + a_mtxA.m[0][2] * pSrc[2] + a_mtxA.m[0][3] ) * fWeight;
-		pDest[1] += ( a_mtxA.m[1][0] * pSrc[0] + a_mtxA.m[1][1] * pSrc[1] + a_mtxA.m[1][2] * pSrc[2] + a_mtxA.m[1][3] ) * fWeight;
-		pDest[2] += ( a_mtxA.m[2][0] * pSrc[0] + a_mtxA.m[2][1] * pSrc[1] + a_mtxA.m[2][2] * pSrc[2] + a_mtxA.m[2][3] ) * fWeight;
-	}
-
-	static inline void MatrixFloatRotateAdd(float *pDest, const cMatrixf &a_mtxA, const float* pSrc, const float fWeight)
-	{
-		pDest[0] += ( a_mtxA.m[0][0] * pSrc[0] + a_mtxA.m[0][1] * pSrc[1] + a_mtxA.m[0][2] * pSrc[2] ) * fWeight;
-		pDest[1] += ( a_mtxA.m[1][0] * pSrc[0] + a_mtxA.m[1][1] * pSrc[1] + a_mtxA.m[1][2] * pSrc[2] ) * fWeight;
-		pDest[2] += ( a_mtxA.m[2][0] * pSrc[0] + a_mtxA.m[2][1] * pSrc[1] + a_mtxA.m[2][2] * pSrc[2] ) * fWeight;
-	}
-
-	//-----------------------------------------------------------------------
-
 	void cSubMeshEntity::UpdateGraphicsForFrame(float afFrameTime)
 	{
 		////////////////////////////////////
@@ -194,70 +163,10 @@ namespace hpl {
 		// If it has dynamic mesh, update it.
 		if(mpDynVtxBuffer)
 		{
-			if(mpMeshEntity->mbSkeletonPhysicsSleeping && mbGraphicsUpdated)
-			{
-				return;
-			}
-			
-			mbGraphicsUpdated = true;
-
-			const float *pBindPos = mpSubMesh->GetVertexBuffer()->GetFloatArray(eVertexBufferElement_Position);
-			const float *pBindNormal = mpSubMesh->GetVertexBuffer()->GetFloatArray(eVertexBufferElement_Normal);
-			const float *pBindTangent = mpSubMesh->GetVertexBuffer()->GetFloatArray(eVertexBufferElement_Texture1Tangent);
-
-			float *pSkinPos = mpDynVtxBuffer->GetFloatArray(eVertexBufferElement_Position);
-			float *pSkinNormal = mpDynVtxBuffer->GetFloatArray(eVertexBufferElement_Normal);
-			float *pSkinTangent = mpDynVtxBuffer->GetFloatArray(eVertexBufferElement_Texture1Tangent);
-
-			const int lVtxStride = mpDynVtxBuffer->GetElementNum(eVertexBufferElement_Position);
-			const int lVtxNum = mpDynVtxBuffer->GetVertexNum();
-
-			for(int vtx=0; vtx < lVtxNum; vtx++)
-			{
-				//To count the bone bindings
-				int lCount = 0;
-				//Get pointer to weights and bone index.
-				const float *pWeight = &mpSubMesh->mpVertexWeights[vtx*4];
-				if(*pWeight==0) continue;
-
-				const unsigned char *pBoneIdx = &mpSubMesh->mpVertexBones[vtx*4];
-
-				const cMatrixf &mtxTransform = mpMeshEntity->mvBoneMatrices[*pBoneIdx];
-				
-				
-				MatrixFloatTransformSet(pSkinPos,mtxTransform, pBindPos, *pWeight);
-
-				MatrixFloatRotateSet(pSkinNormal,mtxTransform, pBindNormal, *pWeight);
-
-				MatrixFloatRotateSet(pSkinTangent,mtxTransform, pBindTangent, *pWeight);
+			UpdateSkinning();
 
-				++pWeight; ++pBoneIdx; ++lCount;
-
-				//Iterate weights until 0 is found or count < 4
-				while(*pWeight != 0 && lCount < 4)
-				{
-					//Log("Boneidx: %d Count %d Weight: %f\n",(int)*pBoneIdx,lCount, *pWeight);				
-					const cMatrixf &mtxTransform = mpMeshEntity->mvBoneMatrices[*pBoneIdx];
-
-					//Transform with the local movement of the bone.
-					MatrixFloatTransformAdd(pSkinPos,mtxTransform, pBindPos, *pWeight);
-
-					MatrixFloatRotateAdd(pSkinNormal,mtxTransform, pBindNormal, *pWeight);
-
-					MatrixFloatRotateAdd(pSkinTangent,mtxTransform, pBindTangent, *pWeight);
-
-					++pWeight; ++pBoneIdx; ++lCount;
-				}
-
-				pBindPos += lVtxStride;
-				pSkinPos += lVtxStride;
-
-				pBindNormal += 3;
-				pSkinNormal += 3;
-
-				pBindTangent += 4;
-				pSkinTangent += 4;
-			}
+			if(mbDynVtxBufferNeedsUpload==false) return;
+			mbDynVtxBufferNeedsUpload = false;
 
 			//No stencil shadows:
 			/*float *pSkinPosArray = mpDynVtxBuffer->GetArray(eVertexElementFlag_Position);
@@ -288,6 +197,45 @@ namespace hpl {
 
 	//-----------------------------------------------------------------------
 
+	void cSubMeshEntity::UpdateSkinning()
+	{
+		if(mpDynVtxBuffer==NULL) return;
+
+		if(mpMeshEntity->mbSkeletonPhysicsSleeping && mbGraphicsUpdated)
+		{
+			return;
+		}
+
+		//Skip if already skinned with the current bone matrices
+		if(mlSkinnedBoneMatricesCount == mpMeshEntity->mlBoneMatricesUpdateCount) return;
+		mlSkinnedBoneMatricesCount = mpMeshEntity->mlBoneMatricesUpdateCount;
+		
+		mbGraphicsUpdated = true;
+
+		iVertexBuffer *pBindVtxBuffer = mpSubMesh->GetVertexBuffer();
+
+		cSkinningParams skinParams;
+		skinParams.mpStreams = mpSubMesh->GetSkinningStreams();
+		skinParams.mpBoneMatrices = &mpMeshEntity->mvBoneMatrices[0];
+		
+		skinParams.mpBindPos = pBindVtxBuffer->GetFloatArray(eVertexBufferElement_Position);
+		skinParams.mpBindNormal = pBindVtxBuffer->GetFloatArray(eVertexBufferElement_Normal);
+		skinParams.mpBindTangent = pBindVtxBuffer->GetFloatArray(eVertexBufferElement_Texture1Tangent);
+
+		skinParams.mpSkinPos = mpDynVtxBuffer->GetFloatArray(eVertexBufferElement_Position);
+		skinParams.mpSkinNormal = mpDynVtxBuffer->GetFloatArray(eVertexBufferElement_Normal);
+		skinParams.mpSkinTangent = mpDynVtxBuffer->GetFloatArray(eVertexBufferElement_Texture1Tangent);
+
+		skinParams.mlPosStride = mpDynVtxBuffer->GetElementNum(eVertexBufferElement_Position);
+		skinParams.mlEndVertex = mpDynVtxBuffer->GetVertexNum();
+
+		cSkinning::SkinVertices(skinParams);
+
+		mbDynVtxBufferNeedsUpload = true;
+	}
+
+	//-----------------------------------------------------------------------
+
 
 	iVertexBuffer* cSubMeshEntity::GetVertexBuffer()
 	{
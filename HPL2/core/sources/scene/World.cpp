@@ -24,6 +24,7 @@
 #include "system/Script.h"
 #include "system/String.h"
 #include "system/LowLevelSystem.h"
+#include "system/JobScheduler.h"
 
 #include "math/Math.h"
 #include "math/MathTypes.h"
@@ -56,6 +57,7 @@
 #include "scene/LightSpot.h"
 #include "scene/LightBox.h"
 #include "scene/MeshEntity.h"
+#include "scene/SubMeshEntity.h"
 #include "scene/SoundEntity.h"
 #include "scene/ParticleEmitter.h"
 #include "scene/ParticleSystem.h"
@@ -67,6 +69,7 @@
 #include "scene/RenderableContainer_List.h"
 #include "scene/RenderableContainer_BoxTree.h"
 #include "scene/RenderableContainer_DynBoxTree.h"
+#include "scene/RenderableContainer_FlatBVH.h"
 #include "scene/DummyRenderable.h"
 
 #include "system/System.h"
@@ -85,6 +88,7 @@
 #include "ai/AINodeContainer.h"
 #include "ai/AINodeGenerator.h"
 #include "ai/AStar.h"
+#include "ai/AStarRequestQueue.h"
 
 #include "haptic/Haptic.h"
 #include "haptic/LowLevelHaptic.h"
@@ -123,12 +127,15 @@ namespace hpl {
 		mlSoundCreationIDCount =0;
 
 		//TODO: Have the container type as param and create.
-		mpRenderableContainer[eWorldContainerType_Static] = hplNew( cRenderableContainer_BoxTree, () );
+		mpRenderableContainer[eWorldContainerType_Static] = hplNew( cRenderableContainer_FlatBVH, () );
 		mpRenderableContainer[eWorldContainerType_Dynamic] = hplNew( cRenderableContainer_DynBoxTree, () );
 
 		mpPhysicsWorld = NULL;
 		mbAutoDeletePhysicsWorld = false;
 
+		mpJobScheduler = NULL;
+		mlSkinnedMeshesFrameCount = -1;
+
 		//////////////////////////////
 		//Sky box
 		mpSkyBoxVtxBuffer = mpGraphics->GetMeshCreator()->CreateSkyBoxVertexBuffer(1);
@@ -197,10 +204,23 @@ namespace hpl {
 		STLDeleteAll(mlstRopeEntities);
 		STLDeleteAll(mlstFogAreas);
 		STLDeleteAll(mlstStartPosEntities);
+		mDynamicMeshEntityNameIndex.Clear();
+		mLightNameIndex.Clear();
+		mBillboardNameIndex.Clear();
+		mBeamNameIndex.Clear();
+		mParticleSystemNameIndex.Clear();
+		mGuiSetEntityNameIndex.Clear();
+		mRopeEntityNameIndex.Clear();
+		mFogAreaNameIndex.Clear();
+		mStartPosEntityNameIndex.Clear();
 		STLMapDeleteAll(m_mapAreaEntities);
 
 
 		STLDeleteAll(mlstAINodeContainers);
+		for(tAStarHandlerIt it = mlstAStarHandlers.begin(); it != mlstAStarHandlers.end(); ++it)
+		{
+			mpAI->GetAStarRequestQueue()->CancelRequest(*it);
+		}
 		STLDeleteAll(mlstAStarHandlers);
 		STLMapDeleteAll(m_mapTempNodes);
 
@@ -212,6 +232,7 @@ namespace hpl {
 
 		//So that bodies can stop sound entities on destruction.
 		STLDeleteAll(mlstSoundEntities);
+		mSoundEntityNameIndex.Clear();
 
 	}
 
@@ -434,7 +455,10 @@ namespace hpl {
 		if(abStatic)
 			mlstStaticMeshEntities.push_back(pMeshEntity);
 		else
+		{
 			mlstDynamicMeshEntities.push_back(pMeshEntity);
+			mDynamicMeshEntityNameIndex.Add(pMeshEntity);
+		}
 
 
 		//////////////////////////////
@@ -467,14 +491,17 @@ namespace hpl {
 		if(apMesh->IsStatic())
 			STLFindAndDelete(mlstStaticMeshEntities,apMesh);
 		else
+		{
+			mDynamicMeshEntityNameIndex.Remove(apMesh);
 			STLFindAndDelete(mlstDynamicMeshEntities,apMesh);
+		}
 	}
 
 	//-----------------------------------------------------------------------
 
 	cMeshEntity* cWorld::GetDynamicMeshEntity(const tString& asName)
 	{
-		 return (cMeshEntity*)STLFindByName(mlstDynamicMeshEntities, asName);
+		 return mDynamicMeshEntityNameIndex.Find(asName);
 	}
 
 	//-----------------------------------------------------------------------
@@ -512,6 +539,7 @@ namespace hpl {
 	{
 		cLightPoint* pLight = hplNew( cLightPoint, (asName,mpResources) );
 		mlstLights.push_back(pLight);
+		mLightNameIndex.Add(pLight);
 
 		if(asGobo != "")
 		{
@@ -537,6 +565,7 @@ namespace hpl {
 	{
 		cLightSpot* pLight = hplNew( cLightSpot, (asName,mpResources) );
 		mlstLights.push_back(pLight);
+		mLightNameIndex.Add(pLight);
 
 		if(asGobo != "")
 		{
@@ -561,6 +590,7 @@ namespace hpl {
 	{
 		cLightBox* pLight = hplNew( cLightBox, (asName,mpResources) );
 		mlstLights.push_back(pLight);
+		mLightNameIndex.Add(pLight);
 
 		pLight->SetStatic(abStatic);
 		AddRenderableToContainer(pLight);
@@ -576,6 +606,7 @@ namespace hpl {
 	{
 		RemoveRenderableFromContainer(apLight);
 
+		mLightNameIndex.Remove(apLight);
 		STLFindAndDelete(mlstLights, apLight);
 	}
 
@@ -583,14 +614,7 @@ namespace hpl {
 
 	iLight* cWorld::GetLight(const tString& asName)
 	{
-		tLightListIt LightIt=mlstLights.begin();
-		for(;LightIt !=mlstLights.end();++LightIt)
-		{
-			if((*LightIt)->GetName() == asName){
-				return *LightIt;
-			}
-		}
-		return NULL;
+		return mLightNameIndex.Find(asName);
 	}
 
 	iLight* cWorld::GetLightFromUniqueID(int alID)
@@ -612,6 +636,7 @@ namespace hpl {
 	{
 		cBillboard* pBillboard = hplNew( cBillboard, (asName, avSize,aType,mpResources,mpGraphics) );
 		mlstBillboards.push_back(pBillboard);
+		mBillboardNameIndex.Add(pBillboard);
 
 		if(asMaterial!="")
 		{
@@ -630,6 +655,7 @@ namespace hpl {
 	{
 		RemoveRenderableFromContainer(apObject);
 
+		mBillboardNameIndex.Remove(apObject);
 		STLFindAndDelete(mlstBillboards, apObject);
 	}
 
@@ -637,7 +663,7 @@ namespace hpl {
 
 	cBillboard* cWorld::GetBillboard(const tString& asName)
 	{
-		return (cBillboard*)STLFindByName(mlstBillboards,asName);
+		return mBillboardNameIndex.Find(asName);
 	}
 
 	cBillboard* cWorld::GetBillboardFromUniqueID(int alID)
@@ -666,6 +692,7 @@ namespace hpl {
 	{
 		cBeam* pBeam = hplNew( cBeam, (asName,mpResources,mpGraphics) );
 		mlstBeams.push_back(pBeam);
+		mBeamNameIndex.Add(pBeam);
 
 		pBeam->SetStatic(abStatic);
 		AddRenderableToContainer(pBeam);
@@ -679,6 +706,7 @@ namespace hpl {
 	{
 		RemoveRenderableFromContainer(apObject);
 
+		mBeamNameIndex.Remove(apObject);
 		STLFindAndDelete(mlstBeams, apObject);
 	}
 
@@ -686,7 +714,7 @@ namespace hpl {
 
 	cBeam* cWorld::GetBeam(const tString& asName)
 	{
-		return (cBeam*)STLFindByName(mlstBeams,asName);
+		return mBeamNameIndex.Find(asName);
 	}
 
 	cBeam* cWorld::GetBeamFromUniqueID(int alID)
@@ -740,6 +768,7 @@ namespace hpl {
 		}
 
 		mlstParticleSystems.push_back(pPS);
+		mParticleSystemNameIndex.Add(pPS);
 
 		//Log("Created particle system '%s'\n",asType.c_str());
 
@@ -770,6 +799,7 @@ namespace hpl {
 		}
 
 		mlstParticleSystems.push_back(pPS);
+		mParticleSystemNameIndex.Add(pPS);
 
 		//Log("Created particle system '%s'\n",asType.c_str());
 
@@ -789,6 +819,7 @@ namespace hpl {
 			RemoveRenderableFromContainer(pPE);
 		}
 
+		mParticleSystemNameIndex.Remove(apPS);
 		STLFindAndDelete(mlstParticleSystems, apPS);
 	}
 
@@ -796,7 +827,7 @@ namespace hpl {
 
 	cParticleSystem* cWorld::GetParticleSystem(const tString& asName)
 	{
-		return (cParticleSystem*)STLFindByName(mlstParticleSystems,asName);
+		return mParticleSystemNameIndex.Find(asName);
 	}
 
 	cParticleSystem* cWorld::GetParticleSystemFromUniqueID(int alID)
@@ -836,6 +867,7 @@ namespace hpl {
 			hplDelete(pPS);
 		}
 		mlstParticleSystems.clear();
+		mParticleSystemNameIndex.Clear();
 	}
 
 	//-----------------------------------------------------------------------
@@ -844,6 +876,7 @@ namespace hpl {
 	{
 		cGuiSetEntity *pSetEntity = hplNew( cGuiSetEntity, (asName, apSet) );
 		mlstGuiSetEntities.push_back(pSetEntity);
+		mGuiSetEntityNameIndex.Add(pSetEntity);
 
 		pSetEntity->SetStatic(abStatic);
 		AddRenderableToContainer(pSetEntity);
@@ -855,12 +888,13 @@ namespace hpl {
 	{
 		//TODO...RemoveRenderableFromContainer(...), etc
 
+		mGuiSetEntityNameIndex.Remove(apObject);
 		STLFindAndDelete(mlstGuiSetEntities, apObject);
 	}
 	
 	cGuiSetEntity* cWorld::GetGuiSetEntity(const tString& asName)
 	{
-		return static_cast<cGuiSetEntity*>(STLFindByName(mlstGuiSetEntities, asName));
+		return mGuiSetEntityNameIndex.Find(asName);
 	}
 
 	cGuiSetEntity* cWorld::GetGuiSetEntityFromUniqueID(int alID)
@@ -883,6 +917,7 @@ namespace hpl {
 	{
 		cRopeEntity *pRope = hplNew( cRopeEntity, (asName, mpResources, mpGraphics, apRope, alMaxSegments));
 		mlstRopeEntities.push_back(pRope);
+		mRopeEntityNameIndex.Add(pRope);
 
 		AddRenderableToContainer(pRope);
 		
@@ -893,12 +928,13 @@ namespace hpl {
 	{
 		RemoveRenderableFromContainer(apRope);
 
+		mRopeEntityNameIndex.Remove(apRope);
 		STLFindAndDelete(mlstRopeEntities, apRope);
 	}
 
 	cRopeEntity* cWorld::GetRopeEntity(const tString& asName)
 	{
-		return static_cast<cRopeEntity*>(STLFindByName(mlstRopeEntities, asName));
+		return mRopeEntityNameIndex.Find(asName);
 	}
 
 	cRopeEntity* cWorld::GetRopeEntityFromUniqueID(int alID)
@@ -921,6 +957,7 @@ namespace hpl {
 	{
 		cFogArea *pFog = hplNew( cFogArea, (asName, mpResources));
 		mlstFogAreas.push_back(pFog);
+		mFogAreaNameIndex.Add(pFog);
 		pFog->SetStatic(abStatic);
 
 
@@ -933,12 +970,13 @@ namespace hpl {
 	{
 		RemoveRenderableFromContainer(apRope);
 
+		mFogAreaNameIndex.Remove(apRope);
 		STLFindAndDelete(mlstFogAreas, apRope);
 	}
 
 	cFogArea* cWorld::GetFogArea(const tString& asName)
 	{
-		return static_cast<cFogArea*>(STLFindByName(mlstFogAreas, asName));
+		return mFogAreaNameIndex.Find(asName);
 	}
 
 	cFogArea* cWorld::GetFogAreaFromUniqueID(int alID)
@@ -984,6 +1022,7 @@ namespace hpl {
 		}*/
 
 		mlstSoundEntities.push_back(pSound);
+		mSoundEntityNameIndex.Add(pSound);
 
 		return pSound;
 	}
@@ -999,6 +1038,7 @@ namespace hpl {
 			cSoundEntity *pSound = *it;
 			if(pSound == apEntity)
 			{
+				mSoundEntityNameIndex.Remove(pSound);
 				mlstSoundEntities.erase(it);
 				hplDelete(pSound);
 				//mlstSoundEntityPool.push_back(apEntity);
@@ -1031,12 +1071,13 @@ namespace hpl {
 		//Destroy all sound entities
 		STLDeleteAll(mlstSoundEntities);
 		mlstSoundEntities.clear();
+		mSoundEntityNameIndex.Clear();
 	}
 
 
 	cSoundEntity* cWorld::GetSoundEntity(const tString& asName)
 	{
-		return (cSoundEntity*)STLFindByName(mlstSoundEntities,asName);
+		return mSoundEntityNameIndex.Find(asName);
 	}
 
 	cSoundEntity* cWorld::GetSoundEntityFromUniqueID(int alID)
@@ -1072,13 +1113,14 @@ namespace hpl {
 		cStartPosEntity *pStartPos = hplNew( cStartPosEntity, (asName) );
 
 		mlstStartPosEntities.push_back(pStartPos);
+		mStartPosEntityNameIndex.Add(pStartPos);
 
 		return pStartPos;
 	}
 
 	cStartPosEntity* cWorld::GetStartPosEntity(const tString &asName)
 	{
-		return (cStartPosEntity*)STLFindByName(mlstStartPosEntities,asName);
+		return mStartPosEntityNameIndex.Find(asName);
 	}
 
 	cStartPosEntity* cWorld::GetFirstStartPosEntity()
@@ -1128,7 +1170,7 @@ namespace hpl {
 
 		tWString sAiFileName = cString::SetFileExtW(sMapPath,_W(""));
 		sAiFileName += _W("_")+cString::To16Char(asName);
-		sAiFileName = cString::SetFileExtW(sAiFileName,_W("nodes"));
+		sAiFileName = cString::SetFileExtW(sAiFileName,_W("ai_cache"));
 
 		//////////////////////////////////
 		//If there is no container created, create it.
@@ -1170,8 +1212,7 @@ namespace hpl {
 
 				if(dateAIFile > dateMapFile || cResources::GetForceCacheLoadingAndSkipSaving())
 				{
-					bLoadedFromFile = true;
-					pContainer->LoadFromFile(sAiFileName);
+					bLoadedFromFile = pContainer->LoadFromFile(sAiFileName);
 				}
 			}
 			
@@ -1210,6 +1251,7 @@ namespace hpl {
 
 	void cWorld::DestroyAStarHandler(cAStarHandler* apHandler)
 	{
+		mpAI->GetAStarRequestQueue()->CancelRequest(apHandler);
 		STLFindAndDelete(mlstAStarHandlers, apHandler);
 	}
 
@@ -1262,6 +1304,7 @@ namespace hpl {
 	{
 		cDummyRenderable *pDummy = hplNew( cDummyRenderable, (asName));
 		mlstDummyRenderables.push_back(pDummy);
+		mDummyRenderableNameIndex.Add(pDummy);
 		pDummy->SetStatic(abStatic);
 
 		AddRenderableToContainer(pDummy);
@@ -1273,12 +1316,13 @@ namespace hpl {
 	{
 		RemoveRenderableFromContainer(apDummy);
 
+		mDummyRenderableNameIndex.Remove(apDummy);
 		STLFindAndDelete(mlstDummyRenderables, apDummy);
 	}
 
 	cDummyRenderable* cWorld::GetDummyRenderable(const tString& asName)
 	{
-		return static_cast<cDummyRenderable*>(STLFindByName(mlstDummyRenderables, asName));
+		return mDummyRenderableNameIndex.Find(asName);
 	}
 
 	cDummyRenderable* cWorld::GetDummyRenderableFromUniqueID(int alID)
@@ -1334,6 +1378,7 @@ namespace hpl {
 			//Check if the system is alive, else destroy
 			if(pPS->GetRemoveWhenDead() && pPS->IsDead())
 			{
+				mParticleSystemNameIndex.Remove(pPS);
                 it = mlstParticleSystems.erase(it);
 				for(int i=0; i< pPS->GetEmitterNum();++i)
 				{
@@ -1350,32 +1395,146 @@ namespace hpl {
 	//-----------------------------------------------------------------------
 
 
+	class cMeshEntityAnimationFunc : public iJobRangeFunc
+	{
+	public:
+		void RunJobRange(int alStart, int alEnd, int alThreadSlot)
+		{
+			for(int i=alStart; i<alEnd; ++i) (*mpEntities)[i]->UpdateSkeletonAnimation(mfTimeStep);
+		}
+
+		std::vector<cMeshEntity*> *mpEntities;
+		float mfTimeStep;
+	};
+
+	//////////////////////////////////////
+
 	void cWorld::UpdateEntities(float afTimeStep)
 	{
 		//static size_t lLastSize = 0;
 		//bool bRenderDebug = lLastSize != mlstDynamicMeshEntities.size() && mlstDynamicMeshEntities.size()>=2;
 		//if(mlstDynamicMeshEntities.size()>=2) lLastSize = mlstDynamicMeshEntities.size();
-        	
+		
+		//////////////////////////////
+		// Everything that touches other objects (physics, attached entities, callbacks) is done in the
+		// before and after steps. The skeleton animations in between only touch the entity itself.
+		mvTempAnimatedMeshEntities.resize(0);
+
 		tMeshEntityListIt MeshIt = mlstDynamicMeshEntities.begin();
 		tMeshEntityListIt endIt =mlstDynamicMeshEntities.end();
-		//if(bRenderDebug)Log("----\n");
 		for(;MeshIt != endIt;MeshIt++)
 		{
 			cMeshEntity *pEntity = *MeshIt;
 
 			if(pEntity->IsActive()){
-				//if(pEntity->IsStatic()==false) START_TIMING_EX(pEntity->GetName().c_str(),entity);
-				pEntity->UpdateLogic(afTimeStep);
-				//if(bRenderDebug) Log("Enitity '%s'. Pos: (%s), Matrix: (%s)\n", pEntity->GetName().c_str(), pEntity->GetWorldPosition().ToString().c_str(),
-																			//pEntity->GetWorldMatrix().ToString().c_str());
-				//if(pEntity->IsStatic()==false) STOP_TIMING(entity);
+				pEntity->UpdateLogicBeforeAnimation(afTimeStep);
+				if(pEntity->HasPendingSkeletonAnimation()) mvTempAnimatedMeshEntities.push_back(pEntity);
 			}
 		}
+
+		//////////////////////////////
+		// Skeleton animations
+		cMeshEntityAnimationFunc animFunc;
+		animFunc.mpEntities = &mvTempAnimatedMeshEntities;
+		animFunc.mfTimeStep = afTimeStep;
+
+		int lAnimatedNum = (int)mvTempAnimatedMeshEntities.size();
+		if(mpJobScheduler && mpJobScheduler->GetWorkerNum()>0 && lAnimatedNum > 1)
+			mpJobScheduler->ParallelFor(0, lAnimatedNum, 1, &animFunc);
+		else
+			animFunc.RunJobRange(0, lAnimatedNum, -1);
+
+		//////////////////////////////
+		// After animation
+		MeshIt = mlstDynamicMeshEntities.begin();
+		endIt =mlstDynamicMeshEntities.end();
+		//if(bRenderDebug)Log("----\n");
+		for(;MeshIt != endIt;MeshIt++)
+		{
+			cMeshEntity *pEntity = *MeshIt;
+
+			//if(pEntity->IsStatic()==false) START_TIMING_EX(pEntity->GetName().c_str(),entity);
+			pEntity->UpdateLogicAfterAnimation(afTimeStep);
+			//if(bRenderDebug) Log("Enitity '%s'. Pos: (%s), Matrix: (%s)\n", pEntity->GetName().c_str(), pEntity->GetWorldPosition().ToString().c_str(),
+																		//pEntity->GetWorldMatrix().ToString().c_str());
+			//if(pEntity->IsStatic()==false) STOP_TIMING(entity);
+		}
 		//if(bRenderDebug)Log("----\n");
 	}
 
 	//-----------------------------------------------------------------------
 
+	class cMeshEntitySkinningFunc : public iJobRangeFunc
+	{
+	public:
+		void RunJobRange(int alStart, int alEnd, int alThreadSlot)
+		{
+			for(int i=alStart; i<alEnd; ++i)
+			{
+				cMeshEntity *pEntity = (*mpEntities)[i];
+				
+				pEntity->UpdateGraphicsForFrame(mfFrameTime);
+				for(int sub=0; sub<pEntity->GetSubMeshEntityNum(); ++sub)
+				{
+					pEntity->GetSubMeshEntity(sub)->UpdateSkinning();
+				}
+			}
+		}
+
+		std::vector<cMeshEntity*> *mpEntities;
+		float mfFrameTime;
+	};
+
+	//////////////////////////////////////
+
+	void cWorld::UpdateSkinnedMeshesForFrame(float afFrameTime)
+	{
+		if(mlSkinnedMeshesFrameCount == iRenderer::GetRenderFrameCount()) return;
+		mlSkinnedMeshesFrameCount = iRenderer::GetRenderFrameCount();
+
+		//////////////////////////////
+		// Gather animated meshes that were rendered last frame, those not seen are skinned when added to a render list.
+		int lLastFrame = iRenderer::GetRenderFrameCount()-1;
+		mvTempAnimatedMeshEntities.resize(0);
+
+		tMeshEntityListIt MeshIt = mlstDynamicMeshEntities.begin();
+		for(;MeshIt != mlstDynamicMeshEntities.end();++MeshIt)
+		{
+			cMeshEntity *pEntity = *MeshIt;
+			if(pEntity->IsActive()==false || pEntity->IsVisible()==false || pEntity->GetMesh()->GetSkeleton()==NULL) continue;
+
+			bool bRendered = false;
+			for(int sub=0; sub<pEntity->GetSubMeshEntityNum(); ++sub)
+			{
+				cSubMeshEntity *pSubEntity = pEntity->GetSubMeshEntity(sub);
+				if(pSubEntity->HasDynamicVertexBuffer() && pSubEntity->GetRenderFrameCount() == lLastFrame)
+				{
+					bRendered = true;
+					break;
+				}
+			}
+			if(bRendered==false) continue;
+
+			//Update the world matrix here so the jobs do not update any shared parents.
+			pEntity->GetWorldMatrix();
+			mvTempAnimatedMeshEntities.push_back(pEntity);
+		}
+
+		//////////////////////////////
+		// Bone matrices and skinning, single join
+		cMeshEntitySkinningFunc skinFunc;
+		skinFunc.mpEntities = &mvTempAnimatedMeshEntities;
+		skinFunc.mfFrameTime = afFrameTime;
+
+		int lEntityNum = (int)mvTempAnimatedMeshEntities.size();
+		if(mpJobScheduler && mpJobScheduler->GetWorkerNum()>0 && lEntityNum > 1)
+			mpJobScheduler->ParallelFor(0, lEntityNum, 1, &skinFunc);
+		else
+			skinFunc.RunJobRange(0, lEntityNum, -1);
+	}
+
+	//-----------------------------------------------------------------------
+
 	void cWorld::UpdateLights(float afTimeStep)
 	{
 		tLightListIt it = mlstLights.begin();
@@ -1405,6 +1564,7 @@ namespace hpl {
 			//Check if the system is stopped, else destroy
 			if(pSound->IsStopped() && pSound->GetRemoveWhenOver())
 			{
+				mSoundEntityNameIndex.Remove(pSound);
 				it =  mlstSoundEntities.erase(it);
 				//mlstSoundEntityPool.push_back(pSound);
 				hplDelete(pSound);
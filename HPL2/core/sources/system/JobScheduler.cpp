@@ -0,0 +1,356 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "system/JobScheduler.h"
+
+#include "system/Platform.h"
+#include "system/Thread.h"
+#include "system/LowLevelSystem.h"
+#include "system/MemoryManager.h"
+
+#include "math/Math.h"
+
+#include <thread>
+
+namespace hpl {
+
+	//////////////////////////////////////////////////////////////////////////
+	// THREAD LOCAL DATA
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	// Set by the worker threads so a scheduler can tell if a caller is one of its workers.
+	static thread_local cJobScheduler* gpCurrentJobScheduler = NULL;
+	static thread_local int glCurrentJobWorker = -1;
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// WORKER
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	class cJobScheduler::cJobWorker : public iThreadClass
+	{
+	public:
+		cJobWorker(cJobScheduler* apScheduler, int alWorker) : mpScheduler(apScheduler), mlWorker(alWorker) {}
+
+		void UpdateThread()
+		{
+			gpCurrentJobScheduler = mpScheduler;
+			glCurrentJobWorker = mlWorker;
+
+			mpScheduler->WorkerLoop(mlWorker);
+		}
+
+	private:
+		cJobScheduler* mpScheduler;
+		int mlWorker;
+	};
+
+	//-----------------------------------------------------------------------
+
+	class cJobRange : public iJob
+	{
+	public:
+		void RunJob()
+		{
+			mpFunc->RunJobRange(mlStart, mlEnd, mpScheduler->GetCurrentThreadSlot());
+		}
+
+		cJobScheduler* mpScheduler;
+		iJobRangeFunc* mpFunc;
+		int mlStart;
+		int mlEnd;
+	};
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// CONSTRUCTORS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	cJobScheduler::cJobScheduler(int alNumWorkers) : mlQueuedJobs(0), mlSleepingWorkers(0), mbShutdown(false)
+	{
+		mlWorkerNum = cMath::Max(alNumWorkers, 0);
+
+		//One queue per worker and the last one shared by all other threads
+		mvQueues.resize(mlWorkerNum+1);
+		for(size_t i=0; i<mvQueues.size(); ++i)
+			mvQueues[i] = hplNew(cJobQueue, ());
+
+		mvWorkers.resize(mlWorkerNum);
+		mvThreads.resize(mlWorkerNum);
+		for(int i=0; i<mlWorkerNum; ++i)
+		{
+			mvWorkers[i] = hplNew(cJobWorker, (this, i));
+			mvThreads[i] = cPlatform::CreateThread(mvWorkers[i]);
+			mvThreads[i]->SetSleepTime(0);
+			mvThreads[i]->Start();
+		}
+
+		Log("  Created job scheduler with %d worker threads\n", mlWorkerNum);
+	}
+
+	//-----------------------------------------------------------------------
+
+	cJobScheduler::~cJobScheduler()
+	{
+		/////////////////////////
+		// Wake up and stop the workers
+		{
+			std::lock_guard<std::mutex> lock(mSleepMutex);
+			mbShutdown = true;
+		}
+		mWakeCondition.notify_all();
+
+		for(int i=0; i<mlWorkerNum; ++i)
+		{
+			mvThreads[i]->Stop();
+			hplDelete(mvThreads[i]);
+			hplDelete(mvWorkers[i]);
+		}
+
+		/////////////////////////
+		// Run anything left so groups are not left hanging
+		cJobEntry job;
+		while(PopJob(mlWorkerNum, job) || StealJob(mlWorkerNum, job))
+		{
+			RunJob(job);
+		}
+
+		STLDeleteAll(mvQueues);
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// PUBLIC METHODS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	int cJobScheduler::GetCurrentThreadSlot()
+	{
+		if(gpCurrentJobScheduler == this) return glCurrentJobWorker;
+		return mlWorkerNum;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cJobScheduler::AddJob(iJob* apJob, cJobGroup* apGroup)
+	{
+		if(apGroup) apGroup->mlPendingJobs++;
+
+		PushJob(cJobEntry(apJob, apGroup));
+		WakeWorkers(1);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cJobScheduler::AddJobs(iJob** apJobs, int alNum, cJobGroup* apGroup)
+	{
+		if(alNum <= 0) return;
+
+		if(apGroup) apGroup->mlPendingJobs += alNum;
+
+		for(int i=0; i<alNum; ++i)
+			PushJob(cJobEntry(apJobs[i], apGroup));
+		
+		WakeWorkers(alNum);
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cJobScheduler::Wait(cJobGroup* apGroup)
+	{
+		int lSlot = GetCurrentThreadSlot();
+
+		while(apGroup->IsDone()==false)
+		{
+			//Help out while the group is running, if nothing is left in the queues the remaining jobs are already running.
+			if(RunNextJob(lSlot)==false)
+				std::this_thread::yield();
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cJobScheduler::ParallelFor(int alStart, int alEnd, int alGrainSize, iJobRangeFunc* apFunc)
+	{
+		int lCount = alEnd - alStart;
+		if(lCount <= 0) return;
+
+		/////////////////////////
+		// Get the size of each chunk
+		int lGrainSize = alGrainSize;
+		if(lGrainSize <= 0)
+		{
+			//A few chunks per thread so stealing can even out uneven work
+			lGrainSize = cMath::Max(lCount / (GetThreadSlotNum()*4), 1);
+		}
+
+		int lChunkNum = (lCount + lGrainSize-1) / lGrainSize;
+
+		/////////////////////////
+		// Not worth splitting up
+		if(lChunkNum==1 || mlWorkerNum==0)
+		{
+			apFunc->RunJobRange(alStart, alEnd, GetCurrentThreadSlot());
+			return;
+		}
+
+		/////////////////////////
+		// Run chunks as jobs
+		std::vector<cJobRange> vRanges(lChunkNum);
+		std::vector<iJob*> vJobs(lChunkNum);
+		for(int i=0; i<lChunkNum; ++i)
+		{
+			cJobRange& range = vRanges[i];
+			range.mpScheduler = this;
+			range.mpFunc = apFunc;
+			range.mlStart = alStart + i*lGrainSize;
+			range.mlEnd = cMath::Min(range.mlStart + lGrainSize, alEnd);
+
+			vJobs[i] = &range;
+		}
+
+		cJobGroup group;
+		AddJobs(&vJobs[0], lChunkNum, &group);
+		Wait(&group);
+	}
+
+	//-----------------------------------------------------------------------
+
+	//////////////////////////////////////////////////////////////////////////
+	// PRIVATE METHODS
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	void cJobScheduler::PushJob(const cJobEntry& aJob)
+	{
+		cJobQueue* pQueue = mvQueues[GetCurrentThreadSlot()];
+		{
+			std::lock_guard<std::mutex> lock(pQueue->mMutex);
+			pQueue->mdqJobs.push_back(aJob);
+			mlQueuedJobs++;
+		}
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cJobScheduler::WakeWorkers(int alNum)
+	{
+		//Workers raise the sleep count before checking the queued count, so if none are sleeping here they will see the new job.
+		if(mlSleepingWorkers.load()==0) return;
+
+		{
+			std::lock_guard<std::mutex> lock(mSleepMutex);
+		}
+		if(alNum==1)	mWakeCondition.notify_one();
+		else			mWakeCondition.notify_all();
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cJobScheduler::PopJob(int alSlot, cJobEntry& aJob)
+	{
+		cJobQueue* pQueue = mvQueues[alSlot];
+		
+		std::lock_guard<std::mutex> lock(pQueue->mMutex);
+		if(pQueue->mdqJobs.empty()) return false;
+
+		aJob = pQueue->mdqJobs.back();
+		pQueue->mdqJobs.pop_back();
+		mlQueuedJobs--;
+
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cJobScheduler::StealJob(int alSlot, cJobEntry& aJob)
+	{
+		int lQueueNum = (int)mvQueues.size();
+		for(int i=1; i<lQueueNum; ++i)
+		{
+			cJobQueue* pQueue = mvQueues[(alSlot + i) % lQueueNum];
+
+			std::lock_guard<std::mutex> lock(pQueue->mMutex);
+			if(pQueue->mdqJobs.empty()) continue;
+
+			aJob = pQueue->mdqJobs.front();
+			pQueue->mdqJobs.pop_front();
+			mlQueuedJobs--;
+
+			return true;
+		}
+
+		return false;
+	}
+
+	//-----------------------------------------------------------------------
+
+	bool cJobScheduler::RunNextJob(int alSlot)
+	{
+		if(mlQueuedJobs.load() <= 0) return false;
+
+		cJobEntry job;
+		if(PopJob(alSlot, job)==false && StealJob(alSlot, job)==false) return false;
+
+		RunJob(job);
+		return true;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cJobScheduler::RunJob(cJobEntry& aJob)
+	{
+		aJob.mpJob->RunJob();
+
+		if(aJob.mpGroup) aJob.mpGroup->mlPendingJobs--;
+	}
+
+	//-----------------------------------------------------------------------
+
+	void cJobScheduler::WorkerLoop(int alWorker)
+	{
+		while(mbShutdown.load()==false)
+		{
+			if(RunNextJob(alWorker)) continue;
+
+			/////////////////////////
+			// Nothing to do, sleep until new jobs are added
+			std::unique_lock<std::mutex> lock(mSleepMutex);
+			mlSleepingWorkers++;
+			while(mlQueuedJobs.load() <= 0 && mbShutdown.load()==false)
+			{
+				mWakeCondition.wait(lock);
+			}
+			mlSleepingWorkers--;
+		}
+	}
+
+	//-----------------------------------------------------------------------
+}
@@ -19,6 +19,8 @@
 
 #include "system/Platform.h"
 #include "system/LowLevelSystem.h"
+#include "system/JobScheduler.h"
+#include "system/MemoryManager.h"
 
 #include "graphics/GraphicsTypes.h"
 #include "math/MathTypes.h"
@@ -127,4 +129,17 @@ namespace hpl
 
 	//---------------------------------------------------------------
 
+	/////////////////////////////////////////////////////////////////
+	// Threading
+
+	cJobScheduler* cPlatform::CreateJobScheduler(int alNumWorkers)
+	{
+		if(alNumWorkers < 0)
+			alNumWorkers = GetNumberOfCores()-1;
+
+		return hplNew(cJobScheduler, (alNumWorkers));
+	}
+
+	//---------------------------------------------------------------
+
 }
\ No newline at end of file
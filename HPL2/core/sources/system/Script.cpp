@@ -0,0 +1,111 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "system/Script.h"
+
+#include "system/String.h"
+#include "system/LowLevelSystem.h"
+
+namespace hpl {
+
+	//////////////////////////////////////////////////////////////////////////
+	// SCRIPT CALL
+	//////////////////////////////////////////////////////////////////////////
+
+	//-----------------------------------------------------------------------
+
+	void cScriptCall::AddString(const tString& asArg)
+	{
+		cScriptCallArg *pArg = NewArg(eScriptArgType_String);
+		if(pArg) pArg->mpString = &asArg;
+	}
+
+	void cScriptCall::AddInt(int alArg)
+	{
+		cScriptCallArg *pArg = NewArg(eScriptArgType_Int);
+		if(pArg) pArg->mlInt = alArg;
+	}
+
+	void cScriptCall::AddFloat(float afArg)
+	{
+		cScriptCallArg *pArg = NewArg(eScriptArgType_Float);
+		if(pArg) pArg->mfFloat = afArg;
+	}
+
+	void cScriptCall::AddBool(bool abArg)
+	{
+		cScriptCallArg *pArg = NewArg(eScriptArgType_Bool);
+		if(pArg) pArg->mlInt = abArg ? 1 : 0;
+	}
+
+	//-----------------------------------------------------------------------
+
+	unsigned int cScriptCall::GetArgSignature() const
+	{
+		//2 bits per arg type and the number of args in the top bits
+		unsigned int lSignature = (unsigned int)mlArgNum << 24;
+		for(int i=0; i<mlArgNum; ++i)
+		{
+			lSignature |= (unsigned int)mvArgs[i].mType << (i*2);
+		}
+		return lSignature;
+	}
+
+	//-----------------------------------------------------------------------
+
+	tString cScriptCall::ToFuncLine() const
+	{
+		tString sLine = *mpFunc + "(";
+		for(int i=0; i<mlArgNum; ++i)
+		{
+			const cScriptCallArg &arg = mvArgs[i];
+			if(i>0) sLine += ", ";
+
+			switch(arg.mType)
+			{
+			case eScriptArgType_String:	sLine += "\"" + *arg.mpString + "\""; break;
+			case eScriptArgType_Int:	sLine += cString::ToString(arg.mlInt); break;
+			case eScriptArgType_Float:	sLine += cString::ToString(arg.mfFloat); break;
+			case eScriptArgType_Bool:	sLine += arg.mlInt ? "true" : "false"; break;
+			default: break;
+			}
+		}
+		sLine += ")";
+
+		return sLine;
+	}
+
+	//-----------------------------------------------------------------------
+
+	cScriptCallArg* cScriptCall::NewArg(eScriptArgType aType)
+	{
+		if(mlArgNum >= kMaxScriptCallArgs)
+		{
+			Error("Too many arguments in call to script func '%s'!\n", mpFunc->c_str());
+			return NULL;
+		}
+
+		cScriptCallArg *pArg = &mvArgs[mlArgNum++];
+		pArg->mType = aType;
+		return pArg;
+	}
+
+	//-----------------------------------------------------------------------
+
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "EngineTest.h"
+
+//------------------------------------------
+
+// Node grid on a slope with walls every 8 columns, each wall has a gap at alternating ends.
+// The slope keeps start and goal too far apart in height for the direct free path check,
+// and the missing world physics makes all free path checks succeed, so only the search is measured.
+
+static const int kGridSize = 64;
+static const float kGridSlope = 0.05f;
+
+static bool IsWallNode(int alX, int alZ)
+{
+	if(alX % 8 != 7) return false;
+
+	bool bGapAtEnd = (alX / 8) % 2 == 0;
+	if(bGapAtEnd)	return alZ < kGridSize - 3;
+	else			return alZ > 2;
+}
+
+static cVector3f GetGridPos(float afX, float afZ)
+{
+	return cVector3f(afX, afX * kGridSlope, afZ);
+}
+
+static cAINodeContainer* CreateGridContainer(cWorld *apWorld)
+{
+	cAINodeContainer *pContainer = hplNew( cAINodeContainer, ("Grid", "PathNode", apWorld, cVector3f(1, 1.5f, 1)) );
+	pContainer->SetMaxEdges(8);
+	pContainer->SetMinEdges(2);
+	pContainer->SetMaxEdgeDistance(1.5f);
+	pContainer->SetMaxHeight(0.41f);
+	pContainer->ReserveSpace(kGridSize*kGridSize);
+
+	int lID = 0;
+	for(int z=0; z<kGridSize; ++z)
+	for(int x=0; x<kGridSize; ++x)
+	{
+		if(IsWallNode(x,z)) continue;
+		pContainer->AddNode("Node"+cString::ToString(lID), lID, GetGridPos((float)x, (float)z));
+		++lID;
+	}
+
+	pContainer->Compile();
+
+	return pContainer;
+}
+
+//------------------------------------------
+
+HPL_BENCH(AStar_GridSearch)
+{
+	cEngine *pEngine = TestGetEngine();
+	if(pEngine==NULL) { TestSkip("no engine"); return; }
+
+	cWorld *pWorld = pEngine->GetScene()->CreateWorld("AStarBench");
+	cAINodeContainer *pContainer = CreateGridContainer(pWorld);
+	cAStarHandler *pAStar = hplNew( cAStarHandler, (pContainer) );
+
+	const int lSearches = cString::ToInt(TestGetArg("astar_searches", "").c_str(), 500);
+
+	/////////////////////////////
+	// Full searches
+	tAINodeVec vPath;
+	int lFound = 0;
+	size_t lPathNodes = 0;
+
+	unsigned long lStartTime = TestGetTime();
+	for(int i=0; i<lSearches; ++i)
+	{
+		cVector3f vStart = GetGridPos(0.5f + (float)(i % 5), (float)((i*7) % kGridSize));
+		cVector3f vGoal = GetGridPos((float)kGridSize - 1.5f - (float)(i % 3), (float)((i*13) % kGridSize));
+
+		vPath.clear();
+		if(pAStar->GetPath(vStart, vGoal, &vPath))
+		{
+			++lFound;
+			lPathNodes += vPath.size();
+		}
+	}
+	TestReport("GetPath, across all walls", TestGetTime() - lStartTime, lSearches);
+
+	HPL_CHECK(lFound == lSearches);
+	HPL_CHECK(lPathNodes > (size_t)lSearches * kGridSize / 2);
+
+	/////////////////////////////
+	// Time sliced searches, the same way cAI runs path requests
+	const int lSliceIterations = 200;
+	int lSlices = 0;
+
+	lStartTime = TestGetTime();
+	for(int i=0; i<lSearches; ++i)
+	{
+		cVector3f vStart = GetGridPos(0.5f + (float)(i % 5), (float)((i*11) % kGridSize));
+		cVector3f vGoal = GetGridPos((float)kGridSize - 1.5f - (float)(i % 3), (float)((i*5) % kGridSize));
+
+		pAStar->StartSearch(vStart, vGoal);
+		while(pAStar->GetSearchState() == eAStarSearchState_Searching)
+		{
+			pAStar->ContinueSearch(lSliceIterations);
+			++lSlices;
+		}
+	}
+	TestReport("StartSearch + ContinueSearch(200)", TestGetTime() - lStartTime, lSearches);
+	Log("AStar bench: %d slices for %d searches\n", lSlices, lSearches);
+
+	hplDelete(pAStar);
+	hplDelete(pContainer);
+	pEngine->GetScene()->DestroyWorld(pWorld);
+}
+
+//------------------------------------------
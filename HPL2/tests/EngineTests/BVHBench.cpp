@@ -0,0 +1,207 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "EngineTest.h"
+
+#include "scene/RenderableContainer_BoxTree.h"
+#include "scene/RenderableContainer_DynBoxTree.h"
+#include "scene/RenderableContainer_FlatBVH.h"
+
+//------------------------------------------
+
+// The bounding boxes of a map's static objects are copied into dummy renderables, which are added
+// to each container type. The containers are then culled against cameras spread over the map.
+
+static const int kBVHCameraNum = 64;
+static const int kBVHIterations = 20;
+
+typedef std::vector<cBoundingVolume*> tBoundingVolumeVec;
+
+static void GetNodeBoundingVolumes(iRenderableContainerNode *apNode, tBoundingVolumeVec *apBVs)
+{
+	apNode->UpdateBeforeUse();
+
+	tRenderableList *pObjects = apNode->GetObjectList();
+	for(tRenderableListIt it = pObjects->begin(); it != pObjects->end(); ++it)
+	{
+		apBVs->push_back((*it)->GetBoundingVolume());
+	}
+
+	tRenderableContainerNodeList *pChildren = apNode->GetChildNodeList();
+	for(tRenderableContainerNodeListIt it = pChildren->begin(); it != pChildren->end(); ++it)
+	{
+		GetNodeBoundingVolumes(*it, apBVs);
+	}
+}
+
+//------------------------------------------
+
+//Node iteration like the renderer does for containers without GetObjectsInFrustum.
+static void GetNodeObjectsInFrustum(iRenderableContainerNode *apNode, cFrustum *apFrustum, bool abInside, tRenderableVec *apObjects)
+{
+	apNode->UpdateBeforeUse();
+
+	if(abInside==false)
+	{
+		eCollision collision = apFrustum->CollideNode(apNode);
+		if(collision == eCollision_Outside) return;
+		abInside = collision == eCollision_Inside;
+	}
+
+	tRenderableList *pObjects = apNode->GetObjectList();
+	for(tRenderableListIt it = pObjects->begin(); it != pObjects->end(); ++it)
+	{
+		iRenderable *pObject = *it;
+		if(abInside || apFrustum->CollideBoundingVolume(pObject->GetBoundingVolume()) != eCollision_Outside)
+			apObjects->push_back(pObject);
+	}
+
+	tRenderableContainerNodeList *pChildren = apNode->GetChildNodeList();
+	for(tRenderableContainerNodeListIt it = pChildren->begin(); it != pChildren->end(); ++it)
+	{
+		GetNodeObjectsInFrustum(*it, apFrustum, abInside, apObjects);
+	}
+}
+
+//------------------------------------------
+
+class cBVHBenchContainer
+{
+public:
+	cBVHBenchContainer(const char *asName, iRenderableContainer *apContainer, const tBoundingVolumeVec& avBVs) : msName(asName), mpContainer(apContainer)
+	{
+		mvDummies.resize(avBVs.size());
+		for(size_t i=0; i<avBVs.size(); ++i)
+		{
+			mvDummies[i] = hplNew( cDummyRenderable, ("BVHDummy"+cString::ToString((int)i)) );
+			mvDummies[i]->SetStatic(true);
+			mvDummies[i]->GetBoundingVolume()->SetLocalMinMax(avBVs[i]->GetMin(), avBVs[i]->GetMax());
+			mpContainer->Add(mvDummies[i]);
+		}
+		mpContainer->Compile();
+		mpContainer->UpdateBeforeRendering();
+	}
+
+	~cBVHBenchContainer()
+	{
+		for(size_t i=0; i<mvDummies.size(); ++i) mpContainer->Remove(mvDummies[i]);
+		STLDeleteAll(mvDummies);
+		hplDelete(mpContainer);
+	}
+
+	void GetObjectsInFrustum(cFrustum *apFrustum, tRenderableVec *apObjects)
+	{
+		if(mpContainer->GetObjectsInFrustum(apFrustum, apObjects)) return;
+		GetNodeObjectsInFrustum(mpContainer->GetRoot(), apFrustum, false, apObjects);
+	}
+
+	const char *msName;
+	iRenderableContainer *mpContainer;
+	std::vector<cDummyRenderable*> mvDummies;
+};
+
+//------------------------------------------
+
+HPL_BENCH(BVH_MapFrustumCulling)
+{
+	cWorld *pWorld = TestLoadMap(eWorldLoadFlag_NoGameEntities);
+	if(pWorld==NULL) { TestSkip("map not found, set -map and -resources"); return; }
+
+	/////////////////////////////
+	// Dump the static objects of the map
+	tBoundingVolumeVec vBVs;
+	iRenderableContainerNode *pRoot = pWorld->GetRenderableContainer(eWorldContainerType_Static)->GetRoot();
+	GetNodeBoundingVolumes(pRoot, &vBVs);
+	cVector3f vMapMin = pRoot->GetMin();
+	cVector3f vMapMax = pRoot->GetMax();
+	Log("BVH bench: %d static objects\n", (int)vBVs.size());
+
+	std::vector<cBVHBenchContainer*> vContainers;
+	vContainers.push_back(hplNew( cBVHBenchContainer, ("FlatBVH", hplNew( cRenderableContainer_FlatBVH, () ), vBVs) ));
+	vContainers.push_back(hplNew( cBVHBenchContainer, ("BoxTree", hplNew( cRenderableContainer_BoxTree, () ), vBVs) ));
+	cRenderableContainer_DynBoxTree *pDynBoxTree = hplNew( cRenderableContainer_DynBoxTree, () );
+	vContainers.push_back(hplNew( cBVHBenchContainer, ("DynBoxTree", pDynBoxTree, vBVs) ));
+	//Build the tree the way it is after the rebuild done some frames after a map is loaded.
+	pDynBoxTree->RebuildNodes();
+	pDynBoxTree->UpdateBeforeRendering();
+
+	/////////////////////////////
+	// Cameras spread over the map, turned in different directions
+	std::vector<cCamera*> vCameras(kBVHCameraNum);
+	for(int i=0; i<kBVHCameraNum; ++i)
+	{
+		cVector3f vT((float)((i*37) % 101) / 100.0f, 0.3f + (float)((i*17) % 41) / 100.0f, (float)((i*61) % 103) / 102.0f);
+
+		vCameras[i] = hplNew( cCamera, () );
+		vCameras[i]->SetFarClipPlane(60.0f);
+		vCameras[i]->SetPosition(vMapMin + (vMapMax - vMapMin) * vT);
+		vCameras[i]->SetYaw((float)i * 0.7f);
+		vCameras[i]->SetPitch(-0.2f + (float)(i % 5) * 0.1f);
+	}
+
+	/////////////////////////////
+	// Check that every container returns all objects touching the frustum
+	tRenderableVec vObjects;
+	for(size_t lContainer=0; lContainer<vContainers.size(); ++lContainer)
+	{
+		cBVHBenchContainer *pBench = vContainers[lContainer];
+		for(int i=0; i<kBVHCameraNum; ++i)
+		{
+			cFrustum *pFrustum = vCameras[i]->GetFrustum();
+
+			vObjects.clear();
+			pBench->GetObjectsInFrustum(pFrustum, &vObjects);
+			std::set<iRenderable*> setFound(vObjects.begin(), vObjects.end());
+
+			bool bAllFound = true;
+			for(size_t j=0; j<pBench->mvDummies.size(); ++j)
+			{
+				cDummyRenderable *pDummy = pBench->mvDummies[j];
+				if(pFrustum->CollideBoundingVolume(pDummy->GetBoundingVolume()) == eCollision_Outside) continue;
+				if(setFound.find(pDummy) == setFound.end()) bAllFound = false;
+			}
+			HPL_CHECK(bAllFound);
+		}
+	}
+
+	/////////////////////////////
+	// Time the culling
+	for(size_t lContainer=0; lContainer<vContainers.size(); ++lContainer)
+	{
+		cBVHBenchContainer *pBench = vContainers[lContainer];
+		size_t lObjectsFound = 0;
+
+		unsigned long lStartTime = TestGetTime();
+		for(int lIt=0; lIt<kBVHIterations; ++lIt)
+		for(int i=0; i<kBVHCameraNum; ++i)
+		{
+			vObjects.clear();
+			pBench->GetObjectsInFrustum(vCameras[i]->GetFrustum(), &vObjects);
+			lObjectsFound += vObjects.size();
+		}
+		TestReport(pBench->msName, TestGetTime() - lStartTime, kBVHIterations*kBVHCameraNum);
+		Log("BVH bench: %s found %d objects per frustum\n", pBench->msName, (int)(lObjectsFound / (kBVHIterations*kBVHCameraNum)));
+	}
+
+	STLDeleteAll(vCameras);
+	STLDeleteAll(vContainers);
+	TestGetEngine()->GetScene()->DestroyWorld(pWorld);
+}
+
+//------------------------------------------
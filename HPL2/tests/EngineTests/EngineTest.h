@@ -0,0 +1,121 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef HPL_ENGINE_TEST_H
+#define HPL_ENGINE_TEST_H
+
+#include "hpl.h"
+#include "impl/LowLevelGraphicsNull.h"
+
+using namespace hpl;
+
+//------------------------------------------
+
+/**
+ * A test or benchmark, created as a static with HPL_TEST / HPL_BENCH and run by EngineTests.cpp.
+ */
+class iEngineTest
+{
+public:
+	iEngineTest(const char *asName, bool abBenchmark);
+	virtual ~iEngineTest(){}
+
+	virtual void Run()=0;
+
+	const char* GetName(){ return msName;}
+	bool IsBenchmark(){ return mbBenchmark;}
+
+private:
+	const char *msName;
+	bool mbBenchmark;
+};
+
+//------------------------------------------
+
+/**
+ * Marks the running test as failed if abResult is false.
+ */
+void TestCheck(bool abResult, const char *asExpr, const char *asFile, int alLine);
+
+/**
+ * Marks the running test as skipped, used when the game data needed is missing.
+ */
+void TestSkip(const char *asReason);
+
+/**
+ * Gets the value of a "-name value" command line argument.
+ */
+tString TestGetArg(const tString& asName, const tString& asDefault);
+
+/**
+ * Engine with the null graphics backend, created on first use and destroyed after all tests.
+ */
+cEngine* TestGetEngine();
+
+/**
+ * Loads the map given with -map, a map from the game by default. NULL if it can not be found.
+ */
+cWorld* TestLoadMap(tWorldLoadFlag aFlags);
+
+/**
+ * Creates a camera at the first start position of the world and a viewport rendering the world with the main renderer.
+ */
+cViewport* TestCreateMapViewport(cWorld *apWorld);
+
+/**
+ * Destroys a viewport from TestCreateMapViewport and its camera.
+ */
+void TestDestroyMapViewport(cViewport *apViewport);
+
+/**
+ * Starts a new frame on the null backend and renders all viewports with cScene::Render. The returned backend holds
+ * the counters of the frame, and the command log if active.
+ */
+cLowLevelGraphicsNull* TestRenderFrame(float afFrameTime);
+
+/**
+ * Time in milliseconds, for benchmarks.
+ */
+unsigned long TestGetTime();
+
+/**
+ * Prints a benchmark result.
+ */
+void TestReport(const char *asLabel, unsigned long alTime, int alIterations);
+
+//------------------------------------------
+
+#define HPL_ENGINE_TEST(name, bench) \
+	class cEngineTest_##name : public iEngineTest \
+	{ \
+	public: \
+		cEngineTest_##name() : iEngineTest(#name, bench){} \
+		void Run(); \
+	}; \
+	static cEngineTest_##name gEngineTest_##name; \
+	void cEngineTest_##name::Run()
+
+#define HPL_TEST(name) HPL_ENGINE_TEST(name, false)
+#define HPL_BENCH(name) HPL_ENGINE_TEST(name, true)
+
+#define HPL_CHECK(expr) TestCheck((expr), #expr, __FILE__, __LINE__)
+
+//------------------------------------------
+
+#endif // HPL_ENGINE_TEST_H
@@ -0,0 +1,217 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "EngineTest.h"
+
+#include <stdio.h>
+
+//------------------------------------------
+
+typedef std::vector<iEngineTest*> tEngineTestVec;
+
+static tEngineTestVec& GetTests()
+{
+	static tEngineTestVec vTests;
+	return vTests;
+}
+
+static tStringVec gvArgs;
+static cEngine *gpEngine = NULL;
+static bool gbEngineFailed = false;
+
+static int glCheckFailures = 0;
+static bool gbSkipped = false;
+
+//------------------------------------------
+
+iEngineTest::iEngineTest(const char *asName, bool abBenchmark)
+{
+	msName = asName;
+	mbBenchmark = abBenchmark;
+	GetTests().push_back(this);
+}
+
+//------------------------------------------
+
+void TestCheck(bool abResult, const char *asExpr, const char *asFile, int alLine)
+{
+	if(abResult) return;
+
+	printf("  %s(%d): check failed: %s\n", asFile, alLine, asExpr);
+	++glCheckFailures;
+}
+
+//------------------------------------------
+
+void TestSkip(const char *asReason)
+{
+	printf("  skipped: %s\n", asReason);
+	gbSkipped = true;
+}
+
+//------------------------------------------
+
+tString TestGetArg(const tString& asName, const tString& asDefault)
+{
+	for(size_t i=0; i+1<gvArgs.size(); ++i)
+	{
+		if(gvArgs[i] == "-"+asName) return gvArgs[i+1];
+	}
+	return asDefault;
+}
+
+//------------------------------------------
+
+cEngine* TestGetEngine()
+{
+	if(gpEngine || gbEngineFailed) return gpEngine;
+
+	cEngineInitVars vars;
+	vars.mGraphics.mvScreenSize = cVector2l(1280, 720);
+	vars.mGraphics.msWindowCaption = "EngineTests";
+	gpEngine = CreateHPLEngine(eHplAPI_OpenGL, eHplSetup_All | eHplSetup_NullGraphics, &vars);
+	if(gpEngine==NULL)
+	{
+		gbEngineFailed = true;
+		return NULL;
+	}
+
+	gpEngine->GetResources()->LoadResourceDirsFile(TestGetArg("resources", "resources.cfg"));
+
+	return gpEngine;
+}
+
+//------------------------------------------
+
+cWorld* TestLoadMap(tWorldLoadFlag aFlags)
+{
+	cEngine *pEngine = TestGetEngine();
+	if(pEngine==NULL) return NULL;
+
+	return pEngine->GetScene()->LoadWorld(TestGetArg("map", "00_rainy_hall.map"), aFlags);
+}
+
+//------------------------------------------
+
+cViewport* TestCreateMapViewport(cWorld *apWorld)
+{
+	cScene *pScene = TestGetEngine()->GetScene();
+
+	cCamera *pCamera = pScene->CreateCamera(eCameraMoveMode_Fly);
+	cStartPosEntity *pStartPos = apWorld->GetFirstStartPosEntity();
+	if(pStartPos) pCamera->SetPosition(pStartPos->GetWorldMatrix().GetTranslation() + cVector3f(0,1.6f,0));
+
+	return pScene->CreateViewport(pCamera, apWorld);
+}
+
+//------------------------------------------
+
+void TestDestroyMapViewport(cViewport *apViewport)
+{
+	cScene *pScene = TestGetEngine()->GetScene();
+
+	cCamera *pCamera = apViewport->GetCamera();
+	pScene->DestroyViewport(apViewport);
+	pScene->DestroyCamera(pCamera);
+}
+
+//------------------------------------------
+
+cLowLevelGraphicsNull* TestRenderFrame(float afFrameTime)
+{
+	cEngine *pEngine = TestGetEngine();
+	cLowLevelGraphicsNull *pLowLevel = static_cast<cLowLevelGraphicsNull*>(pEngine->GetGraphics()->GetLowLevel());
+
+	pLowLevel->SwapBuffers();
+	pEngine->GetScene()->Render(afFrameTime, tSceneRenderFlag_All);
+
+	return pLowLevel;
+}
+
+//------------------------------------------
+
+unsigned long TestGetTime()
+{
+	return cPlatform::GetApplicationTime();
+}
+
+//------------------------------------------
+
+void TestReport(const char *asLabel, unsigned long alTime, int alIterations)
+{
+	double fPerIt = alIterations > 0 ? (double)alTime * 1000.0 / (double)alIterations : 0;
+	printf("  %-40s %8lu ms %8d its %12.2f us/it\n", asLabel, alTime, alIterations, fPerIt);
+}
+
+//------------------------------------------
+
+static bool HasArg(const tString& asName)
+{
+	for(size_t i=0; i<gvArgs.size(); ++i)
+	{
+		if(gvArgs[i] == "-"+asName) return true;
+	}
+	return false;
+}
+
+//------------------------------------------
+
+int hplMain(const tString &asCommandline)
+{
+	cString::GetStringVec(asCommandline, gvArgs);
+
+	bool bBenchmarks = HasArg("bench");
+	tString sFilter = TestGetArg("filter", "");
+
+	SetLogFile(_W("EngineTests.log"));
+
+	int lRun = 0;
+	int lFailed = 0;
+	int lSkipped = 0;
+
+	tEngineTestVec& vTests = GetTests();
+	for(size_t i=0; i<vTests.size(); ++i)
+	{
+		iEngineTest *pTest = vTests[i];
+		if(pTest->IsBenchmark() != bBenchmarks) continue;
+		if(sFilter != "" && tString(pTest->GetName()).find(sFilter) == tString::npos) continue;
+
+		printf("%s\n", pTest->GetName());
+		fflush(stdout);
+
+		glCheckFailures = 0;
+		gbSkipped = false;
+
+		pTest->Run();
+
+		++lRun;
+		if(glCheckFailures > 0)	++lFailed;
+		else if(gbSkipped)		++lSkipped;
+
+		printf("  %s\n", glCheckFailures > 0 ? "FAILED" : (gbSkipped ? "SKIPPED" : "OK"));
+	}
+
+	if(gpEngine) DestroyHPLEngine(gpEngine);
+
+	printf("%d run, %d failed, %d skipped\n", lRun, lFailed, lSkipped);
+
+	return lFailed > 0 ? 1 : 0;
+}
+
+//------------------------------------------
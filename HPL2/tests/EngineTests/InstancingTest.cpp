@@ -0,0 +1,99 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "EngineTest.h"
+
+//------------------------------------------
+
+// A map is rendered on the null backend with and without instancing. The recorded DrawInstanced calls give the
+// run lengths, and together with the single draws they must cover exactly the objects drawn without instancing.
+
+static const float kInstancingFrameTime = 1.0f / 60.0f;
+
+HPL_TEST(InstancedDraws)
+{
+	cEngine *pEngine = TestGetEngine();
+	if(pEngine==NULL) { TestSkip("no engine"); return; }
+
+	//Materials only get instanced programs if instancing is enabled when they are compiled.
+	bool bPrevInstancing = iRenderer::GetInstancingEnabled();
+	iRenderer::SetInstancingEnabled(true);
+
+	cWorld *pWorld = TestLoadMap(eWorldLoadFlag_NoGameEntities);
+	if(pWorld==NULL)
+	{
+		iRenderer::SetInstancingEnabled(bPrevInstancing);
+		TestSkip("map not found, set -map and -resources");
+		return;
+	}
+
+	cViewport *pViewport = TestCreateMapViewport(pWorld);
+
+	//Occlusion culling and shadows depend on earlier frames, so turn them off to draw the same objects every frame.
+	cRenderSettings *pSettings = pViewport->GetRenderSettings();
+	pSettings->mbUseOcclusionCulling = false;
+	pSettings->mbRenderShadows = false;
+
+	////////////////////////////
+	// Without instancing
+	iRenderer::SetInstancingEnabled(false);
+	TestRenderFrame(kInstancingFrameTime);
+
+	cLowLevelGraphicsNull *pLowLevel = TestRenderFrame(kInstancingFrameTime);
+	int lSingleDrawsOnly = pLowLevel->GetCommandCount(eNullGraphicsCommand_Draw);
+	HPL_CHECK(pLowLevel->GetCommandCount(eNullGraphicsCommand_DrawInstanced)==0);
+
+	////////////////////////////
+	// With instancing
+	iRenderer::SetInstancingEnabled(true);
+	pLowLevel->SetCommandLogActive(true);
+	pLowLevel = TestRenderFrame(kInstancingFrameTime);
+
+	int lSingleDraws = pLowLevel->GetCommandCount(eNullGraphicsCommand_Draw);
+	int lInstancedDraws = 0;
+	int lInstances = 0;
+	int lLongestRun = 0;
+
+	const tNullGraphicsCommandVec& vLog = pLowLevel->GetCommandLog();
+	for(size_t i=0; i<vLog.size(); ++i)
+	{
+		const cNullGraphicsCommand& command = vLog[i];
+		if(command.mType != eNullGraphicsCommand_DrawInstanced) continue;
+
+		HPL_CHECK(command.mlValue >= 2 && command.mlValue <= kMaxInstancesPerDraw);
+
+		++lInstancedDraws;
+		lInstances += command.mlValue;
+		lLongestRun = cMath::Max(lLongestRun, command.mlValue);
+	}
+	pLowLevel->SetCommandLogActive(false);
+
+	printf("  %d draws without instancing, %d draws + %d instanced draws (%d instances, longest run %d) with\n",
+			lSingleDrawsOnly, lSingleDraws, lInstancedDraws, lInstances, lLongestRun);
+
+	HPL_CHECK(lInstancedDraws > 0);
+	HPL_CHECK(lSingleDraws + lInstances == lSingleDrawsOnly);
+
+	TestDestroyMapViewport(pViewport);
+	pEngine->GetScene()->DestroyWorld(pWorld);
+
+	iRenderer::SetInstancingEnabled(bPrevInstancing);
+}
+
+//------------------------------------------
@@ -0,0 +1,289 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "EngineTest.h"
+
+#include "graphics/LightFroxelGrid.h"
+
+#include <algorithm>
+#include <math.h>
+
+//------------------------------------------
+
+// Random spheres are binned and the froxel light lists are compared against brute force tests of every sphere
+// against every froxel, computed here in double precision. Binning tests spheres against the view space bounding
+// box of each froxel, but only within the screen range of the light. So a light in a froxel list must touch the
+// froxel box, and a light that touches the froxel itself (the part of the view frustum) must be in the list.
+
+static const float kFroxelFOV = 1.2f;
+static const float kFroxelAspect = 16.0f / 9.0f;
+static const float kFroxelNear = 0.1f;
+static const float kFroxelFar = 60.0f;
+
+//Spheres this close to touching a froxel are not checked, since float and double may disagree.
+static const double kFroxelTouchEpsilon = 1e-3;
+
+//------------------------------------------
+
+static float FroxelRandom(unsigned int *apSeed, float afMin, float afMax)
+{
+	*apSeed = *apSeed * 1103515245 + 12345;
+	return afMin + (afMax - afMin) * (float)((*apSeed >> 8) & 0xFFFF) / 65535.0f;
+}
+
+//------------------------------------------
+
+class cFroxelCell
+{
+public:
+	cFroxelCell(const cVector3l& avGridSize, int alX, int alY, int alZ)
+	{
+		mvTan[1] = tan((double)kFroxelFOV * 0.5);
+		mvTan[0] = mvTan[1] * (double)kFroxelAspect;
+
+		mfDepth0 = kFroxelNear * pow((double)kFroxelFar / kFroxelNear, (double)alZ / avGridSize.z);
+		mfDepth1 = kFroxelNear * pow((double)kFroxelFar / kFroxelNear, (double)(alZ+1) / avGridSize.z);
+
+		mvNdcMin[0] = -1.0 + 2.0*alX / avGridSize.x;
+		mvNdcMax[0] = -1.0 + 2.0*(alX+1) / avGridSize.x;
+		mvNdcMin[1] = -1.0 + 2.0*alY / avGridSize.y;
+		mvNdcMax[1] = -1.0 + 2.0*(alY+1) / avGridSize.y;
+	}
+
+	/**
+	 * Signed distance from the sphere surface to the view space bounding box of the froxel, < 0 means they intersect.
+	 */
+	double GetBoxDistance(const cVector3f& avPos, float afRadius)
+	{
+		double vMin[3], vMax[3];
+		for(int i=0; i<2; ++i)
+		{
+			vMin[i] = std::min(mvNdcMin[i]*mfDepth0, mvNdcMin[i]*mfDepth1) * mvTan[i];
+			vMax[i] = std::max(mvNdcMax[i]*mfDepth0, mvNdcMax[i]*mfDepth1) * mvTan[i];
+		}
+		vMin[2] = -mfDepth1;
+		vMax[2] = -mfDepth0;
+
+		double fDistSqr = 0;
+		for(int i=0; i<3; ++i)
+		{
+			double fClosest = std::max(vMin[i], std::min((double)avPos.v[i], vMax[i]));
+			double fD = avPos.v[i] - fClosest;
+			fDistSqr += fD*fD;
+		}
+
+		return sqrt(fDistSqr) - afRadius;
+	}
+
+	/**
+	 * If the sphere has a point well inside the froxel. Tests the center and points on a slightly smaller sphere, 
+	 * so false means "not sure" when the sphere only just touches the froxel.
+	 */
+	bool SphereSurelyTouches(const cVector3f& avPos, float afRadius)
+	{
+		double fR = afRadius * 0.99;
+		if(PointIsInside(avPos.x, avPos.y, avPos.z)) return true;
+
+		//Towards the center of the froxel
+		double fCenterDepth = (mfDepth0 + mfDepth1) * 0.5;
+		double vCenter[3] = {	(mvNdcMin[0]+mvNdcMax[0])*0.5 * fCenterDepth * mvTan[0],
+								(mvNdcMin[1]+mvNdcMax[1])*0.5 * fCenterDepth * mvTan[1],
+								-fCenterDepth };
+		double vDir[3] = { vCenter[0]-avPos.x, vCenter[1]-avPos.y, vCenter[2]-avPos.z };
+		double fDist = sqrt(vDir[0]*vDir[0] + vDir[1]*vDir[1] + vDir[2]*vDir[2]);
+		double fStep = std::min(fR, fDist) / fDist;
+		if(PointIsInside(avPos.x + vDir[0]*fStep, avPos.y + vDir[1]*fStep, avPos.z + vDir[2]*fStep)) return true;
+
+		//Along the axes and diagonals
+		for(int x=-1; x<=1; ++x)
+		for(int y=-1; y<=1; ++y)
+		for(int z=-1; z<=1; ++z)
+		{
+			if(x==0 && y==0 && z==0) continue;
+			double fScale = fR / sqrt((double)(x*x + y*y + z*z));
+			if(PointIsInside(avPos.x + x*fScale, avPos.y + y*fScale, avPos.z + z*fScale)) return true;
+		}
+
+		return false;
+	}
+
+private:
+	bool PointIsInside(double afX, double afY, double afZ)
+	{
+		double fDepth = -afZ;
+		if(fDepth < mfDepth0 + kFroxelTouchEpsilon || fDepth > mfDepth1 - kFroxelTouchEpsilon) return false;
+
+		double vNdc[2] = { afX / (fDepth * mvTan[0]), afY / (fDepth * mvTan[1]) };
+		for(int i=0; i<2; ++i)
+		{
+			if(vNdc[i] < mvNdcMin[i] + kFroxelTouchEpsilon || vNdc[i] > mvNdcMax[i] - kFroxelTouchEpsilon) return false;
+		}
+		return true;
+	}
+
+	double mvTan[2];
+	double mfDepth0, mfDepth1;
+	double mvNdcMin[2], mvNdcMax[2];
+};
+
+//------------------------------------------
+
+static void CheckFroxelGrid(const cVector3l& avGridSize, int alLightNum, unsigned int alSeed)
+{
+	cLightFroxelGrid grid;
+	grid.Setup(kFroxelFOV, kFroxelAspect, kFroxelNear, kFroxelFar, avGridSize);
+	grid.SetMaxLightsPerFroxel(alLightNum);
+
+	/////////////////////////////
+	// Random spheres, including ones behind the near plane, beyond the far plane and outside the sides
+	std::vector<cVector3f> vPos;
+	std::vector<float> vRadius;
+	unsigned int lSeed = alSeed;
+	for(int i=0; i<alLightNum; ++i)
+	{
+		float fDepth = FroxelRandom(&lSeed, -2.0f, kFroxelFar * 1.2f);
+		float fSpread = cMath::Max(fDepth, 1.0f) * 1.5f;
+
+		cVector3f vLightPos(	FroxelRandom(&lSeed, -fSpread, fSpread) * kFroxelAspect, 
+								FroxelRandom(&lSeed, -fSpread, fSpread), 
+								-fDepth);
+		float fRadius = FroxelRandom(&lSeed, 0.05f, 6.0f);
+
+		HPL_CHECK(grid.AddLight(vLightPos, fRadius) == i);
+		vPos.push_back(vLightPos);
+		vRadius.push_back(fRadius);
+	}
+
+	grid.Bin(NULL);
+	HPL_CHECK(grid.GetOverflowNum() == 0);
+
+	/////////////////////////////
+	// Compare every froxel with the brute force results
+	int lOutsideBox = 0;
+	int lMissing = 0;
+	int lUnsorted = 0;
+	int lBinned = 0;
+	for(int z=0; z<avGridSize.z; ++z)
+	for(int y=0; y<avGridSize.y; ++y)
+	for(int x=0; x<avGridSize.x; ++x)
+	{
+		cFroxelCell cell(avGridSize, x, y, z);
+
+		int lFroxel = grid.GetFroxelIndex(x,y,z);
+		int lNum = grid.GetFroxelLightNum(lFroxel);
+		const unsigned short *pLights = grid.GetFroxelLights(lFroxel);
+		lBinned += lNum;
+
+		//Lists are sorted in the order lights were added
+		for(int i=1; i<lNum; ++i) if(pLights[i-1] >= pLights[i]) ++lUnsorted;
+
+		int lListPos = 0;
+		for(int lLight=0; lLight<alLightNum; ++lLight)
+		{
+			bool bBinned = lListPos < lNum && pLights[lListPos] == lLight;
+			if(bBinned) ++lListPos;
+
+			if(bBinned && cell.GetBoxDistance(vPos[lLight], vRadius[lLight]) > kFroxelTouchEpsilon)
+			{
+				if(lOutsideBox < 5) printf("  froxel %d,%d,%d has light %d outside its box\n", x, y, z, lLight);
+				++lOutsideBox;
+			}
+			if(bBinned==false && cell.SphereSurelyTouches(vPos[lLight], vRadius[lLight]))
+			{
+				if(lMissing < 5) printf("  froxel %d,%d,%d misses light %d\n", x, y, z, lLight);
+				++lMissing;
+			}
+		}
+	}
+
+	Log("Froxel test: grid %d,%d,%d, %d lights, %d froxel entries\n", avGridSize.x, avGridSize.y, avGridSize.z, alLightNum, lBinned);
+	HPL_CHECK(lBinned > 0);
+	HPL_CHECK(lUnsorted == 0);
+	HPL_CHECK(lOutsideBox == 0);
+	HPL_CHECK(lMissing == 0);
+}
+
+//------------------------------------------
+
+HPL_TEST(LightFroxelGrid_BruteForce)
+{
+	CheckFroxelGrid(cVector3l(16,9,24), 200, 1);
+	
+	//Row lengths that are not a multiple of 4, so the SSE path reads the padding columns
+	CheckFroxelGrid(cVector3l(13,7,9), 200, 2);
+	CheckFroxelGrid(cVector3l(1,3,5), 100, 3);
+	CheckFroxelGrid(cVector3l(6,5,4), 100, 4);
+}
+
+//------------------------------------------
+
+HPL_TEST(LightFroxelGrid_NearFarClamping)
+{
+	cVector3l vGridSize(13,7,9);
+	cLightFroxelGrid grid;
+	grid.Setup(kFroxelFOV, kFroxelAspect, kFroxelNear, kFroxelFar, vGridSize);
+
+	HPL_CHECK(grid.GetSlice(0) == 0);
+	HPL_CHECK(grid.GetSlice(kFroxelNear * 0.5f) == 0);
+	HPL_CHECK(grid.GetSlice(kFroxelNear) == 0);
+	HPL_CHECK(grid.GetSlice(kFroxelFar * 0.999f) == vGridSize.z-1);
+	HPL_CHECK(grid.GetSlice(kFroxelFar * 10.0f) == vGridSize.z-1);
+
+	int lBehindCamera = grid.AddLight(cVector3f(0,0,1), 0.5f);
+	int lBeforeNear = grid.AddLight(cVector3f(0,0,-kFroxelNear*0.5f), kFroxelNear*0.25f);
+	int lBeyondFar = grid.AddLight(cVector3f(0,0,-kFroxelFar-2), 1.0f);
+	int lOnNear = grid.AddLight(cVector3f(0,0,-kFroxelNear), 0.05f);
+	int lOnFar = grid.AddLight(cVector3f(0,0,-kFroxelFar), 1.0f);
+
+	cLightFroxelRange range;
+	HPL_CHECK(grid.GetLightRange(lBehindCamera, range) == false);
+	HPL_CHECK(grid.GetLightRange(lBeforeNear, range) == false);
+	HPL_CHECK(grid.GetLightRange(lBeyondFar, range) == false);
+
+	HPL_CHECK(grid.GetLightRange(lOnNear, range));
+	HPL_CHECK(range.mlMinZ == 0);
+
+	HPL_CHECK(grid.GetLightRange(lOnFar, range));
+	HPL_CHECK(range.mlMaxZ == vGridSize.z-1);
+
+	grid.Bin(NULL);
+
+	bool bOnNearFound = false;
+	bool bOnFarFound = false;
+	for(int i=0; i<grid.GetFroxelNum(); ++i)
+	{
+		const unsigned short *pLights = grid.GetFroxelLights(i);
+		for(int j=0; j<grid.GetFroxelLightNum(i); ++j)
+		{
+			int lLight = pLights[j];
+			HPL_CHECK(lLight != lBehindCamera && lLight != lBeforeNear && lLight != lBeyondFar);
+
+			if(lLight == lOnNear)	bOnNearFound = true;
+			if(lLight == lOnFar)	bOnFarFound = true;
+		}
+	}
+	HPL_CHECK(bOnNearFound);
+	HPL_CHECK(bOnFarFound);
+	
+	//Lights on the planes end up in the first and last slice at the center of the screen
+	HPL_CHECK(grid.GetFroxelLightNum(grid.GetFroxelIndex(6,3,0)) > 0);
+	HPL_CHECK(grid.GetFroxelLightNum(grid.GetFroxelIndex(6,3,vGridSize.z-1)) > 0);
+}
+
+//------------------------------------------
@@ -0,0 +1,147 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "EngineTest.h"
+
+//------------------------------------------
+
+// Bodies and lights of a map are looked up by name through the name indices and through a linear scan of the
+// lists (what the lookups did before). Extra bodies are added to reach the body count of a large scripted map.
+
+static const int kNameLookupPasses = 20;
+
+//------------------------------------------
+
+static iPhysicsBody* FindBodyByScan(iPhysicsWorld *apWorld, const tString& asName)
+{
+	cPhysicsBodyIterator it = apWorld->GetBodyIterator();
+	while(it.HasNext())
+	{
+		iPhysicsBody *pBody = it.Next();
+		if(pBody->GetName() == asName) return pBody;
+	}
+	return NULL;
+}
+
+static iLight* FindLightByScan(cWorld *apWorld, const tString& asName)
+{
+	cLightListIterator it = apWorld->GetLightIterator();
+	while(it.HasNext())
+	{
+		iLight *pLight = it.Next();
+		if(pLight->GetName() == asName) return pLight;
+	}
+	return NULL;
+}
+
+//------------------------------------------
+
+HPL_BENCH(NameLookup_Map)
+{
+	cWorld *pWorld = TestLoadMap(eWorldLoadFlag_NoGameEntities);
+	if(pWorld==NULL) { TestSkip("map not found, set -map and -resources"); return; }
+
+	iPhysicsWorld *pPhysicsWorld = pWorld->GetPhysicsWorld();
+	int lExtraBodies = cString::ToInt(TestGetArg("extra_bodies", "3000").c_str(), 3000);
+
+	/////////////////////////////
+	// Extra bodies
+	iCollideShape *pShape = pPhysicsWorld->CreateBoxShape(cVector3f(0.5f), NULL);
+	for(int i=0; i<lExtraBodies; ++i)
+	{
+		pPhysicsWorld->CreateBody("NameLookupBody_" + cString::ToString(i), pShape);
+	}
+
+	/////////////////////////////
+	// Names to look up, the last ones in the lists (worst case for a scan) and some that do not exist
+	tStringVec vBodyNames;
+	cPhysicsBodyIterator bodyIt = pPhysicsWorld->GetBodyIterator();
+	while(bodyIt.HasNext()) vBodyNames.push_back(bodyIt.Next()->GetName());
+
+	tStringVec vLightNames;
+	cLightListIterator lightIt = pWorld->GetLightIterator();
+	while(lightIt.HasNext()) vLightNames.push_back(lightIt.Next()->GetName());
+
+	for(int i=0; i<16; ++i)
+	{
+		vBodyNames.push_back("NameLookupMissing_" + cString::ToString(i));
+		vLightNames.push_back("NameLookupMissing_" + cString::ToString(i));
+	}
+	Log("Name lookup bench: %d bodies and %d lights\n", (int)vBodyNames.size()-16, (int)vLightNames.size()-16);
+
+	/////////////////////////////
+	// The index must give the same object as the scan
+	bool bSameBodies = true;
+	for(size_t i=0; i<vBodyNames.size(); ++i)
+	{
+		if(pPhysicsWorld->GetBody(vBodyNames[i]) != FindBodyByScan(pPhysicsWorld, vBodyNames[i])) bSameBodies = false;
+	}
+	HPL_CHECK(bSameBodies);
+
+	bool bSameLights = true;
+	for(size_t i=0; i<vLightNames.size(); ++i)
+	{
+		if(pWorld->GetLight(vLightNames[i]) != FindLightByScan(pWorld, vLightNames[i])) bSameLights = false;
+	}
+	HPL_CHECK(bSameLights);
+
+	/////////////////////////////
+	// Time lookups
+	int lFound = 0;
+	int lBodyLookups = kNameLookupPasses * (int)vBodyNames.size();
+	int lLightLookups = kNameLookupPasses * (int)vLightNames.size();
+
+	unsigned long lStartTime = TestGetTime();
+	for(int lPass=0; lPass<kNameLookupPasses; ++lPass)
+	for(size_t i=0; i<vBodyNames.size(); ++i)
+	{
+		if(pPhysicsWorld->GetBody(vBodyNames[i])) ++lFound;
+	}
+	TestReport("GetBody, index", TestGetTime() - lStartTime, lBodyLookups);
+
+	lStartTime = TestGetTime();
+	for(int lPass=0; lPass<kNameLookupPasses; ++lPass)
+	for(size_t i=0; i<vBodyNames.size(); ++i)
+	{
+		if(FindBodyByScan(pPhysicsWorld, vBodyNames[i])) ++lFound;
+	}
+	TestReport("GetBody, list scan", TestGetTime() - lStartTime, lBodyLookups);
+
+	lStartTime = TestGetTime();
+	for(int lPass=0; lPass<kNameLookupPasses; ++lPass)
+	for(size_t i=0; i<vLightNames.size(); ++i)
+	{
+		if(pWorld->GetLight(vLightNames[i])) ++lFound;
+	}
+	TestReport("GetLight, index", TestGetTime() - lStartTime, lLightLookups);
+
+	lStartTime = TestGetTime();
+	for(int lPass=0; lPass<kNameLookupPasses; ++lPass)
+	for(size_t i=0; i<vLightNames.size(); ++i)
+	{
+		if(FindLightByScan(pWorld, vLightNames[i])) ++lFound;
+	}
+	TestReport("GetLight, list scan", TestGetTime() - lStartTime, lLightLookups);
+
+	Log("Name lookup bench: %d found\n", lFound);
+
+	TestGetEngine()->GetScene()->DestroyWorld(pWorld);
+}
+
+//------------------------------------------
@@ -0,0 +1,94 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "EngineTest.h"
+
+//------------------------------------------
+
+// Columns of stacked boxes on a floor, simulated with one solver thread and with several. Contacts found by
+// the solver threads are queued and handled after each step, sorted by body creation order.
+
+static const int kStackColumns = 12;
+static const int kStackHeight = 6;
+static const int kStackSteps = 300;
+static const float kStackTimeStep = 1.0f / 60.0f;
+
+//------------------------------------------
+
+static void SimulateStacks(cPhysics *apPhysics, int alThreads)
+{
+	iPhysicsWorld *pWorld = apPhysics->CreateWorld(true);
+	pWorld->SetWorldSize(cVector3f(-50,-10,-50), cVector3f(50,50,50));
+	pWorld->SetNumberOfThreads(alThreads);
+
+	/////////////////////////////
+	// Floor and stacks
+	iCollideShape *pFloorShape = pWorld->CreateBoxShape(cVector3f(60,1,60), NULL);
+	iPhysicsBody *pFloor = pWorld->CreateBody("Floor", pFloorShape);
+	pFloor->SetPosition(cVector3f(0,-0.5f,0));
+
+	iCollideShape *pBoxShape = pWorld->CreateBoxShape(cVector3f(0.5f,0.5f,0.5f), NULL);
+	std::vector<iPhysicsBody*> vBoxes;
+	for(int x=0; x<kStackColumns; ++x)
+	for(int z=0; z<kStackColumns; ++z)
+	for(int y=0; y<kStackHeight; ++y)
+	{
+		iPhysicsBody *pBox = pWorld->CreateBody("Box", pBoxShape);
+		pBox->SetMass(1.0f);
+		pBox->SetPosition(cVector3f((float)x - kStackColumns*0.5f, 0.25f + (float)y*0.501f, (float)z - kStackColumns*0.5f));
+		vBoxes.push_back(pBox);
+	}
+
+	/////////////////////////////
+	// Simulate
+	unsigned long lStartTime = TestGetTime();
+	for(int i=0; i<kStackSteps; ++i)
+	{
+		pWorld->Simulate(kStackTimeStep);
+	}
+	unsigned long lTime = TestGetTime() - lStartTime;
+
+	tString sLabel = cString::ToString(pWorld->GetNumberOfThreads()) + " thread(s), " + cString::ToString((int)vBoxes.size()) + " boxes";
+	TestReport(sLabel.c_str(), lTime, kStackSteps);
+
+	//The stacks should stay on the floor
+	int lFallenThrough = 0;
+	for(size_t i=0; i<vBoxes.size(); ++i)
+	{
+		if(vBoxes[i]->GetWorldPosition().y < 0) ++lFallenThrough;
+	}
+	HPL_CHECK(lFallenThrough == 0);
+
+	apPhysics->DestroyWorld(pWorld);
+}
+
+//------------------------------------------
+
+HPL_BENCH(Physics_StackedBodies)
+{
+	cEngine *pEngine = TestGetEngine();
+	if(pEngine==NULL) { TestSkip("no engine"); return; }
+
+	int lThreads = cString::ToInt(TestGetArg("threads", "4").c_str(), 4);
+
+	SimulateStacks(pEngine->GetPhysics(), 1);
+	SimulateStacks(pEngine->GetPhysics(), lThreads);
+}
+
+//------------------------------------------
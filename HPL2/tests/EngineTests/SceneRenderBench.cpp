@@ -0,0 +1,118 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "EngineTest.h"
+
+//------------------------------------------
+
+// A map is rendered through cScene::Render on the null backend, so culling, sorting and the renderer's
+// state changes and draw calls can be measured without a GPU.
+
+static const float kSceneRenderFrameTime = 1.0f / 60.0f;
+
+static void AddFrameCounters(cLowLevelGraphicsNull *apLowLevel, int *apCounts)
+{
+	for(int i=0; i<eNullGraphicsCommand_LastEnum; ++i)
+	{
+		apCounts[i] += apLowLevel->GetCommandCount((eNullGraphicsCommand)i);
+	}
+}
+
+//------------------------------------------
+
+HPL_TEST(SceneRender_SameFrameSameCommands)
+{
+	cEngine *pEngine = TestGetEngine();
+	if(pEngine==NULL) { TestSkip("no engine"); return; }
+
+	cWorld *pWorld = TestLoadMap(eWorldLoadFlag_NoGameEntities);
+	if(pWorld==NULL) { TestSkip("map not found, set -map and -resources"); return; }
+
+	cViewport *pViewport = TestCreateMapViewport(pWorld);
+
+	//Occlusion culling depends on the results of earlier frames.
+	pViewport->GetRenderSettings()->mbUseOcclusionCulling = false;
+
+	TestRenderFrame(kSceneRenderFrameTime);
+
+	int vFirst[eNullGraphicsCommand_LastEnum] = {0};
+	int vSecond[eNullGraphicsCommand_LastEnum] = {0};
+	AddFrameCounters(TestRenderFrame(kSceneRenderFrameTime), vFirst);
+	AddFrameCounters(TestRenderFrame(kSceneRenderFrameTime), vSecond);
+
+	HPL_CHECK(vFirst[eNullGraphicsCommand_Draw] + vFirst[eNullGraphicsCommand_DrawInstanced] > 0);
+	for(int i=0; i<eNullGraphicsCommand_LastEnum; ++i)
+	{
+		if(vFirst[i] == vSecond[i]) continue;
+
+		printf("  %s: %d then %d\n", cLowLevelGraphicsNull::GetCommandName((eNullGraphicsCommand)i), vFirst[i], vSecond[i]);
+		HPL_CHECK(vFirst[i] == vSecond[i]);
+	}
+
+	TestDestroyMapViewport(pViewport);
+	pEngine->GetScene()->DestroyWorld(pWorld);
+}
+
+//------------------------------------------
+
+HPL_BENCH(SceneRender_Map)
+{
+	cEngine *pEngine = TestGetEngine();
+	if(pEngine==NULL) { TestSkip("no engine"); return; }
+
+	cWorld *pWorld = TestLoadMap(eWorldLoadFlag_NoGameEntities);
+	if(pWorld==NULL) { TestSkip("map not found, set -map and -resources"); return; }
+
+	int lFrames = cString::ToInt(TestGetArg("frames", "200").c_str(), 200);
+	if(lFrames < 1) lFrames = 1;
+
+	cViewport *pViewport = TestCreateMapViewport(pWorld);
+	cCamera *pCamera = pViewport->GetCamera();
+
+	TestRenderFrame(kSceneRenderFrameTime);
+
+	/////////////////////////////
+	// Turn a full circle at the start position
+	int vCounts[eNullGraphicsCommand_LastEnum] = {0};
+	unsigned long lRenderTime = 0;
+	for(int i=0; i<lFrames; ++i)
+	{
+		pCamera->SetYaw(k2Pif * (float)i / (float)lFrames);
+
+		unsigned long lStartTime = TestGetTime();
+		cLowLevelGraphicsNull *pLowLevel = TestRenderFrame(kSceneRenderFrameTime);
+		lRenderTime += TestGetTime() - lStartTime;
+
+		AddFrameCounters(pLowLevel, vCounts);
+	}
+
+	TestReport("cScene::Render", lRenderTime, lFrames);
+	for(int i=0; i<eNullGraphicsCommand_LastEnum; ++i)
+	{
+		if(i == eNullGraphicsCommand_SwapBuffers) continue;
+
+		printf("  %-40s %10.1f per frame\n", cLowLevelGraphicsNull::GetCommandName((eNullGraphicsCommand)i), 
+				(double)vCounts[i] / (double)lFrames);
+	}
+
+	TestDestroyMapViewport(pViewport);
+	pEngine->GetScene()->DestroyWorld(pWorld);
+}
+
+//------------------------------------------
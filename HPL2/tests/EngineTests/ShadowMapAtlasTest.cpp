@@ -0,0 +1,271 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "EngineTest.h"
+
+#include "graphics/ShadowMapAtlas.h"
+
+//------------------------------------------
+
+class cAtlasTile
+{
+public:
+	cAtlasTile(const cVector2l& avPos, int alSize) : mvPos(avPos), mlSize(alSize) {}
+
+	cVector2l mvPos;
+	int mlSize;
+};
+
+static bool TilesOverlap(const cAtlasTile& aA, const cAtlasTile& aB)
+{
+	return	aA.mvPos.x < aB.mvPos.x + aB.mlSize && aB.mvPos.x < aA.mvPos.x + aA.mlSize &&
+			aA.mvPos.y < aB.mvPos.y + aB.mlSize && aB.mvPos.y < aA.mvPos.y + aA.mlSize;
+}
+
+//------------------------------------------
+
+HPL_TEST(ShadowMapAtlas_TileSizes)
+{
+	cShadowMapAtlas atlas(1000, 48);
+
+	HPL_CHECK(atlas.GetSize() == 1024);
+	HPL_CHECK(atlas.GetMinTileSize() == 64);
+	HPL_CHECK(atlas.GetTileSize(10) == 64);
+	HPL_CHECK(atlas.GetTileSize(100) == 128);
+	HPL_CHECK(atlas.GetTileSize(512) == 512);
+	HPL_CHECK(atlas.GetFreeTexels() == 1024*1024);
+
+	cVector2l vPos;
+	HPL_CHECK(atlas.Allocate(2048, vPos) == false);
+}
+
+//------------------------------------------
+
+HPL_TEST(ShadowMapAtlas_FreeMergesSiblings)
+{
+	cShadowMapAtlas atlas(512, 64);
+	cVector2l vPos;
+
+	/////////////////////////////
+	// A single small tile splits all levels, freeing it must merge them back up to the whole atlas
+	HPL_CHECK(atlas.Allocate(64, vPos));
+	HPL_CHECK(vPos == cVector2l(0,0));
+	HPL_CHECK(atlas.Allocate(512, vPos) == false);
+
+	atlas.Free(cVector2l(0,0), 64);
+	HPL_CHECK(atlas.GetFreeTexels() == 512*512);
+	HPL_CHECK(atlas.Allocate(512, vPos));
+	atlas.Free(vPos, 512);
+
+	/////////////////////////////
+	// Four siblings only merge once all four are free
+	cVector2l vQuarters[4];
+	for(int i=0; i<4; ++i) HPL_CHECK(atlas.Allocate(256, vQuarters[i]));
+	HPL_CHECK(atlas.Allocate(256, vPos) == false);
+	HPL_CHECK(atlas.GetFreeTexels() == 0);
+
+	for(int i=0; i<3; ++i) atlas.Free(vQuarters[i], 256);
+	HPL_CHECK(atlas.Allocate(512, vPos) == false);
+	HPL_CHECK(atlas.Allocate(256, vPos));
+	atlas.Free(vPos, 256);
+
+	atlas.Free(vQuarters[3], 256);
+	HPL_CHECK(atlas.Allocate(512, vPos));
+	atlas.Free(vPos, 512);
+
+	/////////////////////////////
+	// Random allocations never overlap, and the atlas is whole again once all are freed
+	std::vector<cAtlasTile> vTiles;
+	unsigned int lSeed = 1234;
+	for(int lIt=0; lIt<2000; ++lIt)
+	{
+		lSeed = lSeed * 1103515245 + 12345;
+		bool bAllocate = vTiles.empty() || ((lSeed >> 16) % 3) != 0;
+
+		if(bAllocate)
+		{
+			int lSize = 64 << ((lSeed >> 20) % 3);
+			if(atlas.Allocate(lSize, vPos)==false) continue;
+
+			cAtlasTile tile(vPos, lSize);
+			HPL_CHECK(vPos.x >= 0 && vPos.y >= 0 && vPos.x + lSize <= 512 && vPos.y + lSize <= 512);
+			HPL_CHECK(vPos.x % lSize == 0 && vPos.y % lSize == 0);
+			for(size_t i=0; i<vTiles.size(); ++i) HPL_CHECK(TilesOverlap(tile, vTiles[i])==false);
+			vTiles.push_back(tile);
+		}
+		else
+		{
+			size_t lIdx = (lSeed >> 8) % vTiles.size();
+			atlas.Free(vTiles[lIdx].mvPos, vTiles[lIdx].mlSize);
+			vTiles[lIdx] = vTiles.back();
+			vTiles.pop_back();
+		}
+
+		int lUsedTexels = 0;
+		for(size_t i=0; i<vTiles.size(); ++i) lUsedTexels += vTiles[i].mlSize * vTiles[i].mlSize;
+		HPL_CHECK(atlas.GetFreeTexels() == 512*512 - lUsedTexels);
+	}
+
+	for(size_t i=0; i<vTiles.size(); ++i) atlas.Free(vTiles[i].mvPos, vTiles[i].mlSize);
+	HPL_CHECK(atlas.GetFreeTexels() == 512*512);
+	HPL_CHECK(atlas.Allocate(512, vPos));
+}
+
+//------------------------------------------
+
+HPL_TEST(ShadowMapScheduler_RateFallsWithDistance)
+{
+	cShadowMapUpdateScheduler scheduler;
+	scheduler.SetReducedRateDistance(8, 4);
+	scheduler.SetMaxUpdateInterval(8);
+	scheduler.SetMaxTexelsPerFrame(1 << 30);
+
+	HPL_CHECK(scheduler.GetUpdateInterval(0) == 1);
+	HPL_CHECK(scheduler.GetUpdateInterval(8) == 1);
+	HPL_CHECK(scheduler.GetUpdateInterval(8.5f) == 2);
+	HPL_CHECK(scheduler.GetUpdateInterval(1000) == 8);
+
+	int lPrevInterval = 1;
+	for(int i=0; i<100; ++i)
+	{
+		int lInterval = scheduler.GetUpdateInterval((float)i);
+		HPL_CHECK(lInterval >= lPrevInterval && lInterval <= 8);
+		lPrevInterval = lInterval;
+	}
+
+	/////////////////////////////
+	// Casters changing every frame: the further away, the fewer updates
+	const int lFrames = 64;
+	int lPrevUpdates = lFrames+1;
+	for(float fDistance = 0; fDistance < 50; fDistance += 5)
+	{
+		cShadowMapUpdateRequest request;
+		request.mbContentValid = true;
+		request.mbCastersChanged = true;
+		request.mfDistance = fDistance;
+		request.mlTexels = 256*256;
+
+		int lUpdates = 0;
+		for(int lFrame=0; lFrame<lFrames; ++lFrame)
+		{
+			++request.mlFramesSinceUpdate;
+
+			scheduler.BeginFrame();
+			if(scheduler.Schedule(request) == eShadowMapUpdate_Render)
+			{
+				++lUpdates;
+				request.mlFramesSinceUpdate = 0;
+			}
+		}
+
+		HPL_CHECK(lUpdates == lFrames / scheduler.GetUpdateInterval(fDistance));
+		HPL_CHECK(lUpdates <= lPrevUpdates);
+		lPrevUpdates = lUpdates;
+	}
+	HPL_CHECK(lPrevUpdates == lFrames / 8);
+}
+
+//------------------------------------------
+
+HPL_TEST(ShadowMapScheduler_TexelBudget)
+{
+	cShadowMapUpdateScheduler scheduler;
+	scheduler.SetMaxTexelsPerFrame(1000);
+	scheduler.SetMaxUpdateInterval(8);
+
+	cShadowMapUpdateRequest request;
+	request.mbContentValid = true;
+	request.mbCastersChanged = true;
+	request.mfDistance = 0;
+	request.mlFramesSinceUpdate = 1;
+	request.mlTexels = 300;
+
+	/////////////////////////////
+	// Changed casters are rendered until the budget is used up
+	scheduler.BeginFrame();
+	for(int i=0; i<3; ++i) HPL_CHECK(scheduler.Schedule(request) == eShadowMapUpdate_Render);
+	HPL_CHECK(scheduler.Schedule(request) == eShadowMapUpdate_Delayed);
+	HPL_CHECK(scheduler.GetRenderedTexels() == 900);
+	HPL_CHECK(scheduler.GetRenderedNum() == 3);
+	HPL_CHECK(scheduler.GetDelayedNum() == 1);
+
+	/////////////////////////////
+	// Invalid content is rendered even over budget, unchanged content is never rendered
+	cShadowMapUpdateRequest invalidRequest = request;
+	invalidRequest.mbContentValid = false;
+	HPL_CHECK(scheduler.Schedule(invalidRequest) == eShadowMapUpdate_Render);
+	HPL_CHECK(scheduler.GetRenderedTexels() == 1200);
+
+	cShadowMapUpdateRequest unchangedRequest = request;
+	unchangedRequest.mbCastersChanged = false;
+	HPL_CHECK(scheduler.Schedule(unchangedRequest) == eShadowMapUpdate_Cached);
+
+	/////////////////////////////
+	// The budget is reset each frame, and a first update larger than the budget is still rendered
+	scheduler.BeginFrame();
+	HPL_CHECK(scheduler.GetRenderedTexels() == 0);
+
+	cShadowMapUpdateRequest largeRequest = request;
+	largeRequest.mlTexels = 5000;
+	HPL_CHECK(scheduler.Schedule(largeRequest) == eShadowMapUpdate_Render);
+	HPL_CHECK(scheduler.Schedule(request) == eShadowMapUpdate_Delayed);
+}
+
+//------------------------------------------
+
+HPL_TEST(ShadowMapScheduler_ForcedUpdate)
+{
+	cShadowMapUpdateScheduler scheduler;
+	scheduler.SetMaxTexelsPerFrame(1000);
+	scheduler.SetMaxUpdateInterval(8);
+	scheduler.SetReducedRateDistance(8, 4);
+
+	//A near light that uses the whole budget every frame
+	cShadowMapUpdateRequest nearRequest;
+	nearRequest.mbContentValid = true;
+	nearRequest.mbCastersChanged = true;
+	nearRequest.mfDistance = 0;
+	nearRequest.mlTexels = 1000;
+
+	//A far light that never fits in the budget
+	cShadowMapUpdateRequest farRequest = nearRequest;
+	farRequest.mfDistance = 100;
+
+	int lForcedFrame = -1;
+	for(int lFrame=1; lFrame<=40; ++lFrame)
+	{
+		++nearRequest.mlFramesSinceUpdate;
+		++farRequest.mlFramesSinceUpdate;
+
+		scheduler.BeginFrame();
+		HPL_CHECK(scheduler.Schedule(nearRequest) == eShadowMapUpdate_Render);
+		nearRequest.mlFramesSinceUpdate = 0;
+
+		if(scheduler.Schedule(farRequest) == eShadowMapUpdate_Render)
+		{
+			if(lForcedFrame < 0) lForcedFrame = lFrame;
+			HPL_CHECK(farRequest.mlFramesSinceUpdate == scheduler.GetMaxUpdateInterval()*2);
+			farRequest.mlFramesSinceUpdate = 0;
+		}
+	}
+
+	HPL_CHECK(lForcedFrame == scheduler.GetMaxUpdateInterval()*2);
+}
+
+//------------------------------------------
@@ -0,0 +1,182 @@
+/*
+ * Copyright © 2009-2020 Frictional Games
+ * 
+ * This file is part of Amnesia: The Dark Descent.
+ * 
+ * Amnesia: The Dark Descent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version. 
+
+ * Amnesia: The Dark Descent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Amnesia: The Dark Descent.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "EngineTest.h"
+
+#include <math.h>
+
+//------------------------------------------
+
+// Skins the sub meshes of the shipped character meshes with every supported kernel,
+// timing each and checking them against the scalar kernel.
+
+static const int kSkinIterations = 200;
+
+class cSkinBenchSubMesh
+{
+public:
+	cSubMesh *mpSubMesh;
+	cSkinningParams mParams;
+	tFloatVec mvPos;
+	tFloatVec mvNormal;
+	tFloatVec mvTangent;
+};
+
+static void SetupSkinBenchSubMesh(cSkinBenchSubMesh *apBench, cSubMesh *apSubMesh, const cMatrixf *apBoneMatrices)
+{
+	iVertexBuffer *pVtxBuffer = apSubMesh->GetVertexBuffer();
+	int lVtxNum = pVtxBuffer->GetVertexNum();
+	int lPosStride = pVtxBuffer->GetElementNum(eVertexBufferElement_Position);
+
+	apBench->mpSubMesh = apSubMesh;
+	apBench->mvPos.assign(pVtxBuffer->GetFloatArray(eVertexBufferElement_Position),
+							pVtxBuffer->GetFloatArray(eVertexBufferElement_Position) + lVtxNum*lPosStride);
+	apBench->mvNormal.assign(pVtxBuffer->GetFloatArray(eVertexBufferElement_Normal),
+							pVtxBuffer->GetFloatArray(eVertexBufferElement_Normal) + lVtxNum*3);
+	apBench->mvTangent.assign(pVtxBuffer->GetFloatArray(eVertexBufferElement_Texture1Tangent),
+							pVtxBuffer->GetFloatArray(eVertexBufferElement_Texture1Tangent) + lVtxNum*4);
+
+	cSkinningParams &params = apBench->mParams;
+	params.mpStreams = apSubMesh->GetSkinningStreams();
+	params.mpBoneMatrices = apBoneMatrices;
+	params.mpBindPos = pVtxBuffer->GetFloatArray(eVertexBufferElement_Position);
+	params.mpBindNormal = pVtxBuffer->GetFloatArray(eVertexBufferElement_Normal);
+	params.mpBindTangent = pVtxBuffer->GetFloatArray(eVertexBufferElement_Texture1Tangent);
+	params.mlPosStride = lPosStride;
+	params.mlEndVertex = lVtxNum;
+}
+
+//Must be called once the sub mesh is no longer moved around.
+static void SetSkinTargets(cSkinBenchSubMesh *apBench)
+{
+	apBench->mParams.mpSkinPos = &apBench->mvPos[0];
+	apBench->mParams.mpSkinNormal = &apBench->mvNormal[0];
+	apBench->mParams.mpSkinTangent = &apBench->mvTangent[0];
+}
+
+static float MaxDifference(const tFloatVec& avA, const tFloatVec& avB)
+{
+	float fMax = 0;
+	for(size_t i=0; i<avA.size(); ++i) fMax = cMath::Max(fMax, fabs(avA[i] - avB[i]));
+	return fMax;
+}
+
+//------------------------------------------
+
+HPL_BENCH(Skinning_CharacterMeshes)
+{
+	cEngine *pEngine = TestGetEngine();
+	if(pEngine==NULL) { TestSkip("no engine"); return; }
+
+	cMeshManager *pMeshManager = pEngine->GetResources()->GetMeshManager();
+
+	tStringVec vMeshFiles;
+	tString sSeparators = ",";
+	cString::GetStringVec(TestGetArg("skin_meshes", "servant_grunt.dae,servant_brute.dae"), vMeshFiles, &sSeparators);
+
+	int lMeshesSkinned = 0;
+
+	for(size_t lMesh=0; lMesh<vMeshFiles.size(); ++lMesh)
+	{
+		cMesh *pMesh = pMeshManager->CreateMesh(vMeshFiles[lMesh]);
+		if(pMesh==NULL)
+		{
+			Log("Skinning bench: could not load '%s'\n", vMeshFiles[lMesh].c_str());
+			continue;
+		}
+		if(pMesh->GetSkeleton()==NULL)
+		{
+			pMeshManager->Destroy(pMesh);
+			continue;
+		}
+
+		/////////////////////////////
+		// Posed bones, some rotation and translation on every bone
+		int lBoneNum = pMesh->GetSkeleton()->GetBoneNum();
+		std::vector<cMatrixf> vBoneMatrices(cMath::Max(lBoneNum,1));
+		for(size_t i=0; i<vBoneMatrices.size(); ++i)
+		{
+			float fT = (float)i * 0.37f;
+			vBoneMatrices[i] = cMath::MatrixRotate(cVector3f(sin(fT)*0.4f, cos(fT)*0.3f, fT*0.1f), eEulerRotationOrder_XYZ);
+			vBoneMatrices[i].SetTranslation(cVector3f(sin(fT)*0.05f, 0.02f, cos(fT)*0.05f));
+		}
+
+		/////////////////////////////
+		// Skinned sub meshes
+		std::vector<cSkinBenchSubMesh> vSubMeshes;
+		int lVertexNum = 0;
+		for(int i=0; i<pMesh->GetSubMeshNum(); ++i)
+		{
+			cSubMesh *pSubMesh = pMesh->GetSubMesh(i);
+			if(pSubMesh->GetSkinningStreams()->IsEmpty()) continue;
+			if(pSubMesh->GetVertexBuffer()->GetFloatArray(eVertexBufferElement_Texture1Tangent)==NULL) continue;
+
+			vSubMeshes.push_back(cSkinBenchSubMesh());
+			SetupSkinBenchSubMesh(&vSubMeshes.back(), pSubMesh, &vBoneMatrices[0]);
+			lVertexNum += pSubMesh->GetVertexBuffer()->GetVertexNum();
+		}
+		if(vSubMeshes.empty())
+		{
+			pMeshManager->Destroy(pMesh);
+			continue;
+		}
+		++lMeshesSkinned;
+
+		/////////////////////////////
+		// Reference
+		std::vector<cSkinBenchSubMesh> vReference = vSubMeshes;
+		for(size_t i=0; i<vSubMeshes.size(); ++i)
+		{
+			SetSkinTargets(&vSubMeshes[i]);
+			SetSkinTargets(&vReference[i]);
+			cSkinning::SkinVertices(vReference[i].mParams, eSkinningKernel_Scalar);
+		}
+
+		/////////////////////////////
+		// Run the kernels
+		Log("Skinning bench: '%s' %d bones %d vertices\n", vMeshFiles[lMesh].c_str(), lBoneNum, lVertexNum);
+		for(int lKernel=0; lKernel<eSkinningKernel_LastEnum; ++lKernel)
+		{
+			eSkinningKernel kernel = (eSkinningKernel)lKernel;
+			if(cSkinning::KernelIsSupported(kernel)==false) continue;
+
+			unsigned long lStartTime = TestGetTime();
+			for(int lIt=0; lIt<kSkinIterations; ++lIt)
+			{
+				for(size_t i=0; i<vSubMeshes.size(); ++i)
+					cSkinning::SkinVertices(vSubMeshes[i].mParams, kernel);
+			}
+			tString sLabel = cString::GetFileName(vMeshFiles[lMesh]) + " " + cSkinning::GetKernelName(kernel);
+			TestReport(sLabel.c_str(), TestGetTime() - lStartTime, kSkinIterations);
+
+			for(size_t i=0; i<vSubMeshes.size(); ++i)
+			{
+				HPL_CHECK(MaxDifference(vSubMeshes[i].mvPos, vReference[i].mvPos) < 1e-3f);
+				HPL_CHECK(MaxDifference(vSubMeshes[i].mvNormal, vReference[i].mvNormal) < 1e-3f);
+				HPL_CHECK(MaxDifference(vSubMeshes[i].mvTangent, vReference[i].mvTangent) < 1e-3f);
+			}
+		}
+
+		pMeshManager->Destroy(pMesh);
+	}
+
+	if(lMeshesSkinned==0) TestSkip("no skinned character meshes found, set -skin_meshes and -resources");
+}
+
+//------------------------------------------
@@ -990,10 +990,10 @@ public:
 						pTrack->Smooth(1.0f/30.0f * 4.0f, 0.5f, 4, true, true);
 						for(int frame =0; frame <pTrack->GetKeyFrameNum(); ++frame)
 						{
-							cKeyFrame *pFrame = pTrack->GetKeyFrame(frame);
-							Log("    %f (%s) | (%f %f %f %f)\n", pFrame->time,pFrame->trans.ToString().c_str(),
-												pFrame->rotation.v.x, pFrame->rotation.v.y, pFrame->rotation.v.z,
-												pFrame->rotation.w);
+							cKeyFrame keyFrame = pTrack->GetKeyFrame(frame);
+							Log("    %f (%s) | (%f %f %f %f)\n", keyFrame.time,keyFrame.trans.ToString().c_str(),
+												keyFrame.rotation.v.x, keyFrame.rotation.v.y, keyFrame.rotation.v.z,
+												keyFrame.rotation.w);
 						}
 						Log("-------\n\n");
 					}
@@ -148,7 +148,9 @@ void cLuxArea_SlimeDamage::OnUpdate(float afTimeStep)
 		//Run Callback
 		if(msCallback != "")
 		{
-			mpMap->RunScript(msCallback+"(\""+msName+"\")");
+			cScriptCall call(msCallback);
+			call.AddString(msName);
+			mpMap->RunScript(call);
 		}
 
 		/////////////////////////
@@ -211,7 +211,7 @@ void cLuxArea_Sticky::DetachBody()
 	//Callback function
 	if(msDetachFunction!="")
 	{
-		mpMap->RunScript(GetCallbackFunc(msDetachFunction,mpAttachedBody));
+		RunCallbackFunc(msDetachFunction,mpAttachedBody);
 	}
 
 	//Sound
@@ -401,7 +401,7 @@ void cLuxArea_Sticky::UpdateCollision(float afTimeStep)
 		// Call callback and see if it should be attached.
 		if(msAttachFunction!="")
 		{
-			mpMap->RunScript(GetCallbackFunc(msAttachFunction,pBody));
+			RunCallbackFunc(msAttachFunction,pBody);
 
 			if(mbAllowAttachment==false) continue;
 		}
@@ -416,9 +416,12 @@ void cLuxArea_Sticky::UpdateCollision(float afTimeStep)
 
 //-----------------------------------------------------------------------
 
-tString cLuxArea_Sticky::GetCallbackFunc(const tString &asFunc,iPhysicsBody *apBody)
+void cLuxArea_Sticky::RunCallbackFunc(const tString &asFunc,iPhysicsBody *apBody)
 {
-	return asFunc + "(\"" + msName + "\",\"" + apBody->GetName() + "\")"; 
+	cScriptCall call(asFunc);
+	call.AddString(msName);
+	call.AddString(apBody->GetName());
+	mpMap->RunScript(call);
 }
 
 //-----------------------------------------------------------------------
@@ -102,7 +102,7 @@ private:
 	void UpdateCollision(float afTimeStep);
 
 	
-	tString GetCallbackFunc(const tString &asFunc,iPhysicsBody *apBody);
+	void RunCallbackFunc(const tString &asFunc,iPhysicsBody *apBody);
 	
 	/////////////////////////
 	// Data
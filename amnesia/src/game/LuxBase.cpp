@@ -1111,6 +1111,9 @@ bool cLuxBase::InitEngine()
 	vars.mSound.mlStreamBufferCount = mpConfigHandler->mlSoundStreamBuffers;
 	vars.mSound.mlStreamBufferSize = mpConfigHandler->mlSoundStreamBufferSize;
 
+	vars.mGame.mlJobWorkerThreads = mpMainConfig->GetInt("Engine","JobWorkerThreads", -1);
+	vars.mGame.mlPhysicsThreads = mpMainConfig->GetInt("Engine","PhysicsThreads", 1);
+
 	// Sound device filter set here (if needed)
 #if defined(_WIN32)
 	iLowLevelSound::SetSoundDeviceNameFilter("software");
@@ -1124,6 +1127,10 @@ bool cLuxBase::InitEngine()
 	iRenderer::SetParallaxEnabled(mpConfigHandler->mbParallaxEnabled);
 
 	iRenderer::SetRefractionEnabled(mpConfigHandler->mbRefraction);
+	iRenderer::SetInstancingEnabled(mpConfigHandler->mbInstancing);
+	iRenderer::SetShadowMapAtlasEnabled(mpConfigHandler->mbShadowMapAtlas);
+	iRenderer::SetOcclusionQueryLatency(mpConfigHandler->mlOcclusionQueryLatency);
+	iRenderer::SetSoftwareOcclusionEnabled(mpConfigHandler->mbSoftwareOcclusion);
 
 	cRendererDeferred::SetSSAOBufferSizeDiv(mpConfigHandler->mlSSAOResolution==0? 2 : 1);
 	cRendererDeferred::SetSSAONumOfSamples(mpConfigHandler->mlSSAOSamples);
@@ -1131,6 +1138,7 @@ bool cLuxBase::InitEngine()
 	cRendererDeferred::SetGBufferType((eDeferredGBuffer)mpMainConfig->GetInt("Graphics","GBufferType", eDeferredGBuffer_32Bit));
 	cRendererDeferred::SetNumOfGBufferTextures(mpMainConfig->GetInt("Graphics","NumOfGBufferTextures", 3));
 	cRendererDeferred::SetEdgeSmoothLoaded(mpConfigHandler->mbEdgeSmooth);
+	cRendererDeferred::SetClusteredLightsLoaded(mpConfigHandler->mbClusteredLights);
 
 	cRendererDeferred::SetOcclusionTestLargeLights(mpConfigHandler->mbOcclusionTestLights);
 
@@ -1139,6 +1147,7 @@ bool cLuxBase::InitEngine()
 	//Other vars
 	cResources::SetForceCacheLoadingAndSkipSaving(mpConfigHandler->mbForceCacheLoadingAndSkipSaving);
 	cResources::SetCreateAndLoadCompressedMaps(false);
+	cResources::SetCompressAnimations(mpConfigHandler->mbCompressAnimations);
 	//cResources::SetCreateAndLoadCompressedMaps(mbPTestActivated || mpConfigHandler->mbCreateAndLoadCompressedMaps);
     
 	/////////////////////////
@@ -1154,6 +1163,7 @@ bool cLuxBase::InitEngine()
 	
 	mpEngine->SetLimitFPS(mpMainConfig->GetBool("Engine","LimitFPS", false));
 	mpEngine->SetWaitIfAppOutOfFocus(mpMainConfig->GetBool("Engine","SleepWhenOutOfFocus", true));
+	mpEngine->GetAI()->GetAStarRequestQueue()->SetMaxIterationsPerUpdate(mpMainConfig->GetInt("Engine","PathfindingIterationsPerUpdate", 3000));
 
 	cMaterialManager* pMatMgr = mpEngine->GetResources()->GetMaterialManager();
 	pMatMgr->SetTextureSizeDownScaleLevel(mpConfigHandler->mlTextureQuality);
@@ -71,6 +71,7 @@ void cLuxConfigHandler::LoadMainConfig()
 	msScreenShotExt = gpBase->mpMainConfig->GetString("Main","ScreenShotExt", "jpg");
 
 	mbForceCacheLoadingAndSkipSaving = gpBase->mpMainConfig->GetBool("Main","ForceCacheLoadingAndSkipSaving", true);
+	mbCompressAnimations = gpBase->mpMainConfig->GetBool("Main","CompressAnimations", false);
 	//mbCreateAndLoadCompressedMaps = gpBase->mpMainConfig->GetBool("Main","CreateAndLoadCompressedMaps", false);
 
 	/////////////////////
@@ -101,6 +102,11 @@ void cLuxConfigHandler::LoadMainConfig()
 	mbWorldReflection = gpBase->mpMainConfig->GetBool("Graphics", "WorldReflection", true);
 	mbRefraction =		gpBase->mpMainConfig->GetBool("Graphics", "Refraction", true);
 	mbEdgeSmooth =		gpBase->mpMainConfig->GetBool("Graphics", "EdgeSmooth", false);
+	mbInstancing =		gpBase->mpMainConfig->GetBool("Graphics", "InstancingEnabled", false);
+	mbShadowMapAtlas =	gpBase->mpMainConfig->GetBool("Graphics", "ShadowMapAtlasEnabled", false);
+	mbClusteredLights =	gpBase->mpMainConfig->GetBool("Graphics", "ClusteredLights", false);
+	mlOcclusionQueryLatency =	gpBase->mpMainConfig->GetInt("Graphics", "OcclusionQueryLatency", 0);
+	mbSoftwareOcclusion =	gpBase->mpMainConfig->GetBool("Graphics", "SoftwareOcclusionCulling", false);
 
 	// SSAO
 	mbSSAOActive =		gpBase->mpMainConfig->GetBool("Graphics","SSAOActive", true);
@@ -142,6 +148,7 @@ void cLuxConfigHandler::SaveMainConfig()
 	gpBase->mpMainConfig->SetString("Main","ScreenShotExt", msScreenShotExt);
 
 	gpBase->mpMainConfig->SetBool("Main","ForceCacheLoadingAndSkipSaving", mbForceCacheLoadingAndSkipSaving);
+	gpBase->mpMainConfig->SetBool("Main","CompressAnimations", mbCompressAnimations);
 
 	/////////////////////
 	// Engine init variables
@@ -175,6 +182,11 @@ void cLuxConfigHandler::SaveMainConfig()
 	
 	gpBase->mpMainConfig->SetBool("Graphics", "WorldReflection", mbWorldReflection);
 	gpBase->mpMainConfig->SetBool("Graphics", "Refraction", mbRefraction);
+	gpBase->mpMainConfig->SetBool("Graphics", "InstancingEnabled", mbInstancing);
+	gpBase->mpMainConfig->SetBool("Graphics", "ShadowMapAtlasEnabled", mbShadowMapAtlas);
+	gpBase->mpMainConfig->SetBool("Graphics", "ClusteredLights", mbClusteredLights);
+	gpBase->mpMainConfig->SetInt("Graphics", "OcclusionQueryLatency", mlOcclusionQueryLatency);
+	gpBase->mpMainConfig->SetBool("Graphics", "SoftwareOcclusionCulling", mbSoftwareOcclusion);
 	
 	gpBase->mpMainConfig->SetBool("Graphics", "ShadowsActive", mbShadowsActive);
 	gpBase->mpMainConfig->SetInt("Graphics","ShadowQuality", mlShadowQuality);
@@ -46,6 +46,7 @@ public:
 
 	bool mbCreateAndLoadCompressedMaps;
 	bool mbForceCacheLoadingAndSkipSaving;
+	bool mbCompressAnimations;
 
 	tString msLangFile;
 	
@@ -73,6 +74,11 @@ public:
 		
 	bool mbWorldReflection;
 	bool mbRefraction;
+	bool mbInstancing;
+	bool mbShadowMapAtlas;
+	bool mbClusteredLights;
+	int mlOcclusionQueryLatency;
+	bool mbSoftwareOcclusion;
 	bool mbShadowsActive;
 
 	bool mbForceShaderModel3And4Off;
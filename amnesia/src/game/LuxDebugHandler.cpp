@@ -432,6 +432,16 @@ void cLuxDebugHandler::OnDraw(float afFrameTime)
 			_W("Climbing: %d\n"), pCharBody->IsClimbing());
 		fY+=15.0f;
 
+		cLuxMap *pMap = gpBase->mpMapHandler->GetCurrentMap();
+		if(pMap)
+		{
+			const cPhysicsActivationStats& activationStats = pMap->GetPhysicsWorld()->GetActivationManager()->GetStats();
+			gpBase->mpGameDebugSet->DrawFont(gpBase->mpDefaultFont, cVector3f(5,fY,10),14,cColor(1,1),
+				_W("Frozen bodies: %d islands: %d cells: %d pending: %d\n"), activationStats.mlFrozenBodyNum, activationStats.mlFrozenIslandNum,
+																			activationStats.mlFrozenCellNum, activationStats.mlPendingIslandNum);
+			fY+=15.0f;
+		}
+
 		if(pPlayer->GetCurrentMoveState()==eLuxMoveState_Normal)
 		{
 			cLuxMoveState_Normal *pMoveNormal = static_cast<cLuxMoveState_Normal*>(pPlayer->GetCurrentMoveStateData());
@@ -1083,7 +1083,7 @@ void cLuxEffect_PlayVoice::Update(float afTimeStep)
 		SetActive(false);
 
 		if(sCallback!="")
-			gpBase->mpMapHandler->GetCurrentMap()->RunScript(sCallback+"()");
+			gpBase->mpMapHandler->GetCurrentMap()->RunScript(cScriptCall(sCallback));
 		
 		return;
 	}
@@ -1138,7 +1138,7 @@ void cLuxEffect_PlayVoice::Update(float afTimeStep)
 		SetActive(false);
 		
 		if(msOverCallback!="")
-			gpBase->mpMapHandler->GetCurrentMap()->RunScript(msOverCallback+"()");
+			gpBase->mpMapHandler->GetCurrentMap()->RunScript(cScriptCall(msOverCallback));
 	}
 }
 
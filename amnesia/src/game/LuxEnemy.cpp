@@ -1941,30 +1941,19 @@ bool iLuxEnemy::LineOfSight(const cVector3f &avPos, const cVector3f &avSize, boo
 
 	////////////////////////////
 	// Init variables
-	//Count of 2 is need for a line of sight success.
-	int lCount=0;
 	const int lMaxAdds = 9;
+	cPhysicsRay vRays[lMaxAdds];
 	
 	///////////////////////////////////
-	//Iterate through all the rays.
+	//Set up all the rays and check them as one batch.
 	for(int i=0; i< lMaxAdds; ++i)
 	{
 		cVector3f vAdd = vRight * (gvPosAdds[i].x*fHalfWidth) + vUp * (gvPosAdds[i].y*fHalfHeight);
-		cVector3f vStart = vStartCenter + vAdd;
-		cVector3f vEnd = vEndCenter + vAdd;
-
-		if(gpBase->mpMapHelper->CheckLineOfSight(vStart, vEnd,false))
-		{
-			lCount++;
-		}
-
-		if(lCount==2)
-		{
-			return true;
-		}
+		vRays[i] = cPhysicsRay(vStartCenter + vAdd, vEndCenter + vAdd);
 	}
-	
-	return false;
+
+	//Count of 2 is need for a line of sight success.
+	return gpBase->mpMapHelper->CheckLinesOfSight(vRays, lMaxAdds, false) >= 2;
 }
 
 //-----------------------------------------------------------------------
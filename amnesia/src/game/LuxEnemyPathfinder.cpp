@@ -37,6 +37,7 @@ cLuxEnemyPathfinder::cLuxEnemyPathfinder(iLuxEnemy *apEnemy, cLuxEnemyMover *apM
 	mpMover = apMover;
 
 	mbMoving = false;
+	mbWaitingForPath = false;
 
 	mpAStar = NULL;
 	mpNodeContainer = NULL;
@@ -84,25 +85,23 @@ void cLuxEnemyPathfinder::AfterWorldLoad()
 
 bool cLuxEnemyPathfinder::MoveTo(const cVector3f& avPos)
 {
-	///////////////////////
-	// Set up data
 	iCharacterBody *pCharBody = mpEnemy->mpCharBody;
 
-	mlstPathNodeDistances.clear();
-	mlstPathNodes.clear();
-	mbMoving = true;
-	
-	/////////////////////////////////////
-	//Get the start and goal position
-	cVector3f vStartPos = pCharBody->GetPosition();
-	mvMoveGoalPos = avPos;
-
 	/////////////////////////////////////
 	//No path finding just go straight to goal.
 	if(mpAStar==NULL)
 	{
+		mlstPathNodeDistances.clear();
+		mvPathNodes.clear();
+		mbMoving = true;
+		mvMoveGoalPos = avPos;
 		return false;
 	}
+
+	/////////////////////////////////////
+	//Get the start and goal position
+	cVector3f vStartPos = pCharBody->GetPosition();
+	mvRequestGoalPos = avPos;
 	
 
 	//If node is not at center, the nodes are assumed to be at feet, adjust for this!
@@ -114,25 +113,25 @@ bool cLuxEnemyPathfinder::MoveTo(const cVector3f& avPos)
 	vStartPos.y += 0.01f;
 
 	/////////////////////////////////
-	//Get the nodes of the path
-	bool bRet = mpAStar->GetPath(vStartPos,mvMoveGoalPos,&mlstPathNodes);
+	//Request the nodes of the path, the search is run by the AI update.
+	mbWaitingForPath = true;
+	GetRequestQueue()->AddRequest(mpAStar, vStartPos, mvRequestGoalPos, this);
 
-	if(bRet==false)
-	{
-		//Log("Could not find path!\n");
-		//TODO: Debug output
-	}
-
-	
-	return bRet;
+	return true;
 }
 
 //-----------------------------------------------------------------------
 
 void cLuxEnemyPathfinder::Stop()
 {
+	if(mbWaitingForPath)
+	{
+		GetRequestQueue()->CancelRequest(mpAStar);
+		mbWaitingForPath = false;
+	}
+
 	mbMoving = false;
-	mlstPathNodes.clear();
+	mvPathNodes.clear();
 	mlstPathNodeDistances.clear();
 }
 
@@ -276,8 +275,8 @@ void cLuxEnemyPathfinder::OnRenderSolid(cRendererCallbackFunctions* apFunctions)
 
 	//////////////////////////////
 	//Nodes
-	tAINodeListIt it = mlstPathNodes.begin();
-	for(; it != mlstPathNodes.end(); ++it)
+	tAINodeVecIt it = mvPathNodes.begin();
+	for(; it != mvPathNodes.end(); ++it)
 	{
 		cAINode *pNode = *it;
 
@@ -307,20 +306,35 @@ void cLuxEnemyPathfinder::OnRenderSolid(cRendererCallbackFunctions* apFunctions)
 
 cVector3f  cLuxEnemyPathfinder::GetNextGoalPos()
 {
-	if(mlstPathNodes.empty())
+	if(mvPathNodes.empty())
 	{
-		return mvMoveGoalPos;
+		return mbWaitingForPath ? mvRequestGoalPos : mvMoveGoalPos;
 	}
 	else
 	{
-		cAINode *pCurrentNode = mlstPathNodes.back();
+		cAINode *pCurrentNode = mvPathNodes.back();
 		return pCurrentNode->GetPosition();
 	}
 }
 
 const cVector3f& cLuxEnemyPathfinder::GetFinalGoalPos()
 {
-	return mvMoveGoalPos;
+	return mbWaitingForPath ? mvRequestGoalPos : mvMoveGoalPos;
+}
+
+//-----------------------------------------------------------------------
+
+void cLuxEnemyPathfinder::OnAStarRequestDone(cAStarHandler *apHandler, bool abFoundPath)
+{
+	mbWaitingForPath = false;
+
+	mlstPathNodeDistances.clear();
+	mvPathNodes.clear();
+	mbMoving = true;
+	mvMoveGoalPos = mvRequestGoalPos;
+
+	//If no path was found, go straight to goal.
+	if(abFoundPath) apHandler->GetSearchPath(&mvPathNodes);
 }
 
 //-----------------------------------------------------------------------
@@ -335,6 +349,9 @@ void cLuxEnemyPathfinder::UpdateMoving(float afTimeStep)
 {
 	if(mbMoving==false) return;
 
+	//Keep following the old path while waiting for the new, but do not head for the old goal.
+	if(mbWaitingForPath && mvPathNodes.empty()) return;
+
 	iCharacterBody *pCharBody = mpEnemy->mpCharBody;
 	cAINode *pCurrentNode = NULL;
 	
@@ -348,12 +365,12 @@ void cLuxEnemyPathfinder::UpdateMoving(float afTimeStep)
 
 	/////////////////////////////////////////
 	//Get the position to move towards and current node if there is any.
-	if(mlstPathNodes.empty())
+	if(mvPathNodes.empty())
 	{
 		vGoal = mvMoveGoalPos;
 	}
 	else{
-		pCurrentNode = mlstPathNodes.back();
+		pCurrentNode = mvPathNodes.back();
 		vGoal = pCurrentNode->GetPosition();
 	}
 
@@ -390,14 +407,14 @@ void cLuxEnemyPathfinder::UpdateMoving(float afTimeStep)
 	//Check if node is reached
 	if(bStuckAtNode || cMath::CheckPointInBVIntersection(vGoal, tempBV))
 	{
-		if(mlstPathNodes.empty())
+		if(mvPathNodes.empty())
 		{
 			mbMoving = false;
 			mpEnemy->SendMessage(eLuxEnemyMessage_EndOfPath);
 		}
 		else
 		{
-			mlstPathNodes.pop_back(); //Go to next node next update.
+			mvPathNodes.pop_back(); //Go to next node next update.
 		}
 		mlstPathNodeDistances.clear();
 	}
@@ -407,7 +424,7 @@ void cLuxEnemyPathfinder::UpdateMoving(float afTimeStep)
 	{
 		mpMover->ResetStuckCounter();
 
-		mlstPathNodes.clear();
+		mvPathNodes.clear();
 		mlstPathNodeDistances.clear();
 
 		mpEnemy->SendMessage(eLuxEnemyMessage_EndOfPath,0,false, 0,0,1);
@@ -416,6 +433,13 @@ void cLuxEnemyPathfinder::UpdateMoving(float afTimeStep)
 
 //-----------------------------------------------------------------------
 
+cAStarRequestQueue* cLuxEnemyPathfinder::GetRequestQueue()
+{
+	return gpBase->mpEngine->GetAI()->GetAStarRequestQueue();
+}
+
+//-----------------------------------------------------------------------
+
 //////////////////////////////////////////////////////////////////////////
 // SAVE DATA STUFF
 //////////////////////////////////////////////////////////////////////////
@@ -435,10 +459,18 @@ kEndSerialize()
 
 void cLuxEnemyPathfinder_SaveData::FromPathfinder(cLuxEnemyPathfinder *apPathfinder)
 {
+	//A path not yet found is saved as a move straight to the goal, without nodes.
+	if(apPathfinder->mbWaitingForPath)
+	{
+		mbMoving = true;
+		mvMoveGoalPos = apPathfinder->mvRequestGoalPos;
+		return;
+	}
+
 	mbMoving = apPathfinder->mbMoving;
 	mvMoveGoalPos = apPathfinder->mvMoveGoalPos;
 
-	for(tAINodeListIt it = apPathfinder->mlstPathNodes.begin(); it != apPathfinder->mlstPathNodes.end(); ++it)
+	for(tAINodeVecIt it = apPathfinder->mvPathNodes.begin(); it != apPathfinder->mvPathNodes.end(); ++it)
 	{
 		cAINode *pNode = *it;
 
@@ -463,7 +495,7 @@ void cLuxEnemyPathfinder_SaveData::SetupPathfinder(cLuxEnemyPathfinder *apPathfi
 	for(size_t i=0; i<mvPathNodeIds.Size(); ++i)
 	{
 		cAINode *pNode = apPathfinder->mpNodeContainer->GetNodeFromID(mvPathNodeIds[i]);
-		if(pNode) apPathfinder->mlstPathNodes.push_back(pNode);
+		if(pNode) apPathfinder->mvPathNodes.push_back(pNode);
 	}	
 }
 
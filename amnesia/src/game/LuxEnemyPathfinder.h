@@ -31,7 +31,7 @@ class cLuxEnemyMover;
 
 //----------------------------------------------
 
-class cLuxEnemyPathfinder
+class cLuxEnemyPathfinder : public iAStarRequestCallback
 {
 friend class cLuxEnemyPathfinder_SaveData;
 public:	
@@ -47,6 +47,10 @@ public:
 
 	//////////////////////
 	//Actions
+	/**
+	 * Requests a path to the position. The search is run by the engine's path request queue in the AI update
+	 * and the current path is followed until it is done. Returns false if there is no path finding.
+	 */
 	bool MoveTo(const cVector3f& avPos);
 	void Stop();
 
@@ -58,9 +62,10 @@ public:
 	
 	//////////////////////
 	//Properties
-	tAINodeList* GetNodeList(){ return &mlstPathNodes;}
+	tAINodeVec* GetNodeList(){ return &mvPathNodes;}
 
-	bool IsMoving(){ return mbMoving;}
+	bool IsMoving(){ return mbMoving || mbWaitingForPath;}
+	bool IsWaitingForPath(){ return mbWaitingForPath;}
 	cVector3f GetNextGoalPos();
 	const cVector3f& GetFinalGoalPos();
 
@@ -77,8 +82,13 @@ public:
 	//////////////////////
 	//Save data stuff
 	
+	//////////////////////
+	//Path request callback
+	void OnAStarRequestDone(cAStarHandler *apHandler, bool abFoundPath);
+
 private:
 	void UpdateMoving(float afTimeStep);
+	cAStarRequestQueue* GetRequestQueue();
 
 	iLuxEnemy *mpEnemy;
 	cLuxEnemyMover *mpMover;
@@ -89,7 +99,10 @@ private:
     bool mbMoving;
 	cVector3f mvMoveGoalPos;
 
-	tAINodeList mlstPathNodes;
+	bool mbWaitingForPath;
+	cVector3f mvRequestGoalPos;
+
+	tAINodeVec mvPathNodes;
 	std::list<float> mlstPathNodeDistances;
 };
 
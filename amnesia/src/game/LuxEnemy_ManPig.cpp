@@ -2149,17 +2149,13 @@ bool cLuxEnemy_ManPig::InsidePlayerView()
 	vPositions[1] = mpCharBody->GetPosition() + vSideAdd;
 	vPositions[2] = mpCharBody->GetPosition() - vSideAdd;
 	
+	cPhysicsRay vRays[3];
 	for(int i=0; i<3; ++i)
 	{
-		if(gpBase->mpMapHelper->CheckLineOfSight(vStart, vPositions[i], true))
-		{
-			//Log(" true: ray %d!\n", i);
-			return true;
-		}
+		vRays[i] = cPhysicsRay(vStart, vPositions[i]);
 	}
 
-	//Log(" false: no rays!\n");
-	return false;
+	return gpBase->mpMapHelper->CheckLinesOfSight(vRays, 3, true) > 0;
 }
 
 void cLuxEnemy_ManPig::UpdateCheckInLantern(float afTimeStep)
@@ -124,7 +124,10 @@ void iLuxEntity::RunCallbackFunc(const tString& asType)
 {
 	if(msCallbackFunc=="")return;
 
-	mpMap->RunScript(msCallbackFunc + "(\""+msName+"\", \""+asType+"\")" );
+	cScriptCall call(msCallbackFunc);
+	call.AddString(msName);
+	call.AddString(asType);
+	mpMap->RunScript(call);
 }
 
 //-----------------------------------------------------------------------
@@ -133,7 +136,9 @@ void iLuxEntity::RunInteractCallbackFunc()
 {
 	if(msInteractCallback=="")return;
 	
-	mpMap->RunScript(msInteractCallback + "(\""+msName+"\")");
+	cScriptCall call(msInteractCallback);
+	call.AddString(msName);
+	mpMap->RunScript(call);
 	
 	if(mbInteractCallbackRemove) msInteractCallback = "";
 }
@@ -271,15 +276,16 @@ void iLuxEntity::UpdatePlayerLookAt(float afTimeStep)
 		vLineOfSightTestPos[3] = vLineOfSightTestPos[0] + pCamera->GetRight() * fHalfRadius;
 		vLineOfSightTestPos[4] = vLineOfSightTestPos[0] - pCamera->GetRight() * fHalfRadius;
 				
+		cPhysicsRay vRays[5];
 		for(int i=0; i<5; ++i)
 		{
-			if(gpBase->mpMapHelper->CheckLineOfSight(vStart, vLineOfSightTestPos[i], false))
-			{
-				bLookingAt = true;
-				break;
-			}
+			vRays[i] = cPhysicsRay(vStart, vLineOfSightTestPos[i]);
+		}
+		if(gpBase->mpMapHelper->CheckLinesOfSight(vRays, 5, false) > 0)
+		{
+			bLookingAt = true;
+			break;
 		}
-		if(bLookingAt) break;
 	}
 
 	//////////////////////////////////////
@@ -289,11 +295,17 @@ void iLuxEntity::UpdatePlayerLookAt(float afTimeStep)
 		tString sTempCallback = msLookAtCallback;
 		if(mbLookAtCallbackRemove) msLookAtCallback = "";
 
-		mpMap->RunScript(sTempCallback + "(\""+msName+"\", 1)" );
+		cScriptCall call(sTempCallback);
+		call.AddString(msName);
+		call.AddInt(1);
+		mpMap->RunScript(call);
 	}
 	else if(bLookingAt==false && mbIsLookedAt)
 	{
-		mpMap->RunScript(msLookAtCallback + "(\""+msName+"\", -1)" );	
+		cScriptCall call(msLookAtCallback);
+		call.AddString(msName);
+		call.AddInt(-1);
+		mpMap->RunScript(call);
 	}
 
 	mbIsLookedAt = bLookingAt;
@@ -307,8 +319,10 @@ void iLuxEntity::ConnectionStateChange(int alState)
 	// Callback
 	if(msConnectionStateChangeCallback != "")
 	{
-		mpMap->RunScript(	msConnectionStateChangeCallback + 
-							"(\""+msName+"\", "+ cString::ToString(alState) + ")");
+		cScriptCall call(msConnectionStateChangeCallback);
+		call.AddString(msName);
+		call.AddInt(alState);
+		mpMap->RunScript(call);
 	}
 
     //////////////////////////////////
@@ -333,11 +347,12 @@ void iLuxEntity::ConnectionStateChange(int alState)
 		if(pConn->GetCallbackFunc()!="")
 		{
 			//Syntax: ConnectionName,ParentEnt, ChildEnt, state
-			tString sCommand = pConn->GetCallbackFunc() + "(\"" + pConn->GetName() + "\"," +
-															"\"" + msName +  + "\"," +
-															"\"" + pConn->GetEntity()->GetName() + "\"," +
-															cString::ToString(lState) + ")";
-			mpMap->RunScript(sCommand);		
+			cScriptCall call(pConn->GetCallbackFunc());
+			call.AddString(pConn->GetName());
+			call.AddString(msName);
+			call.AddString(pConn->GetEntity()->GetName());
+			call.AddInt(lState);
+			mpMap->RunScript(call);
 		}
 	}
 }
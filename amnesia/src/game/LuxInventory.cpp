@@ -325,7 +325,10 @@ bool cLuxInventory_Slot::OnMouseUp(iWidget* apWidget, const cGuiMessageData& aDa
 			{
 				bool bAutoDestroy = pComb->mbAutoDestroy;
 				tString sCombName = pComb->msName;
-				mpInventory->RunScript(pComb->msFunction+ "(\"" + pComb->msItemA + "\", \"" + pComb->msItemB + "\")" );
+				cScriptCall call(pComb->msFunction);
+				call.AddString(pComb->msItemA);
+				call.AddString(pComb->msItemB);
+				mpInventory->RunScript(call);
 				
 				if(bAutoDestroy) 
 				{
@@ -1324,6 +1327,13 @@ void cLuxInventory::RunScript(const tString& asCommand)
     mpScript->Run(asCommand);
 }
 
+void cLuxInventory::RunScript(const cScriptCall& aCall)
+{
+	if(mpScript==NULL) return;
+
+    mpScript->Run(aCall);
+}
+
 bool cLuxInventory::RecompileScript(tString *apOutput)
 {
 	if(mpScript)
@@ -222,6 +222,7 @@ public:
 	cLuxCombineItemsCallback* GetCombineCallback(const tString& asItemA, const tString& asItemB);
 
 	void RunScript(const tString& asCommand);
+	void RunScript(const cScriptCall& aCall);
 	bool RecompileScript(tString *apOutput);
 
 	void SetDescTextFromItem(cLuxInventory_Item *apItem);
@@ -210,7 +210,10 @@ bool cLuxItemType_Diary::BeforeAddItem(cLuxInventory_Item *apItem)
 	{
 		cLuxMap *pMap = gpBase->mpMapHandler->GetCurrentMap();
 	
-		pMap->RunScript(sCallbackFunc+"(\""+apItem->GetName()+ "\","+ cString::ToString(lDiaryIdx)+")" );
+		cScriptCall call(sCallbackFunc);
+		call.AddString(apItem->GetName());
+		call.AddInt(lDiaryIdx);
+		pMap->RunScript(call);
 	}
 
 	if(mbShowJournalOnPickup)
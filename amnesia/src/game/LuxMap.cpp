@@ -197,6 +197,15 @@ bool cLuxMap::LoadFromFile(const tString & asFile, bool abLoadEntities)
 
 	mpPhysicsWorld = mpWorld->GetPhysicsWorld();
 
+	//Stop simulating bodies far away from the player and enemies
+	cPhysicsActivationManager *pActivation = mpPhysicsWorld->GetActivationManager();
+	pActivation->SetCellSize(gpBase->mpGameCfg->GetFloat("Physics","ActivationCellSize",8));
+	pActivation->SetActivateRadius(gpBase->mpGameCfg->GetFloat("Physics","ActivateRadius",24));
+	pActivation->SetDeactivateRadius(gpBase->mpGameCfg->GetFloat("Physics","DeactivateRadius",32));
+	pActivation->SetDeactivateDelay(gpBase->mpGameCfg->GetFloat("Physics","DeactivateDelay",3));
+	pActivation->SetMaxReactivatedBodiesPerUpdate(gpBase->mpGameCfg->GetInt("Physics","MaxReactivatedBodiesPerUpdate",32));
+	pActivation->SetActive(gpBase->mpGameCfg->GetBool("Physics","ActivationManagerActive",true));
+
 	if(abLoadEntities) AfterWorldLoadEntitySetup();
 
 	gpBase->mpCurrentMapLoading = NULL;
@@ -409,6 +418,14 @@ void cLuxMap::RunScript(const tString& asCommand)
     mpScript->Run(asCommand);
 }
 
+void cLuxMap::RunScript(const cScriptCall& aCall)
+{
+	if(mpScript==NULL) return;
+	if(this != gpBase->mpMapHandler->GetCurrentMap()) return;
+
+    mpScript->Run(aCall);
+}
+
 bool cLuxMap::RecompileScript(tString *apOutput)
 {
 	if(mpScript)
@@ -540,7 +557,10 @@ void cLuxMap::LoadCheckPoint()
 
 	//////////////////////////////
 	// Run script (last thing done!)
-	RunScript(msCheckPointCallback + "(\""+ msCheckPointName + "\", "+cString::ToString(mlCheckPointCount)+")"  );
+	cScriptCall checkPointCall(msCheckPointCallback);
+	checkPointCall.AddString(msCheckPointName);
+	checkPointCall.AddInt(mlCheckPointCount);
+	RunScript(checkPointCall);
 	
 	mlCheckPointCount++;
 }
@@ -756,7 +776,7 @@ bool cLuxMap::AINodeIsUsedAsGoal(cAINode *apNode)
 	{
 		iLuxEnemy *pEnemy = it.Next();
 
-		tAINodeList *pNodeList = pEnemy->GetPathFinder()->GetNodeList();
+		tAINodeVec *pNodeList = pEnemy->GetPathFinder()->GetNodeList();
 		if(pNodeList->empty()) continue;
 
 		if(pNodeList->front() == apNode) return true;
@@ -1343,7 +1363,9 @@ void cLuxMap::UpdateTimers(float afTimeStep)
 
 		if(pTimer->mfCount <=0 && pTimer->mbDestroyMe==false)
 		{
-			RunScript(pTimer->msFunction+"(\""+pTimer->msName+"\")");
+			cScriptCall timerCall(pTimer->msFunction);
+			timerCall.AddString(pTimer->msName);
+			RunScript(timerCall);
 			it = mlstTimers.erase(it);
 			hplDelete(pTimer);
 			
@@ -89,6 +89,7 @@ public:
 	void Update(float afTimeStep);
 
 	void RunScript(const tString& asCommand);
+	void RunScript(const cScriptCall& aCall);
 	bool RecompileScript(tString *apOutput);
 
 	void OnRenderSolid(cRendererCallbackFunctions* apFunctions);
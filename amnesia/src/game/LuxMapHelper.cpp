@@ -449,20 +449,45 @@ bool cLuxMapHelper::ShapeDamage(iCollideShape *apShape, const cMatrixf& a_mtxTra
 
 
 bool cLuxMapHelper::CheckLineOfSight(const cVector3f& avStart, const cVector3f& avEnd, bool abCheckShadows)
+{
+	cPhysicsRay ray(avStart, avEnd);
+	return CheckLinesOfSight(&ray, 1, abCheckShadows) == 1;
+}
+
+//-----------------------------------------------------------------------
+
+int cLuxMapHelper::CheckLinesOfSight(cPhysicsRay *apRays, int alRayNum, bool abCheckShadows)
 {
 	////////////////////////////
 	//Check so there really is a world
 	cLuxMap *pCurrentMap = gpBase->mpMapHandler->GetCurrentMap();
-	if(pCurrentMap==NULL) return false;
+	if(pCurrentMap==NULL)
+	{
+		for(int i=0; i<alRayNum; ++i) apRays[i].mbHit = true;
+		return 0;
+	}
+	if(alRayNum <= 0) return 0;
 
 	iPhysicsWorld *pPhysicsWorld = pCurrentMap->GetPhysicsWorld();
 
-	mLineOfSightCallback.Reset();
+	////////////////////////////
+	//Any hit is enough to block, the callback is only used as filter.
+	if((int)mvTempRayHits.size() < alRayNum) mvTempRayHits.resize(alRayNum);
+
 	mLineOfSightCallback.SetCheckShadow(abCheckShadows);
-	pPhysicsWorld->CastRay(	&mLineOfSightCallback, avStart,avEnd,false,false,false,true);
+	pPhysicsWorld->CastRays(apRays, alRayNum, ePhysicsRayFlag_AnyHit | ePhysicsRayFlag_NoNormal, &mvTempRayHits[0],
+							&mLineOfSightCallback);
 
-	return mLineOfSightCallback.GetIntersected()==false;
+	int lFreeNum =0;
+	for(int i=0; i<alRayNum; ++i)
+	{
+		apRays[i].mbHit = mvTempRayHits[i].mbHit;
+		if(apRays[i].mbHit==false) lFreeNum++;
+	}
+
+	return lFreeNum;
 }
+
 //-----------------------------------------------------------------------
 
 bool cLuxMapHelper::GetClosestEntity(	const cVector3f& avStart,const cVector3f& avDir, float afRayLength,
@@ -110,6 +110,11 @@ public:
 						bool *apHitPlayer=NULL);
 
 	bool CheckLineOfSight(const cVector3f& avStart, const cVector3f& avEnd, bool abCheckShadows);
+	/**
+	 * Checks all lines in one batch, mbHit is set for lines that are blocked. Returns the number of free lines.
+	 * Keep lines from the same start next to each other, they are then checked together.
+	 */
+	int CheckLinesOfSight(cPhysicsRay *apRays, int alRayNum, bool abCheckShadows);
 
 	bool GetClosestEntity(	const cVector3f& avStart,const cVector3f& avDir, float afRayLength,
 							float *afDistance, iPhysicsBody** apBody, iLuxEntity **apEntity);
@@ -123,6 +128,7 @@ private:
 	void GetLightsAtNode(iRenderableContainerNode *apNode, tLightList &alstLights, const cVector3f& avPos);	
 
 	cLuxLineOfSightCallback mLineOfSightCallback;
+	tPhysicsRayHitVec mvTempRayHits;
 	cLuxClosestEntityCallback mClosestEntityCallback;
 	cLuxClosestCharColliderCallback mClosestharColliderCallback;
 	cLuxAttackRayCallback mAttackRayCallback;
@@ -979,7 +979,7 @@ void cLuxPlayerFlashback::Update(float afTimeStep)
 
 			cLuxMap *pMap = gpBase->mpMapHandler->GetCurrentMap();
 			if(msCallback != "")
-				pMap->RunScript(msCallback + "()");
+				pMap->RunScript(cScriptCall(msCallback));
 		}
 	}
 	
@@ -1084,7 +1084,7 @@ void cLuxPlayerLookAt::Update(float afTimeStep)
 	float fTotalDist = vDist.x*vDist.x + vDist.y*vDist.y;
 	if(fTotalDist < 0.01)
 	{
-		gpBase->mpMapHandler->GetCurrentMap()->RunScript(msAtTargetCallback+"()");
+		gpBase->mpMapHandler->GetCurrentMap()->RunScript(cScriptCall(msAtTargetCallback));
 	}
 }
 
@@ -1391,7 +1391,11 @@ void cLuxPlayerSanity::UpdateCheckEnemySeen(float afTimeStep)
 	}
 	
 	/////////////////////////////////////
-	// Iterate enemies
+	// Iterate enemies, collecting the rays of all enemies that might be seen
+	const int lRaysPerEnemy = 5;
+	mvCheckSeenEnemies.resize(0);
+	mvCheckSeenRays.resize(0);
+
 	cLuxEnemyIterator it = pMap->GetEnemyIterator();
     while(it.HasNext())
 	{
@@ -1416,9 +1420,9 @@ void cLuxPlayerSanity::UpdateCheckEnemySeen(float afTimeStep)
 		}
 		
 		//////////////////////////////
-		//Cast rays
+		//Add rays
 		cVector3f vHalfSize = pCharBody->GetSize()*0.5f;
-		cVector3f vPosAdd[5] = {
+		cVector3f vPosAdd[lRaysPerEnemy] = {
 			cVector3f(0),
 			vRight*vHalfSize.x,
 			vRight*vHalfSize.x*-1,
@@ -1426,22 +1430,34 @@ void cLuxPlayerSanity::UpdateCheckEnemySeen(float afTimeStep)
 			vUp*vHalfSize.y*-0.8f,
 		};
 
-		int lCount =0;
-		for(int i=0; i<5; ++i)
+		mvCheckSeenEnemies.push_back(pEnemy);
+		for(int i=0; i<lRaysPerEnemy; ++i)
+		{
+			mvCheckSeenRays.push_back(cPhysicsRay(vPlayerHeadPos, pCharBody->GetPosition()+vPosAdd[i]));
+		}
+	}
+
+	/////////////////////////////////////
+	// Cast all rays at once, an enemy is seen if at least two of its rays are free
+	if(mvCheckSeenRays.empty()==false)
+	{
+		gpBase->mpMapHelper->CheckLinesOfSight(&mvCheckSeenRays[0], (int)mvCheckSeenRays.size(), false);
+
+		for(size_t i=0; i<mvCheckSeenEnemies.size(); ++i)
 		{
-			if(gpBase->mpMapHelper->CheckLineOfSight(vPlayerHeadPos, pCharBody->GetPosition()+vPosAdd[i], false))
+			int lCount =0;
+			for(int j=0; j<lRaysPerEnemy; ++j)
 			{
-				lCount++;
-				if(lCount >=2)
-				{
-					bSeenEnemy = true;
-					pEnemy->SetIsSeenByPlayer(true);
-					break;
-				}
+				if(mvCheckSeenRays[i*lRaysPerEnemy + j].mbHit==false) lCount++;
+			}
+
+			//No break, since we check visibility for all enemies.
+			if(lCount >=2)
+			{
+				bSeenEnemy = true;
+				mvCheckSeenEnemies[i]->SetIsSeenByPlayer(true);
 			}
 		}
-		
-		//if(bSeenEnemy) break; No break, since we check visibility for all enemies.
 	}
 
 	/////////////////////////////////////
@@ -1832,7 +1848,9 @@ void cLuxPlayerLantern::SetActive(bool abX, bool abUseEffects, bool abCheckForOi
 	cLuxMap *pMap = gpBase->mpMapHandler->GetCurrentMap();
 	if(pMap->GetLanternLitCallback()!="")
 	{
-		pMap->RunScript(pMap->GetLanternLitCallback()+"(" + (mbActive ? "true" : "false") + ")" );
+		cScriptCall call(pMap->GetLanternLitCallback());
+		call.AddBool(mbActive);
+		pMap->RunScript(call);
 	}
 }
 
@@ -353,6 +353,9 @@ private:
 	float mfSeenEnemyCount;
 	bool mbEnemyIsSeen;
 
+	std::vector<iLuxEnemy*> mvCheckSeenEnemies;
+	tPhysicsRayVec mvCheckSeenRays;
+
 	float mfShowHintTimer;
 
 	//////////////
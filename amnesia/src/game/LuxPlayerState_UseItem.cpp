@@ -205,7 +205,10 @@ void cLuxPlayerState_UseItem::UseItem()
             // Running the script MAY destroy this item so "Backup" the check flag.
             bool bAutoDestroy = pCallback->mbAutoDestroy;
 			tString sName = pCallback->msName;
-            pMap->RunScript(pCallback->msFunction+ "(\"" + pCallback->msItem + "\", \"" + pCallback->msEntity + "\")" );
+			cScriptCall call(pCallback->msFunction);
+			call.AddString(pCallback->msItem);
+			call.AddString(pCallback->msEntity);
+            pMap->RunScript(call);
 
 			if(bAutoDestroy)
 			{
@@ -1208,7 +1208,11 @@ void iLuxProp::UpdateAnimation(float afTimeStep)
 	{
 		mlCurrentNonLoopAnimIndex = -1;
 		if(msAnimCallback !="")
-			mpMap->RunScript(msAnimCallback + "(\""+ msName + "\")");
+		{
+			cScriptCall call(msAnimCallback);
+			call.AddString(msName);
+			mpMap->RunScript(call);
+		}
 	}
 }
 
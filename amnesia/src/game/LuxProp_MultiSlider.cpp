@@ -368,7 +368,10 @@ void cLuxProp_MultiSlider::ChangeState(int alState, bool abEffects)
 	//Callback
 	if(msChangeStateCallback!="")
 	{
-		mpMap->RunScript(msChangeStateCallback + "(\""+msName+"\", "+cString::ToString(mlCurrentState)+")");
+		cScriptCall call(msChangeStateCallback);
+		call.AddString(msName);
+		call.AddInt(mlCurrentState);
+		mpMap->RunScript(call);
 	}
 }
 
@@ -292,6 +292,9 @@ void cLuxSavedGameMap::FromMap(cLuxMap *apMap)
 	// Init
 	cWorld *pWorld = apMap->GetWorld();
 
+	//Frozen bodies need their velocities back before being saved
+	apMap->GetPhysicsWorld()->GetActivationManager()->ReactivateAll();
+
 	/////////////////////
 	//Settings
 	msName = apMap->GetName();
@@ -61,6 +61,9 @@ void cLuxSavedMap::FromMap(cLuxMap *apMap)
 	// Init
 	cWorld *pWorld = apMap->GetWorld();
 
+	//Frozen bodies need their velocities back before being saved
+	apMap->GetPhysicsWorld()->GetActivationManager()->ReactivateAll();
+
 
 	/////////////////////////////////
 	// General properties
@@ -175,8 +175,11 @@ void iLuxCollideCallbackContainer::CheckCollisionCallback(const tString& asName,
             pCallback->mbColliding = bCollide;
 			if(lState == pCallback->mlStates || pCallback->mlStates==0)
 			{
-				tString sCommand = pCallback->msCallbackFunc+"(\"" + asName + "\", \""+ pEntity->GetName()+"\", "+cString::ToString(lState)+")" ;
-				apMap->RunScript(sCommand);
+				cScriptCall call(pCallback->msCallbackFunc);
+				call.AddString(asName);
+				call.AddString(pEntity->GetName());
+				call.AddInt(lState);
+				apMap->RunScript(call);
 			
 				///////////////////////
 				// Auto remove